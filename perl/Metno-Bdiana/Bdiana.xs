@@ -31,4 +31,21 @@ parseAndProcessString(const char* str, OUTLIST int ret)
   CODE:
     ret = diana_parseAndProcessString(str);
 
+void
+parseAndProcessStringToBuffer(const char* str, int kind)
+  PREINIT:
+    char* data;
+    size_t size;
+    int width, height, ret;
+  PPCODE:
+    ret = diana_parseAndProcessStringToBuffer(str, kind, &data, &size, &width, &height);
+    EXTEND(SP, 4);
+    mPUSHi(ret);
+    if (ret == DIANA_OK)
+      mPUSHp(data, size);
+    else
+      PUSHs(&PL_sv_undef);
+    mPUSHi(width);
+    mPUSHi(height);
+    diana_freeBuffer(data);
 
@@ -8,7 +8,7 @@
 use strict;
 use warnings;
 
-use Test::More tests => 4;
+use Test::More tests => 9;
 BEGIN { use_ok('Metno::Bdiana', ':all') };
 
 #########################
@@ -21,7 +21,7 @@ Metno::Bdiana::init();
 my $setup = "/disk1/WMS/usr/share/metno-wmsservice/verportal/bdiana/diana.setup";
 SKIP: {
 
-    skip "no test-data installed", 3 unless -r $setup; 
+    skip "no test-data installed", 8 unless -r $setup; 
 
     is(DI_OK(), readSetupFile($setup), "reading setup");
 
@@ -42,5 +42,14 @@ ENDPLOT
 EOT
     is(DI_OK(), parseAndProcessString($plot), "creating plot");
     ok(-f "/tmp/test.png", "plot created");
+
+    my ($ret, $png, $width, $height) = parseAndProcessStringToBuffer($plot, DI_BUFFER_ENCODED());
+    is(DI_OK(), $ret, "creating plot in memory");
+    is(substr($png, 1, 3), "PNG", "plot encoded as png");
+
+    ($ret, my $rgba, $width, $height) = parseAndProcessStringToBuffer($plot, DI_BUFFER_RGBA());
+    is(DI_OK(), $ret, "creating raw plot in memory");
+    is(length($rgba), 4*256*256, "raw plot size");
+    is("$width x $height", "256 x 256", "raw plot dimensions");
 }
 
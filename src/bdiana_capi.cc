@@ -43,6 +43,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -90,8 +92,15 @@
 #include <boost/algorithm/string/join.hpp>
 
 #include <QApplication>
+#include <QBuffer>
+#include <QImageWriter>
 #include <QPrinter>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+#include <QPdfWriter>
+#endif
 
+#include "export/ContourExport.h"
+#include "export/ImageSaver.h"
 #include "export/MovieMaker.h"
 
 #define MILOGGER_CATEGORY "diana.bdiana"
@@ -163,6 +172,8 @@ const std::string com_trajectory_opt = "trajectory_options";
 const std::string com_trajectory_print = "trajectory_print";
 const std::string com_setup_field_info = "setup_field_info";
 
+const std::string com_contour_times = "contour.times";
+
 const std::string com_time_opt = "time_options";
 const std::string com_time_format = "time_format";
 const std::string com_time = "time";
@@ -227,6 +238,9 @@ SpectrumManager* spectrummanager = 0;
 QApplication * application = 0; // The Qt Application object
 QPainter painter;
 QPrinter *printer = 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+QPdfWriter *pdfWriter = 0; // paints the pages instead of printer when writing pdf to memory
+#endif
 QPainter pagePainter;
 static DiPaintGLCanvas* glcanvas = 0;
 static DiPaintGLPainter* glpainter = 0;
@@ -270,6 +284,9 @@ bool postscript = false;
 bool svg = false;
 bool pdf = false;
 bool json = false;
+bool contours = false; // contour lines as vector data, without plotting
+ContourExport::Format contour_format = ContourExport::GEOJSON;
+std::string contour_times; // empty: plot time only, "all": all field times, else list of times
 int raster_type = image_png; // see enum image_type above
 
 bool plotAnnotationsOnly = false;
@@ -295,6 +312,11 @@ std::string time_format = "$time";
 
 QString movieFormat = "avi";
 MovieMaker *movieMaker = 0;
+ImageSaver *imageSaver = 0; // writes raster images while the next plot is made
+
+int outputBufferKind = 0; // DIANA_BUFFER_* while writing to memory, 0 when writing files
+QBuffer outputBuffer;     // encoded product when writing to memory
+QImage outputImage;       // raster product when writing to memory
 
 // list of lists..
 vector<stringlist> lists;
@@ -605,11 +627,40 @@ void endVideo()
   movieMaker = 0;
 }
 
+//! start writing a new product to memory, dropping any previous one
+static QIODevice* openOutputBuffer()
+{
+  outputBuffer.close();
+  outputBuffer.setData(QByteArray());
+  outputBuffer.open(QIODevice::WriteOnly);
+  outputImage = QImage();
+  return &outputBuffer;
+}
+
+static bool writeOutputImage(const QImage& img)
+{
+  openOutputBuffer();
+  outputImage = img;
+  if (outputBufferKind == DIANA_BUFFER_RGBA)
+    return true;
+
+  // same format as QImage::save would choose from the file name
+  QByteArray format = QFileInfo(QString::fromStdString(priop.fname)).suffix().toLower().toLatin1();
+  if (!QImageWriter::supportedImageFormats().contains(format))
+    format = "png";
+  if (!img.save(&outputBuffer, format.constData())) {
+    METLIBS_LOG_ERROR("could not encode image as '" << format.constData() << "'");
+    return false;
+  }
+  return true;
+}
+
 void startHardcopy(const plot_type pt, const printOptions priop)
 {
   if (!printer) {
     printer = new QPrinter();
-    printer->setOutputFileName(QString::fromStdString(priop.fname));
+    if (!outputBufferKind)
+      printer->setOutputFileName(QString::fromStdString(priop.fname));
     if (pdf)
       printer->setOutputFormat(QPrinter::PdfFormat);
     else {
@@ -640,17 +691,34 @@ void startHardcopy(const plot_type pt, const printOptions priop)
 
     QSizeF size = printer->paperSize(QPrinter::DevicePixel);
 
+    QPaintDevice* device = printer;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+    if (outputBufferKind) {
+      // QPrinter cannot write to a QIODevice, use its page layout for a QPdfWriter
+      pdfWriter = new QPdfWriter(openOutputBuffer());
+      pdfWriter->setResolution(printer->resolution());
+      pdfWriter->setPageLayout(printer->pageLayout());
+      device = pdfWriter;
+    }
+#endif
+
     double xscale = size.width()/xsize;
     double yscale = size.height()/ysize;
     double scale = qMin(qMin(xscale, yscale), 1.0);
-    pagePainter.begin(printer);
+    pagePainter.begin(device);
     pagePainter.translate(size.width()/2.0, size.height()/2.0);
     if (scale != 1.0)
       pagePainter.scale(scale, scale);
     pagePainter.translate(-xsize/2.0, -ysize/2.0);
     pagePainter.setClipRect(QRectF(0, 0, xsize, ysize));
-  } else
+  } else {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+    if (pdfWriter)
+      pdfWriter->newPage();
+    else
+#endif
       printer->newPage();
+  }
   hardcopy_started[pt] = true;
 }
 
@@ -674,6 +742,19 @@ void endHardcopy(const plot_type pt)
   hardcopy_started[pt] = false;
 }
 
+//! finish the document started in startHardcopy
+static void endPrinting()
+{
+  if (pagePainter.isActive())
+    pagePainter.end();
+  delete printer;
+  printer = 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+  delete pdfWriter;
+  pdfWriter = 0;
+#endif
+}
+
 // VPROF-options with parser
 std::vector<std::string> vprof_stations;
 vector<string> vprof_models, vprof_options;
@@ -833,6 +914,7 @@ static void printUsage(bool showexample)
     " - as EPS (Encapsulated PostScript)",
     " - as PNG (all available raster formats in Qt)",
     " - as AVI (MS MPEG4-v2 video format), MPG, MP4",
+    " - contour lines as GeoJSON, shapefile or binary polylines",
     "***************************************************",
     "",
     "Usage: bdiana -i <job-filename> [-s <setup-filename>]" // no "," / newline here
@@ -873,6 +955,12 @@ static void printUsage(bool showexample)
     "                         #  RASTER: format from filename-suffix",
     "                         #  PDF/SVG/JSON (only with -use_qimage)",
     "                         #  JSON (only for annotations)",
+    "                         #  GEOJSON/CONTOURS/CONTOURS.SHP: contour",
+    "                         #  lines of FIELD plots as GeoJSON, binary",
+    "                         #  polylines or shapefile, without plotting",
+    "contour.times=           # for GEOJSON/CONTOURS/CONTOURS.SHP: ALL or",
+    "                         #  comma-separated times, one file per time;",
+    "                         #  empty means plot time only",
     "colour=COLOUR            # GREYSCALE/COLOUR",
     "filename=tmp_diana.ps    # output filename",
     "keepPlotArea=NO          # YES=try to keep plotarea for several",
@@ -1496,6 +1584,101 @@ static bool MAKE_CONTROLLER()
   return true;
 }
 
+static vector<miTime> selectContourTimes()
+{
+  vector<miTime> times;
+  if (miutil::to_lower(contour_times) == "all") {
+    map<string,vector<miTime> > plottimes;
+    main_controller->getPlotTimes(plottimes);
+    times = plottimes["fields"];
+  } else if (!contour_times.empty()) {
+    const vector<string> vt = miutil::split(contour_times, ",");
+    for (size_t i = 0; i < vt.size(); ++i) {
+      if (miTime::isValid(vt[i]))
+        times.push_back(miTime(vt[i]));
+      else
+        METLIBS_LOG_WARN("WARNING, invalid time in " << com_contour_times << ": '" << vt[i] << "'");
+    }
+  } else {
+    selectTime();
+    times.push_back(ptime);
+  }
+  return times;
+}
+
+/*
+ * Write contour lines of all FIELD plots in the plot commands, without
+ * plotting. Fields are read one time after the other and contoured in
+ * parallel; one file is written per time.
+ */
+static int exportContours(vector<string>& pcom)
+{
+  if (not MAKE_CONTROLLER())
+    return 99;
+
+  vector<std::string> field_errors;
+  if (!main_controller->getFieldManager()->updateFileSetup(extra_field_lines, field_errors)) {
+    METLIBS_LOG_ERROR("ERROR, an error occurred while adding new fields:");
+    for (unsigned int kk = 0; kk < field_errors.size(); ++kk)
+      METLIBS_LOG_ERROR(field_errors[kk]);
+  }
+  extra_field_lines.clear();
+
+  if (updateCommandSyntax(pcom))
+    METLIBS_LOG_WARN("The plot commands are outdated, please update!");
+  main_controller->plotCommands(makeCommands(pcom));
+
+  const vector<miTime> times = selectContourTimes();
+
+  // one file per time, the filename must contain a time format like %Y%m%d%H
+  vector<std::string> filenames;
+  std::set<std::string> unique_filenames;
+  for (size_t t = 0; t < times.size(); ++t) {
+    std::string filename = priop.fname;
+    expandTime(filename, times[t]);
+    if (!unique_filenames.insert(filename).second) {
+      METLIBS_LOG_ERROR("ERROR, filename '" << priop.fname << "' is the same for several times,"
+          " add a time format like %Y%m%d%H");
+      return 99;
+    }
+    filenames.push_back(filename);
+  }
+
+  ContourExport exporter(contour_format);
+  for (size_t t = 0; t < times.size(); ++t) {
+    if (verbose)
+      METLIBS_LOG_INFO("- reading fields for time:" << times[t]);
+    main_controller->setPlotTime(times[t]);
+    if (!main_controller->updatePlots() && failOnMissingData) {
+      METLIBS_LOG_WARN("Failed to update plots.");
+      return 99;
+    }
+    const vector<FieldPlot*> fieldplots = main_controller->getFieldPlots();
+    for (size_t i = 0; i < fieldplots.size(); ++i) {
+      const PlotOptions& poptions = fieldplots[i]->getPlotOptions();
+      if (poptions.plottype != fpt_contour && poptions.plottype != fpt_contour1
+          && poptions.plottype != fpt_contour2) {
+        // wind, vector, shaded etc. plots have no contour lines to export
+        if (verbose)
+          METLIBS_LOG_INFO("- skipping plot type '" << poptions.plottype << "'");
+        continue;
+      }
+      const vector<Field*>& fields = fieldplots[i]->getFields();
+      if (!fields.empty())
+        exporter.add(times[t], fields[0], poptions);
+    }
+  }
+
+  int result = 0;
+  for (size_t t = 0; t < times.size(); ++t) {
+    if (verbose)
+      METLIBS_LOG_INFO("- writing contours to '" << filenames[t] << "'");
+    if (!exporter.write(times[t], filenames[t]))
+      result = 99;
+  }
+  return result;
+}
+
 static void handleVprofOpt(int& k)
 {
   const std::vector<std::string> pcom = FIND_END_COMMAND(k, com_vprof_opt_end);
@@ -1516,8 +1699,28 @@ static void handleSpectrumOpt(int& k)
   parse_spectrum_options(pcom);
 }
 
+//! check if the current output-format can be written in memory with outputBufferKind
+static bool canWriteOutputBuffer()
+{
+  if (raster)
+    return raster_type != image_avi;
+  if (outputBufferKind != DIANA_BUFFER_ENCODED)
+    return false;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+  if (pdf)
+    return true;
+#endif
+  return svg || json;
+}
+
 static int handlePlotCommand(int& k)
 {
+  if (outputBufferKind && !canWriteOutputBuffer()) {
+    METLIBS_LOG_ERROR("ERROR, the output-format cannot be written to memory, Linenumber:"
+        << linenumbers[k]);
+    return 1;
+  }
+
   // --- START PLOT ---
   const std::string command = miutil::to_lower(lines[k]);
   if (command == com_plot) {
@@ -1567,7 +1770,11 @@ static int handlePlotCommand(int& k)
     return 1;
   }
 
-  if (!buffermade) {
+  if (contours && multiple_plots) {
+    METLIBS_LOG_ERROR("ERROR, you can not export contours for multiple plots ..Exiting..");
+    return 1;
+  }
+  if (!buffermade && !contours) {
     METLIBS_LOG_ERROR("ERROR, no buffersize set..exiting");
     return 1;
   }
@@ -1597,6 +1804,9 @@ static int handlePlotCommand(int& k)
   }
   k++;
 
+  if (plottype == plot_standard && contours)
+    return exportContours(pcom);
+
   if (plottype == plot_standard) {
     // -- normal plot
 
@@ -1926,10 +2136,16 @@ static int handlePlotCommand(int& k)
     for (unsigned int i = 0; i < lines.size(); ++i)
       image.setText(QString::number(i), QString::fromStdString(lines[i]));
 
-    if (raster_type != image_avi)
-      image.save(QString::fromStdString(priop.fname));
-    else
+    if (outputBufferKind) {
+      if (!writeOutputImage(image))
+        return 1;
+    } else if (raster_type != image_avi) {
+      if (!imageSaver)
+        imageSaver = new ImageSaver();
+      imageSaver->add(image, QString::fromStdString(priop.fname));
+    } else {
       addVideoFrame(image);
+    }
 
   } else if (shape) { // Only shape output
 
@@ -1957,7 +2173,10 @@ static int handlePlotCommand(int& k)
     // a QPrinter instance which we do not otherwise use.
     QPrinter sprinter;
     QSvgGenerator svgFile;
-    svgFile.setFileName(QString::fromStdString(priop.fname));
+    if (outputBufferKind)
+      svgFile.setOutputDevice(openOutputBuffer());
+    else
+      svgFile.setFileName(QString::fromStdString(priop.fname));
     svgFile.setSize(QSize(xsize, ysize));
     svgFile.setViewBox(QRect(0, 0, xsize, ysize));
     svgFile.setResolution(sprinter.resolution());
@@ -1982,8 +2201,9 @@ static int handlePlotCommand(int& k)
 
     ensureNewContext();
 
-    QFile outputFile(QString::fromStdString(priop.fname));
-    if (outputFile.open(QFile::WriteOnly)) {
+    QFile jsonFile(QString::fromStdString(priop.fname));
+    QIODevice& outputFile = outputBufferKind ? *openOutputBuffer() : jsonFile;
+    if (outputFile.isOpen() || outputFile.open(QIODevice::WriteOnly)) {
       outputFile.write("{\n");
 
       unsigned int i = 0;
@@ -2221,6 +2441,10 @@ static int handlePrintDocument(int& k)
 
 static int handleWaitForCommands(int& k, int& linenum)
 {
+  // write the images made so far before waiting
+  if (imageSaver)
+    imageSaver->finish();
+
   if (command_path.empty()) {
     METLIBS_LOG_ERROR("ERROR, wait_for_commands found, but command_path not set");
     return 1;
@@ -2544,6 +2768,7 @@ static int handleOutputCommand(int& k, const std::string& value)
   raster = false;
   shape = false;
   json = false;
+  contours = false;
   postscript = false;
   svg = false;
   pdf = false;
@@ -2561,6 +2786,15 @@ static int handleOutputCommand(int& k, const std::string& value)
 
   } else if (lvalue == "shp") {
     shape = true;
+  } else if (lvalue == "geojson") {
+    contours = true;
+    contour_format = ContourExport::GEOJSON;
+  } else if (lvalue == "contours") {
+    contours = true;
+    contour_format = ContourExport::BINARY;
+  } else if (lvalue == "contours.shp") {
+    contours = true;
+    contour_format = ContourExport::SHAPEFILE;
   } else if (lvalue == "avi") {
     raster = true;
     movieFormat = "avi";
@@ -2593,7 +2827,7 @@ static int handleOutputCommand(int& k, const std::string& value)
     return 1;
   }
 
-  if (raster || shape) {
+  if (raster || shape || contours) {
     // first stop ongoing postscript sessions
     endHardcopy(plot_none);
   }
@@ -2612,10 +2846,7 @@ static int handleMultiplePlotsCommand(int& k, const std::string& value)
     if (multiple_plots) {
       METLIBS_LOG_ERROR("Multiple plots are already enabled at line " << linenumbers[k]);
       endHardcopy(plot_none);
-      if (printer && pagePainter.isActive()) {
-        pagePainter.end();
-        delete printer;
-      }
+      endPrinting();
     }
     vector<std::string> v1 = miutil::split(value, ",");
     if (v1.size() < 2) {
@@ -2694,7 +2925,18 @@ static int handlePlotCellCommand(int& k, const std::string& value)
   return 0;
 }
 
+static int parseAndProcessCommands(istream &is);
+
 static int parseAndProcess(istream &is)
+{
+  const int res = parseAndProcessCommands(is);
+  // all images must be written when processing the commands has finished
+  if (imageSaver && !imageSaver->finish() && res == 0)
+    return 1;
+  return res;
+}
+
+static int parseAndProcessCommands(istream &is)
 {
   ensureNewContext();
   
@@ -2908,6 +3150,9 @@ static int parseAndProcess(istream &is)
     } else if (key == com_trajectory_print) {
       main_controller->printTrajectoryPositions(value);
 
+    } else if (key == com_contour_times) {
+      contour_times = value;
+
     } else if (key == com_time_opt) {
       time_options = miutil::to_lower(value);
 
@@ -2922,10 +3167,7 @@ static int parseAndProcess(istream &is)
 
   // finish off any dangling postscript-sessions
   endHardcopy(plot_none);
-  if (printer && pagePainter.isActive()) {
-    pagePainter.end();
-    delete printer;
-  }
+  endPrinting();
 
   return 0;
 }
@@ -2950,6 +3192,73 @@ int diana_parseAndProcessString(const char* string)
   return DIANA_ERROR;
 }
 
+/*
+ * public C api writing the product to memory instead of files
+ */
+int diana_parseAndProcessStringToBuffer(const char* string, int kind,
+    char** data, size_t* size, int* width, int* height)
+{
+  *data = 0;
+  *size = 0;
+  if (width)
+    *width = 0;
+  if (height)
+    *height = 0;
+  if (kind != DIANA_BUFFER_ENCODED && kind != DIANA_BUFFER_RGBA)
+    return DIANA_ERROR;
+
+  outputBufferKind = kind;
+  openOutputBuffer();
+  int retVal = diana_parseAndProcessString(string);
+  endPrinting(); // pdf is complete only when the writer is deleted
+  outputBufferKind = 0;
+  outputBuffer.close();
+
+  QByteArray bytes;
+  if (kind == DIANA_BUFFER_RGBA && !outputImage.isNull()) {
+    const QImage argb = outputImage.convertToFormat(QImage::Format_ARGB32);
+    bytes.resize(4 * argb.width() * argb.height());
+    unsigned char* out = reinterpret_cast<unsigned char*>(bytes.data());
+    for (int y = 0; y < argb.height(); ++y) {
+      const QRgb* line = reinterpret_cast<const QRgb*>(argb.constScanLine(y));
+      for (int x = 0; x < argb.width(); ++x) {
+        *out++ = qRed(line[x]);
+        *out++ = qGreen(line[x]);
+        *out++ = qBlue(line[x]);
+        *out++ = qAlpha(line[x]);
+      }
+    }
+  } else {
+    bytes = outputBuffer.data();
+  }
+  const QSize imageSize = outputImage.size();
+  outputBuffer.setData(QByteArray());
+  outputImage = QImage();
+
+  if (retVal != DIANA_OK)
+    return retVal;
+  if (bytes.isEmpty()) {
+    METLIBS_LOG_ERROR("no product has been written to memory");
+    return DIANA_ERROR;
+  }
+
+  *data = static_cast<char*>(malloc(bytes.size()));
+  if (!*data)
+    return DIANA_ERROR;
+  memcpy(*data, bytes.constData(), bytes.size());
+  *size = bytes.size();
+  if (width)
+    *width = imageSize.width();
+  if (height)
+    *height = imageSize.height();
+  return DIANA_OK;
+}
+
+void diana_freeBuffer(char* data)
+{
+  free(data);
+}
+
 
 /*
  =================================================================
@@ -3183,6 +3492,8 @@ int diana_dealloc()
   // clean up structures
   if(movieMaker)
     endVideo();
+  delete imageSaver;
+  imageSaver = 0;
 
   delete vprofmanager;
   delete spectrummanager;
@@ -2,6 +2,8 @@
 #define BDIANA_CAPI_H_
 
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,6 +17,20 @@ extern int diana_dealloc();
 extern int diana_readSetupFile(const char* setupFilename);
 extern int diana_parseAndProcessString(const char* str);
 
+/* kinds of output for diana_parseAndProcessStringToBuffer */
+#define DIANA_BUFFER_ENCODED 1 /* file content as selected with "output=", i.e. png, svg, pdf or json */
+#define DIANA_BUFFER_RGBA 2    /* raster image, 4 bytes (r, g, b, a) per pixel, rows from top to bottom */
+
+/* Like diana_parseAndProcessString, but return the last product in
+ * *data instead of writing it to a file. *data must be released with
+ * diana_freeBuffer. width and height (may be NULL) are set to the image
+ * size for raster output and to 0 otherwise. Video, postscript and shape
+ * output cannot be written to memory.
+ */
+extern int diana_parseAndProcessStringToBuffer(const char* str, int kind,
+    char** data, size_t* size, int* width, int* height);
+extern void diana_freeBuffer(char* data);
+
 
 #ifdef __cplusplus
 }
@@ -70,7 +70,8 @@ using namespace std;
 
 Controller::Controller()
 : plotm(0), fieldm(0), fieldplotm(0), obsm(0), satm(0),
-  objm(0), editm(0),editoverride(false)
+  objm(0), editm(0),editoverride(false),
+  guiThread(std::this_thread::get_id())
 {
   METLIBS_LOG_SCOPE();
 
@@ -107,6 +108,7 @@ Controller::~Controller()
 
 void Controller::setCanvas(DiCanvas* canvas)
 {
+  const PlotLock lock = lockPlots();
   plotm->setCanvas(canvas);
 }
 
@@ -115,8 +117,33 @@ DiCanvas* Controller::canvas()
   return DrawingManager::instance()->canvas(); // FIXME store elsewhere
 }
 
+void Controller::setPlotCancel(const std::function<void()>& cancel)
+{
+  plotCancel = cancel;
+}
+
+Controller::PlotLock Controller::lockPlots() const
+{
+  if (plotCancel)
+    plotCancel();
+  return PlotLock(plotMutex);
+}
+
+bool Controller::canPlotInThread()
+{
+  // no lock here, mapmode and manager states are only changed by the gui thread
+  if (editm->getMapMode() != normal_mode || editm->isInEdit())
+    return false;
+  for (PlotModule::managers_t::const_iterator it = plotm->managers.begin(); it != plotm->managers.end(); ++it) {
+    if (it->second->hasPlots())
+      return false;
+  }
+  return true;
+}
+
 // hack: indices for colorIndex mode set from gui
 void Controller::setColourIndices(std::vector<Colour::ColourInfo>& vc){
+  const PlotLock lock = lockPlots();
   int n= vc.size();
   for (int i=0; i<n; i++){
     Colour::setindex(vc[i].name,vc[i].rgb[0]);
@@ -126,11 +153,13 @@ void Controller::setColourIndices(std::vector<Colour::ColourInfo>& vc){
 bool Controller::updateFieldFileSetup(const std::vector<std::string>& lines,
     std::vector<std::string>& errors)
 {
+  const PlotLock lock = lockPlots();
   return getFieldManager()->updateFileSetup(lines, errors);
 }
 
 bool Controller::parseSetup()
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE();
 
   // plotm->getStaticPlot()->initFontManager();
@@ -182,6 +211,7 @@ bool Controller::parseSetup()
 
 void Controller::plotCommands(const PlotCommand_cpv& inp)
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE();
   if (METLIBS_LOG_DEBUG_ENABLED()) {
     for (size_t q = 0; q < inp.size(); q++)
@@ -194,16 +224,26 @@ void Controller::plotCommands(const PlotCommand_cpv& inp)
 void Controller::plot(DiGLPainter* gl, bool under, bool over)
 {
   METLIBS_LOG_SCOPE();
+  PlotLock lock(plotMutex, std::defer_lock);
+  if (std::this_thread::get_id() != guiThread) {
+    // render thread: wait for the gui thread, cancelling would drop this frame
+    lock.lock();
+  } else if (!lock.try_lock()) {
+    // gui thread: stop the render thread only when it has to wait for it
+    lock = lockPlots();
+  }
   plotm->plot(gl, under, over);
 }
 
 vector<AnnotationPlot*> Controller::getAnnotations()
 {
+  const PlotLock lock = lockPlots();
   return plotm->getAnnotations();
 }
 
 vector<Rectangle> Controller::plotAnnotations(DiGLPainter* gl)
 {
+  const PlotLock lock = lockPlots();
   return plotm->plotAnnotations(gl);
 }
 
@@ -223,15 +263,29 @@ const Area& Controller::getMapArea(){
 }
 
 void Controller::zoomTo(const Rectangle & r) {
+  const PlotLock lock = lockPlots();
   plotm->setMapAreaFromMap(r);
 }
 
 void Controller::zoomOut(){
+  const PlotLock lock = lockPlots();
   plotm->zoomOut();
 }
 
+void Controller::setInteractive(bool interactive)
+{
+  const PlotLock lock = lockPlots();
+  plotm->setInteractive(interactive);
+}
+
+bool Controller::isInteractive() const
+{
+  return plotm->isInteractive();
+}
+
 // plotwindow size from GLwidget..
 void Controller::setPlotWindow(const int w, const int h){
+  const PlotLock lock = lockPlots();
   plotm->setPlotWindow(w,h);
 }
 
@@ -277,23 +331,27 @@ double Controller::getWindowArea()
   return plotm->getWindowArea();
 }
 
-const miutil::miTime& Controller::getPlotTime()
+miutil::miTime Controller::getPlotTime()
 {
+  const PlotLock lock = lockPlots();
   return plotm->getPlotTime();
 }
 
 void Controller::getPlotTimes(map<string,vector<miutil::miTime> >& times)
 {
+  const PlotLock lock = lockPlots();
   plotm->getPlotTimes(times);
 }
 
 bool Controller::getProductTime(miTime& t)
 {
+  const PlotLock lock = lockPlots();
   return editm->getProductTime(t);
 }
 
 std::string Controller::getProductName()
 {
+  const PlotLock lock = lockPlots();
   return editm->getProductName();
 }
 
@@ -305,44 +363,52 @@ std::string Controller::getProductName()
 // set plottime
 void Controller::setPlotTime(const miTime& t)
 {
+  const PlotLock lock = lockPlots();
   plotm->setPlotTime(t);
 }
 
 // toggle area conservatism
 void Controller::keepCurrentArea(bool b){
+  const PlotLock lock = lockPlots();
   plotm->keepCurrentArea(b);
 }
 
 // update plot-classes with new data
 bool Controller::updatePlots()
 {
+  const PlotLock lock = lockPlots();
   return plotm->updatePlots();
 }
 
 // reload obsevations
 void Controller::updateObs(){
+  const PlotLock lock = lockPlots();
   plotm->updateObs();
 }
 
 // find obs in grid position x,y
 bool Controller::findObs(int x, int y)
 {
+  const PlotLock lock = lockPlots();
   return plotm->obsplots()->findObs(x,y);
 }
 
 bool Controller::getObsName(int x, int y, std::string& name)
 {
+  const PlotLock lock = lockPlots();
   return plotm->obsplots()->getObsName(x,y,name);
 }
 
 std::string Controller::getObsPopupText(int x, int y)
 {
+  const PlotLock lock = lockPlots();
   return plotm->obsplots()->getObsPopupText(x,y);
 }
 
 // plot other observations
 void Controller::nextObs(bool next)
 {
+  const PlotLock lock = lockPlots();
   plotm->obsplots()->nextObs(next);
 }
 
@@ -352,6 +418,7 @@ bool Controller::initHqcdata(int from,
     const string& common,
     const string& desc,
     const vector<string>& data){
+  const PlotLock lock = lockPlots();
   return obsm->initHqcdata(from,commondesc,common,desc,data);
 }
 
@@ -360,51 +427,60 @@ void Controller::updateHqcdata(const string& commondesc,
     const string& common,
     const string& desc,
     const vector<string>& data){
+  const PlotLock lock = lockPlots();
   obsm->updateHqcdata(commondesc,common,desc,data);
 }
 
 //select obs parameter to flag from QSocket
 void Controller::processHqcCommand(const std::string& command,
     const std::string& str){
+  const PlotLock lock = lockPlots();
   obsm->processHqcCommand(command, str);
 }
 
 //plot trajectory position
 void Controller::trajPos(const vector<string>& str)
 {
+  const PlotLock lock = lockPlots();
   plotm->trajPos(str);
 }
 
 //plot measurements position
 void Controller::measurementsPos(const vector<string>& str)
 {
+  const PlotLock lock = lockPlots();
   plotm->measurementsPos(str);
 }
 
 // start trajectory computation
 bool Controller::startTrajectoryComputation(){
+  const PlotLock lock = lockPlots();
   return plotm->startTrajectoryComputation();
 }
 
 // get trajectory fields
 vector<string> Controller::getTrajectoryFields()
 {
+  const PlotLock lock = lockPlots();
   return plotm->fieldplots()->getTrajectoryFields();
 }
 
 // write trajectory positions to file
 bool Controller::printTrajectoryPositions(const std::string& filename ){
+  const PlotLock lock = lockPlots();
   return plotm->printTrajectoryPositions( filename );
 }
 
 // get name++ of current channels (with calibration)
 vector<string> Controller::getCalibChannels()
 {
+  const PlotLock lock = lockPlots();
   return satm->getCalibChannels();
 }
 
 // show values in grid position x,y
 vector<SatValues> Controller::showValues(float x, float y){
+  const PlotLock lock = lockPlots();
   return satm->showValues(x,y);
 }
 
@@ -419,42 +495,50 @@ vector<SatValues> Controller::showValues(float x, float y){
 
 vector<string> Controller::getSatnames()
 {
+  const PlotLock lock = lockPlots();
   return satm->getSatnames();
 }
 
 void Controller::showAnnotations(bool on)
 {
+  const PlotLock lock = lockPlots();
   plotm->showAnnotations(on);
 }
 
 bool Controller::markAnnotationPlot(int x, int y)
 {
+  const PlotLock lock = lockPlots();
   return plotm->markAnnotationPlot(x,y);
 }
 
 std::string Controller::getMarkedAnnotation()
 {
+  const PlotLock lock = lockPlots();
   return plotm->getMarkedAnnotation();
 }
 
 void Controller::changeMarkedAnnotation(std::string text,int cursor,
     int sel1, int sel2)
 {
+  const PlotLock lock = lockPlots();
   plotm->changeMarkedAnnotation(text,cursor,sel1,sel2);
 }
 
 void Controller::DeleteMarkedAnnotation()
 {
+  const PlotLock lock = lockPlots();
   plotm->DeleteMarkedAnnotation();
 }
 
 void Controller::startEditAnnotation()
 {
+  const PlotLock lock = lockPlots();
   plotm->startEditAnnotation();
 }
 
 void Controller::stopEditAnnotation(std::string prodname)
 {
+  const PlotLock lock = lockPlots();
   const PlotCommand_cpv labels  = plotm->writeAnnotations(prodname);
   editm->saveProductLabels(labels);
   plotm->stopEditAnnotation();
@@ -462,12 +546,14 @@ void Controller::stopEditAnnotation(std::string prodname)
 
 void Controller::editNextAnnoElement()
 {
+  const PlotLock lock = lockPlots();
   plotm->editNextAnnoElement();
 }
 
 
 void Controller::editLastAnnoElement()
 {
+  const PlotLock lock = lockPlots();
   plotm->editLastAnnoElement();
 }
 
@@ -475,6 +561,7 @@ void Controller::editLastAnnoElement()
 //Archive mode
 void Controller::archiveMode(bool on)
 {
+  const PlotLock lock = lockPlots();
   obsm->archiveMode(on);
   satm->archiveMode(on);
 }
@@ -493,6 +580,7 @@ void Controller::archiveMode(bool on)
 //
 void Controller::sendMouseEvent(QMouseEvent* me, EventResult& res)
 {
+  const PlotLock lock = lockPlots();
 #ifdef DEBUGREDRAW
   METLIBS_LOG_SCOPE();
 #endif
@@ -566,6 +654,7 @@ void Controller::sendMouseEvent(QMouseEvent* me, EventResult& res)
 //
 void Controller::sendKeyboardEvent(QKeyEvent* ke, EventResult& res)
 {
+  const PlotLock lock = lockPlots();
   bool keyoverride = false;
   res.do_nothing();
 
@@ -712,6 +801,7 @@ mapMode Controller::getMapMode()
 
 set<string> Controller::getComplexList()
 {
+  const PlotLock lock = lockPlots();
   return objm->getComplexList();
 }
 
@@ -720,10 +810,11 @@ set<string> Controller::getComplexList()
 
 
 // return satfileinfo
-const vector<SatFileInfo>& Controller::getSatFiles(const std::string& satellite,
+vector<SatFileInfo> Controller::getSatFiles(const std::string& satellite,
     const std::string& file,
     bool update)
 {
+  const PlotLock lock = lockPlots();
   return satm->getFiles(satellite,file,update);
 }
 
@@ -731,28 +822,33 @@ const vector<SatFileInfo>& Controller::getSatFiles(const std::string& satellite,
 void Controller::getCapabilitiesTime(set<miTime>& okTimes,
     const PlotCommand_cpv& pinfos, bool allTimes)
 {
+  const PlotLock lock = lockPlots();
   plotm->getCapabilitiesTime(okTimes,pinfos,allTimes);
 }
 
-const vector<Colour>& Controller::getSatColours(const std::string& satellite,
+vector<Colour> Controller::getSatColours(const std::string& satellite,
     const std::string& file)
 {
+  const PlotLock lock = lockPlots();
   return satm->getColours(satellite,file);
 }
 
 
-const vector<std::string>& Controller::getSatChannels(const std::string& satellite,
+vector<std::string> Controller::getSatChannels(const std::string& satellite,
     const std::string& file, int index)
 {
+  const PlotLock lock = lockPlots();
   return satm->getChannels(satellite,file,index);
 }
 
 bool Controller::isMosaic(const std::string & satellite, const std::string & file)
 {
+  const PlotLock lock = lockPlots();
   return satm->isMosaic(satellite,file);
 }
 
 void Controller::SatRefresh(const std::string& satellite, const std::string& file){
+  const PlotLock lock = lockPlots();
   // HK set flag to refresh all files
   satm->updateFiles();
   satm->getFiles(satellite,file,true);
@@ -763,6 +859,7 @@ void Controller::SatRefresh(const std::string& satellite, const std::string& fil
 
 bool Controller::satFileListChanged()
 {
+  const PlotLock lock = lockPlots();
   // returns information about whether list of satellite files have changed
   //hence dialog and timeSlider times should change as well
   return satm->isFileListChanged();
@@ -770,6 +867,7 @@ bool Controller::satFileListChanged()
 
 void Controller::satFileListUpdated()
 {
+  const PlotLock lock = lockPlots();
   //called when the dialog and timeSlider updated with info from satellite
   //file list
   satm->setFileListChanged(false);
@@ -777,6 +875,7 @@ void Controller::satFileListUpdated()
 
 bool Controller::obsTimeListChanged()
 {
+  const PlotLock lock = lockPlots();
   // returns information about whether list of observation files have changed
   //hence dialog and timeSlider times should change as well
   return obsm->timeListChanged;
@@ -784,6 +883,7 @@ bool Controller::obsTimeListChanged()
 
 void Controller::obsTimeListUpdated()
 {
+  const PlotLock lock = lockPlots();
   //called when the dialog and timeSlider updated with info from observation
   //file list
   obsm->timeListChanged = false;
@@ -793,6 +893,7 @@ void Controller::obsTimeListUpdated()
 void Controller::setSatAuto(bool autoFile,const std::string& satellite,
     const std::string& file)
 {
+  const PlotLock lock = lockPlots();
   satm->setSatAuto(autoFile,satellite,file);
 }
 
@@ -800,60 +901,71 @@ void Controller::setSatAuto(bool autoFile,const std::string& satellite,
 void Controller::getUffdaClasses(vector <std::string> & vUffdaClass,
     vector <std::string> &vUffdaClassTip)
 {
+  const PlotLock lock = lockPlots();
   vUffdaClass=satm->vUffdaClass;
   vUffdaClassTip=satm->vUffdaClassTip;
 }
 
 bool Controller::getUffdaEnabled()
 {
+  const PlotLock lock = lockPlots();
   return satm->uffdaEnabled;
 }
 
 std::string Controller::getUffdaMailAddress()
 {
+  const PlotLock lock = lockPlots();
   return satm->uffdaMailAddress;
 }
 
 // return button names for ObsDialog
 ObsDialogInfo Controller::initObsDialog()
 {
+  const PlotLock lock = lockPlots();
   return obsm->initDialog();
 }
 
 // return button names for ObsDialog ... ascii files (when activated)
 ObsDialogInfo Controller::updateObsDialog(const std::string& name)
 {
+  const PlotLock lock = lockPlots();
   return obsm->updateDialog(name);
 }
 
 // return button names for SatDialog
 SatDialogInfo Controller::initSatDialog()
 {
+  const PlotLock lock = lockPlots();
   return satm->initDialog();
 }
 
 stationDialogInfo Controller::initStationDialog()
 {
+  const PlotLock lock = lockPlots();
   return stam->initDialog();
 }
 
 EditDialogInfo Controller::initEditDialog()
 {
+  const PlotLock lock = lockPlots();
   return editm->getEditDialogInfo();
 }
 
 vector<FieldDialogInfo> Controller::initFieldDialog()
 {
+  const PlotLock lock = lockPlots();
   return fieldm->getFieldDialogInfo();
 }
 
 void Controller::getAllFieldNames(vector<std::string> & fieldNames)
 {
+  const PlotLock lock = lockPlots();
   fieldplotm->getAllFieldNames(fieldNames);
 }
 
 vector<std::string> Controller::getFieldLevels(const PlotCommand_cp& pinfo)
 {
+  const PlotLock lock = lockPlots();
   if (KVListPlotCommand_cp cmd = std::dynamic_pointer_cast<const KVListPlotCommand>(pinfo))
     return fieldplotm->getFieldLevels(cmd->all());
   else
@@ -862,16 +974,19 @@ vector<std::string> Controller::getFieldLevels(const PlotCommand_cp& pinfo)
 
 set<std::string> Controller::getFieldReferenceTimes(const std::string model)
 {
+  const PlotLock lock = lockPlots();
   return fieldm->getReferenceTimes(model);
 }
 
 std::string Controller::getBestFieldReferenceTime(const std::string& model, int refOffset, int refHour)
 {
+  const PlotLock lock = lockPlots();
   return fieldm->getBestReferenceTime(model, refOffset, refHour);
 }
 
 miutil::miTime Controller::getFieldReferenceTime()
 {
+  const PlotLock lock = lockPlots();
   return plotm->fieldplots()->getFieldReferenceTime();
 }
 
@@ -880,22 +995,26 @@ void Controller::getFieldGroups(const std::string& modelName,
     bool plotGroups,
     vector<FieldGroupInfo>& vfgi)
 {
+  const PlotLock lock = lockPlots();
   fieldplotm->getFieldGroups(modelName, refTime, plotGroups, vfgi);
 }
 
 std::map<std::string,std::string> Controller::getFieldGlobalAttributes(const std::string& modelName,
     const std::string& refTime)
 {
+  const PlotLock lock = lockPlots();
   return fieldm->getGlobalAttributes(modelName, refTime);
 }
 
 vector<miTime> Controller::getFieldTime(vector<FieldRequest>& request)
 {
+  const PlotLock lock = lockPlots();
   return fieldplotm->getFieldTime(request);
 }
 
 void Controller::updateFieldSource(const std::string & modelName)
 {
+  const PlotLock lock = lockPlots();
   fieldm->updateSource(modelName);
 }
 
@@ -903,36 +1022,43 @@ void Controller::updateFieldSource(const std::string & modelName)
 
 vector<std::string> Controller::getObjectNames(bool useArchive)
 {
+  const PlotLock lock = lockPlots();
   return objm->getObjectNames(useArchive);
 }
 
 void Controller::setObjAuto(bool autoFile)
 {
+  const PlotLock lock = lockPlots();
   plotm->setObjAuto(autoFile);
 }
 
 vector<ObjFileInfo> Controller::getObjectFiles(std::string objectname,
     bool refresh) {
+  const PlotLock lock = lockPlots();
   return objm->getObjectFiles(objectname,refresh);
 }
 
 map<std::string,bool> Controller::decodeTypeString( std::string token)
 {
+  const PlotLock lock = lockPlots();
   return objm->decodeTypeString(token);
 }
 
 vector< vector<Colour::ColourInfo> > Controller::getMultiColourInfo(int multiNum)
 {
+  const PlotLock lock = lockPlots();
   return LocalSetupParser::getMultiColourInfo(multiNum);
 }
 
 bool Controller::getQuickMenus(vector<QuickMenuDefs>& qm)
 {
+  const PlotLock lock = lockPlots();
   return LocalSetupParser::getQuickMenus(qm);
 }
 
 vector<miTime> Controller::getObsTimes(const vector<string>& name)
 {
+  const PlotLock lock = lockPlots();
   return obsm->getTimes(name);
 }
 
@@ -941,6 +1067,7 @@ vector<miTime> Controller::getObsTimes(const vector<string>& name)
 
 void Controller::putStations(StationPlot* stationPlot)
 {
+  const PlotLock lock = lockPlots();
   stam->putStations(stationPlot);
   plotm->setAnnotations();
 }
@@ -951,16 +1078,19 @@ void Controller::makeStationPlot(const string& commondesc,
     int from,
     const  vector<string>& data)
 {
+  const PlotLock lock = lockPlots();
   stam->makeStationPlot(commondesc,common,description,from,data);
 }
 
 std::string Controller::findStation(int x, int y, const std::string& name, int id)
 {
+  const PlotLock lock = lockPlots();
   return stam->findStation(x,y,name,id);
 }
 
 std::vector<std::string> Controller::findStations(int x, int y, const std::string& name, int id)
 {
+  const PlotLock lock = lockPlots();
   return stam->findStations(x,y,name,id);
 }
 
@@ -969,11 +1099,13 @@ void Controller::findStations(int x, int y, bool add,
     vector<int>& id,
     vector<std::string>& station)
 {
+  const PlotLock lock = lockPlots();
   stam->findStations(x,y,add,name,id,station);
 }
 
 void Controller::getStationData(vector< vector<std::string> >& data)
 {
+  const PlotLock lock = lockPlots();
   stam->getStationData(data);
 }
 
@@ -982,6 +1114,7 @@ void Controller::stationCommand(const string& command,
     const string& name, int id,
     const string& misc)
 {
+  const PlotLock lock = lockPlots();
   stam->stationCommand(command,data,name,id,misc);
 
   if (command == "annotation")
@@ -991,6 +1124,7 @@ void Controller::stationCommand(const string& command,
 void Controller::stationCommand(const string& command,
     const string& name, int id)
 {
+  const PlotLock lock = lockPlots();
   stam->stationCommand(command,name,id);
 
   plotm->setAnnotations();
@@ -998,17 +1132,20 @@ void Controller::stationCommand(const string& command,
 
 float Controller::getStationsScale()
 {
+  const PlotLock lock = lockPlots();
   return stam->getStationsScale();
 }
 
 void Controller::setStationsScale(float new_scale)
 {
+  const PlotLock lock = lockPlots();
   stam->setStationsScale(new_scale);
 }
 
 // area objects
 void Controller::makeAreaObjects(const std::string& name, std::string areastring, int id)
 {
+  const PlotLock lock = lockPlots();
   //METLIBS_LOG_DEBUG("Controller::makeAreas ");
   plotm->areaobjects()->makeAreaObjects(name,areastring,id);
 }
@@ -1016,30 +1153,35 @@ void Controller::makeAreaObjects(const std::string& name, std::string areastring
 void Controller::areaObjectsCommand(const std::string& command,const std::string& dataSet,
     const std::vector<std::string>& data, int id)
 {
+  const PlotLock lock = lockPlots();
   //METLIBS_LOG_DEBUG("Controller::areaCommand");
   plotm->areaobjects()->areaObjectsCommand(command,dataSet,data,id);
 }
 
 vector <selectArea> Controller::findAreaObjects(int x, int y, bool newArea)
 {
+  const PlotLock lock = lockPlots();
   return plotm->areaobjects()->findAreaObjects(x,y,newArea);
 }
 
 //********** plotting and selecting locationPlots on the map **************
 void Controller::putLocation(const LocationData& locationdata)
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE();
   plotm->putLocation(locationdata);
 }
 
 void Controller::updateLocation(const LocationData& locationdata)
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE();
   plotm->updateLocation(locationdata);
 }
 
 void Controller::deleteLocation(const std::string& name)
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE(LOGVAL(name));
   plotm->deleteLocation(name);
 }
@@ -1047,12 +1189,14 @@ void Controller::deleteLocation(const std::string& name)
 void Controller::setSelectedLocation(const std::string& name,
     const std::string& elementname)
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE(LOGVAL(name) << LOGVAL(elementname));
   plotm->setSelectedLocation(name, elementname);
 }
 
 string Controller::findLocation(int x, int y, const string& name)
 {
+  const PlotLock lock = lockPlots();
   METLIBS_LOG_SCOPE(LOGVAL(x) << LOGVAL(y) << LOGVAL(name));
   return plotm->findLocation(x,y,name);
 }
@@ -1061,17 +1205,20 @@ string Controller::findLocation(int x, int y, const string& name)
 
 map<string,InfoFile> Controller::getInfoFiles()
 {
+  const PlotLock lock = lockPlots();
   return LocalSetupParser::getInfoFiles();
 }
 
 
 vector<PlotElement> Controller::getPlotElements()
 {
+  const PlotLock lock = lockPlots();
   return plotm->getPlotElements();
 }
 
 void Controller::enablePlotElement(const PlotElement& pe)
 {
+  const PlotLock lock = lockPlots();
   plotm->enablePlotElement(pe);
 }
 
@@ -1079,6 +1226,7 @@ void Controller::enablePlotElement(const PlotElement& pe)
 
 vector<string> Controller::writeLog()
 {
+  const PlotLock lock = lockPlots();
   return plotm->writeLog();
 }
 
@@ -1086,27 +1234,32 @@ void Controller::readLog(const vector<string>& vstr,
     const string& thisVersion,
     const string& logVersion)
 {
+  const PlotLock lock = lockPlots();
   plotm->readLog(vstr,thisVersion,logVersion);
 }
 
 // Miscellaneous get methods
 vector<SatPlot*> Controller::getSatellitePlots() const
 {
+  const PlotLock lock = lockPlots();
   return satm->getSatellitePlots();
 }
 
 std::vector<FieldPlot*> Controller::getFieldPlots() const
 {
+  const PlotLock lock = lockPlots();
   return plotm->fieldplots()->getFieldPlots();
 }
 
 std::vector<ObsPlot*> Controller::getObsPlots() const
 {
+  const PlotLock lock = lockPlots();
   return plotm->obsplots()->getObsPlots();
 }
 
 void Controller::addManager(const std::string &name, Manager *man)
 {
+  const PlotLock lock = lockPlots();
   plotm->managers[name] = man;
 }
 
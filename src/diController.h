@@ -38,7 +38,10 @@
 
 #include <puTools/miTime.h>
 
+#include <functional>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <set>
 
@@ -97,10 +100,34 @@ private:
 
   bool editoverride; // do not route mouse/key-events to editmanager
 
+  mutable std::recursive_mutex plotMutex; // held while plotting and while changing plots
+  std::function<void()> plotCancel;
+  std::thread::id guiThread; // thread creating the controller, the only one calling plotCancel in plot()
+
 public:
+  typedef std::unique_lock<std::recursive_mutex> PlotLock;
+
   Controller();
   ~Controller();
 
+  /*! Set a function that stops painting in another thread. It is called
+   *  before the plots are locked, and must not wait for the painting.
+   */
+  void setPlotCancel(const std::function<void()>& cancel);
+
+  /*! Stop painting in another thread, and lock the plots until the
+   *  returned lock is released. Most methods do this themselves; it is
+   *  needed when using the managers directly. Methods locking the plots
+   *  return copies, not references into data the render thread may change.
+   */
+  PlotLock lockPlots() const;
+
+  /*! True if the plots may be painted in another thread, i.e. not
+   *  while editing and not while managers like drawings or web maps
+   *  have plots.
+   */
+  bool canPlotInThread();
+
   void setCanvas(DiCanvas* canvas);
   DiCanvas* canvas();
 
@@ -121,7 +148,7 @@ public:
   bool parseSetup();
   /// set new plotcommands
   void plotCommands(const PlotCommand_cpv&);
-  /// call PlotModule.plot()
+  /// call PlotModule.plot(), holding the plot lock but without cancelling
   void plot(DiGLPainter* gl, bool over =true, bool under =true);
   /// get annotations
   std::vector<AnnotationPlot*> getAnnotations();
@@ -135,6 +162,10 @@ public:
   void zoomTo(const Rectangle & r);
   /// zoom out map
   void zoomOut();
+  /// start or stop panning or zooming, see PlotModule::setInteractive
+  void setInteractive(bool interactive);
+  /// true while plotting with reduced quality during panning or zooming
+  bool isInteractive() const;
   /// set plotwindow size in pixels (from GLwidget..)
   void setPlotWindow(const int, const int);
   /// return latitude,longitude from physical x,y
@@ -153,7 +184,7 @@ public:
   double getWindowArea();
 
   /// return current plottime
-  const miutil::miTime& getPlotTime();
+  miutil::miTime getPlotTime();
 
   /// return data times (fields,images, observations, objects and editproducts)
   void getPlotTimes(std::map<std::string, std::vector<miutil::miTime> >& times);
@@ -242,11 +273,11 @@ public:
 
   // Sat-dialog routines
   /// get list of satfiles of class satellite and subclass file. if update is true read new list from disk
-  const std::vector<SatFileInfo>& getSatFiles(const std::string & satellite, const std::string & file,bool update);
+  std::vector<SatFileInfo> getSatFiles(const std::string & satellite, const std::string & file,bool update);
   /// returns colour palette for subproduct of class satellite and subclass file
-  const std::vector<Colour>& getSatColours(const std::string & satellite, const std::string & file);
+  std::vector<Colour> getSatColours(const std::string & satellite, const std::string & file);
   /// returns channels for subproduct of class satellite and subclass file
-  const std::vector<std::string>& getSatChannels(const std::string & satellite, const std::string &file ,
+  std::vector<std::string> getSatChannels(const std::string & satellite, const std::string &file ,
       int index=-1);
   /// returns true if satellite picture is a mosaic
   bool isMosaic(const std::string &, const std::string &);
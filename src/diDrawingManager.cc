@@ -46,6 +46,7 @@
 
 #include <puTools/miStringFunctions.h>
 
+#include <algorithm>
 #include <set>
 
 #include <QImage>
@@ -62,10 +63,26 @@
 using namespace std;
 using namespace miutil;
 
+namespace {
+//! margin around the plot area in pixels, for line widths and decorations of items just outside
+const float DRAW_MARGIN = 50;
+
+//! margin around the mouse position in pixels when finding items to test for hits
+const float HIT_MARGIN = 8;
+
+Rectangle itemBox(const DrawingItemBase *item)
+{
+  const QRectF r = item->boundingRect().normalized();
+  return Rectangle(r.left(), r.top(), r.right(), r.bottom());
+}
+} // namespace
+
 DrawingManager *DrawingManager::self_ = 0;
 Rectangle DrawingManager::editRect_;
 
 DrawingManager::DrawingManager()
+  : indexGeneration_(0)
+  , indexProjectionChanged_(true)
 {
   setEditRect(PLOTM->getPlotSize());
   styleManager_ = DrawingStyleManager::instance();
@@ -494,6 +511,7 @@ bool DrawingManager::changeProjection(const Area& newArea)
   // Update the edit rectangle so that objects are positioned consistently.
   const Rectangle& r = PLOTM->getPlotSize();
   setEditRect(r);
+  indexProjectionChanged_ = true;
   return true;
 }
 
@@ -516,16 +534,94 @@ void DrawingManager::plot(DiGLPainter* gl, bool under, bool over)
   gl->Scalef(PLOTM->getStaticPlot()->getPhysToMapScaleX(),
       PLOTM->getStaticPlot()->getPhysToMapScaleY(), 1.0);
 
-  foreach (DrawingItemBase *item, allItems()) {
+  updateItemIndex(allItems());
 
+  const StaticPlot* sp = PLOTM->getStaticPlot();
+  const Rectangle visible(-DRAW_MARGIN, -DRAW_MARGIN,
+      sp->getPhysWidth() + DRAW_MARGIN, sp->getPhysHeight() + DRAW_MARGIN);
+  foreach (DrawingItemBase *item, indexedItems(visible)) {
     if (isItemVisible(item)) {
       applyPlotOptions(gl, item);
-      setFromLatLonPoints(item, item->getLatLonPoints());
       item->draw(gl);
     }
   }
 }
 
+void DrawingManager::updateItemIndex(const QList<DrawingItemBase *> &items)
+{
+  const XY& scale = PLOTM->getStaticPlot()->getPhysToMapScale();
+  const bool reproject = indexProjectionChanged_ || indexedEditRect_ != editRect_
+      || indexedPhysToMapScale_ != scale;
+
+  indexGeneration_ += 1;
+  for (int i = 0; i < items.size(); ++i) {
+    DrawingItemBase *item = items.at(i);
+    QHash<DrawingItemBase *, IndexedItem>::iterator it = indexed_.find(item);
+    const bool added = (it == indexed_.end());
+    if (added) {
+      it = indexed_.insert(item, IndexedItem());
+      if (freeIds_.empty()) {
+        it->id = indexedById_.size();
+        indexedById_.push_back(item);
+      } else {
+        it->id = freeIds_.back();
+        freeIds_.pop_back();
+        indexedById_[it->id] = item;
+      }
+    }
+
+    IndexedItem &entry = it.value();
+    entry.order = i;
+    entry.seen = indexGeneration_;
+
+    // QList comparison is cheap for unchanged items as the lists share their data
+    const QList<QPointF> latLonPoints = item->getLatLonPoints();
+    if (added || reproject || entry.latLonPoints != latLonPoints || entry.points != item->getPoints()) {
+      setFromLatLonPoints(item, latLonPoints);
+      entry.latLonPoints = latLonPoints;
+      entry.points = item->getPoints();
+      itemIndex_.set(entry.id, itemBox(item));
+    }
+  }
+
+  // remove items that were deleted or are in inactive groups
+  QHash<DrawingItemBase *, IndexedItem>::iterator it = indexed_.begin();
+  while (it != indexed_.end()) {
+    if (it->seen != indexGeneration_) {
+      itemIndex_.remove(it->id);
+      indexedById_[it->id] = 0;
+      freeIds_.push_back(it->id);
+      it = indexed_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  indexProjectionChanged_ = false;
+  indexedEditRect_ = editRect_;
+  indexedPhysToMapScale_ = scale;
+}
+
+QList<DrawingItemBase *> DrawingManager::indexedItems(const Rectangle &r) const
+{
+  std::vector<size_t> ids;
+  itemIndex_.query(r, ids);
+
+  std::vector<std::pair<int, DrawingItemBase *> > ordered;
+  ordered.reserve(ids.size());
+  for (size_t id : ids) {
+    DrawingItemBase *item = indexedById_[id];
+    ordered.push_back(std::make_pair(indexed_.value(item).order, item));
+  }
+  std::sort(ordered.begin(), ordered.end());
+
+  QList<DrawingItemBase *> items;
+  items.reserve(ordered.size());
+  for (size_t i = 0; i < ordered.size(); ++i)
+    items.append(ordered[i].second);
+  return items;
+}
+
 QMap<QString, QString> &DrawingManager::getDrawings()
 {
   return drawings_;
@@ -704,10 +800,17 @@ QList<DrawingItemBase *> DrawingManager::findHitItems(const QPointF &pos,
   QList<DrawingItemBase *> hitItems;
   hitItemTypes.clear();
 
+  // Only plotted items near pos can be hit. Items that have not been plotted
+  // are not in the index and are always tested.
+  const Rectangle near(pos.x() - HIT_MARGIN, pos.y() - HIT_MARGIN,
+      pos.x() + HIT_MARGIN, pos.y() + HIT_MARGIN);
+  const QSet<DrawingItemBase *> candidates = indexedItems(near).toSet();
+
   QMap<QString, EditItems::ItemGroup *>::const_iterator it;
   for (it = itemGroups_.begin(); it != itemGroups_.end(); ++it) {
     foreach (DrawingItemBase *item, it.value()->items()) {
-      if (item->hit(pos, false) != DrawingItemBase::None)
+      const bool test = candidates.contains(item) || !indexed_.contains(item);
+      if (test && item->hit(pos, false) != DrawingItemBase::None)
         hitItems.append(item);
       else
         missedItems.append(item);
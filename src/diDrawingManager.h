@@ -31,6 +31,7 @@
 
 #include "diManager.h"
 #include "EditItems/drawingitembase.h"
+#include "util/rectangle_tree.h"
 
 #include <diField/diGridConverter.h>
 #include <EditItems/drawingitembase.h>
@@ -151,6 +152,31 @@ protected:
   bool allItemsVisible_;
 
 private:
+  /// screen points and index entry for an item plotted by this manager
+  struct IndexedItem {
+    size_t id;
+    int order;                   //!< position in allItems()
+    unsigned int seen;           //!< indexGeneration_ when last found in allItems()
+    QList<QPointF> latLonPoints; //!< geographic points used for the screen points
+    QList<QPointF> points;       //!< screen points when the item was indexed
+  };
+
+  // Updates screen points and bounding boxes for items that changed, and for
+  // all items if the projection changed. Removes items that are gone.
+  void updateItemIndex(const QList<DrawingItemBase *> &items);
+  // Returns the indexed items with bounding boxes intersecting \a r (in screen
+  // coordinates), in the order of allItems().
+  QList<DrawingItemBase *> indexedItems(const Rectangle &r) const;
+
+  QHash<DrawingItemBase *, IndexedItem> indexed_;
+  std::vector<DrawingItemBase *> indexedById_;
+  std::vector<size_t> freeIds_;
+  diutil::RectangleIndex itemIndex_;
+  unsigned int indexGeneration_;
+  bool indexProjectionChanged_;
+  Rectangle indexedEditRect_;
+  XY indexedPhysToMapScale_;
+
   GridConverter gc_;
   QString workDir_;
 
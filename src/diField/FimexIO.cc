@@ -36,6 +36,7 @@
 #include <boost/date_time/gregorian/greg_duration.hpp>
 #include <boost/shared_array.hpp>
 
+#include <cstdlib>
 #include <sstream>
 
 #define MILOGGER_CATEGORY "diField.FimexIO"
@@ -247,9 +248,15 @@ FimexIO::FimexIO(const std::string & modelname, const std::string & sourcename,
     }
   }
 
+  cache_variant = makeCacheVariant(reftime);
+
   if (makeFeltReader) {
-    feltReader = createReader();
-    reftime_from_file = fallbackGetReferenceTime();
+    // a cached inventory also has the reference time, no need to open the file
+    GridInventoryCache::Key key;
+    if (!GridInventoryCache::makeKey(source_name, cache_variant, key) || !readCachedInventory(key)) {
+      feltReader = createReader();
+      reftime_from_file = fallbackGetReferenceTime();
+    }
     sourceChanged(true);
   }
   METLIBS_LOG_DEBUG("reftime" << reftime_from_file);
@@ -308,6 +315,67 @@ void addTimeAxis(CoordinateSystem::ConstAxisPtr tAxis,
 }
 } // namespace anonymous
 
+std::string FimexIO::makeCacheVariant(const std::string& reftime) const
+{
+  std::ostringstream variant;
+  variant << source_type << '\n' << config_filename;
+  if (!config_filename.empty())
+    variant << ':' << miutil::path_ctime(config_filename);
+  variant << '\n' << reftime << '\n' << projDef << '\n' << singleTimeStep << '\n' << reproj_name;
+  if (!reproj_name.empty() && setup) {
+    std::map<std::string, std::map<std::string, std::string> >::const_iterator reproj_data_it = setup->optionMap.find(reproj_name);
+    if (reproj_data_it != setup->optionMap.end()) {
+      for (const std::pair<const std::string, std::string>& kv : reproj_data_it->second)
+        variant << '\n' << kv.first << '=' << kv.second;
+    }
+  }
+  return variant.str();
+}
+
+bool FimexIO::readCachedInventory(const GridInventoryCache::Key& key)
+{
+  GridInventoryCache::Properties properties;
+  gridinventory::Inventory cached;
+  if (!GridInventoryCache::instance().find(key, cached, properties))
+    return false;
+
+  METLIBS_LOG_DEBUG("inventory for " << source_name << " from cache");
+  std::swap(inventory, cached);
+  reftime_from_file = properties["reftime"];
+  noOfClimateTimes = atoi(properties["climate_times"].c_str());
+  // reader and coordinate systems are made when data are requested, see openReader;
+  // a reader opened before might be for an older version of the file
+  feltReader.reset();
+  coordSys.clear();
+  sourceOk = true;
+  return true;
+}
+
+void FimexIO::writeCachedInventory(const GridInventoryCache::Key& key)
+{
+  GridInventoryCache::Properties properties;
+  properties["reftime"] = reftime_from_file;
+  properties["climate_times"] = miutil::from_number(noOfClimateTimes);
+  GridInventoryCache::instance().insert(key, inventory, properties);
+}
+
+bool FimexIO::openReader()
+{
+  try {
+    if (not feltReader) {
+      feltReader = createReader();
+      if (not feltReader)
+        return false;
+    }
+    if (coordSys.empty())
+      coordSys = MetNoFimex::listCoordinateSystems(feltReader);
+    return true;
+  } catch (std::exception& ex) {
+    METLIBS_LOG_WARN("Could not open " << source_name << ", exception is: " << ex.what());
+    return false;
+  }
+}
+
 FimexIO::CDMReaderPtr FimexIO::createReader()
 {
   int filetype = mifi_get_filetype(source_type.c_str());
@@ -532,6 +600,26 @@ std::string FimexIO::fallbackGetReferenceTime()
   return "";
 }
 
+bool FimexIO::makeCachedInventory(const std::string& reftime)
+{
+  if (!reftime_from_file.empty() && reftime_from_file != reftime)
+    return true;
+
+  // wdb sources are no files and never cached; an open reader must not be
+  // closed here, as this may run in parallel with other sources
+  if (source_type == format_wdb || feltReader)
+    return false;
+
+  if (!sourceChanged(false) && sourceOk)
+    return true;
+
+  GridInventoryCache::Key cacheKey;
+  if (!GridInventoryCache::makeKey(source_name, cache_variant, cacheKey) || !readCachedInventory(cacheKey))
+    return false;
+  sourceChanged(true);
+  return true;
+}
+
 /**
  * Build the inventory from source
  *
@@ -551,12 +639,17 @@ bool FimexIO::makeInventory(const std::string& reftime)
   if (source_type != format_wdb && !sourceChanged(true) && sourceOk)
     return true;
 
+  // wdb sources are no files and never cached
+  GridInventoryCache::Key cacheKey;
+  const bool cacheable = GridInventoryCache::makeKey(source_name, cache_variant, cacheKey);
+  if (cacheable && readCachedInventory(cacheKey))
+    return true;
+
   METLIBS_LOG_INFO("Source:" << source_name <<" : "<<config_filename<<" : " <<reftime_from_file);
-  if (not feltReader){
-    feltReader = createReader();
-    if (not feltReader)
-      return false;
-  }
+  // list all coordinate systems from file again, usually one, but may be a few (theoretical limit: # of variables)
+  coordSys.clear();
+  if (!openReader())
+    return false;
 
   std::string  try_reftime_from_file= fallbackGetReferenceTime();
   if (!try_reftime_from_file.empty()) {
@@ -582,17 +675,11 @@ bool FimexIO::makeInventory(const std::string& reftime)
 
   std::map<std::string, std::string> name2id;
 
-  if (not feltReader)
-    return false;
-
   try {
 
     // Get the CDM from the reader
     const CDM& cdm = feltReader->getCDM();
 
-    // get all coordinate systems from file, usually one, but may be a few (theoretical limit: # of variables)
-    coordSys = MetNoFimex::listCoordinateSystems(feltReader);
-
     // First add a set of empty axes (in case they are missing in the data)
     extraaxes.insert(gridinventory::ExtraAxis(""));
     zaxes.insert(gridinventory::Zaxis(""));
@@ -830,6 +917,9 @@ bool FimexIO::makeInventory(const std::string& reftime)
 
   //METLIBS_LOG_DEBUG(inventory);
 
+  if (cacheable)
+    writeCachedInventory(cacheKey);
+
   sourceOk = true;
   return true;
 }
@@ -971,6 +1061,9 @@ Field* FimexIO::getData(const std::string& reftime, const gridinventory::GridPar
     return 0;
   }
 
+  if (!openReader())
+    return 0;
+
   try {
     CoordinateSystemPtr varCS = findCoordinateSystem(param);
     if (not varCS)
@@ -1032,6 +1125,8 @@ vcross::Values_p  FimexIO::getVariable(const std::string& varName)
   METLIBS_LOG_SCOPE();
   METLIBS_LOG_INFO(LOGVAL(varName));
 
+  if (!openReader())
+    return vcross::Values_p();
 
   try {
 
@@ -1072,6 +1167,9 @@ bool FimexIO::putData(const std::string& reftime, const gridinventory::GridParam
   METLIBS_LOG_TIME();
   METLIBS_LOG_INFO(" Param: "<<param.key.name<<"  time:"<<time<<" Source:"<<source_name);
 
+  if (!openReader())
+    return false;
+
   boost::shared_ptr<CDMReaderWriter> feltWriter = boost::dynamic_pointer_cast<CDMReaderWriter>(feltReader);
   if (not feltWriter) {
     METLIBS_LOG_INFO(" No feltWriter");
@@ -33,6 +33,7 @@
 #define FIMEXIO_H_
 
 #include "GridIO.h"
+#include "GridInventoryCache.h"
 
 #include <fimex/CDMReader.h>
 #include <fimex/coordSys/CoordinateSystem.h>
@@ -109,7 +110,7 @@ private:
   int noOfClimateTimes;
   bool writeable;
   bool turnWaveDirection;
-  CDMReaderPtr feltReader;
+  CDMReaderPtr feltReader; //! null after reading a cached inventory, see openReader
 
   FimexIOsetup* setup;
 
@@ -127,6 +128,11 @@ private:
   typedef std::map<std::string, std::string> name2id_t;
 
   CDMReaderPtr createReader();
+  //! create reader and coordinate systems if not done yet, e.g. after reading a cached inventory
+  bool openReader();
+  std::string makeCacheVariant(const std::string& reftime) const;
+  bool readCachedInventory(const GridInventoryCache::Key& key);
+  void writeCachedInventory(const GridInventoryCache::Key& key);
 
   size_t findTimeIndex(const gridinventory::Taxis& taxis, const miutil::miTime& time);
   size_t findZIndex(const gridinventory::Zaxis& zaxis, const std::string& zlevel);
@@ -202,6 +208,12 @@ public:
    */
   virtual bool makeInventory(const std::string& reftime);
 
+  /**
+   * Take the inventory from the GridInventoryCache; does not open or close a reader
+   * @return status
+   */
+  virtual bool makeCachedInventory(const std::string& reftime);
+
   /**
    * Get data slice as Field
    */
@@ -12,6 +12,7 @@
 #endif
 #include "diFieldFunctions.h"
 #include "../diUtilities.h"
+#include "../util/thread_pool.h"
 
 #include <puCtools/puCglob.h>
 #include <puTools/miTime.h>
@@ -23,6 +24,8 @@
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 
+#include <algorithm>
+
 #define MILOGGER_CATEGORY "diField.GridCollection"
 #include "miLogger/miLogging.h"
 
@@ -34,6 +37,7 @@ GridConverter GridCollection::gc;    // Projection-converter
 
 GridCollection::GridCollection()
 : gridsetup(0)
+, computedParametersValid(false)
 {
 }
 
@@ -78,11 +82,136 @@ void GridCollection::clearGridSources()
 {
   diutil::delete_all_and_clear(gridsources);
   gridsourcesTimeMap.clear();
+  watchedsources.clear();
+  gridsourceindex.clear();
   inventoryOK.clear();
+  computedParametersValid = false;
+}
+
+GridIO* GridCollection::makeGridIO(const std::string& format, const std::string& config,
+    const miutil::TimeFilter& tf, const std::string& sourcename, miutil::miTime& time) const
+{
+  //Find time from filename if possible
+  std::string reftime_from_filename;
+  bool makeFeltReader = true;
+  if (tf.getTime(sourcename,time)) {
+    makeFeltReader = false;
+    if ( !timeFromFilename ) {
+      reftime_from_filename = time.isoTime("T");
+    }
+  }
+
+  // new source - add them according to the source type
+  GridIO* gp = 0;
+#ifdef FIMEX
+  if (sourcetype == FimexIO::getSourceType()) {
+    gp = new FimexIO(collectionname, sourcename, reftime_from_filename, format, config,
+        options, makeFeltReader, static_cast<FimexIOsetup*> (gridsetup));
+  }
+#endif
+  return gp;
+}
+
+bool GridCollection::addGridIOs(size_t index, const miutil::TimeFilter& tf,
+    const std::vector<std::string>& sourcenames, bool watched)
+{
+  //if #formats == #rawsources, use corresponding files. If not use first format
+  std::string format;
+  if ( rawsources.size() == formats.size() ) {
+    format = formats[index];
+  } else if ( formats.size() > 0) {
+    format = formats[0];
+  }
+
+  //if #configs == #rawsources, use corresponding files. If not use first config
+  std::string config;
+  if ( rawsources.size() == configs.size() ) {
+    config = configs[index];
+  } else if ( configs.size() > 0) {
+    config = configs[0];
+  }
+
+  // GridIO constructors may open the file to find the reference time; this
+  // is not done in parallel, as fimex readers and netcdf are not thread-safe
+  bool ok = true;
+  for (const std::string& sourcename : sourcenames) {
+    miutil::miTime time;
+    GridIO* gp = makeGridIO(format, config, tf, sourcename, time);
+    if (!gp) {
+      METLIBS_LOG_ERROR("unknown type:" << sourcetype << " for source:" << sourcename);
+      ok = false;
+      continue;
+    }
+    gridsources.push_back(gp);
+    gridsourceindex[gp] = index;
+    if ( timeFromFilename ) {
+      if (!time.undef())
+        timesFromFilename.insert(time);
+      gridsourcesTimeMap[time]=gp;
+    }
+    if (watched)
+      watchedsources[gp] = std::make_pair(index, sourcename);
+  }
+  return ok;
 }
 
-void GridCollection::updateGridSources()
+void GridCollection::removeGridIO(GridIO* gp)
 {
+  gridsources.erase(std::remove(gridsources.begin(), gridsources.end(), gp), gridsources.end());
+  for (std::map<miutil::miTime,GridIO*>::iterator it = gridsourcesTimeMap.begin(); it != gridsourcesTimeMap.end(); ) {
+    if (it->second == gp) {
+      timesFromFilename.erase(it->first);
+      gridsourcesTimeMap.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  watchedsources.erase(gp);
+  gridsourceindex.erase(gp);
+  delete gp;
+  computedParametersValid = false;
+}
+
+void GridCollection::updateGridSources(size_t index, const diutil::FileWatch::Changes& changes)
+{
+  // changed files get a new GridIO instance, the old one might have kept the file open
+  std::set<std::string> gone(changes.removed.begin(), changes.removed.end());
+  gone.insert(changes.changed.begin(), changes.changed.end());
+  std::vector<GridIO*> obsolete;
+  for (watchedsources_t::const_iterator it = watchedsources.begin(); it != watchedsources.end(); ++it) {
+    if (it->second.first == index && gone.count(it->second.second))
+      obsolete.push_back(it->first);
+  }
+  for (GridIO* gp : obsolete)
+    removeGridIO(gp);
+  for (const std::string& sourcename : changes.removed)
+    sources.erase(sourcename);
+
+  std::vector<std::string> added = changes.added;
+  added.insert(added.end(), changes.changed.begin(), changes.changed.end());
+  sources.insert(added.begin(), added.end());
+
+  std::string sourcestr = rawsources[index];
+  const miutil::TimeFilter tf(sourcestr);
+  addGridIOs(index, tf, added, true);
+
+  // the new GridIOs were appended; restore the order of makeGridIOinstances, as the
+  // first source wins when times overlap
+  std::map<std::string, size_t> globorder;
+  const diutil::string_v files = sourceWatches[index]->fileNames();
+  for (size_t i = 0; i < files.size(); ++i)
+    globorder[files[i]] = i;
+  std::map<GridIO*, size_t> order;
+  for (GridIO* gp : gridsources) {
+    const watchedsources_t::const_iterator it = watchedsources.find(gp);
+    order[gp] = (it != watchedsources.end() && it->second.first == index) ? globorder[it->second.second] : 0;
+  }
+  std::stable_sort(gridsources.begin(), gridsources.end(), [&](GridIO* a, GridIO* b) {
+      const size_t ia = gridsourceindex[a], ib = gridsourceindex[b];
+      if (ia != ib)
+        return ia < ib;
+      return order[a] < order[b];
+    });
 }
 
 // unpack the raw sources and make one or more GridIO instances
@@ -102,82 +231,38 @@ bool GridCollection::makeGridIOinstances()
   sources.clear();
   refTimes.clear();
   sources_with_wildcards.clear();
+  sourceWatches.assign(rawsources.size(), diutil::FileWatch_p());
 
   // unpack each raw source - creating one or more GridIO instances from each
   int index = -1;
   for (std::string sourcestr : rawsources) {
     ++index;
 
-    std::set<std::string> tmpsources;
+    diutil::string_v tmpsources;
 
     // init time filter and replace yyyy etc. with ????
     const miutil::TimeFilter tf(sourcestr);
 
     // check for wild cards - expand filenames if necessary
-    if (sourcestr.find_first_of("*?") != sourcestr.npos && sourcestr.find("glob:") == sourcestr.npos) {
+    const bool watched = (sourcestr.find_first_of("*?") != sourcestr.npos && sourcestr.find("glob:") == sourcestr.npos);
+    if (watched) {
       sources_with_wildcards.push_back(sourcestr);
-      const diutil::string_v files = diutil::glob(sourcestr, GLOB_BRACE);
+      diutil::FileWatch_p watch = std::make_shared<diutil::FileWatch>(sourcestr, GLOB_BRACE);
+      watch->update();
+      sourceWatches[index] = watch;
+      const diutil::string_v files = watch->fileNames();
       if( !files.size() ) {
         METLIBS_LOG_INFO("No source available for "<<sourcestr);
         continue;
       }
-      tmpsources.insert(files.begin(), files.end());
+      tmpsources = files;
     } else {
-      tmpsources.insert(sourcestr);
+      tmpsources.push_back(sourcestr);
     }
     sources.insert(tmpsources.begin(),tmpsources.end());
 
-    //if #formats == #rawsources, use corresponding files. If not use first format
-    std::string format;
-    if ( rawsources.size() == formats.size() ) {
-      format = formats[index];
-    } else if ( formats.size() > 0) {
-      format = formats[0];
-    }
-
-    //if #configs == #rawsources, use corresponding files. If not use first config
-    std::string config;
-    if ( rawsources.size() == configs.size() ) {
-      config = configs[index];
-    } else if ( configs.size() > 0) {
-      config = configs[0];
-    }
-
-
-    // loop through sources (filenames)
-    for (const std::string& sourcename : tmpsources) {
-
-      //Find time from filename if possible
-      std::string reftime_from_filename;
-      miutil::miTime time;
-      bool makeFeltReader = true;
-      if (tf.getTime(sourcename,time)) {
-        makeFeltReader = false;
-        if ( timeFromFilename ) {
-          timesFromFilename.insert(time);
-        } else {
-          reftime_from_filename = time.isoTime("T");
-        }
-      }
-
-      // new source - add them according to the source type
-      GridIO* gp = 0;
-#ifdef FIMEX
-      if (sourcetype == FimexIO::getSourceType()) {
-        gp = new FimexIO(collectionname, sourcename, reftime_from_filename, format, config,
-            options, makeFeltReader, static_cast<FimexIOsetup*> (gridsetup));
-      }
-#endif
-      if ( gp ) {
-        gridsources.push_back(gp);
-        if ( timeFromFilename ) {
-          gridsourcesTimeMap[time]=gp;
-        }
-      } else {
-        METLIBS_LOG_ERROR("unknown type:" << sourcetype << " for source:" << sourcename);
-        ok = false;
-      }
-    }
+    if (!addGridIOs(index, tf, tmpsources, watched))
+      ok = false;
   }
 
   if( !sources.size() ) {
@@ -201,14 +286,13 @@ bool GridCollection::makeInventory(const std::string& refTime,
   inventoryOK.clear();
   inventory.clear();
 
+  std::vector<GridIO*> todo;
   for(gridsources_t::const_iterator it_io=gridsources.begin(); it_io!=gridsources.end(); ++it_io) {
     // enforce the reference time limits
     //    (*itr)->setReferencetimeLimits(limit_min, limit_max); // not used yet
 
-    // make inventory on each GridIO
-    bool result = false;
-
     // make referencetime inventory from referencetime given in filename, if possible
+    bool result = false;
     if (refTime.empty()) {
       const std::string reftime_from_filename = (*it_io)->getReferenceTime();
       if (!reftime_from_filename.empty()) {
@@ -217,20 +301,32 @@ bool GridCollection::makeInventory(const std::string& refTime,
       }
     }
 
-    if (!result && (*it_io)->referenceTimeOK(refTime)) {
-      result = (*it_io)->makeInventory(refTime);
-      METLIBS_LOG_DEBUG(LOGVAL(refTime));
-      inventoryOK[refTime] = result;
-      if (result)
-        inventory = inventory.merge((*it_io)->getInventory());
-    }
-    ok |= result;
+    if (!result && (*it_io)->referenceTimeOK(refTime))
+      todo.push_back(*it_io);
 
     //When using time from filename there is no need to make inventory for more than one source now
     if ( timeFromFilename )
       break;
   }
 
+  // cache lookups do not open any file and run on the thread pool; other sources
+  // are read serially, as fimex readers and netcdf are not thread-safe
+  std::vector<char> cached(todo.size(), 0);
+  diutil::parallel_for(0, todo.size(), 1, [&](size_t i0, size_t i1) {
+      for (size_t i = i0; i < i1; ++i)
+        cached[i] = todo[i]->makeCachedInventory(refTime);
+    });
+
+  for (size_t i = 0; i < todo.size(); ++i) {
+    GridIO* gp = todo[i];
+    const bool result = cached[i] || gp->makeInventory(refTime);
+    METLIBS_LOG_DEBUG(LOGVAL(refTime));
+    inventoryOK[refTime] = result;
+    if (result)
+      inventory = inventory.merge(gp->getInventory());
+    ok |= result;
+  }
+
   if (not ok)
     METLIBS_LOG_WARN("makeInventory failed for GridIO with source:" << refTime);
   if(inventory.reftimes.size())
@@ -241,8 +337,12 @@ bool GridCollection::makeInventory(const std::string& refTime,
 
 bool GridCollection::sourcesChanged()
 {
+  // files matching wildcards are checked by the watches, without stat for each file
+  for (const diutil::FileWatch_p& w : sourceWatches)
+    if (w && w->changed())
+      return true;
   for(gridsources_t::const_iterator it_io=gridsources.begin(); it_io!=gridsources.end(); ++it_io)
-    if ((*it_io)->sourceChanged(false))
+    if (!watchedsources.count(*it_io) && (*it_io)->sourceChanged(false))
       return true;
   return false;
 }
@@ -492,25 +592,36 @@ bool GridCollection::updateSources()
 {
   METLIBS_LOG_SCOPE();
   //Filenames without wildcards do not change
-  if (sources_with_wildcards.empty()) {
+  if (sources_with_wildcards.empty() || sourceWatches.size() != rawsources.size()) {
     return makeGridIOinstances();
   }
 
-  std::set<std::string> newSources;
-  for (const std::string& sourcestr : sources_with_wildcards) {
-    // check for wild cards - expand filenames if necessary
-    if (sourcestr.find_first_of("*?") != std::string::npos) {
-      const diutil::string_v files = diutil::glob(sourcestr, GLOB_BRACE);
-      newSources.insert(files.begin(), files.end());
-    } else {
-      newSources.insert(sourcestr);
-    }
+  // sources without wildcards are not watched
+  for (gridsources_t::const_iterator it_io=gridsources.begin(); it_io!=gridsources.end(); ++it_io) {
+    if (!watchedsources.count(*it_io) && (*it_io)->sourceChanged(false))
+      return makeGridIOinstances();
   }
 
-  if (sources != newSources || sourcesChanged() ) {
-    return makeGridIOinstances();
+  // replace only GridIO instances for files that were added, changed or removed
+  bool changed = false;
+  for (size_t index = 0; index < sourceWatches.size(); ++index) {
+    diutil::FileWatch::Changes changes;
+    if (sourceWatches[index] && sourceWatches[index]->update(&changes)) {
+      METLIBS_LOG_DEBUG(LOGVAL(rawsources[index]) << LOGVAL(changes.added.size())
+          << LOGVAL(changes.changed.size()) << LOGVAL(changes.removed.size()));
+      updateGridSources(index, changes);
+      changed = true;
+    }
+  }
+  if (changed) {
+    refTimes.clear();
+    inventoryOK.clear();
   }
 
+  if( !sources.size() ) {
+    METLIBS_LOG_WARN("No sources available for "<<collectionname);
+    return false;
+  }
   return true;
 }
 
@@ -866,6 +977,26 @@ void GridCollection::addComputedParameters()
 
   gridinventory::ReftimeInventory& rinventory = reftimes.begin()->second;
 
+  std::set<std::string> inputNames;
+  for (const gridinventory::GridParameter& p : rinventory.parameters) {
+    inputNames.insert(p.key.name);
+    inputNames.insert(p.standard_name);
+  }
+
+  // if sources were only added, parameters computed before are still
+  // computable; only functions depending on the time axis are checked again
+  std::map<int, gridinventory::GridParameter> previous;
+  if (computedParametersValid && computedReftime == rinventory.referencetime
+      && std::includes(inputNames.begin(), inputNames.end(), computedInputNames.begin(), computedInputNames.end()))
+  {
+    METLIBS_LOG_DEBUG("reusing " << computedParameters.size() << " computed parameters");
+    std::swap(previous, computedParameters);
+  }
+  computedParameters.clear();
+  std::swap(computedInputNames, inputNames);
+  computedReftime = rinventory.referencetime;
+  computedParametersValid = true;
+
   // loop through all functions
   int i = -1;
   for (const FieldFunctions::FieldCompute& fc : FieldFunctions::fieldComputes()) {
@@ -880,6 +1011,16 @@ void GridCollection::addComputedParameters()
     if (pitr != rinventory.parameters.end()) {
       break;
     }
+
+    if (!FieldFunctions::isTimeStepFunction(fc.function)) {
+      std::map<int, gridinventory::GridParameter>::const_iterator itP = previous.find(i);
+      if (itP != previous.end()) {
+        rinventory.parameters.insert(itP->second);
+        computed_inventory.parameters.insert(itP->second);
+        computedParameters.insert(*itP);
+        continue;
+      }
+    }
     //Compute parameter?
     //find input parameters and check
 
@@ -994,6 +1135,7 @@ void GridCollection::addComputedParameters()
       newparameter.nativekey = ost.str();
       rinventory.parameters.insert(newparameter);
       computed_inventory.parameters.insert(newparameter);
+      computedParameters[i] = newparameter;
       METLIBS_LOG_DEBUG("Add new parameter");
       METLIBS_LOG_DEBUG(LOGVAL(newparameter.key.name) <<LOGVAL(computeZaxis));
       METLIBS_LOG_DEBUG(LOGVAL(newparameter.nativekey));
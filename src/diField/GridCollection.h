@@ -38,6 +38,8 @@
 #include "diGridConverter.h"
 #include "diFieldFunctions.h"
 
+#include "../util/file_watcher.h"
+
 #include <puTools/miTime.h>
 #include <boost/shared_array.hpp>
 #include <string>
@@ -45,6 +47,9 @@
 
 class GridIOsetup;
 class Field;
+namespace miutil {
+class TimeFilter;
+}
 
 
 class GridCollection {
@@ -268,17 +273,39 @@ private:
   gridinventory::Inventory inventory;
   /// the combined inventory with computed parameters
   gridinventory::ReftimeInventory computed_inventory;
+  /// computed parameters added by the last addComputedParameters, by function index
+  std::map<int, gridinventory::GridParameter> computedParameters;
+  /// names of the input parameters for computedParameters
+  std::set<std::string> computedInputNames;
+  /// reference time for computedParameters
+  std::string computedReftime;
+  /// false if sources were removed or replaced after addComputedParameters
+  bool computedParametersValid;
   /// the actual data-containers - list of GridIO objects
   typedef std::vector<GridIO*> gridsources_t;
   gridsources_t gridsources;
   std::map<miutil::miTime,GridIO*> gridsourcesTimeMap;
+  /// watches for raw sources with wildcards, same index as rawsources, or null
+  std::vector<diutil::FileWatch_p> sourceWatches;
+  /// GridIO objects made from files found by sourceWatches, with index and file name
+  typedef std::map<GridIO*, std::pair<size_t, std::string> > watchedsources_t;
+  watchedsources_t watchedsources;
+  /// index in rawsources of each GridIO; gridsources are ordered by it, then by glob order
+  std::map<GridIO*, size_t> gridsourceindex;
 
   /// unpack the raw sources and make one or more GridIO instances
   bool makeGridIOinstances();
   /// clear the gridsources vector
   void clearGridSources();
-  /// update the gridsources vector
-  void updateGridSources();
+  /// make a GridIO instance for one source, time is set if found in the source name
+  GridIO* makeGridIO(const std::string& format, const std::string& config,
+      const miutil::TimeFilter& tf, const std::string& sourcename, miutil::miTime& time) const;
+  /// make GridIO instances for sources from rawsources[index] and add them to the gridsources vector
+  bool addGridIOs(size_t index, const miutil::TimeFilter& tf, const std::vector<std::string>& sourcenames, bool watched);
+  /// remove a GridIO instance from the gridsources vector and delete it
+  void removeGridIO(GridIO* gp);
+  /// update the gridsources vector for changed files from rawsources[index]
+  void updateGridSources(size_t index, const diutil::FileWatch::Changes& changes);
   bool getActualTime(const std::string& reftime, const std::string& paramname, const miutil::miTime& time,
       const int & time_tolerance, miutil::miTime& actualtime);
   bool dataExists_reftime(const gridinventory::ReftimeInventory& reftimInv,
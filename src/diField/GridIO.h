@@ -193,6 +193,15 @@ public:
       const miutil::miTime& time, const std::string& elevel,
       const std::string& unit);
 
+  /**
+   * Take the inventory from a cache, without opening the source.
+   * May be called for different instances at the same time.
+   * @param reftime, as for makeInventory
+   * @return true if the inventory is up to date, false if makeInventory is needed
+   */
+  virtual bool makeCachedInventory(const std::string& /*reftime*/)
+    { return false; }
+
   // ===================== PURE VIRTUAL FUNCTIONS BELOW THIS LINE ============================
 
   /**
@@ -0,0 +1,446 @@
+#include "GridInventoryCache.h"
+
+#include "../util/binary_io.h"
+#include "../util/mapped_file.h"
+
+#include <cstring>
+
+#include <sys/stat.h>
+
+#define MILOGGER_CATEGORY "diField.GridInventoryCache"
+#include "miLogger/miLogging.h"
+
+using namespace gridinventory;
+
+namespace {
+
+const char MAGIC[8] = { 'D', 'I', 'I', 'N', 'V', '0', '0', '1' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//! cache files not used for this long are removed
+const time_t MAX_FILE_AGE = 7*24*3600;
+
+typedef diutil::BinaryWriter Writer;
+typedef diutil::BinaryReader Reader;
+
+bool sameKey(const GridInventoryCache::Key& a, const GridInventoryCache::Key& b)
+{
+  return a.size == b.size && a.mtime == b.mtime
+      && a.source == b.source && a.variant == b.variant;
+}
+
+// ========================================================================
+// one put/get pair for each inventory type, declared here for the templates
+
+void put(Writer& w, const Grid& g);
+bool get(Reader& r, Grid& g);
+void put(Writer& w, const Zaxis& z);
+bool get(Reader& r, Zaxis& z);
+void put(Writer& w, const Taxis& t);
+bool get(Reader& r, Taxis& t);
+void put(Writer& w, const ExtraAxis& e);
+bool get(Reader& r, ExtraAxis& e);
+void put(Writer& w, const GridParameter& p);
+bool get(Reader& r, GridParameter& p);
+void put(Writer& w, const ReftimeInventory& ri);
+bool get(Reader& r, ReftimeInventory& ri);
+
+void put(Writer& w, const std::string& s)
+{
+  w.str(s);
+}
+
+bool get(Reader& r, std::string& s)
+{
+  return r.str(s);
+}
+
+void put(Writer& w, bool b)
+{
+  w.u32(b ? 1 : 0);
+}
+
+bool get(Reader& r, bool& b)
+{
+  uint32_t v;
+  if (!r.u32(v))
+    return false;
+  b = (v != 0);
+  return true;
+}
+
+void put(Writer& w, int i)
+{
+  w.i64(i);
+}
+
+bool get(Reader& r, int& i)
+{
+  int64_t v;
+  if (!r.i64(v))
+    return false;
+  i = v;
+  return true;
+}
+
+void put(Writer& w, float f)
+{
+  w.f64(f);
+}
+
+bool get(Reader& r, float& f)
+{
+  double v;
+  if (!r.f64(v))
+    return false;
+  f = v;
+  return true;
+}
+
+void put(Writer& w, const miutil::miTime& t)
+{
+  if (t.undef()) {
+    w.i64(0);
+  } else {
+    w.i64(((((t.year() * 100LL + t.month()) * 100 + t.day()) * 100 + t.hour()) * 100 + t.min()) * 100 + t.sec());
+  }
+}
+
+bool get(Reader& r, miutil::miTime& t)
+{
+  int64_t v;
+  if (!r.i64(v))
+    return false;
+  if (v == 0) {
+    t = miutil::miTime();
+  } else {
+    t = miutil::miTime(v / 10000000000LL, (v / 100000000) % 100, (v / 1000000) % 100,
+        (v / 10000) % 100, (v / 100) % 100, v % 100);
+  }
+  return true;
+}
+
+template<class T>
+void put(Writer& w, const std::vector<T>& v)
+{
+  w.u32(v.size());
+  for (const T& e : v)
+    put(w, e);
+}
+
+template<class T>
+bool get(Reader& r, std::vector<T>& v)
+{
+  uint32_t n;
+  if (!r.u32(n))
+    return false;
+  v.clear();
+  for (uint32_t i = 0; i < n; ++i) {
+    T e;
+    if (!get(r, e))
+      return false;
+    v.push_back(e);
+  }
+  return true;
+}
+
+// double values are stored as one block
+void put(Writer& w, const std::vector<double>& v)
+{
+  w.u32(v.size());
+  w.column(v);
+}
+
+bool get(Reader& r, std::vector<double>& v)
+{
+  uint32_t n;
+  return r.u32(n) && r.column(v, n);
+}
+
+template<class T>
+void put(Writer& w, const std::set<T>& s)
+{
+  w.u32(s.size());
+  for (const T& e : s)
+    put(w, e);
+}
+
+template<class T>
+bool get(Reader& r, std::set<T>& s)
+{
+  uint32_t n;
+  if (!r.u32(n))
+    return false;
+  s.clear();
+  for (uint32_t i = 0; i < n; ++i) {
+    T e;
+    if (!get(r, e))
+      return false;
+    s.insert(s.end(), e);
+  }
+  return true;
+}
+
+template<class V>
+void put(Writer& w, const std::map<std::string, V>& m)
+{
+  w.u32(m.size());
+  for (const typename std::map<std::string, V>::value_type& kv : m) {
+    w.str(kv.first);
+    put(w, kv.second);
+  }
+}
+
+template<class V>
+bool get(Reader& r, std::map<std::string, V>& m)
+{
+  uint32_t n;
+  if (!r.u32(n))
+    return false;
+  m.clear();
+  for (uint32_t i = 0; i < n; ++i) {
+    std::string k;
+    if (!r.str(k) || !get(r, m[k]))
+      return false;
+  }
+  return true;
+}
+
+void putBase(Writer& w, const InventoryBase& b)
+{
+  put(w, b.id);
+  put(w, b.name);
+  put(w, b.values);
+  put(w, b.stringvalues);
+}
+
+bool getBase(Reader& r, InventoryBase& b)
+{
+  return get(r, b.id) && get(r, b.name) && get(r, b.values) && get(r, b.stringvalues);
+}
+
+void put(Writer& w, const Grid& g)
+{
+  putBase(w, g);
+  put(w, g.nx);
+  put(w, g.ny);
+  put(w, g.x_0);
+  put(w, g.y_0);
+  put(w, g.x_resolution);
+  put(w, g.y_resolution);
+  put(w, g.projection);
+  put(w, g.y_direction_up);
+}
+
+bool get(Reader& r, Grid& g)
+{
+  return getBase(r, g) && get(r, g.nx) && get(r, g.ny) && get(r, g.x_0) && get(r, g.y_0)
+      && get(r, g.x_resolution) && get(r, g.y_resolution) && get(r, g.projection)
+      && get(r, g.y_direction_up);
+}
+
+void put(Writer& w, const Zaxis& z)
+{
+  putBase(w, z);
+  put(w, z.vc_type);
+  put(w, z.positive);
+  put(w, z.verticalType);
+}
+
+bool get(Reader& r, Zaxis& z)
+{
+  return getBase(r, z) && get(r, z.vc_type) && get(r, z.positive) && get(r, z.verticalType);
+}
+
+void put(Writer& w, const Taxis& t)
+{
+  putBase(w, t);
+}
+
+bool get(Reader& r, Taxis& t)
+{
+  return getBase(r, t);
+}
+
+void put(Writer& w, const ExtraAxis& e)
+{
+  putBase(w, e);
+}
+
+bool get(Reader& r, ExtraAxis& e)
+{
+  return getBase(r, e);
+}
+
+void put(Writer& w, const GridParameterKey& k)
+{
+  putBase(w, k);
+  put(w, k.zaxis);
+  put(w, k.taxis);
+  put(w, k.extraaxis);
+}
+
+bool get(Reader& r, GridParameterKey& k)
+{
+  return getBase(r, k) && get(r, k.zaxis) && get(r, k.taxis) && get(r, k.extraaxis);
+}
+
+void put(Writer& w, const GridParameter& p)
+{
+  putBase(w, p);
+  put(w, p.key);
+  put(w, p.grid);
+  put(w, p.unit);
+  put(w, p.nativename);
+  put(w, p.standard_name);
+  put(w, p.long_name);
+  put(w, p.nativekey);
+  put(w, p.calibration);
+  put(w, p.zaxis_id);
+  put(w, p.taxis_id);
+  put(w, p.extraaxis_id);
+}
+
+bool get(Reader& r, GridParameter& p)
+{
+  return getBase(r, p) && get(r, p.key) && get(r, p.grid) && get(r, p.unit)
+      && get(r, p.nativename) && get(r, p.standard_name) && get(r, p.long_name)
+      && get(r, p.nativekey) && get(r, p.calibration)
+      && get(r, p.zaxis_id) && get(r, p.taxis_id) && get(r, p.extraaxis_id);
+}
+
+void put(Writer& w, const ReftimeInventory& ri)
+{
+  putBase(w, ri);
+  put(w, ri.referencetime);
+  put(w, ri.parameters);
+  put(w, ri.grids);
+  put(w, ri.zaxes);
+  put(w, ri.taxes);
+  put(w, ri.extraaxes);
+  put(w, ri.timestamp);
+  put(w, ri.globalAttributes);
+}
+
+bool get(Reader& r, ReftimeInventory& ri)
+{
+  return getBase(r, ri) && get(r, ri.referencetime)
+      && get(r, ri.parameters) && get(r, ri.grids) && get(r, ri.zaxes)
+      && get(r, ri.taxes) && get(r, ri.extraaxes)
+      && get(r, ri.timestamp) && get(r, ri.globalAttributes);
+}
+
+} // namespace
+
+// ========================================================================
+
+GridInventoryCache::GridInventoryCache()
+  : files_("inventory-")
+{
+}
+
+// static
+GridInventoryCache& GridInventoryCache::instance()
+{
+  static GridInventoryCache cache;
+  return cache;
+}
+
+void GridInventoryCache::setDirectory(const std::string& directory)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.setDirectory(directory, MAX_FILE_AGE);
+}
+
+// static
+bool GridInventoryCache::makeKey(const std::string& source, const std::string& variant, Key& key)
+{
+  struct stat st;
+  if (stat(source.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    return false;
+  key.source = source;
+  key.variant = variant;
+  key.size = st.st_size;
+  key.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  return true;
+}
+
+bool GridInventoryCache::find(const Key& key, Inventory& inventory, Properties& properties)
+{
+  std::string cf;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!files_.enabled())
+      return false;
+    cf = files_.path(key.source + '\n' + key.variant);
+  }
+
+  const diutil::MappedFile mapped(cf);
+  if (!mapped.data())
+    return false;
+  if (!read(mapped.data(), mapped.size(), key, inventory, properties)) {
+    METLIBS_LOG_DEBUG("cache file '" << cf << "' is outdated or broken");
+    return false;
+  }
+  METLIBS_LOG_DEBUG("read inventory for '" << key.source << "' from cache");
+
+  // mark as used, see setDirectory
+  diutil::CacheDirectory::touch(cf);
+  return true;
+}
+
+void GridInventoryCache::insert(const Key& key, const Inventory& inventory, const Properties& properties)
+{
+  std::string cf;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!files_.enabled())
+      return;
+    cf = files_.path(key.source + '\n' + key.variant);
+  }
+  diutil::CacheDirectory::write(cf, write(key, inventory, properties));
+}
+
+// static
+std::string GridInventoryCache::write(const Key& key, const Inventory& inventory, const Properties& properties)
+{
+  Writer w;
+  w.put(MAGIC, sizeof(MAGIC));
+  w.u32(BYTE_ORDER_MARK);
+  w.str(key.source);
+  w.str(key.variant);
+  w.i64(key.size);
+  w.i64(key.mtime);
+  put(w, properties);
+  put(w, inventory.reftimes);
+  return w.buffer;
+}
+
+// static
+bool GridInventoryCache::read(const char* data, size_t size, const Key& key,
+    Inventory& inventory, Properties& properties)
+{
+  Reader r(data, size);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t byteOrder;
+  Key fileKey;
+  int64_t fsize, fmtime;
+  if (!r.get(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+      || !r.u32(byteOrder) || byteOrder != BYTE_ORDER_MARK
+      || !r.str(fileKey.source) || !r.str(fileKey.variant)
+      || !r.i64(fsize) || !r.i64(fmtime))
+    return false;
+  fileKey.size = fsize;
+  fileKey.mtime = fmtime;
+  if (!sameKey(fileKey, key))
+    return false;
+
+  Inventory inv;
+  Properties props;
+  if (!get(r, props) || !get(r, inv.reftimes) || !r.atEnd())
+    return false;
+  std::swap(inventory, inv);
+  std::swap(properties, props);
+  return true;
+}
@@ -0,0 +1,65 @@
+#ifndef GRIDINVENTORYCACHE_H
+#define GRIDINVENTORYCACHE_H
+
+#include "GridInventoryTypes.h"
+#include "../util/cache_directory.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+  \brief Cache of grid source inventories
+
+  Inventories are written to binary files in the cache directory, so that
+  files that did not change are not opened again when diana or bdiana
+  start, or when a model collection is updated.
+
+  Entries are identified by file path, file size and modification time,
+  and a variant string for the reader parameters (format, config, options).
+  Sources that are not regular files are not cached.
+ */
+class GridInventoryCache {
+public:
+  struct Key {
+    std::string source;
+    std::string variant;
+    long long size;
+    long long mtime;
+  };
+
+  //! extra information about a source, besides the inventory
+  typedef std::map<std::string, std::string> Properties;
+
+  static GridInventoryCache& instance();
+
+  /*! Set the directory for the cache files, creating it if necessary.
+   *  Files not used for a week are removed. With an empty directory,
+   *  nothing is cached.
+   */
+  void setDirectory(const std::string& directory);
+
+  //! make the key for a file, return false if the source is not a regular file
+  static bool makeKey(const std::string& source, const std::string& variant, Key& key);
+
+  //! find a cached inventory, return false if not found
+  bool find(const Key& key, gridinventory::Inventory& inventory, Properties& properties);
+
+  void insert(const Key& key, const gridinventory::Inventory& inventory, const Properties& properties);
+
+  //! serialize an inventory in the binary format of the cache files
+  static std::string write(const Key& key, const gridinventory::Inventory& inventory, const Properties& properties);
+
+  //! read an inventory in the binary format, return false if the data are broken or for a different key
+  static bool read(const char* data, size_t size, const Key& key,
+      gridinventory::Inventory& inventory, Properties& properties);
+
+private:
+  GridInventoryCache();
+
+private:
+  std::mutex mutex_;
+  diutil::CacheDirectory files_;
+};
+
+#endif // GRIDINVENTORYCACHE_H
@@ -0,0 +1,580 @@
+#include "diAnalyticProjection.h"
+
+#include "../util/openmp_tools.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+
+#define MILOGGER_CATEGORY "diField.AnalyticProjection"
+#include "miLogger/miLogging.h"
+
+// The formulas and tolerances below follow pj_fwd.c, pj_inv.c,
+// PJ_ob_tran.c, PJ_stere.c and PJ_lcc.c from proj4 so that the results
+// agree with pj_transform to rounding errors.
+
+namespace {
+
+const double HALFPI = M_PI_2;
+const double FORTPI = M_PI_4;
+const double EPS = 1e-12;   // pj_fwd
+const double EPS10 = 1e-10;
+
+inline double adjlon(double lon)
+{
+  if (std::fabs(lon) <= 3.14159265359)
+    return lon;
+  lon += M_PI;
+  lon -= 2*M_PI * std::floor(lon / (2*M_PI));
+  lon -= M_PI;
+  return lon;
+}
+
+inline double aasin(double v)
+{
+  const double av = std::fabs(v);
+  if (av >= 1)
+    return (v < 0) ? -HALFPI : HALFPI;
+  return std::asin(v);
+}
+
+inline double aatan2(double n, double d)
+{
+  if (std::fabs(n) < 1e-50 && std::fabs(d) < 1e-50)
+    return 0;
+  return std::atan2(n, d);
+}
+
+inline double tsfn(double phi, double sinphi, double e)
+{
+  sinphi *= e;
+  return std::tan(.5 * (HALFPI - phi)) / std::pow((1. - sinphi) / (1. + sinphi), .5 * e);
+}
+
+inline double msfn(double sinphi, double cosphi, double es)
+{
+  return cosphi / std::sqrt(1. - es * sinphi * sinphi);
+}
+
+inline bool phi2(double ts, double e, double& phi)
+{
+  const double eccnth = .5 * e;
+  phi = HALFPI - 2. * std::atan(ts);
+  for (int i = 15; i > 0; --i) {
+    const double con = e * std::sin(phi);
+    const double dphi = HALFPI - 2. * std::atan(ts * std::pow((1. - con) / (1. + con), eccnth)) - phi;
+    phi += dphi;
+    if (std::fabs(dphi) <= 1e-10)
+      return true;
+  }
+  return false;
+}
+
+// ========================================================================
+
+typedef std::map<std::string, std::string> params_t;
+
+params_t parseDefinition(projPJ pj)
+{
+  params_t params;
+  char* def = pj_get_def(pj, 0);
+  if (!def)
+    return params;
+
+  std::istringstream in(def);
+  pj_dalloc(def);
+
+  std::string token;
+  while (in >> token) {
+    if (token.size() < 2 || token[0] != '+')
+      continue;
+    const size_t eq = token.find('=');
+    if (eq == std::string::npos)
+      params[token.substr(1)] = std::string();
+    else
+      params[token.substr(1, eq - 1)] = token.substr(eq + 1);
+  }
+  return params;
+}
+
+bool hasParam(const params_t& params, const char* key)
+{
+  return params.find(key) != params.end();
+}
+
+//! false if the parameter exists but is not a plain number (e.g. given as degrees-minutes-seconds)
+bool getParam(const params_t& params, const char* key, double& value)
+{
+  params_t::const_iterator it = params.find(key);
+  if (it == params.end())
+    return true;
+  const char* begin = it->second.c_str();
+  char* end = 0;
+  value = strtod(begin, &end);
+  return (end != begin && *end == 0);
+}
+
+//! parameters for which the formulas below would be incomplete
+bool hasUnsupportedParams(const params_t& params)
+{
+  static const char* unsupported[] = {
+    "pm", "axis", "geoc", "lon_wrap", "nadgrids", "geoidgrids", "to_meter", "vto_meter", "vunits", 0
+  };
+  for (const char** u = unsupported; *u; ++u) {
+    if (hasParam(params, *u))
+      return true;
+  }
+  params_t::const_iterator it = params.find("units");
+  return (it != params.end() && it->second != "m");
+}
+
+// ========================================================================
+
+class LongLat : public AnalyticProjection {
+public:
+  void forward(size_t, size_t, double*, double*) const override { }
+  void inverse(size_t, size_t, double*, double*) const override { }
+
+protected:
+  double scale() const override
+    { return 1; }
+};
+
+//! parameters applied by pj_fwd and pj_inv
+struct Common {
+  double a, ra, es, x0, y0, lam0;
+  bool over;
+};
+
+/*! Loops over coordinates, with projection specific formulas from F.
+ *
+ * F must implement
+ *   bool project(double lam, double phi, double& x, double& y) const;
+ *   bool unproject(double x, double y, double& lam, double& phi) const;
+ * for a sphere with radius 1.
+ */
+template<class F>
+class Projected : public AnalyticProjection {
+public:
+  Projected(const Common& c, const F& f, double s)
+    : c_(c), f_(f), scale_(s) { }
+
+  void forward(size_t npos, size_t offset, double* x, double* y) const override;
+  void inverse(size_t npos, size_t offset, double* x, double* y) const override;
+
+protected:
+  double scale() const override
+    { return scale_; }
+
+private:
+  Common c_;
+  F f_;
+  double scale_;
+};
+
+template<class F>
+void Projected<F>::forward(size_t npos, size_t offset, double* x, double* y) const
+{
+  DIUTIL_OPENMP(simd)
+  for (size_t i = 0; i < npos; ++i) {
+    double& xi = x[i*offset];
+    double& yi = y[i*offset];
+    if (xi == HUGE_VAL)
+      continue;
+    double lam = xi, phi = yi;
+    const double t = std::fabs(phi) - HALFPI;
+    if (t > EPS || std::fabs(lam) > 10.) {
+      xi = yi = HUGE_VAL;
+      continue;
+    }
+    if (std::fabs(t) <= EPS)
+      phi = (phi < 0) ? -HALFPI : HALFPI;
+    lam -= c_.lam0;
+    if (!c_.over)
+      lam = adjlon(lam);
+    if (!f_.project(lam, phi, xi, yi)) {
+      xi = yi = HUGE_VAL;
+      continue;
+    }
+    xi = c_.a * xi + c_.x0;
+    yi = c_.a * yi + c_.y0;
+  }
+}
+
+template<class F>
+void Projected<F>::inverse(size_t npos, size_t offset, double* x, double* y) const
+{
+  DIUTIL_OPENMP(simd)
+  for (size_t i = 0; i < npos; ++i) {
+    double& xi = x[i*offset];
+    double& yi = y[i*offset];
+    if (xi == HUGE_VAL)
+      continue;
+    if (yi == HUGE_VAL) {
+      xi = HUGE_VAL;
+      continue;
+    }
+    double lam, phi;
+    if (!f_.unproject((xi - c_.x0) * c_.ra, (yi - c_.y0) * c_.ra, lam, phi)) {
+      xi = yi = HUGE_VAL;
+      continue;
+    }
+    lam += c_.lam0;
+    if (!c_.over)
+      lam = adjlon(lam);
+    xi = lam;
+    yi = phi;
+  }
+}
+
+// ========================================================================
+
+//! rotated longlat, ob_tran with o_proj=longlat and o_lat_p
+struct ObTranLongLat {
+  double a, lamp, sphip, cphip;
+
+  bool project(double lam, double phi, double& x, double& y) const
+    {
+      const double coslam = std::cos(lam), sinphi = std::sin(phi), cosphi = std::cos(phi);
+      const double rlam = adjlon(aatan2(cosphi * std::sin(lam), sphip * cosphi * coslam + cphip * sinphi) + lamp);
+      const double rphi = aasin(sphip * sinphi - cphip * cosphi * coslam);
+      // forward of the linked longlat projection
+      x = rlam / a;
+      y = rphi / a;
+      return true;
+    }
+
+  bool unproject(double x, double y, double& lam, double& phi) const
+    {
+      // inverse of the linked longlat projection
+      const double rlam = x * a - lamp, rphi = y * a;
+      const double coslam = std::cos(rlam), sinphi = std::sin(rphi), cosphi = std::cos(rphi);
+      phi = aasin(sphip * sinphi + cphip * cosphi * coslam);
+      lam = aatan2(cosphi * std::sin(rlam), sphip * cosphi * coslam - cphip * sinphi);
+      return true;
+    }
+};
+
+//! polar stereographic, ellipsoid or sphere
+struct PolarStereographic {
+  bool south, ellips;
+  double e, akm1;
+
+  bool project(double lam, double phi, double& x, double& y) const
+    {
+      double coslam = std::cos(lam);
+      const double sinlam = std::sin(lam);
+      if (ellips) {
+        double sinphi = std::sin(phi);
+        if (south) {
+          phi = -phi;
+          coslam = -coslam;
+          sinphi = -sinphi;
+        }
+        const double rho = akm1 * tsfn(phi, sinphi, e);
+        x = rho * sinlam;
+        y = -rho * coslam;
+      } else {
+        if (!south) {
+          coslam = -coslam;
+          phi = -phi;
+        }
+        if (std::fabs(phi - HALFPI) < 1e-8)
+          return false;
+        const double rho = akm1 * std::tan(FORTPI + .5 * phi);
+        x = sinlam * rho;
+        y = rho * coslam;
+      }
+      return true;
+    }
+
+  bool unproject(double x, double y, double& lam, double& phi) const
+    {
+      const double rho = std::hypot(x, y);
+      if (!south)
+        y = -y;
+      if (ellips) {
+        const double tp = -rho / akm1, halfe = -.5 * e;
+        double phi_l = HALFPI - 2. * std::atan(tp);
+        for (int i = 8; i--; phi_l = phi) {
+          const double sinphi = e * std::sin(phi_l);
+          phi = 2. * std::atan(tp * std::pow((1. + sinphi) / (1. - sinphi), halfe)) + HALFPI;
+          if (std::fabs(phi_l - phi) < 1e-10) {
+            if (south)
+              phi = -phi;
+            lam = (x == 0. && y == 0.) ? 0. : std::atan2(x, y);
+            return true;
+          }
+        }
+        return false;
+      } else {
+        const double cosc = std::cos(2. * std::atan(rho / akm1));
+        if (std::fabs(rho) <= EPS10)
+          phi = south ? -HALFPI : HALFPI;
+        else
+          phi = std::asin(south ? -cosc : cosc);
+        lam = (x == 0. && y == 0.) ? 0. : std::atan2(x, y);
+        return true;
+      }
+    }
+};
+
+//! lambert conformal conic, ellipsoid or sphere
+struct LambertConformalConic {
+  bool ellips;
+  double e, n, c, rho0, k0;
+
+  bool project(double lam, double phi, double& x, double& y) const
+    {
+      double rho;
+      if (std::fabs(std::fabs(phi) - HALFPI) < EPS10) {
+        if (phi * n <= 0.)
+          return false;
+        rho = 0.;
+      } else {
+        rho = c * (ellips ? std::pow(tsfn(phi, std::sin(phi), e), n)
+            : std::pow(std::tan(FORTPI + .5 * phi), -n));
+      }
+      lam *= n;
+      x = k0 * (rho * std::sin(lam));
+      y = k0 * (rho0 - rho * std::cos(lam));
+      return true;
+    }
+
+  bool unproject(double x, double y, double& lam, double& phi) const
+    {
+      x /= k0;
+      y = rho0 - y / k0;
+      double rho = std::hypot(x, y);
+      if (rho != 0.0) {
+        if (n < 0.) {
+          rho = -rho;
+          x = -x;
+          y = -y;
+        }
+        if (ellips) {
+          if (!phi2(std::pow(rho / c, 1. / n), e, phi))
+            return false;
+        } else {
+          phi = 2. * std::atan(std::pow(c / rho, 1. / n)) - HALFPI;
+        }
+        lam = std::atan2(x, y) / n;
+      } else {
+        lam = 0.;
+        phi = (n > 0.) ? HALFPI : -HALFPI;
+      }
+      return true;
+    }
+};
+
+// ========================================================================
+
+AnalyticProjection* createObTran(const params_t& params, const Common& common)
+{
+  params_t::const_iterator it = params.find("o_proj");
+  if (it == params.end() || (it->second != "longlat" && it->second != "latlong"
+          && it->second != "lonlat" && it->second != "latlon"))
+    return 0;
+  // only the "new pole" variant
+  if (!hasParam(params, "o_lat_p") || hasParam(params, "o_alpha") || hasParam(params, "o_lon_c")
+      || hasParam(params, "o_lat_c") || hasParam(params, "o_lon_1") || hasParam(params, "o_lat_1"))
+    return 0;
+
+  double o_lat_p = 0, o_lon_p = 0;
+  if (!getParam(params, "o_lat_p", o_lat_p) || !getParam(params, "o_lon_p", o_lon_p))
+    return 0;
+  const double phip = o_lat_p * DEG_TO_RAD;
+  if (std::fabs(phip) <= 1e-10)
+    return 0; // transverse
+
+  ObTranLongLat f;
+  f.a = common.a;
+  f.lamp = o_lon_p * DEG_TO_RAD;
+  f.sphip = std::sin(phip);
+  f.cphip = std::cos(phip);
+  return new Projected<ObTranLongLat>(common, f, 1);
+}
+
+AnalyticProjection* createStere(const params_t& params, const Common& common)
+{
+  double lat_0 = 0, lat_ts = 90, k0 = 1;
+  if (!getParam(params, "lat_0", lat_0) || !getParam(params, "lat_ts", lat_ts)
+      || !getParam(params, "k", k0) || !getParam(params, "k_0", k0))
+    return 0;
+  const double phi0 = lat_0 * DEG_TO_RAD;
+  if (std::fabs(std::fabs(phi0) - HALFPI) >= EPS10)
+    return 0; // only polar aspect
+
+  PolarStereographic f;
+  f.south = (phi0 < 0);
+  f.ellips = (common.es != 0);
+  f.e = std::sqrt(common.es);
+  const double phits = std::fabs(lat_ts * DEG_TO_RAD);
+  if (f.ellips) {
+    if (std::fabs(phits - HALFPI) < EPS10) {
+      f.akm1 = 2. * k0 / std::sqrt(std::pow(1 + f.e, 1 + f.e) * std::pow(1 - f.e, 1 - f.e));
+    } else {
+      double t = std::sin(phits);
+      f.akm1 = std::cos(phits) / tsfn(phits, t, f.e);
+      t *= f.e;
+      f.akm1 /= std::sqrt(1. - t * t);
+    }
+  } else {
+    f.akm1 = (std::fabs(phits - HALFPI) >= EPS10)
+        ? std::cos(phits) / std::tan(FORTPI - .5 * phits)
+        : 2. * k0;
+  }
+  return new Projected<PolarStereographic>(common, f, common.a);
+}
+
+AnalyticProjection* createLcc(const params_t& params, const Common& common)
+{
+  if (!hasParam(params, "lat_1"))
+    return 0;
+  double lat_0 = 0, lat_1 = 0, lat_2 = 0, k0 = 1;
+  if (!getParam(params, "lat_0", lat_0) || !getParam(params, "lat_1", lat_1)
+      || !getParam(params, "lat_2", lat_2) || !getParam(params, "k", k0) || !getParam(params, "k_0", k0))
+    return 0;
+
+  const double phi1 = lat_1 * DEG_TO_RAD;
+  double phi0 = lat_0 * DEG_TO_RAD, phi2 = lat_2 * DEG_TO_RAD;
+  if (!hasParam(params, "lat_2")) {
+    phi2 = phi1;
+    if (!hasParam(params, "lat_0"))
+      phi0 = phi1;
+  }
+  if (std::fabs(phi1 + phi2) < EPS10)
+    return 0;
+
+  LambertConformalConic f;
+  f.k0 = k0;
+  double sinphi = std::sin(phi1);
+  const double cosphi = std::cos(phi1);
+  f.n = sinphi;
+  const bool secant = std::fabs(phi1 - phi2) >= EPS10;
+  f.ellips = (common.es != 0);
+  f.e = std::sqrt(common.es);
+  if (f.ellips) {
+    const double m1 = msfn(sinphi, cosphi, common.es);
+    const double ml1 = tsfn(phi1, sinphi, f.e);
+    if (secant) {
+      sinphi = std::sin(phi2);
+      f.n = std::log(m1 / msfn(sinphi, std::cos(phi2), common.es));
+      f.n /= std::log(ml1 / tsfn(phi2, sinphi, f.e));
+    }
+    f.c = f.rho0 = m1 * std::pow(ml1, -f.n) / f.n;
+    f.rho0 *= (std::fabs(std::fabs(phi0) - HALFPI) < EPS10) ? 0.
+        : std::pow(tsfn(phi0, std::sin(phi0), f.e), f.n);
+  } else {
+    if (secant)
+      f.n = std::log(cosphi / std::cos(phi2))
+          / std::log(std::tan(FORTPI + .5 * phi2) / std::tan(FORTPI + .5 * phi1));
+    f.c = cosphi * std::pow(std::tan(FORTPI + .5 * phi1), f.n) / f.n;
+    f.rho0 = (std::fabs(std::fabs(phi0) - HALFPI) < EPS10) ? 0.
+        : f.c * std::pow(std::tan(FORTPI + .5 * phi0), -f.n);
+  }
+  return new Projected<LambertConformalConic>(common, f, common.a);
+}
+
+AnalyticProjection* createFromParams(projPJ pj)
+{
+  const params_t params = parseDefinition(pj);
+  if (hasUnsupportedParams(params))
+    return 0;
+
+  params_t::const_iterator it = params.find("proj");
+  if (it == params.end())
+    return 0;
+  const std::string& proj = it->second;
+
+  if (proj == "longlat" || proj == "latlong" || proj == "lonlat" || proj == "latlon")
+    return new LongLat;
+
+  Common common;
+  pj_get_spheroid_defn(pj, &common.a, &common.es);
+  if (!(common.a > 0))
+    return 0;
+  common.ra = 1 / common.a;
+  common.x0 = common.y0 = common.lam0 = 0;
+  if (!getParam(params, "x_0", common.x0) || !getParam(params, "y_0", common.y0)
+      || !getParam(params, "lon_0", common.lam0))
+    return 0;
+  common.lam0 *= DEG_TO_RAD;
+  common.over = hasParam(params, "over");
+
+  if (proj == "ob_tran")
+    return createObTran(params, common);
+  else if (proj == "stere")
+    return createStere(params, common);
+  else if (proj == "lcc")
+    return createLcc(params, common);
+  return 0;
+}
+
+// ========================================================================
+
+bool near(double expected, double actual, double tolerance)
+{
+  return std::fabs(expected - actual) <= tolerance;
+}
+
+//! test points, degrees
+const double test_lon[] = { -179, -135, -90, -45, -10, 0.5, 10, 45, 90, 135, 179 };
+const double test_lat[] = { -85, -60, -30, -5, 5, 30, 60, 85 };
+
+} // namespace
+
+// ########################################################################
+
+AnalyticProjection::AnalyticProjection()
+{
+}
+
+AnalyticProjection::~AnalyticProjection()
+{
+}
+
+// static
+AnalyticProjection_cp AnalyticProjection::create(projPJ pj, projPJ geographic)
+{
+  if (!pj || !geographic)
+    return AnalyticProjection_cp();
+
+  AnalyticProjection_cp ap(createFromParams(pj));
+  if (!ap)
+    return ap;
+
+  // compare with pj_transform, one point at a time to get errors for each point
+  const double tolerance = 1e-9, tolerance_xy = tolerance * ap->scale();
+  int nvalid = 0;
+  for (double lon : test_lon) {
+    for (double lat : test_lat) {
+      const double glon = lon * DEG_TO_RAD, glat = lat * DEG_TO_RAD;
+      double px = glon, py = glat, ax = glon, ay = glat;
+      const bool p_ok = (pj_transform(geographic, pj, 1, 1, &px, &py, 0) == 0 && px != HUGE_VAL);
+      ap->forward(1, 1, &ax, &ay);
+      if (p_ok != (ax != HUGE_VAL))
+        return AnalyticProjection_cp();
+      if (!p_ok)
+        continue;
+      if (!near(px, ax, tolerance_xy) || !near(py, ay, tolerance_xy))
+        return AnalyticProjection_cp();
+
+      double pix = px, piy = py, aix = px, aiy = py;
+      const bool pi_ok = (pj_transform(pj, geographic, 1, 1, &pix, &piy, 0) == 0 && pix != HUGE_VAL);
+      ap->inverse(1, 1, &aix, &aiy);
+      if (pi_ok != (aix != HUGE_VAL))
+        return AnalyticProjection_cp();
+      if (pi_ok && (!near(0, adjlon(pix - aix), tolerance) || !near(piy, aiy, tolerance)))
+        return AnalyticProjection_cp();
+      nvalid += 1;
+    }
+  }
+  if (nvalid == 0)
+    return AnalyticProjection_cp();
+
+  METLIBS_LOG_DEBUG("using closed-form conversion");
+  return ap;
+}
@@ -0,0 +1,49 @@
+#ifndef DI_ANALYTIC_PROJECTION_H
+#define DI_ANALYTIC_PROJECTION_H
+
+#include <proj_api.h>
+
+#include <cstddef>
+#include <memory>
+
+class AnalyticProjection;
+typedef std::shared_ptr<const AnalyticProjection> AnalyticProjection_cp;
+
+/**
+ \brief Closed-form coordinate conversion for common projections
+
+ Implements the proj4 formulas for longlat, rotated longlat (ob_tran
+ with o_proj=longlat), polar stereographic and lambert conformal conic
+ projections as plain loops over the coordinate arrays, avoiding the
+ per-point overhead of pj_transform.
+
+ As for pj_transform, geographic coordinates are in radians, and points
+ with x == HUGE_VAL are left unchanged. Points that cannot be converted
+ are set to HUGE_VAL.
+ */
+class AnalyticProjection {
+public:
+  virtual ~AnalyticProjection();
+
+  /// convert geographic coordinates to this projection, in place
+  virtual void forward(size_t npos, size_t offset, double* x, double* y) const = 0;
+
+  /// convert coordinates in this projection to geographic coordinates, in place
+  virtual void inverse(size_t npos, size_t offset, double* x, double* y) const = 0;
+
+  /*! Create closed-form conversion for a proj4 projection.
+   *
+   * Returns null if the projection or some of its parameters are not
+   * supported, or if the result does not agree with pj_transform from
+   * and to the geographic projection at a set of test points.
+   */
+  static AnalyticProjection_cp create(projPJ pj, projPJ geographic);
+
+protected:
+  AnalyticProjection();
+
+  //! typical size of projected coordinates, for comparison with pj_transform
+  virtual double scale() const = 0;
+};
+
+#endif // DI_ANALYTIC_PROJECTION_H
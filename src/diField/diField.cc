@@ -34,6 +34,8 @@
 #include "diField.h"
 #include "diGridConverter.h"
 
+#include <algorithm>
+
 #define MILOGGER_CATEGORY "diField.Field"
 #include "miLogger/miLogging.h"
 
@@ -146,6 +148,7 @@ void Field::memberCopy(const Field& rhs)
   isPartOfCache=false;
   lastAccessed=miTime::nowTime();
 
+  invalidateDownsampled();
   if (area.nx != rhs.area.nx || area.ny != rhs.area.ny) {
     delete[] data;
     data= 0;
@@ -224,6 +227,10 @@ long Field::bytesize()
   // the area
   bytes+= sizeof(Area);
 
+  // downsampled levels
+  for (size_t i=0; i<downsampled_.size(); ++i)
+    bytes+= downsampled_[i]->bytesize();
+
   return bytes;
 }
 
@@ -239,6 +246,7 @@ void Field::reserve(int xdim, int ydim)
 
 void Field::fill(float v)
 {
+  invalidateDownsampled();
   defined_ = (v == difield::UNDEF) ? difield::NONE_DEFINED : difield::ALL_DEFINED;
   if (area.nx>0 && area.ny>0) {
     if (!data)
@@ -254,6 +262,7 @@ void Field::fill(float v)
 void Field::cleanup()
 {
   METLIBS_LOG_SCOPE();
+  invalidateDownsampled();
   area.nx  = 0;
   area.ny  = 0;
   delete[] data;
@@ -271,6 +280,7 @@ bool Field::subtract(const Field &rhs)
   if (defined_ == difield::NONE_DEFINED)
     return true; // no change
 
+  invalidateDownsampled();
   const size_t fsize = area.gridSize();
   if (rhs.defined_ == difield::NONE_DEFINED) {
     fill(difield::UNDEF);
@@ -491,6 +501,8 @@ bool Field::smooth(int nsmooth, float *work,
   if (nsmooth==0)
     return true;
 
+  invalidateDownsampled();
+
   if (allDefined() && nsmooth>0) {
 
     for (n=0; n<nsmooth; n++) {
@@ -871,14 +883,15 @@ bool Field::changeGrid(const GridArea& anew, bool fine_interpolation)
   if (area == anew)
     return true;
 
-  InterpolationType interpoltype = fine_interpolation ? I_BESSEL : I_BILINEAR;
-
   int nxnew= int(anew.R().width() /anew.resolutionX+0.5)+1;
   int nynew= int(anew.R().height()/anew.resolutionY+0.5)+1;
 
   if (nxnew<2 || nynew<2)
     return false;
 
+  if (!fine_interpolation)
+    return changeGrid(anew, GridRegridding::BILINEAR);
+
   float *newdata= new float[nxnew*nynew];
 
   float *x, *y;
@@ -887,12 +900,13 @@ bool Field::changeGrid(const GridArea& anew, bool fine_interpolation)
 
   convertToGrid(anew.gridSize(), x, y);
 
-  if (!interpolate(anew.gridSize(), x, y, newdata, interpoltype)) {
+  if (!interpolate(anew.gridSize(), x, y, newdata, I_BESSEL)) {
     delete[] newdata;
     METLIBS_LOG_ERROR("Interpolation failure");
     return false;
   }
 
+  invalidateDownsampled();
   delete[] data;
   data = newdata;
   area = anew;
@@ -904,6 +918,144 @@ bool Field::changeGrid(const GridArea& anew, bool fine_interpolation)
   return true;
 }
 
+bool Field::changeGrid(const GridArea& anew, GridRegridding::Method method)
+{
+  METLIBS_LOG_SCOPE();
+  if (!data)
+    return false;
+
+  if (area == anew)
+    return true;
+
+  GridRegridding_cp regridding = GridRegridding::get(area, anew, method);
+  if (!regridding) {
+    METLIBS_LOG_ERROR("Interpolation failure");
+    return false;
+  }
+
+  const size_t fsize = anew.gridSize();
+  float *newdata= new float[fsize];
+  const size_t n_undefined = regridding->apply(data, newdata, allDefined());
+
+  invalidateDownsampled();
+  delete[] data;
+  data = newdata;
+  area = anew;
+
+  defined_ = difield::checkDefined(n_undefined, fsize);
+
+  gridChanged= true;
+
+  return true;
+}
+
+namespace {
+
+/* Average defined values in blocks of 2x2 points for the downsampled
+ * index range [dx0,dx1) x [dy0,dy1). Partial blocks at the right and top
+ * edges are averaged over the points that exist.
+ */
+void downsample2x2(const float* src, int nx, int ny, float* dst, int dnx,
+    int dx0, int dy0, int dx1, int dy1, bool discontinuous, size_t& n_undefined)
+{
+  n_undefined = 0;
+  for (int dy = dy0; dy < dy1; ++dy) {
+    const int y0 = 2*dy, y1 = std::min(y0 + 1, ny - 1);
+    for (int dx = dx0; dx < dx1; ++dx) {
+      const int x0 = 2*dx, x1 = std::min(x0 + 1, nx - 1);
+      const float v[4] = {
+        src[y0*nx + x0], src[y0*nx + x1],
+        src[y1*nx + x0], src[y1*nx + x1]
+      };
+      float sum = 0;
+      int count = 0;
+      for (int k = 0; k < 4; ++k) {
+        if (v[k] != difield::UNDEF) {
+          if (discontinuous) {
+            // do not create new classes by averaging
+            sum = v[k];
+            count = 1;
+            break;
+          }
+          sum += v[k];
+          count += 1;
+        }
+      }
+      float& d = dst[dy*dnx + dx];
+      if (count > 0) {
+        d = sum / count;
+      } else {
+        d = difield::UNDEF;
+        n_undefined += 1;
+      }
+    }
+  }
+}
+
+} // namespace
+
+Field* Field::downsampled(int level)
+{
+  if (level <= 0)
+    return this;
+  if (!data)
+    return 0;
+
+  while (int(downsampled_.size()) < level) {
+    const Field* src = downsampled_.empty() ? this : downsampled_.back();
+    const int dnx = (src->area.nx + 1) / 2, dny = (src->area.ny + 1) / 2;
+    if (dnx < 2 || dny < 2)
+      return 0;
+
+    Field* dst = new Field();
+    dst->shallowMemberCopy(*src);
+
+    // a coarse point is located at the centre of its 2x2 block
+    Rectangle r = src->area.R();
+    r.x1 += 0.5 * src->area.resolutionX;
+    r.y1 += 0.5 * src->area.resolutionY;
+    dst->area = GridArea(Area(src->area.P(), r), dnx, dny,
+        2 * src->area.resolutionX, 2 * src->area.resolutionY);
+    r.x2 = dst->area.fromGridX(dnx - 1);
+    r.y2 = dst->area.fromGridY(dny - 1);
+    dst->area.setR(r);
+
+    dst->data = new float[dst->area.gridSize()];
+    size_t n_undefined;
+    downsample2x2(src->data, src->area.nx, src->area.ny, dst->data, dnx,
+        0, 0, dnx, dny, discontinuous, n_undefined);
+    dst->defined_ = difield::checkDefined(n_undefined, dst->area.gridSize());
+    downsampled_.push_back(dst);
+  }
+  return downsampled_[level-1];
+}
+
+void Field::updateDownsampled(int ix1, int iy1, int ix2, int iy2)
+{
+  const Field* src = this;
+  for (size_t l=0; l<downsampled_.size(); ++l) {
+    Field* dst = downsampled_[l];
+    ix1 = ix1 / 2;
+    iy1 = iy1 / 2;
+    ix2 = std::min((ix2 + 1) / 2, dst->area.nx);
+    iy2 = std::min((iy2 + 1) / 2, dst->area.ny);
+    if (ix1 >= ix2 || iy1 >= iy2)
+      break;
+    size_t n_undefined;
+    downsample2x2(src->data, src->area.nx, src->area.ny, dst->data, dst->area.nx,
+        ix1, iy1, ix2, iy2, discontinuous, n_undefined);
+    dst->checkDefined();
+    src = dst;
+  }
+}
+
+void Field::invalidateDownsampled()
+{
+  for (size_t i=0; i<downsampled_.size(); ++i)
+    delete downsampled_[i];
+  downsampled_.clear();
+}
+
 void Field::convertToGrid(int npos, float* xpos, float* ypos) const
 {
   for (int i = 0; i < npos; i++) {
@@ -32,10 +32,12 @@
 
 #include "diFieldDefined.h"
 #include "diArea.h"
+#include "diGridRegridding.h"
 #include "VcrossData.h"
 
 #include <puTools/miTime.h>
 #include <iosfwd>
+#include <vector>
 
 /**
 
@@ -107,6 +109,9 @@ private:
 
   difield::ValuesDefined defined_;
 
+  // lazily built downsampled levels 1, 2, ..., see downsampled()
+  std::vector<Field*> downsampled_;
+
   // this member is set by its friends diFieldCache(Entity) and noone else...
   bool isPartOfCache;
   // this member is set by its friends diFieldCache(Entity) and noone else...
@@ -156,6 +161,20 @@ public:
   /// Set all values undefined
   void setUndefined();
 
+  /*! Return this field downsampled by a factor 2^level in each direction.
+   *  Level 0 is this field. Coarser levels are built lazily by averaging
+   *  defined values in 2x2 blocks (picking one value for discontinuous
+   *  fields) and kept until the data are changed.
+   *  Returns 0 if the level would have less than 2x2 points.
+   */
+  Field* downsampled(int level);
+
+  /// Discard downsampled levels; must be called after changing data outside Field methods
+  void invalidateDownsampled();
+
+  /// Recompute existing downsampled levels after changing data in index range [ix1,ix2) x [iy1,iy2)
+  void updateDownsampled(int ix1, int iy1, int ix2, int iy2);
+
   /// smooth the field in nsmooth iterations
   bool smooth(int nsmooth);
   /// smooth the field in nsmooth iterations
@@ -177,6 +196,9 @@ public:
   /// interpolate to another grid
   bool changeGrid(const GridArea& anew, bool fine_interpolation);
 
+  /// interpolate to another grid, using cached weights
+  bool changeGrid(const GridArea& anew, GridRegridding::Method method);
+
   /// Return x,y in proj-coord
   void convertFromGrid(int npos, float* xpos, float* ypos) const;
 
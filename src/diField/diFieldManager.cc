@@ -810,7 +810,7 @@ bool FieldManager::makeDifferenceFields(std::vector<Field*> & fv1,
   if (differentGrid) {
     unsigned int j = 0;
     while (res && j < dim) {
-      res = fv2[j]->changeGrid(area1, false);
+      res = fv2[j]->changeGrid(area1, GridRegridding::BILINEAR); // weights are shared by all fields
       j++;
     }
     if (res && dim == 2) {
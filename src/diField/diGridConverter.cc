@@ -33,7 +33,7 @@
 
 #include "diGridConverter.h"
 
-#include "../util/openmp_tools.h"
+#include "../util/thread_pool.h"
 #include <VcrossUtil.h> // minimize / maximize
 
 #include <cmath>
@@ -172,18 +172,20 @@ bool GridConverter::doGetGridPoints(const GridArea& area, const Projection& map_
 
   const float gdxy = gridboxes ? 0.5 : 0; // offset by half cell iff using gridboxes
 
-  DIUTIL_OPENMP_PARALLEL(npos, for)
-  for (int iy = 0; iy < ny; iy++) {
-    for (int ix = 0; ix < (nx-1); ix++) {
-      int i = ix + iy*nx;
-      p0.x[i] = area.fromGridX(ix - gdxy);
-      p0.y[i] = area.fromGridY(iy - gdxy);
-    }
-    int i = iy*nx + nx - 1;
-    // FIXME x[i]=nx-1 converts to x[i]=0 when transforming between geo-projections
-    p0.x[i] = area.fromGridX(nx - gdxy - 1.1);
-    p0.y[i] = area.fromGridY(iy - gdxy);
-  }
+  const size_t grain_rows = std::max<size_t>(1, diutil::GRAIN_POINTS / nx);
+  diutil::parallel_for(0, ny, grain_rows, [&](size_t iy0, size_t iy1) {
+      for (int iy = iy0; iy < int(iy1); iy++) {
+        for (int ix = 0; ix < (nx-1); ix++) {
+          int i = ix + iy*nx;
+          p0.x[i] = area.fromGridX(ix - gdxy);
+          p0.y[i] = area.fromGridY(iy - gdxy);
+        }
+        int i = iy*nx + nx - 1;
+        // FIXME x[i]=nx-1 converts to x[i]=0 when transforming between geo-projections
+        p0.x[i] = area.fromGridX(nx - gdxy - 1.1);
+        p0.y[i] = area.fromGridY(iy - gdxy);
+      }
+    });
 
   const Projection& pa = area.P();
   if (!map_proj.convertPoints(pa, npos, p0.x, p0.y)) {
@@ -386,19 +388,20 @@ bool GridConverter::getVectors(const Area& data_area, const Projection& map_proj
   if (!getVectorRotationElements(data_area, map_proj, nvec, x, y, &cosx, &sinx))
     return false;
 
-  DIUTIL_OPENMP_PARALLEL(nvec, for)
-  for (int i = 0; i < nvec; ++i) {
-    if (u[i] != undef && v[i] != undef) {
-      if (cosx[i] == HUGE_VAL || sinx[i] == HUGE_VAL) {
-        u[i] = undef;
-        v[i] = undef;
-      } else {
-        const float ui = u[i], vi = v[i];
-        u[i] = cosx[i] * ui - sinx[i] * vi;
-        v[i] = sinx[i] * ui + cosx[i] * vi;
+  diutil::parallel_for(0, nvec, diutil::GRAIN_POINTS, [&](size_t i0, size_t i1) {
+      for (size_t i = i0; i < i1; ++i) {
+        if (u[i] != undef && v[i] != undef) {
+          if (cosx[i] == HUGE_VAL || sinx[i] == HUGE_VAL) {
+            u[i] = undef;
+            v[i] = undef;
+          } else {
+            const float ui = u[i], vi = v[i];
+            u[i] = cosx[i] * ui - sinx[i] * vi;
+            v[i] = sinx[i] * ui + cosx[i] * vi;
+          }
+        }
       }
-    }
-  }
+    });
 
   return true;
 }
@@ -415,15 +418,16 @@ bool GridConverter::getDirectionVectors(const Area& map_area, const bool turn,
   // to be rotated to the map grid
   // u,v is dd,ff coming in
   const float zturn = turn ? -1 : 1;
-  DIUTIL_OPENMP_PARALLEL(nvec, for)
-  for (int i=0; i<nvec; ++i) {
-    if (u[i] != undef && v[i] != undef) {
-      float dd   = u[i] * DEG_TO_RAD;
-      float ff   = v[i] * zturn;
-      u[i] = ff * sinf(dd);
-      v[i] = ff * cosf(dd);
-    }
-  }
+  diutil::parallel_for(0, nvec, diutil::GRAIN_POINTS, [&](size_t i0, size_t i1) {
+      for (size_t i = i0; i < i1; ++i) {
+        if (u[i] != undef && v[i] != undef) {
+          float dd   = u[i] * DEG_TO_RAD;
+          float ff   = v[i] * zturn;
+          u[i] = ff * sinf(dd);
+          v[i] = ff * cosf(dd);
+        }
+      }
+    });
 
   return getVectors(geo_area, map_area.P(), nvec, x, y, u, v);
 }
@@ -0,0 +1,294 @@
+#include "diGridRegridding.h"
+
+#include "diFieldDefined.h"
+#include "diGridConverter.h"
+#include "../util/openmp_tools.h"
+#include "../util/thread_pool.h"
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+
+#define MILOGGER_CATEGORY "diField.GridRegridding"
+#include "miLogger/miLogging.h"
+
+namespace {
+
+// same tolerance at the grid border as Field::interpolate
+const float BORDER = 0.03;
+
+bool sameGrid(const GridArea& a, const GridArea& b)
+{
+  return a == b && a.nx == b.nx && a.ny == b.ny
+      && a.resolutionX == b.resolutionX && a.resolutionY == b.resolutionY;
+}
+
+bool insideGrid(const GridArea& g, float x, float y)
+{
+  // also false for nan
+  return (x > -BORDER && x < g.nx - 1 + BORDER && y > -BORDER && y < g.ny - 1 + BORDER);
+}
+
+bool nearestStencil(const GridArea& g, float x, float y, int& ij)
+{
+  if (!insideGrid(g, x, y))
+    return false;
+  const int i = std::max(0, std::min(g.nx - 1, int(x + 1.5) - 1));
+  const int j = std::max(0, std::min(g.ny - 1, int(y + 1.5) - 1));
+  ij = j*g.nx + i;
+  return true;
+}
+
+bool bilinearStencil(const GridArea& g, float x, float y, int& ij, float* w)
+{
+  if (!insideGrid(g, x, y))
+    return false;
+  const int i = std::max(0, std::min(g.nx - 2, int(x + 1.) - 1));
+  const int j = std::max(0, std::min(g.ny - 2, int(y + 1.) - 1));
+  const float x1 = x - i, y1 = y - j;
+  w[0] = (1 - y1) * (1 - x1);
+  w[1] = (1 - y1) * x1;
+  w[2] = y1 * (1 - x1);
+  w[3] = y1 * x1;
+  ij = j*g.nx + i;
+  return true;
+}
+
+size_t countUndefined(const float* data, int n)
+{
+  return diutil::parallel_sum<size_t>(0, n, diutil::GRAIN_POINTS, [data](size_t i0, size_t i1) {
+      return size_t(std::count(data + i0, data + i1, difield::UNDEF));
+    });
+}
+
+const size_t CACHE_SIZE = 4;
+std::mutex cacheMutex;
+std::list<GridRegridding_cp> cache; // most recently used first
+
+} // namespace
+
+GridRegridding::GridRegridding(const GridArea& source, const GridArea& target, Method method)
+  : source_(source)
+  , target_(target)
+  , method_(method)
+  , valid_(false)
+  , width_(0)
+{
+  METLIBS_LOG_TIME(LOGVAL(source_) << LOGVAL(target_) << LOGVAL(method_));
+  if (source_.nx < 2 || source_.ny < 2 || target_.nx < 1 || target_.ny < 1)
+    return;
+
+  // target gridpoints in source grid coordinates
+  const int ntarget = target_.gridSize();
+  std::vector<float> sx(ntarget), sy(ntarget);
+  {
+    GridConverter gc(1);
+    float *x, *y;
+    if (!gc.getGridPoints(target_, source_, false, &x, &y))
+      return;
+    for (int t = 0; t < ntarget; ++t) {
+      sx[t] = source_.toGridX(x[t]);
+      sy[t] = source_.toGridY(y[t]);
+    }
+  }
+
+  if (method_ == AVERAGE)
+    makeAverageStencils(&sx[0], &sy[0]);
+  else
+    makeStencils(&sx[0], &sy[0]);
+}
+
+void GridRegridding::makeStencils(const float* sx, const float* sy)
+{
+  const int ntarget = target_.gridSize();
+  width_ = (method_ == NEAREST) ? 1 : 4;
+  index_.resize(ntarget);
+  weight_.resize(ntarget * width_);
+
+  for (int t = 0; t < ntarget; ++t) {
+    float* w = &weight_[t * width_];
+    bool inside;
+    if (method_ == NEAREST) {
+      inside = nearestStencil(source_, sx[t], sy[t], index_[t]);
+      w[0] = 1;
+    } else {
+      inside = bilinearStencil(source_, sx[t], sy[t], index_[t], w);
+    }
+    if (!inside) {
+      // read a valid source point with zero weight, overwritten afterwards
+      index_[t] = 0;
+      std::fill(w, w + width_, 0.0f);
+      outside_.push_back(t);
+    }
+  }
+  valid_ = true;
+}
+
+void GridRegridding::makeAverageStencils(const float* sx, const float* sy)
+{
+  const int nsource = source_.gridSize(), ntarget = target_.gridSize();
+
+  // target gridbox containing each source gridpoint, or -1
+  std::vector<int> box(nsource, -1);
+  std::vector<int> count(ntarget, 0);
+  {
+    GridConverter gc(1);
+    float *x, *y;
+    if (!gc.getGridPoints(source_, target_, false, &x, &y))
+      return;
+    for (int s = 0; s < nsource; ++s) {
+      const float tx = target_.toGridX(x[s]), ty = target_.toGridY(y[s]);
+      if (tx > -0.5 && tx < target_.nx - 0.5 && ty > -0.5 && ty < target_.ny - 0.5) {
+        const int i = std::min(target_.nx - 1, int(tx + 0.5));
+        const int j = std::min(target_.ny - 1, int(ty + 0.5));
+        box[s] = j*target_.nx + i;
+        count[box[s]] += 1;
+      }
+    }
+  }
+
+  // target gridboxes without source gridpoints are interpolated bilinearly
+  std::vector<int> bilinearIndex(ntarget, -1);
+  std::vector<float> bilinearWeight;
+  offsets_.resize(ntarget + 1);
+  offsets_[0] = 0;
+  for (int t = 0; t < ntarget; ++t) {
+    int n = count[t];
+    if (n == 0) {
+      float w[4];
+      if (bilinearStencil(source_, sx[t], sy[t], bilinearIndex[t], w)) {
+        bilinearWeight.insert(bilinearWeight.end(), w, w + 4);
+        n = 4;
+      } else {
+        bilinearIndex[t] = -1;
+      }
+    }
+    offsets_[t+1] = offsets_[t] + n;
+  }
+
+  index_.resize(offsets_[ntarget]);
+  weight_.resize(offsets_[ntarget]);
+  std::vector<int> next(offsets_.begin(), offsets_.end() - 1);
+  for (int s = 0; s < nsource; ++s) {
+    if (box[s] >= 0) {
+      const int k = next[box[s]]++;
+      index_[k] = s;
+      weight_[k] = 1;
+    }
+  }
+  const int snx = source_.nx;
+  std::vector<float>::const_iterator bw = bilinearWeight.begin();
+  for (int t = 0; t < ntarget; ++t) {
+    const int ij = bilinearIndex[t];
+    if (ij >= 0) {
+      const int k = offsets_[t];
+      index_[k] = ij;
+      index_[k+1] = ij + 1;
+      index_[k+2] = ij + snx;
+      index_[k+3] = ij + snx + 1;
+      std::copy(bw, bw + 4, weight_.begin() + k);
+      bw += 4;
+    }
+  }
+  valid_ = true;
+}
+
+size_t GridRegridding::apply(const float* src, float* dst, bool allDefined) const
+{
+  if (!valid_)
+    return 0;
+  if (width_ > 0)
+    return applyFixed(src, dst, allDefined);
+  else
+    return applyVariable(src, dst);
+}
+
+size_t GridRegridding::applyFixed(const float* src, float* dst, bool allDefined) const
+{
+  const int n = target_.gridSize(), snx = source_.nx;
+  const int* index = &index_[0];
+  const float* w = &weight_[0];
+
+  // the loops without branches are meant to be vectorised
+  diutil::parallel_for(0, n, diutil::GRAIN_POINTS, [&](size_t t0, size_t t1) {
+      const int t_begin = t0, t_end = t1;
+      if (width_ == 1) {
+        DIUTIL_OPENMP(simd)
+        for (int t = t_begin; t < t_end; ++t)
+          dst[t] = src[index[t]];
+      } else if (allDefined) {
+        DIUTIL_OPENMP(simd)
+        for (int t = t_begin; t < t_end; ++t) {
+          const float* s = src + index[t];
+          const float* wt = w + 4*t;
+          dst[t] = wt[0]*s[0] + wt[1]*s[1] + wt[2]*s[snx] + wt[3]*s[snx+1];
+        }
+      } else {
+        for (int t = t_begin; t < t_end; ++t) {
+          const float* s = src + index[t];
+          const float* wt = w + 4*t;
+          if (s[0] != difield::UNDEF && s[1] != difield::UNDEF
+              && s[snx] != difield::UNDEF && s[snx+1] != difield::UNDEF)
+            dst[t] = wt[0]*s[0] + wt[1]*s[1] + wt[2]*s[snx] + wt[3]*s[snx+1];
+          else
+            dst[t] = difield::UNDEF;
+        }
+      }
+    });
+
+  for (size_t k = 0; k < outside_.size(); ++k)
+    dst[outside_[k]] = difield::UNDEF;
+
+  if (allDefined)
+    return outside_.size();
+  else
+    return countUndefined(dst, n);
+}
+
+size_t GridRegridding::applyVariable(const float* src, float* dst) const
+{
+  const int n = target_.gridSize();
+  const int* offsets = &offsets_[0];
+  const int* index = index_.empty() ? 0 : &index_[0];
+  const float* w = weight_.empty() ? 0 : &weight_[0];
+
+  diutil::parallel_for(0, n, diutil::GRAIN_POINTS, [&](size_t t0, size_t t1) {
+      for (size_t t = t0; t < t1; ++t) {
+        float sum = 0, wsum = 0;
+        for (int k = offsets[t]; k < offsets[t+1]; ++k) {
+          const float v = src[index[k]];
+          if (v != difield::UNDEF) {
+            sum += w[k] * v;
+            wsum += w[k];
+          }
+        }
+        dst[t] = (wsum > 0) ? sum / wsum : difield::UNDEF;
+      }
+    });
+
+  return countUndefined(dst, n);
+}
+
+// static
+GridRegridding_cp GridRegridding::get(const GridArea& source, const GridArea& target, Method method)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  for (std::list<GridRegridding_cp>::iterator it = cache.begin(); it != cache.end(); ++it) {
+    const GridRegridding& r = **it;
+    if (r.method() == method && sameGrid(r.source(), source) && sameGrid(r.target(), target)) {
+      GridRegridding_cp found = *it;
+      cache.erase(it);
+      cache.push_front(found);
+      return found;
+    }
+  }
+
+  GridRegridding_cp r = std::make_shared<GridRegridding>(source, target, method);
+  if (!r->valid())
+    return GridRegridding_cp();
+
+  cache.push_front(r);
+  if (cache.size() > CACHE_SIZE)
+    cache.pop_back();
+  return r;
+}
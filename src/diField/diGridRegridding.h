@@ -0,0 +1,89 @@
+#ifndef DI_GRID_REGRIDDING_H
+#define DI_GRID_REGRIDDING_H
+
+#include "diArea.h"
+
+#include <memory>
+#include <vector>
+
+class GridRegridding;
+typedef std::shared_ptr<const GridRegridding> GridRegridding_cp;
+
+/**
+ \brief Interpolation weights from one grid to another
+
+ All projection calculations are done once when the weights are
+ computed; regridding a field is then a weighted gather from the
+ source data. Use GridRegridding::get to share weights between all
+ fields with the same source and target grid.
+ */
+class GridRegridding {
+public:
+  enum Method {
+    NEAREST,  ///< nearest source gridpoint
+    BILINEAR, ///< bilinear interpolation between 2x2 source gridpoints
+    AVERAGE   ///< average of source gridpoints inside each target gridbox, bilinear if there are none
+  };
+
+  GridRegridding(const GridArea& source, const GridArea& target, Method method);
+
+  const GridArea& source() const
+    { return source_; }
+
+  const GridArea& target() const
+    { return target_; }
+
+  Method method() const
+    { return method_; }
+
+  /*! False if the source or target grid is too small or if the
+   *  target gridpoints could not be converted to the source projection.
+   */
+  bool valid() const
+    { return valid_; }
+
+  /*! Regrid source data to target data. With bilinear and nearest,
+   *  a target point is undefined if any of its source points is
+   *  undefined; with average, undefined source points are skipped.
+   *
+   * \param src source data, source().gridSize() values
+   * \param dst target data, target().gridSize() values
+   * \param allDefined true if src contains no undefined values
+   * \return number of undefined target points
+   */
+  size_t apply(const float* src, float* dst, bool allDefined) const;
+
+  /*! Get weights from a small cache, computing them if necessary.
+   *  Returns null if no valid weights can be computed.
+   */
+  static GridRegridding_cp get(const GridArea& source, const GridArea& target, Method method);
+
+private:
+  void makeStencils(const float* sx, const float* sy);
+  void makeAverageStencils(const float* tx, const float* ty);
+
+  size_t applyFixed(const float* src, float* dst, bool allDefined) const;
+  size_t applyVariable(const float* src, float* dst) const;
+
+private:
+  GridArea source_;
+  GridArea target_;
+  Method method_;
+  bool valid_;
+
+  //! number of source points per target point, 0 if variable (offsets_ used)
+  int width_;
+
+  //! first source point and weights for each target point (fixed width)
+  //! or for each entry in offsets_ (variable width)
+  std::vector<int> index_;
+  std::vector<float> weight_;
+
+  //! for variable width, entries offsets_[t] .. offsets_[t+1] belong to target point t
+  std::vector<int> offsets_;
+
+  //! target points outside the source grid (fixed width only)
+  std::vector<int> outside_;
+};
+
+#endif // DI_GRID_REGRIDDING_H
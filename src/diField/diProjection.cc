@@ -33,8 +33,11 @@
 
 #include "diProjection.h"
 
+#include "diAnalyticProjection.h"
+
 #include "../util/math_util.h"
 #include "../util/openmp_tools.h"
+#include "../util/thread_pool.h"
 
 #include <puDatatypes/miCoordinates.h> // for earth radius
 #include <puTools/miString.h>
@@ -53,6 +56,19 @@
 
 using namespace miutil;
 
+namespace {
+
+const char GEOGRAPHIC_DEFINITION[] = "+proj=longlat  +ellps=WGS84 +towgs84=0,0,0 +no_defs";
+
+//! geographic projection for checking closed-form conversions
+projPJ referenceGeographic()
+{
+  static std::shared_ptr<void> pj(pj_init_plus(GEOGRAPHIC_DEFINITION), pj_free);
+  return pj.get();
+}
+
+} // namespace
+
 // static
 std::shared_ptr<Projection> Projection::sGeographic;
 
@@ -74,6 +90,8 @@ bool Projection::set_proj_definition(const std::string& projStr)
   if (!projObject)
     METLIBS_LOG_WARN("proj4 init error for '" << projDefinition << "': " << pj_strerrno(pj_errno));
 
+  analytic = AnalyticProjection::create(projObject.get(), referenceGeographic());
+
   return (projObject != 0);
 }
 
@@ -206,6 +224,18 @@ bool Projection::convertPoints(const Projection& srcProj, size_t npos, diutil::P
 
 bool Projection::transformAndCheck(const Projection& src, size_t npos, size_t offset, double* x, double* y, bool silent) const
 {
+  if (analytic && src.analytic) {
+    // both steps in the same chunk, while the coordinates are in the cache
+    diutil::parallel_for(0, npos, diutil::GRAIN_POINTS, [&](size_t i0, size_t i1) {
+        double* xi = x + i0*offset;
+        double* yi = y + i0*offset;
+        src.analytic->inverse(i1 - i0, offset, xi, yi);
+        analytic->forward(i1 - i0, offset, xi, yi);
+      });
+    // pj_transform reports an error if a single point cannot be converted
+    return !(npos == 1 && x[0] == HUGE_VAL);
+  }
+
   // actual transformation -- here we spend most of the time when large matrixes.
   double* z = 0;
   const int ret = pj_transform(src.projObject.get(), projObject.get(), npos, offset, x, y, z);
@@ -638,6 +668,6 @@ bool Projection::getLatLonIncrement(float lat, float /*lon*/, float& dlat, float
 const Projection& Projection::geographic()
 {
   if (!sGeographic)
-    sGeographic = std::shared_ptr<Projection>(new Projection("+proj=longlat  +ellps=WGS84 +towgs84=0,0,0 +no_defs"));
+    sGeographic = std::shared_ptr<Projection>(new Projection(GEOGRAPHIC_DEFINITION));
   return *sGeographic;
 }
@@ -31,6 +31,7 @@
 #define diProjection_h
 
 #include "diPoint.h"
+#include "diAnalyticProjection.h"
 #include "diRectangle.h"
 
 #include <proj_api.h>
@@ -73,6 +74,12 @@ public:
    */
   bool isGeographic() const;
 
+  /**
+   * Return true if conversions use closed-form formulas instead of pj_transform
+   */
+  bool hasAnalyticConversion() const
+    { return analytic != 0; }
+
   void setDefault();
 
   /// Convert Points to this projection
@@ -162,6 +169,7 @@ private:
   typedef void PJ;
 #endif
   std::shared_ptr<PJ> projObject;
+  AnalyticProjection_cp analytic;
 
   static std::shared_ptr<Projection> sGeographic;
 };
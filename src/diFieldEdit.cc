@@ -114,6 +114,7 @@ FieldEdit& FieldEdit::operator=(const FieldEdit &rhs)
 
   // fieldPlot
   editfieldplot= new FieldPlot();
+  editfieldplot->setIncrementalContouring(true);
   editfieldplot->setData(vf, tprod);
 
   // all the other members...
@@ -310,6 +311,7 @@ bool FieldEdit::prepareEditFieldPlot(const std::string& fieldname,
   if (editfieldplot)
     delete editfieldplot;
   editfieldplot= new FieldPlot();
+  editfieldplot->setIncrementalContouring(true);
   editfieldplot->setData(vf, tprod);
 
   return true;
@@ -519,8 +521,11 @@ void FieldEdit::setData(const vector<Field*>& vf,
 
 void FieldEdit::setConstantValue(float value)
 {
-  if (editfield)
+  if (editfield) {
     editfield->fill(value);
+    if (editfieldplot)
+      editfieldplot->dataChanged(0, 0, editfield->area.nx, editfield->area.ny);
+  }
 }
 
 
@@ -622,6 +627,9 @@ bool FieldEdit::notifyEditEvent(const EditEvent& ee)
   bool change= false;
   bool repaint= true;
 
+  // gridpoint range modified in editfield by this event
+  int i1ch= 0, i2ch= 0, j1ch= 0, j2ch= 0;
+
   bool haveDoneUndoRedo= justDoneUndoRedo;
 
   if (justDoneUndoRedo) {
@@ -838,6 +846,11 @@ bool FieldEdit::notifyEditEvent(const EditEvent& ee)
       // save influence as shown in dialog
       if (!haveDoneUndoRedo) currentInfluence= getFieldInfluence(false);
       // set cursor pos and influence
+      i1ch= undofields[u].i1;
+      i2ch= undofields[u].i2;
+      j1ch= undofields[u].j1;
+      j2ch= undofields[u].j2;
+
       if (ee.type==edit_redo) setFieldInfluence(undofields[u].influence, true);
       else if (u>0)           setFieldInfluence(undofields[u-1].influence, true);
       else                    setFieldInfluence(firstInfluence, true);
@@ -1279,6 +1292,14 @@ bool FieldEdit::notifyEditEvent(const EditEvent& ee)
 
     }
 
+    if (editstate==edit_replace_undef || editstate==edit_set_undef) {
+      // editfield changed directly by editBrush
+      i1ch= i1ed;
+      i2ch= i2ed;
+      j1ch= j1ed;
+      j2ch= j2ed;
+    }
+
     xprev= gx;
     yprev= gy;
 
@@ -1323,11 +1344,12 @@ bool FieldEdit::notifyEditEvent(const EditEvent& ee)
         }
       }
     }
+    // previous step may have touched points outside the current range
+    if (i1edp>i1ed) i1edp=i1ed;
+    if (i2edp<i2ed) i2edp=i2ed;
+    if (j1edp>j1ed) j1edp=j1ed;
+    if (j2edp<j2ed) j2edp=j2ed;
     if (workfield!=editfield) {
-      if (i1edp>i1ed) i1edp=i1ed;
-      if (i2edp<i2ed) i2edp=i2ed;
-      if (j1edp>j1ed) j1edp=j1ed;
-      if (j2edp<j2ed) j2edp=j2ed;
       int i,j,ij;
       for (j=j1edp; j<j2edp; j++) {
         for (i=i1edp; i<i2edp; i++) {
@@ -1336,14 +1358,22 @@ bool FieldEdit::notifyEditEvent(const EditEvent& ee)
             editfield->data[ij]= workfield->data[ij];
         }
       }
-      i1edp= i1ed;
-      i2edp= i2ed;
-      j1edp= j1ed;
-      j2edp= j2ed;
     }
+    i1ch= i1edp;
+    i2ch= i2edp;
+    j1ch= j1edp;
+    j2ch= j2edp;
+    i1edp= i1ed;
+    i2edp= i2ed;
+    j1edp= j1ed;
+    j2edp= j2ed;
 
   }
 
+  // recompute downsampled levels and contours only where data changed
+  if (existing && editfieldplot && i1ch<i2ch && j1ch<j2ch)
+    editfieldplot->dataChanged(i1ch, j1ch, i2ch, j2ch);
+
   return repaint;
 }
 
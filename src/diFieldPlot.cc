@@ -48,6 +48,7 @@
 #include "diColourShading.h"
 #include "diUtilities.h"
 #include "util/charsets.h"
+#include "util/format_int.h"
 #include "util/math_util.h"
 #include "util/string_util.h"
 
@@ -555,6 +556,9 @@ void RasterAlarmBox::pixelQuad(const diutil::PointI &s, const diutil::PointD& px
 FieldPlot::FieldPlot(FieldPlotManager* fieldplotm)
   : fieldplotm_(fieldplotm)
   , pshade(false)
+  , resampledLevel(0)
+  , contourTilesLevel(0)
+  , contourCache(new DianaContourCache)
   , vectorAnnotationSize(0)
 {
   METLIBS_LOG_SCOPE();
@@ -569,6 +573,9 @@ FieldPlot::~FieldPlot()
 void FieldPlot::clearFields()
 {
   METLIBS_LOG_SCOPE();
+  if (contourTiles)
+    contourTiles->clear();
+  contourCache->clear();
   diutil::delete_all_and_clear(tmpfields);
   if (fieldplotm_)
     fieldplotm_->freeFields(fields);
@@ -674,6 +681,9 @@ bool FieldPlot::prepare(const std::string& fname, const PlotCommand_cp& pc)
   opts.insert(opts.end(), cmd_all.begin(), cmd_all.end());
 
   setPlotInfo(opts);
+  if (contourTiles)
+    contourTiles->clear();
+  contourCache->clear();
 
   if (poptions.maxDiagonalInMeters > -1) {
     METLIBS_LOG_INFO(
@@ -1112,6 +1122,28 @@ bool FieldPlot::plotMe(DiGLPainter* gl, PlotOrder zorder)
     }
   }
 
+  // plot coarser field levels if the grid is much denser than the screen pixels
+  std::vector<Field*> fullResolutionFields;
+  const int level = resamplingLevel(gl);
+  resampledLevel = 0;
+  if (level > 0) {
+    std::vector<Field*> resampled;
+    for (size_t i = 0; i < fields.size(); ++i) {
+      Field* f = fields[i] ? fields[i]->downsampled(level) : 0;
+      if (fields[i] && !f) {
+        resampled.clear();
+        break;
+      }
+      resampled.push_back(f);
+    }
+    if (!resampled.empty()) {
+      METLIBS_LOG_DEBUG("plotting downsampled field" << LOGVAL(level));
+      fullResolutionFields.swap(fields);
+      fields.swap(resampled);
+      resampledLevel = level;
+    }
+  }
+
   bool ok = false;
 
   if (plottype() == fpt_contour1)
@@ -1140,6 +1172,9 @@ bool FieldPlot::plotMe(DiGLPainter* gl, PlotOrder zorder)
   if (poptions.use_stencil || poptions.update_stencil)
     gl->Disable(DiGLPainter::gl_STENCIL_TEST);
 
+  if (!fullResolutionFields.empty())
+    fields.swap(fullResolutionFields);
+
   return ok;
 }
 
@@ -1322,6 +1357,10 @@ void FieldPlot::setAutoStep(float* x, float* y, int& ixx1, int ix2, int& iyy1,
     }
   }
 
+  // fewer arrows and numbers while panning or zooming with slow frames
+  if (getStaticPlot()->isInteractive())
+    step *= 2;
+
   dist *= float(step);
 
   //adjust ix1,iy1 to make sure that same grid points are used when panning
@@ -1468,6 +1507,8 @@ bool FieldPlot::plotWind(DiGLPainter* gl)
 
   gl->setLineStyle(poptions.linecolour, poptions.linewidth, false);
 
+  // select arrows first, to find all latitudes in one call
+  std::vector<int> arrows;
   for (int iy = iy1; iy < iy2; iy += step) {
     const int xstep = xAutoStep(x, y, ix1, ix2, iy, sdist);
     for (int ix = ix1; ix < ix2; ix += xstep) {
@@ -1475,23 +1516,30 @@ bool FieldPlot::plotWind(DiGLPainter* gl)
 
       if (u[i] == fieldUndef || v[i] == fieldUndef || !ms.isnear(x[i], y[i]))
         continue;
+      if (colours && fields[2]->data[i] == fieldUndef)
+        continue;
+      arrows.push_back(i);
+    }
+  }
 
-      if (colours) {
-        const float c = fields[2]->data[i];
-        if (c == fieldUndef)
-          continue;
-        else
-          colours.setColour(gl, c);
-      }
+  std::vector<float> lon(arrows.size()), lat(arrows.size());
+  for (size_t k = 0; k < arrows.size(); ++k) {
+    lon[k] = x[arrows[k]];
+    lat[k] = y[arrows[k]];
+  }
+  if (!arrows.empty())
+    projection.convertToGeographic(arrows.size(), &lon[0], &lat[0]);
 
-      // If southern hemisphere, turn the feathers
-      float xx = x[i], yy = y[i];
-      projection.convertToGeographic(1, &xx, &yy);
-      const int turnBarbs = (yy < 0) ? -1 : 1;
-      const float KNOT = 3600.0 / 1852.0;
-      const float gu = u[i] * KNOT, gv = v[i] * KNOT;
-      gl->drawWindArrow(gu, gv, x[i], y[i], flagl, poptions.arrowstyle == arrow_wind_arrow, turnBarbs);
-    }
+  const float KNOT = 3600.0 / 1852.0;
+  for (size_t k = 0; k < arrows.size(); ++k) {
+    const int i = arrows[k];
+    if (colours)
+      colours.setColour(gl, fields[2]->data[i]);
+
+    // If southern hemisphere, turn the feathers
+    const int turnBarbs = (lat[k] < 0) ? -1 : 1;
+    const float gu = u[i] * KNOT, gv = v[i] * KNOT;
+    gl->drawWindArrow(gu, gv, x[i], y[i], flagl, poptions.arrowstyle == arrow_wind_arrow, turnBarbs);
   }
   gl->Disable(DiGLPainter::gl_LINE_STIPPLE);
 
@@ -2382,37 +2430,15 @@ bool FieldPlot::plotContour(DiGLPainter* gl)
   bool res = true;
   float *x = 0, *y = 0;
 
-  //Resampling disabled
-  int factor = 1; //resamplingFactor(nx, ny);
-
-  if (factor < 2)
-    factor = 1;
-
   // convert gridpoints to correct projection
-  if (not getGridPoints(x, y, ix1, ix2, iy1, iy2, factor)) {
+  if (not getGridPoints(x, y, ix1, ix2, iy1, iy2)) {
     METLIBS_LOG_ERROR("getGridPoints returned false");
     return false;
   }
 
-  const int rnx = fields[0]->area.nx / factor, rny = fields[0]->area.ny / factor;
-
-  // Create a resampled data array to pass to the contour function.
-  float *data;
-  if (factor != 1) {
-    METLIBS_LOG_INFO("Resampled field from" << LOGVAL(fields[0]->area.nx) << LOGVAL(fields[0]->area.ny)
-        << " to" << LOGVAL(rnx) << LOGVAL(rny));
-    data = new float[rnx * rny];
-    int i = 0;
-    for (int iy = 0; iy < rny; ++iy) {
-      int j = 0;
-      for (int ix = 0; ix < rnx; ++ix) {
-        data[(i * rnx) + j] = fields[0]->data[(iy * fields[0]->area.nx * factor) + (ix * factor)];
-        ++j;
-      }
-      ++i;
-    }
-  } else
-    data = fields[0]->data;
+  // resampling is done in plotMe, using Field::downsampled
+  const int rnx = fields[0]->area.nx, rny = fields[0]->area.ny;
+  float *data = fields[0]->data;
 
   if (ix1 >= ix2 || iy1 >= iy2)
     return false;
@@ -2663,9 +2689,6 @@ bool FieldPlot::plotContour(DiGLPainter* gl)
   if (poptions.update_stencil)
     plotFrameStencil(gl, rnx, rny, x, y);
 
-  if (factor != 1)
-    delete[] data;
-
   return true;
 }
 
@@ -2719,17 +2742,37 @@ bool FieldPlot::plotContour2(DiGLPainter* gl, PlotOrder zorder)
   if (poptions.valueLabel)
     gl->setFont(poptions.fontname, poptions.fontface, 10 * poptions.labelSize);
 
-  {
-    METLIBS_LOG_TIME("contour2");
-    if (not poly_contour(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
-            poptions, fieldUndef, paintMode))
-      METLIBS_LOG_ERROR("contour2 error");
-  }
-  if (poptions.options_2) {
-    METLIBS_LOG_TIME("contour2 options_2");
-    if (not poly_contour(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
-            poptions, fieldUndef, paintMode, true))
-      METLIBS_LOG_ERROR("contour2 options_2 error");
+  if (contourTiles && !gl->isPrinting()) {
+    if (contourTilesLevel != resampledLevel) {
+      contourTiles->clear();
+      contourTilesLevel = resampledLevel;
+    }
+    METLIBS_LOG_TIME("contour2 tiles");
+    contourTiles->paint(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
+        poptions, fieldUndef, paintMode, false);
+    if (poptions.options_2)
+      contourTiles->paint(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
+          poptions, fieldUndef, paintMode, true);
+  } else if (!gl->isPrinting()) {
+    METLIBS_LOG_TIME("contour2 cache");
+    contourCache->paint(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
+        poptions, fieldUndef, paintMode, false);
+    if (poptions.options_2)
+      contourCache->paint(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
+          poptions, fieldUndef, paintMode, true);
+  } else {
+    {
+      METLIBS_LOG_TIME("contour2");
+      if (not poly_contour(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
+              poptions, fieldUndef, paintMode))
+        METLIBS_LOG_ERROR("contour2 error");
+    }
+    if (poptions.options_2) {
+      METLIBS_LOG_TIME("contour2 options_2");
+      if (not poly_contour(nx, ny, ix1, iy1, ix2, iy2, fields[0]->data, x, y, gl,
+              poptions, fieldUndef, paintMode, true))
+        METLIBS_LOG_ERROR("contour2 options_2 error");
+    }
   }
   if (poptions.extremeType != "None" && poptions.extremeType != "Ingen"
       && !poptions.extremeType.empty())
@@ -3436,7 +3479,7 @@ bool FieldPlot::plotNumbers(DiGLPainter* gl)
       gy = y[i];
 
       if (field[i] != fieldUndef) {
-        str = QString::number(field[i], 'f', iprec);
+        str = QString::fromLatin1(diutil::format_fixed(field[i], iprec).c_str());
         gl->getTextSize(str, w, h);
         w *= 0.5;
       } else {
@@ -3523,17 +3566,63 @@ bool FieldPlot::checkFields(size_t count) const
   return true;
 }
 
-int FieldPlot::resamplingFactor(int nx, int ny) const
+void FieldPlot::setIncrementalContouring(bool enable)
+{
+  if (!enable)
+    contourTiles.reset(0);
+  else if (!contourTiles)
+    contourTiles.reset(new DianaContourTiles);
+}
+
+void FieldPlot::dataChanged(int ix1, int iy1, int ix2, int iy2)
+{
+  for (size_t i = 0; i < fields.size(); ++i) {
+    if (fields[i])
+      fields[i]->updateDownsampled(ix1, iy1, ix2, iy2);
+  }
+  if (contourTiles) {
+    const int l = contourTilesLevel, m = (1 << l) - 1;
+    contourTiles->invalidate(ix1 >> l, iy1 >> l, (ix2 + m) >> l, (iy2 + m) >> l);
+  }
+}
+
+int FieldPlot::resamplingLevel(DiGLPainter* gl) const
 {
-  float cx[2], cy[2];
-  cx[0] = fields[0]->area.R().x1;
-  cy[0] = fields[0]->area.R().y1;
-  cx[1] = fields[0]->area.R().x2;
-  cy[1] = fields[0]->area.R().y2;
-  getPoints(2, cx, cy);
-
-  double xs = getStaticPlot()->getPlotSize().width() / fabs(cx[1] - cx[0]);
-  double ys = getStaticPlot()->getPlotSize().height() / fabs(cy[1] - cy[0]);
-  double resamplingF = min(xs, ys);
-  return int(resamplingF);
+  if (poptions.fullResolution || gl->isPrinting())
+    return 0;
+  if (!checkFields(1) || poptions.discontinuous || fields[0]->discontinuous)
+    return 0;
+
+  const std::string& pt = plottype();
+  const bool autoDensity = (poptions.density < 1);
+  if (!(pt == fpt_contour || pt == fpt_contour1 || pt == fpt_contour2 || pt == fpt_alpha_shade
+          || (autoDensity && (pt == fpt_wind || pt == fpt_vector || pt == fpt_direction))))
+    return 0;
+
+  const GridArea& fa = fields[0]->area;
+  if (fa.nx < 4 || fa.ny < 4)
+    return 0;
+
+  // distance in pixels between neighbouring gridpoints near the field centre
+  const int cx = fa.nx / 2, cy = fa.ny / 2;
+  float px[3] = { fa.fromGridX(cx), fa.fromGridX(cx + 1), fa.fromGridX(cx) };
+  float py[3] = { fa.fromGridY(cy), fa.fromGridY(cy), fa.fromGridY(cy + 1) };
+  if (!getPoints(3, px, py))
+    return 0;
+  const float sx = getStaticPlot()->getPhysToMapScaleX(), sy = getStaticPlot()->getPhysToMapScaleY();
+  if (sx <= 0 || sy <= 0)
+    return 0;
+  float spacing = std::max(diutil::absval((px[1] - px[0]) / sx, (py[1] - py[0]) / sy),
+      diutil::absval((px[2] - px[0]) / sx, (py[2] - py[0]) / sy));
+  if (!(spacing > 0))
+    return 0;
+
+  // coarsest level with at most one gridpoint distance per pixel
+  const int MaxResamplingLevel = 6;
+  int level = 0;
+  while (level < MaxResamplingLevel && 2 * spacing <= 1) {
+    spacing *= 2;
+    level += 1;
+  }
+  return level;
 }
@@ -40,9 +40,12 @@
 
 #include <QPolygonF>
 
+#include <memory>
 #include <vector>
 
 class DiGLPainter;
+class DianaContourCache;
+class DianaContourTiles;
 class FieldPlotManager;
 
 /**
@@ -78,6 +81,16 @@ public:
 
   bool plotUndefined(DiGLPainter* gl);
   bool plotNumbers(DiGLPainter* gl);
+
+  /** Keep contour geometry in tiles, so that only tiles touched by
+   *  dataChanged are contoured again. Used for field editing.
+   */
+  void setIncrementalContouring(bool enable);
+
+  /** Notify that field data in grid index range [ix1,ix2) x [iy1,iy2)
+   *  have been changed outside the Field methods.
+   */
+  void dataChanged(int ix1, int iy1, int ix2, int iy2);
   std::string getModelName();
   std::string getTrajectoryFieldName();
 
@@ -90,6 +103,15 @@ private:
   // plotting parameters
   bool pshade;          // shaded (true) or line drawing (false)
 
+  int resampledLevel;   // Field::downsampled level used while plotting
+
+  // incremental contouring, see setIncrementalContouring
+  std::unique_ptr<DianaContourTiles> contourTiles;
+  int contourTilesLevel;
+
+  // contour geometry in grid index space, reused when panning, zooming and reprojecting
+  std::unique_ptr<DianaContourCache> contourCache;
+
   // from plotting routines to annotations
   float    vectorAnnotationSize;
   std::string vectorAnnotationText;
@@ -130,7 +152,10 @@ private:
   bool markExtreme(DiGLPainter* gl);
   bool plotGridLines(DiGLPainter* gl);
 
-  int resamplingFactor(int nx, int ny) const;
+  /** Return the Field::downsampled level to use for the current
+   *  plottype and map scale, 0 for full resolution.
+   */
+  int resamplingLevel(DiGLPainter* gl) const;
 
   /** Return true if fields 0..count-1 are non-0 and have data.
    *  If count == 0, check that at least one field exists an that all fields have data.
@@ -35,11 +35,13 @@
 #include "diFieldPlot.h"
 #include "diPlotOptions.h"
 #include "diKVListPlotCommand.h"
+#include "diLocalSetupParser.h"
 #include "miSetupParser.h"
 #include "util/string_util.h"
 
 #include "diField/diFieldFunctions.h"
 #include "diField/diFlightLevel.h"
+#include "diField/GridInventoryCache.h"
 
 #include <puTools/miStringFunctions.h>
 
@@ -82,6 +84,10 @@ void FieldPlotManager::getAllFieldNames(vector<std::string>& fieldNames)
 
 bool FieldPlotManager::parseSetup()
 {
+  const std::string& cachedir = LocalSetupParser::basicValue("cachedir");
+  if (!cachedir.empty())
+    GridInventoryCache::instance().setDirectory(cachedir + "/fields");
+
   if (!parseFieldPlotSetup())
     return false;
   if (!parseFieldGroupSetup())
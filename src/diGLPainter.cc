@@ -130,6 +130,11 @@ void DiGLPainter::drawWindArrow(float u, float v, float x, float y,
   }
 }
 
+void DiGLPainter::drawSymbol(quint32, const QRectF&, const SymbolDrawer& draw)
+{
+  draw(this);
+}
+
 void DiGLPainter::clear(const Colour& colour)
 {
   ClearColor(colour.fR(), colour.fG(), colour.fB(), 1.0);
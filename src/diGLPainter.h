@@ -4,7 +4,10 @@
 
 #include "diPainter.h"
 
+#include <functional>
+
 class QImage;
+class QRectF;
 
 class DiGLCanvas : public DiCanvas {
 public:
@@ -312,6 +315,17 @@ public:
 
   void drawWindArrow(float u, float v, float x, float y,
       float arrowSize, bool withArrowHead, int turnBarbs=1) override;
+
+  typedef std::function<void(DiGLPainter*)> SymbolDrawer;
+
+  /*! Draw a symbol at the origin of the current transformation.
+   *
+   * The default implementation calls draw(this). Painters may instead
+   * draw a cached image of the symbol, so draw must only use the colour
+   * and line style set before, and the same symbol number must always
+   * give the same drawing, inside bounds.
+   */
+  virtual void drawSymbol(quint32 symbol, const QRectF& bounds, const SymbolDrawer& draw);
 };
 
 #endif // DIGLPAINTER_H
@@ -145,6 +145,10 @@ bool LocalSetupParser::parse(std::string& mainfilename)
     }
   }
 
+  const std::string& cachedir = basic_values["cachedir"];
+  if (!cachedir.empty())
+    miutil::SetupParser::setCacheDirectory(cachedir + "/setup");
+
   if (! miutil::SetupParser::parse( setupFilename ) )
     return false;
 
@@ -38,6 +38,11 @@
 #define MILOGGER_CATEGORY "diana.MItiff"
 #include <miLogger/miLogging.h>
 
+namespace {
+//! extra part of the view read on each side, to avoid reading again when panning
+const float WINDOW_MARGIN = 0.25;
+}
+
 MItiff::MItiff()
 {
 }
@@ -99,12 +104,57 @@ bool MItiff::readMItiff(const std::string& filename, Sat& sd, int index)
   //for each channel (index[i]) in rawimage[i], and  information about the
   // satellite pictures in the structure ginfo
 
+  //If sd has a view, only the part of the image needed for the view is
+  //read, see Sat::findWindow. Other channels (index>0) and mosaic files
+  //are read with the same window.
+
   satimg::dihead    ginfo;
 
-  int rres= satimg::MITIFF_read_diana(filename,&sd.rawimage[index], sd.no,sd.index, ginfo);
-  if (rres == -1) {
-    METLIBS_LOG_ERROR("MITIFF_read_diana returned false:" << filename);
-    return false;
+  int rres = -1;
+  if ((index == 0 && sd.viewWidth > 0) || sd.reduced()) {
+    rres = satimg::MITIFF_head_diana(filename, ginfo);
+    if (rres == -1) {
+      METLIBS_LOG_ERROR("MITIFF_head_diana returned false:" << filename);
+      return false;
+    }
+  }
+  if (index == 0 && sd.viewWidth > 0) {
+    sd.area.nx=ginfo.xsize;
+    sd.area.ny=ginfo.ysize;
+    sd.Ax = ginfo.Ax;
+    sd.Ay = ginfo.Ay;
+    sd.Bx = ginfo.Bx;
+    sd.By = ginfo.By;
+    sd.TrueLat= ginfo.trueLat;
+    sd.GridRot= ginfo.gridRot;
+    if ( sd.proj_string.empty() )
+      sd.proj_string = ginfo.proj_string;
+    sd.setArea();
+    if (!sd.findWindow(sd.viewArea, sd.viewWidth, sd.viewHeight, WINDOW_MARGIN, sd.window))
+      sd.window = Sat::Window();
+  }
+
+  if (sd.reduced()) {
+    const Sat::Window& w = sd.window;
+    if (satimg::MITIFF_read_window(filename, &sd.rawimage[index], sd.no, sd.index,
+            w.x0, w.y0, w.nx, w.ny, w.step) == 0) {
+      METLIBS_LOG_DEBUG("read " << w.nx << "x" << w.ny << " pixels at " << w.x0 << "," << w.y0
+          << " step " << w.step << " from " << filename);
+    } else if (index == 0) {
+      METLIBS_LOG_INFO("cannot read window from '" << filename << "', reading full image");
+      sd.window = Sat::Window();
+    } else {
+      METLIBS_LOG_ERROR("MITIFF_read_window returned false:" << filename);
+      return false;
+    }
+  }
+  if (!sd.reduced()) {
+    ginfo = satimg::dihead();
+    rres= satimg::MITIFF_read_diana(filename,&sd.rawimage[index], sd.no,sd.index, ginfo);
+    if (rres == -1) {
+      METLIBS_LOG_ERROR("MITIFF_read_diana returned false:" << filename);
+      return false;
+    }
   }
 
   if (rres == 2) {
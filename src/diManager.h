@@ -88,6 +88,9 @@ public:
 
   virtual bool isEnabled() const;
   virtual bool isEditing() const;
+  //! true if the manager has something to plot; such plots are painted in the gui thread
+  virtual bool hasPlots() const
+    { return isEnabled(); }
   virtual bool hasFocus() const;
 
 public slots:
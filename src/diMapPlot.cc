@@ -329,6 +329,9 @@ void MapPlot::plotMap(DiGLPainter* gl, int zorder)
     const float physdiag= getStaticPlot()->getPhysDiagonal();
     // map resolution i km/pixel
     float mapres= (physdiag > 0 ? getStaticPlot()->getGcd()/(physdiag*1000) : 0);
+    // less detail while panning or zooming with slow frames
+    if (getStaticPlot()->isInteractive())
+      mapres *= 4;
 
     // find correct mapfile
     size_t n= mapinfo.mapfiles.size();
@@ -32,19 +32,23 @@
 #endif
 
 #include "diObsBufr.h"
+#include "diObsCache.h"
 #include "diObsData.h"
 #include "diVprofPlot.h"
 #include "util/format_int.h"
+#include "util/mapped_file.h"
+#include "util/thread_pool.h"
 
 #include <puTools/miStringFunctions.h>
 #include <puTools/miTime.h>
 
-#include <boost/shared_array.hpp>
-
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 
 #define MILOGGER_CATEGORY "diana.ObsBufr"
@@ -133,6 +137,85 @@ int fix_year(int year)
     year = (year > 70) ? year + 1900 : year + 2000;
   return year;
 }
+
+const int kelem = 80000; //length of subsection
+const int kvals = 440000;
+
+//! size of the buffer given to readbufr
+const long max_message_length = 50000 * sizeof(int);
+
+//! libemos keeps the decoded message in fortran common blocks
+std::mutex emosMutex;
+
+//! output arrays of bufrex and busel2, about 45MB
+struct BufrexArrays {
+  std::unique_ptr<char[]> cnames, cunits, cvals;
+  std::unique_ptr<double[]> values;
+  std::unique_ptr<int[]> ktdlst, ktdexp;
+
+  BufrexArrays()
+    : cnames(new char[kelem * len_cnames])
+    , cunits(new char[kelem * len_cunits])
+    , cvals(new char[kvals * len_cvals])
+    , values(new double[kvals])
+    , ktdlst(new int[kelem])
+    , ktdexp(new int[kelem])
+  {
+  }
+};
+
+//! arrays for decoding in the calling thread, allocated once per thread instead of once per message
+BufrexArrays& threadBufrexArrays()
+{
+  thread_local BufrexArrays arrays;
+  return arrays;
+}
+
+struct BufrMessage {
+  const char* data;
+  long length;
+};
+
+/*! Find the BUFR messages in a file.
+ *
+ * Returns false if the messages cannot be split without readbufr, i.e.
+ * for BUFR edition 0 and 1 without total length in section 0, and for
+ * messages that are too long.
+ */
+bool splitMessages(const char* data, size_t size, std::vector<BufrMessage>& messages)
+{
+  static const char BUFR[] = "BUFR", END[] = "7777";
+  const char* const end = data + size;
+  const char* p = data;
+  while (true) {
+    const char* m = std::search(p, end, BUFR, BUFR + 4);
+    if (end - m < 8)
+      return true;
+
+    const unsigned char* s0 = reinterpret_cast<const unsigned char*>(m);
+    if (s0[7] < 2)
+      return false;
+    const long length = (s0[4] << 16) | (s0[5] << 8) | s0[6];
+    if (length < 12 || length > end - m || memcmp(m + length - 4, END, 4) != 0) {
+      // not a message, or truncated
+      p = m + 1;
+      continue;
+    }
+    if (length > max_message_length)
+      return false;
+
+    const BufrMessage bm = { m, length };
+    messages.push_back(bm);
+    p = m + length;
+  }
+}
+
+//! copy message to an int array, as filled by readbufr
+void copyMessage(const char* data, long length, std::vector<int>& ibuff)
+{
+  ibuff.assign(length / sizeof(int) + 2, 0);
+  memcpy(&ibuff[0], data, length);
+}
 } // namespace
 
 ObsBufr::ObsBufr()
@@ -142,8 +225,33 @@ ObsBufr::ObsBufr()
 
 bool ObsBufr::setObsPlot(ObsPlot* op, const std::string& filename)
 {
+  METLIBS_LOG_SCOPE(LOGVAL(filename));
   oplot = op;
-  return init(filename, FORMAT_OBSPLOT);
+  const int level = oplot->getLevel();
+
+  ObsCache& cache = ObsCache::instance();
+  ObsCache::Key key;
+  const bool cacheable = ObsCache::makeKey(filename, "bufr level=" + miutil::from_number(level), key);
+  ObsData_cpv obs;
+  if (cacheable)
+    obs = cache.find(key);
+  if (!obs) {
+    std::shared_ptr<ObsData_v> decoded = std::make_shared<ObsData_v>();
+    if (!decodeObsFile(filename, level, *decoded))
+      return init(filename, FORMAT_OBSPLOT);
+    obs = decoded;
+    if (cacheable)
+      cache.insert(key, obs);
+  }
+
+  // the cache has all times, not only those for this plot
+  ObsData_v selected;
+  for (size_t i = 0; i < obs->size(); ++i) {
+    if (oplot->timeOK((*obs)[i].obsTime))
+      selected.push_back((*obs)[i]);
+  }
+  oplot->addObs(selected);
+  return true;
 }
 
 bool ObsBufr::init(const std::string& bufr_file, Format format)
@@ -152,6 +260,50 @@ bool ObsBufr::init(const std::string& bufr_file, Format format)
   METLIBS_LOG_INFO("Reading '"<<bufr_file<<"'");
   obsTime = miTime(); //undef
 
+  const diutil::MappedFile mapped(bufr_file);
+  std::vector<BufrMessage> messages;
+  if (!mapped.data() || !splitMessages(mapped.data(), mapped.size(), messages))
+    return readMessages(bufr_file, format);
+
+  std::vector<int> ibuff;
+  for (size_t m = 0; m < messages.size(); ++m) {
+    copyMessage(messages[m].data, messages[m].length, ibuff);
+    //BUFRdecode returns false when vprof station is found
+    if (!BUFRdecode(&ibuff[0], messages[m].length, format))
+      return false;
+  }
+  return true;
+}
+
+bool ObsBufr::decodeObsFile(const std::string& bufr_file, int level, std::vector<ObsData>& obs)
+{
+  METLIBS_LOG_INFO("Reading '"<<bufr_file<<"'");
+
+  const diutil::MappedFile mapped(bufr_file);
+  std::vector<BufrMessage> messages;
+  if (!mapped.data() || !splitMessages(mapped.data(), mapped.size(), messages))
+    return false;
+
+  // bufrex is serialised, but conversion to ObsData runs in parallel
+  std::vector< std::vector<ObsData> > decoded(messages.size());
+  diutil::parallel_for(0, messages.size(), 1, [&](size_t m0, size_t m1) {
+      for (size_t m = m0; m < m1; ++m)
+        decodeObs(messages[m].data, messages[m].length, level, decoded[m]);
+    });
+
+  size_t count = 0;
+  for (size_t m = 0; m < decoded.size(); ++m)
+    count += decoded[m].size();
+  obs.reserve(obs.size() + count);
+  for (size_t m = 0; m < decoded.size(); ++m) {
+    for (size_t i = 0; i < decoded[m].size(); ++i)
+      obs.push_back(std::move(decoded[m][i]));
+  }
+  return true;
+}
+
+bool ObsBufr::readMessages(const std::string& bufr_file, Format format)
+{
   FILE* file_bufr = fopen(bufr_file.c_str(), "r");
   if (!file_bufr) {
     METLIBS_LOG_ERROR("fopen failed for '" << bufr_file << "'");
@@ -300,6 +452,9 @@ bool ObsBufr::BUFRdecode(int* ibuff, int ilen, Format format)
   // Decode BUFR message into fully decoded form
   METLIBS_LOG_SCOPE(LOGVAL(format));
 
+  // libemos is not reentrant, and busel2 uses the state left by bufrex
+  std::lock_guard<std::mutex> lock(emosMutex);
+
   int kerr;
 
   int ksup[9];
@@ -314,20 +469,18 @@ bool ObsBufr::BUFRdecode(int* ibuff, int ilen, Format format)
     return true;
   }
 
-  const int kelem = 80000; //length of subsection
-  const int kvals = 440000;
-
-  boost::shared_array<char> cnames(new char[kelem * len_cnames]);
-  boost::shared_array<char> cunits(new char[kelem * len_cunits]);
-  boost::shared_array<char> cvals (new char[kvals * len_cvals]);
-  boost::shared_array<double> values(new double[kvals]);
+  BufrexArrays& arrays = threadBufrexArrays();
+  char* cnames = arrays.cnames.get();
+  char* cunits = arrays.cunits.get();
+  char* cvals = arrays.cvals.get();
+  double* values = arrays.values.get();
 
   int kkvals = kvals;
   int kxelem = std::min(kvals / ksup[5], kelem);
   int ktdlen, ktdexl;
 
   bufrex_(&ilen, ibuff, ksup, ksec0, ksec1, ksec2, ksec3, ksec4, &kxelem,
-      cnames.get(), cunits.get(), &kkvals, values.get(), cvals.get(), &kerr,
+      cnames, cunits, &kkvals, values, cvals, &kerr,
       len_cnames, len_cunits, len_cvals);
   if (kerr > 0) {
     METLIBS_LOG_ERROR("Error in BUFREX: KERR=" << kerr);
@@ -353,9 +506,10 @@ bool ObsBufr::BUFRdecode(int* ibuff, int ilen, Format format)
   // Return list of Data Descriptors from Section 3 of Bufr message, and
   // total/requested list of elements. BUFREX must have been called before BUSEL.
 
-  boost::shared_array<int> ktdlst(new int[kelem]), ktdexp(new int[kelem]);
+  int* ktdlst = arrays.ktdlst.get();
+  int* ktdexp = arrays.ktdexp.get();
   for (int i = 1; i < nsubset + 1; i++) {
-    busel2_(&i, &kxelem, &ktdlen, ktdlst.get(), &ktdexl, ktdexp.get(), cnames.get(), cunits.get(), &kerr);
+    busel2_(&i, &kxelem, &ktdlen, ktdlst, &ktdexl, ktdexp, cnames, cunits, &kerr);
     if (kerr > 0) {
       METLIBS_LOG_ERROR("Error in BUSEL: KERR=" << kerr);
       continue;
@@ -365,13 +519,13 @@ bool ObsBufr::BUFRdecode(int* ibuff, int ilen, Format format)
       ObsData & obs = oplot->getNextObs();
 
       if (oplot->getLevel() < -1) {
-        if (!get_diana_data(ktdexl, ktdexp.get(), values.get(), cvals.get(), i - 1, kxelem, obs)
+        if (!get_diana_data(ktdexl, ktdexp, values, cvals, i - 1, kxelem, obs)
             || !oplot->timeOK(obs.obsTime))
         {
           oplot->removeObs();
         }
       } else {
-        if (!get_diana_data_level(ktdexl, ktdexp.get(), values.get(), cvals.get(),
+        if (!get_diana_data_level(ktdexl, ktdexp, values, cvals,
                 i - 1, kxelem, obs, oplot->getLevel())
             || !oplot->timeOK(obs.obsTime))
         {
@@ -380,16 +534,92 @@ bool ObsBufr::BUFRdecode(int* ibuff, int ilen, Format format)
       }
     } else if (format == FORMAT_VPROFPLOT) {
       //will return without reading more subsets, fix later
-      return !get_data_level(ktdexl, ktdexp.get(), values.get(), cvals.get(),
+      return !get_data_level(ktdexl, ktdexp, values, cvals,
           i - 1, kxelem, obsTime);
     } else if (format == FORMAT_STATIONINFO) {
-      get_station_info(ktdexl, ktdexp.get(), values.get(), cvals.get(), i - 1, kelem);
+      get_station_info(ktdexl, ktdexp, values, cvals, i - 1, kelem);
     }
   }
 
   return true;
 }
 
+void ObsBufr::decodeObs(const char* message, long length, int level, std::vector<ObsData>& obs)
+{
+  std::vector<int> ibuff;
+  copyMessage(message, length, ibuff);
+  int ilen = length;
+
+  BufrexArrays& arrays = threadBufrexArrays();
+  char* cnames = arrays.cnames.get();
+  char* cunits = arrays.cunits.get();
+  char* cvals = arrays.cvals.get();
+  double* values = arrays.values.get();
+
+  // element lists for all subsets, so that libemos can be released before conversion
+  int kxelem;
+  std::vector<int> subset_ktdexl, subset_offset, all_ktdexp;
+  {
+    std::lock_guard<std::mutex> lock(emosMutex);
+
+    int kerr;
+    int ksup[9];
+    int ksec0[3];
+    int ksec1[40];
+    int ksec2[4096];
+    int ksec3[4];
+    int ksec4[2];
+    bus012_(&ilen, &ibuff[0], ksup, ksec0, ksec1, ksec2, &kerr);
+    if (kerr > 0) {
+      METLIBS_LOG_ERROR("Error in BUS012: KERR=" << kerr);
+      return;
+    }
+
+    int kkvals = kvals;
+    kxelem = std::min(kvals / ksup[5], kelem);
+    bufrex_(&ilen, &ibuff[0], ksup, ksec0, ksec1, ksec2, ksec3, ksec4, &kxelem,
+        cnames, cunits, &kkvals, values, cvals, &kerr,
+        len_cnames, len_cunits, len_cvals);
+    if (kerr > 0) {
+      METLIBS_LOG_ERROR("Error in BUFREX: KERR=" << kerr);
+      return;
+    }
+
+    const int nsubset = ksup[5];
+    subset_ktdexl.resize(nsubset, -1);
+    subset_offset.resize(nsubset, 0);
+    int* ktdlst = arrays.ktdlst.get();
+    int* ktdexp = arrays.ktdexp.get();
+    for (int i = 1; i < nsubset + 1; i++) {
+      int ktdlen, ktdexl;
+      busel2_(&i, &kxelem, &ktdlen, ktdlst, &ktdexl, ktdexp, cnames, cunits, &kerr);
+      if (kerr > 0) {
+        METLIBS_LOG_ERROR("Error in BUSEL: KERR=" << kerr);
+        continue;
+      }
+      subset_ktdexl[i - 1] = ktdexl;
+      subset_offset[i - 1] = all_ktdexp.size();
+      all_ktdexp.insert(all_ktdexp.end(), ktdexp, ktdexp + ktdexl);
+    }
+  }
+
+  for (size_t i = 0; i < subset_ktdexl.size(); i++) {
+    const int ktdexl = subset_ktdexl[i];
+    if (ktdexl < 0)
+      continue;
+    int* ktdexp = all_ktdexp.data() + subset_offset[i];
+
+    ObsData d;
+    bool ok;
+    if (level < -1)
+      ok = get_diana_data(ktdexl, ktdexp, values, cvals, i, kxelem, d);
+    else
+      ok = get_diana_data_level(ktdexl, ktdexp, values, cvals, i, kxelem, d, level);
+    if (ok)
+      obs.push_back(std::move(d));
+  }
+}
+
 bool ObsBufr::get_diana_data(int ktdexl, int *ktdexp, double* values,
     const char* cvals, int subset, int kelem, ObsData &d)
 {
@@ -59,6 +59,9 @@ private:
       const char* cvals, int subset, int kelem, miutil::miTime time);
 
   bool init(const std::string& filename, Format format);
+  bool readMessages(const std::string& filename, Format format);
+  bool decodeObsFile(const std::string& filename, int level, std::vector<ObsData>& obs);
+  void decodeObs(const char* message, long length, int level, std::vector<ObsData>& obs);
 
   std::string cloudAmount(int i);
   std::string cloudHeight(int i);
@@ -0,0 +1,399 @@
+#include "diObsCache.h"
+
+#include "util/binary_io.h"
+#include "util/mapped_file.h"
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#define MILOGGER_CATEGORY "diana.ObsCache"
+#include <miLogger/miLogging.h>
+
+namespace {
+
+const char MAGIC[8] = { 'D', 'I', 'O', 'B', 'S', '0', '0', '1' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//! maximum number of observations kept in memory, summed over all files
+const size_t MAX_CACHED_OBS = 500000;
+
+//! cache files not used for this long are removed
+const time_t MAX_FILE_AGE = 2*24*3600;
+
+bool sameKey(const ObsCache::Key& a, const ObsCache::Key& b)
+{
+  return a.size == b.size && a.mtime == b.mtime
+      && a.filename == b.filename && a.variant == b.variant;
+}
+
+class StringTable {
+public:
+  uint32_t add(const std::string& s)
+    {
+      std::unordered_map<std::string, uint32_t>::const_iterator it = index_.find(s);
+      if (it != index_.end())
+        return it->second;
+      const uint32_t i = strings_.size();
+      index_.insert(std::make_pair(s, i));
+      strings_.push_back(s);
+      return i;
+    }
+
+  const std::vector<std::string>& strings() const
+    { return strings_; }
+
+private:
+  std::unordered_map<std::string, uint32_t> index_;
+  std::vector<std::string> strings_;
+};
+
+typedef diutil::BinaryWriter Writer;
+typedef diutil::BinaryReader Reader;
+
+// ========================================================================
+
+typedef std::vector<std::string> string_v;
+
+//! a list of strings for each observation, as offsets into one index column
+void writeListColumn(Writer& w, StringTable& st, const ObsData_v& obs, string_v ObsData::*member)
+{
+  std::vector<uint32_t> offsets(1, 0), strings;
+  for (size_t i = 0; i < obs.size(); ++i) {
+    const string_v& l = obs[i].*member;
+    for (size_t k = 0; k < l.size(); ++k)
+      strings.push_back(st.add(l[k]));
+    offsets.push_back(strings.size());
+  }
+  w.column(offsets);
+  w.u32(strings.size());
+  w.column(strings);
+}
+
+bool readListColumn(Reader& r, const string_v& st, ObsData_v& obs, string_v ObsData::*member)
+{
+  std::vector<uint32_t> offsets, strings;
+  uint32_t n;
+  if (!r.column(offsets, obs.size() + 1) || !r.u32(n) || !r.column(strings, n))
+    return false;
+  for (size_t i = 0; i < obs.size(); ++i) {
+    if (offsets[i] > offsets[i+1] || offsets[i+1] > n)
+      return false;
+    string_v& l = obs[i].*member;
+    for (uint32_t k = offsets[i]; k < offsets[i+1]; ++k) {
+      if (strings[k] >= st.size())
+        return false;
+      l.push_back(st[strings[k]]);
+    }
+  }
+  return true;
+}
+
+/*! one sparse column per map key, with the rows that have this key
+ *  and the values in these rows
+ */
+template<class M, class V, class ToColumn>
+void writeMapColumns(Writer& w, StringTable& st, const ObsData_v& obs, M ObsData::*member, ToColumn toColumn)
+{
+  std::vector<std::string> keys;
+  std::unordered_map<std::string, size_t> keyIndex;
+  std::vector< std::vector<uint32_t> > rows;
+  std::vector< std::vector<V> > values;
+  for (size_t i = 0; i < obs.size(); ++i) {
+    const M& m = obs[i].*member;
+    for (typename M::const_iterator it = m.begin(); it != m.end(); ++it) {
+      std::unordered_map<std::string, size_t>::const_iterator itK = keyIndex.find(it->first);
+      size_t k;
+      if (itK == keyIndex.end()) {
+        k = keys.size();
+        keyIndex.insert(std::make_pair(it->first, k));
+        keys.push_back(it->first);
+        rows.push_back(std::vector<uint32_t>());
+        values.push_back(std::vector<V>());
+      } else {
+        k = itK->second;
+      }
+      rows[k].push_back(i);
+      values[k].push_back(toColumn(it->second));
+    }
+  }
+
+  w.u32(keys.size());
+  for (size_t k = 0; k < keys.size(); ++k) {
+    w.u32(st.add(keys[k]));
+    w.u32(rows[k].size());
+    w.column(rows[k]);
+    w.column(values[k]);
+  }
+}
+
+template<class M, class V, class FromColumn>
+bool readMapColumns(Reader& r, const string_v& st, ObsData_v& obs, M ObsData::*member, FromColumn fromColumn)
+{
+  uint32_t nkeys;
+  if (!r.u32(nkeys))
+    return false;
+  std::vector<uint32_t> rows;
+  std::vector<V> values;
+  for (uint32_t k = 0; k < nkeys; ++k) {
+    uint32_t key, count;
+    if (!r.u32(key) || key >= st.size() || !r.u32(count)
+        || !r.column(rows, count) || !r.column(values, count))
+      return false;
+    for (uint32_t c = 0; c < count; ++c) {
+      if (rows[c] >= obs.size())
+        return false;
+      typename M::mapped_type v;
+      if (!fromColumn(values[c], v))
+        return false;
+      (obs[rows[c]].*member)[st[key]] = v;
+    }
+  }
+  return true;
+}
+
+float floatToColumn(float f)
+{
+  return f;
+}
+
+bool floatFromColumn(float c, float& f)
+{
+  f = c;
+  return true;
+}
+
+enum { FLAG_SHOW_TIME_ID = 1, FLAG_CAVOK = 2 };
+
+} // namespace
+
+// ========================================================================
+
+ObsCache::ObsCache()
+  : files_("obs-")
+  , cachedObs_(0)
+{
+}
+
+// static
+ObsCache& ObsCache::instance()
+{
+  static ObsCache cache;
+  return cache;
+}
+
+void ObsCache::setDirectory(const std::string& directory)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.setDirectory(directory, MAX_FILE_AGE);
+}
+
+// static
+bool ObsCache::makeKey(const std::string& filename, const std::string& variant, Key& key)
+{
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    return false;
+  key.filename = filename;
+  key.variant = variant;
+  key.size = st.st_size;
+  key.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  return true;
+}
+
+std::string ObsCache::cacheFile(const Key& key) const
+{
+  return files_.path(key.filename + '\n' + key.variant);
+}
+
+ObsData_cpv ObsCache::find(const Key& key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::list<Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it) {
+    if (sameKey(it->key, key)) {
+      entries_.splice(entries_.begin(), entries_, it);
+      return it->obs;
+    }
+  }
+
+  if (!files_.enabled())
+    return ObsData_cpv();
+
+  const std::string cf = cacheFile(key);
+  const diutil::MappedFile mapped(cf);
+  if (!mapped.data())
+    return ObsData_cpv();
+
+  std::shared_ptr<ObsData_v> obs = std::make_shared<ObsData_v>();
+  if (!read(mapped.data(), mapped.size(), key, *obs)) {
+    METLIBS_LOG_DEBUG("cache file '" << cf << "' is outdated or broken");
+    return ObsData_cpv();
+  }
+  METLIBS_LOG_DEBUG("read " << obs->size() << " observations for '" << key.filename << "' from cache");
+
+  // mark as used, see setDirectory
+  diutil::CacheDirectory::touch(cf);
+
+  Entry e = { key, obs };
+  entries_.push_front(e);
+  cachedObs_ += obs->size();
+  while (cachedObs_ > MAX_CACHED_OBS && entries_.size() > 1) {
+    cachedObs_ -= entries_.back().obs->size();
+    entries_.pop_back();
+  }
+  return obs;
+}
+
+void ObsCache::insert(const Key& key, ObsData_cpv obs)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::list<Entry>::iterator it = entries_.begin(); it != entries_.end(); ) {
+    if (it->key.filename == key.filename && it->key.variant == key.variant) {
+      cachedObs_ -= it->obs->size();
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  Entry e = { key, obs };
+  entries_.push_front(e);
+  cachedObs_ += obs->size();
+  while (cachedObs_ > MAX_CACHED_OBS && entries_.size() > 1) {
+    cachedObs_ -= entries_.back().obs->size();
+    entries_.pop_back();
+  }
+
+  if (files_.enabled())
+    diutil::CacheDirectory::write(cacheFile(key), write(key, *obs));
+}
+
+// static
+std::string ObsCache::write(const Key& key, const ObsData_v& obs)
+{
+  const size_t n = obs.size();
+  StringTable st;
+
+  std::vector<float> xpos(n), ypos(n);
+  std::vector<int32_t> date(n), clock(n);
+  std::vector<uint8_t> flags(n);
+  std::vector<uint32_t> id(n), name(n), metarId(n);
+  for (size_t i = 0; i < n; ++i) {
+    const ObsData& d = obs[i];
+    xpos[i] = d.xpos;
+    ypos[i] = d.ypos;
+    if (d.obsTime.undef()) {
+      date[i] = clock[i] = 0;
+    } else {
+      const miutil::miTime& t = d.obsTime;
+      date[i] = (t.year() * 100 + t.month()) * 100 + t.day();
+      clock[i] = (t.hour() * 100 + t.min()) * 100 + t.sec();
+    }
+    flags[i] = (d.show_time_id ? FLAG_SHOW_TIME_ID : 0) | (d.CAVOK ? FLAG_CAVOK : 0);
+    id[i] = st.add(d.id);
+    name[i] = st.add(d.name);
+    metarId[i] = st.add(d.metarId);
+  }
+
+  Writer columns;
+  columns.column(xpos);
+  columns.column(ypos);
+  columns.column(date);
+  columns.column(clock);
+  columns.column(flags);
+  columns.column(id);
+  columns.column(name);
+  columns.column(metarId);
+  writeListColumn(columns, st, obs, &ObsData::REww);
+  writeListColumn(columns, st, obs, &ObsData::ww);
+  writeListColumn(columns, st, obs, &ObsData::cloud);
+  writeMapColumns<ObsData::fdata_t, float>(columns, st, obs, &ObsData::fdata, floatToColumn);
+  writeMapColumns<ObsData::stringdata_t, uint32_t>(columns, st, obs, &ObsData::stringdata,
+      [&st](const std::string& s) { return st.add(s); });
+
+  Writer w;
+  w.put(MAGIC, sizeof(MAGIC));
+  w.u32(BYTE_ORDER_MARK);
+  w.str(key.filename);
+  w.str(key.variant);
+  w.i64(key.size);
+  w.i64(key.mtime);
+  const string_v& strings = st.strings();
+  w.u32(strings.size());
+  for (size_t i = 0; i < strings.size(); ++i)
+    w.str(strings[i]);
+  w.u32(n);
+  w.put(columns.buffer.data(), columns.buffer.size());
+  return w.buffer;
+}
+
+// static
+bool ObsCache::read(const char* data, size_t size, const Key& key, ObsData_v& obs)
+{
+  Reader r(data, size);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t byteOrder;
+  Key fileKey;
+  int64_t fsize, fmtime;
+  if (!r.get(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+      || !r.u32(byteOrder) || byteOrder != BYTE_ORDER_MARK
+      || !r.str(fileKey.filename) || !r.str(fileKey.variant)
+      || !r.i64(fsize) || !r.i64(fmtime))
+    return false;
+  fileKey.size = fsize;
+  fileKey.mtime = fmtime;
+  if (!sameKey(fileKey, key))
+    return false;
+
+  uint32_t nstrings;
+  if (!r.u32(nstrings))
+    return false;
+  string_v st;
+  for (uint32_t i = 0; i < nstrings; ++i) {
+    std::string s;
+    if (!r.str(s))
+      return false;
+    st.push_back(s);
+  }
+
+  uint32_t n;
+  std::vector<float> xpos, ypos;
+  std::vector<int32_t> date, clock;
+  std::vector<uint8_t> flags;
+  std::vector<uint32_t> id, name, metarId;
+  if (!r.u32(n) || !r.column(xpos, n) || !r.column(ypos, n)
+      || !r.column(date, n) || !r.column(clock, n) || !r.column(flags, n)
+      || !r.column(id, n) || !r.column(name, n) || !r.column(metarId, n))
+    return false;
+
+  obs.clear();
+  obs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    ObsData& d = obs[i];
+    d.xpos = xpos[i];
+    d.ypos = ypos[i];
+    if (date[i] != 0) {
+      d.obsTime = miutil::miTime(date[i] / 10000, (date[i] / 100) % 100, date[i] % 100,
+          clock[i] / 10000, (clock[i] / 100) % 100, clock[i] % 100);
+    }
+    d.show_time_id = (flags[i] & FLAG_SHOW_TIME_ID) != 0;
+    d.CAVOK = (flags[i] & FLAG_CAVOK) != 0;
+    if (id[i] >= st.size() || name[i] >= st.size() || metarId[i] >= st.size())
+      return false;
+    d.id = st[id[i]];
+    d.name = st[name[i]];
+    d.metarId = st[metarId[i]];
+  }
+
+  return readListColumn(r, st, obs, &ObsData::REww)
+      && readListColumn(r, st, obs, &ObsData::ww)
+      && readListColumn(r, st, obs, &ObsData::cloud)
+      && readMapColumns<ObsData::fdata_t, float>(r, st, obs, &ObsData::fdata, floatFromColumn)
+      && readMapColumns<ObsData::stringdata_t, uint32_t>(r, st, obs, &ObsData::stringdata,
+          [&st](uint32_t c, std::string& s) { if (c >= st.size()) return false; s = st[c]; return true; })
+      && r.atEnd();
+}
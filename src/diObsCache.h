@@ -0,0 +1,74 @@
+#ifndef DIOBSCACHE_H
+#define DIOBSCACHE_H
+
+#include "diObsData.h"
+#include "util/cache_directory.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef std::vector<ObsData> ObsData_v;
+typedef std::shared_ptr<const ObsData_v> ObsData_cpv;
+
+/**
+  \brief Cache of decoded observation files
+
+  Observations decoded from a file are kept in memory for the most
+  recently used files, and written to a binary file in the cache
+  directory, where other diana and bdiana processes may find them.
+
+  Entries are identified by file path, file size and modification time,
+  and a variant string for the decoding parameters (e.g. the level).
+ */
+class ObsCache {
+public:
+  struct Key {
+    std::string filename;
+    std::string variant;
+    long long size;
+    long long mtime;
+  };
+
+  static ObsCache& instance();
+
+  /*! Set the directory for the cache files, creating it if necessary.
+   *  Files not used for two days are removed. With an empty directory,
+   *  observations are only cached in memory.
+   */
+  void setDirectory(const std::string& directory);
+
+  //! make the key for a file, return false if the file cannot be found
+  static bool makeKey(const std::string& filename, const std::string& variant, Key& key);
+
+  //! find cached observations, or return null
+  ObsData_cpv find(const Key& key);
+
+  void insert(const Key& key, ObsData_cpv obs);
+
+  //! serialize observations in the binary format of the cache files
+  static std::string write(const Key& key, const ObsData_v& obs);
+
+  //! read observations in the binary format, return false if the data are broken or for a different key
+  static bool read(const char* data, size_t size, const Key& key, ObsData_v& obs);
+
+private:
+  ObsCache();
+
+  std::string cacheFile(const Key& key) const;
+
+private:
+  struct Entry {
+    Key key;
+    ObsData_cpv obs;
+  };
+
+  std::mutex mutex_;
+  diutil::CacheDirectory files_;
+  std::list<Entry> entries_; // most recently used first
+  size_t cachedObs_;
+};
+
+#endif // DIOBSCACHE_H
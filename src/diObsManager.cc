@@ -34,7 +34,9 @@
 #include "diObsManager.h"
 
 #include "diKVListPlotCommand.h"
+#include "diLocalSetupParser.h"
 #include "diObsAscii.h"
+#include "diObsCache.h"
 #include "diObsMetaData.h"
 #include "diObsPlot.h"
 #include "diPlotModule.h"
@@ -75,6 +77,42 @@ std::vector<std::string> split_on_comma(const std::string& txt, const char* comm
   boost::algorithm::split(s, txt, boost::algorithm::is_any_of(comma));
   return s;
 }
+
+typedef std::map<std::string, miutil::miTime> string_miTime_m;
+
+//! update the file list of a pattern; files added or changed since the last update are inserted into modified
+diutil::string_v watchPattern(ObsManager::patternInfo& pat, std::set<std::string>& modified)
+{
+  if (!pat.watch)
+    pat.watch = std::make_shared<diutil::FileWatch>(pat.pattern);
+  diutil::FileWatch::Changes changes;
+  pat.watch->update(&changes);
+  modified.insert(changes.added.begin(), changes.added.end());
+  modified.insert(changes.changed.begin(), changes.changed.end());
+  return pat.watch->fileNames();
+}
+
+//! times of files in the previous list, to avoid reading unchanged files again
+string_miTime_m fileTimes(const std::vector<ObsManager::FileInfo>& fileInfo)
+{
+  string_miTime_m times;
+  for (const ObsManager::FileInfo& fi : fileInfo)
+    times.insert(std::make_pair(fi.filename, fi.time));
+  return times;
+}
+
+//! find the time of an unchanged file from the previous list
+bool unchangedFileTime(const string_miTime_m& oldTimes, const std::set<std::string>& modified,
+    const std::string& filename, miutil::miTime& time)
+{
+  if (modified.count(filename))
+    return false;
+  const string_miTime_m::const_iterator it = oldTimes.find(filename);
+  if (it == oldTimes.end())
+    return false;
+  time = it->second;
+  return true;
+}
 } /* anonymous namespace */
 
 ObsManager::ObsManager()
@@ -444,10 +482,12 @@ bool ObsManager::updateTimes(std::string obsType)
   {
 #endif
     ProdInfo& pi = Prod[obsType];
-    for (std::vector<patternInfo>::const_iterator pit = pi.pattern.begin(); pit != pi.pattern.end(); ++pit) {
+    const string_miTime_m oldTimes = fileTimes(oldfileInfo);
+    for (std::vector<patternInfo>::iterator pit = pi.pattern.begin(); pit != pi.pattern.end(); ++pit) {
       if (pit->archive == useArchive) {
         bool ok = pit->filter.ok();
-        const diutil::string_v matches = diutil::glob(pit->pattern);
+        std::set<std::string> modified;
+        const diutil::string_v matches = watchPattern(*pit, modified);
         if (matches.empty())
           METLIBS_LOG_INFO("No files matches '" <<pit->pattern <<"'");
         for (diutil::string_v::const_iterator mit = matches.begin(); mit != matches.end(); ++mit) {
@@ -456,6 +496,8 @@ bool ObsManager::updateTimes(std::string obsType)
           finfo.filetype = pit->fileType;
           if (ok && pit->filter.getTime(finfo.filename, finfo.time)) {
             //time from file name
+          } else if (unchangedFileTime(oldTimes, modified, finfo.filename, finfo.time)) {
+            //time from previous update
           } else {
             //time not found from filename, open file
             if (finfo.filetype == "bufr") {
@@ -547,17 +589,20 @@ bool ObsManager::updateTimesfromFile(const std::string& obsType)
   } else
 #endif
   {
-    vector<std::string> fname;
-    for (std::vector<patternInfo>::const_iterator pit = pi.pattern.begin(); pit != pi.pattern.end(); ++pit) {
+    const string_miTime_m oldTimes = fileTimes(oldfileInfo);
+    for (std::vector<patternInfo>::iterator pit = pi.pattern.begin(); pit != pi.pattern.end(); ++pit) {
       if (pit->archive == useArchive) {
-        const diutil::string_v matches = diutil::glob(pit->pattern);
+        std::set<std::string> modified;
+        const diutil::string_v matches = watchPattern(*pit, modified);
         if (matches.empty())
           METLIBS_LOG_INFO("No files matches '" <<pit->pattern <<"'");
         for (diutil::string_v::const_iterator mit = matches.begin(); mit != matches.end(); ++mit) {
           FileInfo finfo;
           finfo.filename = *mit;
           finfo.filetype = pit->fileType;
-          if (pit->fileType == "bufr") {
+          if (unchangedFileTime(oldTimes, modified, finfo.filename, finfo.time)) {
+            //time from previous update
+          } else if (pit->fileType == "bufr") {
 #ifdef BUFROBS
             //read time from bufr-file
             ObsBufr bufr;
@@ -1375,6 +1420,11 @@ void ObsManager::printProdInfo(const ProdInfo & pinfo)
 bool ObsManager::parseSetup()
 {
   METLIBS_LOG_SCOPE();
+
+  const std::string& cachedir = LocalSetupParser::basicValue("cachedir");
+  if (!cachedir.empty())
+    ObsCache::instance().setDirectory(cachedir + "/obs");
+
   const std::string obs_name = "OBSERVATION_FILES";
   vector<std::string> sect_obs;
 
@@ -35,6 +35,7 @@
 #include "diPlot.h"
 #include "diPlotCommand.h"
 #include "diObsData.h"
+#include "util/file_watcher.h"
 
 #include <puTools/TimeFilter.h>
 
@@ -84,6 +85,7 @@ public:
     std::string pattern;
     bool archive;
     std::string fileType;  //bufr,miobs...
+    diutil::FileWatch_p watch; //files matching pattern, created when listing files
   };
 
   struct FileInfo {
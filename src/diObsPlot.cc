@@ -41,6 +41,7 @@
 #include "diKVListPlotCommand.h"
 #include "diUtilities.h"
 #include "miSetupParser.h"
+#include "util/format_int.h"
 #include "util/math_util.h"
 #include "util/qstring_util.h"
 
@@ -48,6 +49,7 @@
 #include <puTools/miStringFunctions.h>
 
 #include <QPolygonF>
+#include <QRectF>
 #include <QString>
 #include <QTextCodec>
 
@@ -87,6 +89,88 @@ public:
     : GlMatrixPushPop(gl)
     { gl->Translatef(translate.x(), translate.y(), 0); gl->Scalef(scale, scale, 1); }
 };
+
+//! factor for the station density while panning or zooming, see StaticPlot::isInteractive
+const float INTERACTIVE_DENSITY = 0.5;
+
+//! kinds of symbols for DiGLPainter::drawSymbol
+enum SymbolKind {
+  SYMBOL_CLOUD_COVER = 1,
+  SYMBOL_SYNOP_TABLE,
+  SYMBOL_METAR_TABLE
+};
+
+/*! Symbol number for DiGLPainter::drawSymbol, with kind in the upper
+ *  bits, then size in 1/16 units and value; returns 0 if the size or
+ *  value do not fit.
+ */
+quint32 symbolNumber(SymbolKind kind, float size, int value)
+{
+  const int isize = int(size * 16 + 0.5);
+  if (isize < 0 || isize >= (1 << 12) || value < 0 || value >= (1 << 16))
+    return 0;
+  return (quint32(kind) << 28) | (quint32(isize) << 16) | quint32(value);
+}
+
+void drawCloudCover(DiGLPainter* gl, int N, float radius)
+{
+  int i;
+  float x, y;
+
+  // Total cloud cover N
+
+  if (N < 0 || N > 9) { //cloud cover not observed
+    x = radius * 1.1 / sqrt((float) 2);
+    gl->drawCross(0, 0, x, true);
+  } else if (N == 9) {
+    x = radius / sqrt((float) 2);
+    gl->drawCross(0, 0, x, true);
+  } else if (N == 7) {
+    // qpainter.drawChord(radius, -72*16, 144*16);
+    gl->PolygonMode(DiGLPainter::gl_FRONT_AND_BACK, DiGLPainter::gl_FILL);
+    gl->Begin(DiGLPainter::gl_POLYGON);
+    for (i = 5; i < 46; i++) {
+      x = radius * cos(i * 2 * M_PI / 100.0);
+      y = radius * sin(i * 2 * M_PI / 100.0);
+      gl->Vertex2f(y, x);
+    }
+    i = 5;
+    x = radius * cos(i * 2 * M_PI / 100.0);
+    y = radius * sin(i * 2 * M_PI / 100.0);
+    gl->Vertex2f(y, x);
+    gl->End();
+    // qpainter.drawChord(radius, 108*16, 144*16);
+    gl->Begin(DiGLPainter::gl_POLYGON);
+    for (i = 55; i < 96; i++) {
+      x = radius * cos(i * 2 * M_PI / 100.0);
+      y = radius * sin(i * 2 * M_PI / 100.0);
+      gl->Vertex2f(y, x);
+    }
+    i = 55;
+    x = radius * cos(i * 2 * M_PI / 100.0);
+    y = radius * sin(i * 2 * M_PI / 100.0);
+    gl->Vertex2f(y, x);
+    gl->End();
+  } else {
+    if (N == 1 || N == 3) {
+      gl->drawLine(0, radius, 0, -radius);
+    } else if (N == 5) {
+      gl->drawLine(8, 0, -8, 0);
+    }
+    // qpainter.drawPie(radius, -90*16, N*45*16);
+    gl->PolygonMode(DiGLPainter::gl_FRONT_AND_BACK, DiGLPainter::gl_FILL);
+    gl->Begin(DiGLPainter::gl_POLYGON);
+    gl->Vertex2f(0, 0);
+    for (i = 0; i < 101 * (N / 2) / 4.0; i++) {
+      x = radius * cos(i * 2 * M_PI / 100.0);
+      y = radius * sin(i * 2 * M_PI / 100.0);
+      gl->Vertex2f(y, x);
+    }
+    gl->Vertex2f(0, 0);
+    gl->End();
+  }
+}
+
 } // namespace /*anonymous*/
 
 void ObsPlotCollider::clear()
@@ -504,6 +588,15 @@ ObsData& ObsPlot::getNextObs()
   return obsp.back();
 }
 
+void ObsPlot::addObs(std::vector<ObsData>& obs)
+{
+  for (size_t i = 0; i < obs.size(); ++i) {
+    obsp.push_back(std::move(obs[i]));
+    obsp.back().dataType = currentDatatype;
+  }
+  obs.clear();
+}
+
 void ObsPlot::mergeMetaData(const std::map<std::string, ObsData>& metaData)
 {
   //METLIBS_LOG_DEBUG(__FUNCTION__<<" : "<<obsp.size()<<" : "<<metaData.size());
@@ -1597,24 +1690,26 @@ void ObsPlot::plot(DiGLPainter* gl, PlotOrder zorder)
 
   int num = calcNum();
   float xdist = 0, ydist = 0;
+  // fewer stations while panning or zooming with slow frames
+  const float plotDensity = getStaticPlot()->isInteractive() ? density * INTERACTIVE_DENSITY : density;
   // I think we should plot roadobs like synop here
   // OBS!******************************************
 
   if (isSynopMetarRoad()) {
-    xdist = 100 * scale / density;
-    ydist = 90 * scale / density;
+    xdist = 100 * scale / plotDensity;
+    ydist = 90 * scale / plotDensity;
   } else if (plottype() == OPT_LIST || plottype() == OPT_ASCII) {
     if (num > 0) {
       if (vertical_orientation) {
-        xdist = 58 * scale / density;
-        ydist = 18 * (num + 0.2) * scale / density;
+        xdist = 58 * scale / plotDensity;
+        ydist = 18 * (num + 0.2) * scale / plotDensity;
       } else {
-        xdist = 50 * num * scale / density;
-        ydist = 10 * scale / density;
+        xdist = 50 * num * scale / plotDensity;
+        ydist = 10 * scale / plotDensity;
       }
     } else {
-      xdist = 14 * scale / density;
-      ydist = 14 * scale / density;
+      xdist = 14 * scale / plotDensity;
+      ydist = 14 * scale / plotDensity;
     }
   }
 
@@ -3192,83 +3287,68 @@ void ObsPlot::initMetarMap()
   lwwg2[31] = 7;
 }
 
+namespace {
+//! same as std::ostream with width and fill '0'
+std::string zeroPadded(int value, size_t width)
+{
+  std::string s = miutil::from_number(value);
+  if (s.size() < width)
+    s.insert(0, width - s.size(), '0');
+  return s;
+}
+} // namespace
+
 void ObsPlot::printNumber(DiGLPainter* gl, float f, QPointF xy, const std::string& align,
     bool line, bool mark)
 {
   float x = xy.x() * scale;
   float y = xy.y() * scale;
 
-  ostringstream cs;
-
+  std::string str;
   if (align == "temp") {
-    cs.setf(ios::fixed);
-    if (tempPrecision) {
-      f = diutil::float2int(f);
-      cs.precision(0);
-    } else {
-      cs.precision(1);
-    }
-    cs << f;
+    if (tempPrecision)
+      str = diutil::format_fixed(diutil::float2int(f), 0);
+    else
+      str = diutil::format_fixed(f, 1);
     float w, h;
-    gl->getTextSize(cs.str(), w, h);
+    gl->getTextSize(str, w, h);
     x -= w - 30 * scale;
   }
 
   else if (align == "center") {
     float w, h;
-    cs << f;
-    gl->getTextSize(cs.str(), w, h);
+    str = diutil::format_general(f);
+    gl->getTextSize(str, w, h);
     x -= w / 2;
   }
 
   else if (align == "PPPP") {
-    cs.width(3);
-    cs.fill('0');
-    f = (int(f * 10 + 0.5)) % 1000;
-    cs << f;
+    str = zeroPadded((int(f * 10 + 0.5)) % 1000, 3);
   } else if (align == "float_1") {
-    cs.setf(ios::fixed);
-    cs.precision(1);
-    cs << f;
+    str = diutil::format_fixed(f, 1);
     float w, h;
-    gl->getTextSize(cs.str(), w, h);
+    gl->getTextSize(str, w, h);
     x -= w - 30 * scale;
   } else if (align == "fill_2") {
-    int i = diutil::float2int(f);
-    cs.width(2);
-    cs.fill('0');
-    cs << i;
+    str = zeroPadded(diutil::float2int(f), 2);
   } else if (align == "fill_1") {
-    int i = diutil::float2int(f);
-    cs.width(1);
-    cs.fill('0');
-    cs << i;
+    str = zeroPadded(diutil::float2int(f), 1);
   } else if (align == "ppp") {
-    if (f > 0)
-      cs << '+';
-    else
-      cs << '-';
+    str = (f > 0) ? "+" : "-";
     if (fabsf(f) < 1)
-      cs << '0';
-    cs << fabsf(f) * 10;
+      str += '0';
+    str += diutil::format_general(fabsf(f) * 10);
   } else if (align == "RRR") {
-    cs.setf(ios::fixed);
-    cs.setf(ios::showpoint);
-    if (f < 1) {
-      cs.precision(1);
-    } else {
-      cs.precision(0);
-    }
-    cs << f;
+    // showpoint, i.e. "12." for precision 0
+    if (f < 1)
+      str = diutil::format_fixed(f, 1);
+    else
+      str = diutil::format_fixed(f, 0) + '.';
   } else if (align == "PPPP_mslp") {
-    cs.setf(ios::fixed);
-    cs.precision(1);
-    cs.setf(ios::showpos);
-    cs << f;
+    str = diutil::format_fixed(f, 1, true);
   } else
-    cs << f;
+    str = diutil::format_general(f);
 
-  const std::string str = cs.str();
   float cw, ch;
   if (mark || line)
     gl->getTextSize(str, cw, ch);
@@ -3731,6 +3811,7 @@ void ObsPlot::symbol(DiGLPainter* gl, int n, QPointF xypos, float scale, bool al
   const int k1 = n + 10;
   const int k2 = k1 + nstep * npos;
 
+  QList<QPolygonF> lines;
   QPolygonF line;
   QPointF xy = xytab(n + 4);
   line << xy;
@@ -3742,7 +3823,7 @@ void ObsPlot::symbol(DiGLPainter* gl, int n, QPointF xypos, float scale, bool al
     if (std::abs(dxy.x()) < 100) {
       xy += dxy;
     } else {
-      gl->drawPolyline(line);
+      lines << line;
       line.clear();
 
       dxy.rx() = std::fmod(dxy.x(), 100);
@@ -3752,68 +3833,40 @@ void ObsPlot::symbol(DiGLPainter* gl, int n, QPointF xypos, float scale, bool al
   }
 
   if (line.count() >= 2)
-    gl->drawPolyline(line);
+    lines << line;
+
+  const auto drawLines = [&lines](DiGLPainter* g) {
+    for (const QPolygonF& l : lines)
+      g->drawPolyline(l);
+  };
+
+  // the scale is part of the transformation, the symbol only depends on n and the table
+  const quint32 sn = symbolNumber(iptab == &iptabMetar ? SYMBOL_METAR_TABLE : SYMBOL_SYNOP_TABLE, 0, n);
+  if (sn == 0) {
+    drawLines(gl);
+    return;
+  }
+  QRectF bounds;
+  for (const QPolygonF& l : lines)
+    bounds |= l.boundingRect();
+  gl->drawSymbol(sn, bounds, drawLines);
 }
 
 void ObsPlot::cloudCover(DiGLPainter* gl, const float& fN, const float &radius)
 {
   int N = diutil::float2int(fN);
-
-  int i;
-  float x, y;
-
-  // Total cloud cover N
-
-  if (N < 0 || N > 9) { //cloud cover not observed
-    x = radius * 1.1 / sqrt((float) 2);
-    gl->drawCross(0, 0, x, true);
-  } else if (N == 9) {
-    x = radius / sqrt((float) 2);
-    gl->drawCross(0, 0, x, true);
-  } else if (N == 7) {
-    // qpainter.drawChord(radius, -72*16, 144*16);
-    gl->PolygonMode(DiGLPainter::gl_FRONT_AND_BACK, DiGLPainter::gl_FILL);
-    gl->Begin(DiGLPainter::gl_POLYGON);
-    for (i = 5; i < 46; i++) {
-      x = radius * cos(i * 2 * M_PI / 100.0);
-      y = radius * sin(i * 2 * M_PI / 100.0);
-      gl->Vertex2f(y, x);
-    }
-    i = 5;
-    x = radius * cos(i * 2 * M_PI / 100.0);
-    y = radius * sin(i * 2 * M_PI / 100.0);
-    gl->Vertex2f(y, x);
-    gl->End();
-    // qpainter.drawChord(radius, 108*16, 144*16);
-    gl->Begin(DiGLPainter::gl_POLYGON);
-    for (i = 55; i < 96; i++) {
-      x = radius * cos(i * 2 * M_PI / 100.0);
-      y = radius * sin(i * 2 * M_PI / 100.0);
-      gl->Vertex2f(y, x);
-    }
-    i = 55;
-    x = radius * cos(i * 2 * M_PI / 100.0);
-    y = radius * sin(i * 2 * M_PI / 100.0);
-    gl->Vertex2f(y, x);
-    gl->End();
-  } else {
-    if (N == 1 || N == 3) {
-      gl->drawLine(0, radius, 0, -radius);
-    } else if (N == 5) {
-      gl->drawLine(8, 0, -8, 0);
-    }
-    // qpainter.drawPie(radius, -90*16, N*45*16);
-    gl->PolygonMode(DiGLPainter::gl_FRONT_AND_BACK, DiGLPainter::gl_FILL);
-    gl->Begin(DiGLPainter::gl_POLYGON);
-    gl->Vertex2f(0, 0);
-    for (i = 0; i < 101 * (N / 2) / 4.0; i++) {
-      x = radius * cos(i * 2 * M_PI / 100.0);
-      y = radius * sin(i * 2 * M_PI / 100.0);
-      gl->Vertex2f(y, x);
-    }
-    gl->Vertex2f(0, 0);
-    gl->End();
+  if (N < 0 || N > 9)
+    N = 10; // not observed, all drawn the same
+
+  // the line for N=5 is longer than the radius
+  const float r = std::max(radius, 8.0f);
+  const quint32 sn = symbolNumber(SYMBOL_CLOUD_COVER, radius, N);
+  if (sn == 0) {
+    drawCloudCover(gl, N, radius);
+    return;
   }
+  gl->drawSymbol(sn, QRectF(-r, -r, 2 * r, 2 * r),
+      [N, radius](DiGLPainter* g) { drawCloudCover(g, N, radius); });
 }
 
 void ObsPlot::cloudCoverAuto(DiGLPainter* gl, const float& fN, const float &radius)
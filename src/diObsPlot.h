@@ -488,6 +488,9 @@ public:
 
   ObsData& getNextObs(); // BUFR only
 
+  //! append observations in the given order, leaving obs empty; BUFR only
+  void addObs(std::vector<ObsData>& obs);
+
   void resetObs(int num) // BUFR only, called from ObsManager
     { obsp.resize(num); }
 
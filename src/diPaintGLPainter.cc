@@ -50,6 +50,9 @@ namespace {
 
 const int TEXTURE_CACHE_SIZE = 16;
 
+//! text runs are forgotten when there are more than this
+const int MAX_TEXT_RUNS = 20000;
+
 } // namespace
 
 DiPaintGLCanvas::DiPaintGLCanvas(QPaintDevice* device)
@@ -57,6 +60,7 @@ DiPaintGLCanvas::DiPaintGLCanvas(QPaintDevice* device)
   , mFont(QFont(), mDevice)
   , mFontScaleX(1)
   , mFontScaleY(1)
+  , mFontId(-1)
 {
   METLIBS_LOG_SCOPE();
 }
@@ -85,6 +89,7 @@ bool DiPaintGLCanvas::setFont(const std::string& name)
 
   mFont.setFamily(it.value());
   mFont.setStyleStrategy(QFont::NoFontMerging);
+  fontChanged();
   return true;
 }
 
@@ -95,12 +100,14 @@ bool DiPaintGLCanvas::setFontFace(FontFace face)
   else
     mFont.setWeight(QFont::Normal);
   mFont.setItalic((face & 2) != 0);
+  fontChanged();
   return true;
 }
 
 bool DiPaintGLCanvas::setFontSize(const float size)
 {
   mFont.setPointSizeF(size);
+  fontChanged();
   return true;
 }
 
@@ -135,8 +142,7 @@ bool DiPaintGLCanvas::getTextRect(const QString& str, float& x, float& y, float&
     x = y = w = h = 0;
     return false;
   }
-  QFontMetricsF fm(mFont, mDevice);
-  QRectF rect = fm.tightBoundingRect(str);
+  const QRectF& rect = textRun(str).bounds;
   x = rect.x() * mFontScaleX;
   y = -rect.bottom() * mFontScaleY;
   w = rect.width() * mFontScaleX;
@@ -147,6 +153,45 @@ bool DiPaintGLCanvas::getTextRect(const QString& str, float& x, float& y, float&
   return true;
 }
 
+void DiPaintGLCanvas::updateFontId()
+{
+  if (mFontId >= 0)
+    return;
+
+  const QString key = mFont.key();
+  QHash<QString, int>::const_iterator it = mFontIds.constFind(key);
+  if (it != mFontIds.constEnd()) {
+    mFontId = it.value();
+  } else {
+    mFontId = mFontIds.size();
+    mFontIds.insert(key, mFontId);
+  }
+  mFontMetrics.reset(new QFontMetricsF(mFont, mDevice));
+}
+
+DiPaintGLCanvas::TextRun& DiPaintGLCanvas::textRun(const QString& str)
+{
+  updateFontId();
+  const TextKey key(mFontId, str);
+  QHash<TextKey, TextRun>::iterator it = mTextRuns.find(key);
+  if (it != mTextRuns.end())
+    return it.value();
+
+  if (mTextRuns.size() >= MAX_TEXT_RUNS)
+    mTextRuns.clear();
+  TextRun& run = mTextRuns[key];
+  run.bounds = mFontMetrics->tightBoundingRect(str);
+  run.text.setText(str);
+  run.text.setTextFormat(Qt::PlainText);
+  return run;
+}
+
+qreal DiPaintGLCanvas::fontAscent()
+{
+  updateFontId();
+  return mFontMetrics->ascent();
+}
+
 QImage DiPaintGLCanvas::convertToGLFormat(const QImage& i)
 {
   return i.transformed(QTransform().scale(1, -1)).rgbSwapped();
@@ -351,8 +396,8 @@ void DiPaintGLPainter::renderPrimitive()
   if (points.size() == 0)
     return;
 
-  static QPointF poly[4];
-  static QRgb color[4];
+  QPointF poly[4];
+  QRgb color[4];
 
   switch (mode) {
   case gl_POINTS:
@@ -1486,6 +1531,71 @@ void DiPaintGLPainter::drawPolygons(const QList<QPolygonF>& polygons)
   unsetClipPath();
 }
 
+void DiPaintGLPainter::drawWindArrow(float u, float v, float x, float y,
+    float arrowSize, bool withArrowHead, int turnBarbs)
+{
+  const WindArrowGlyphs::Glyph* glyph = 0;
+  if (canDrawPixelImages()) {
+    // map y is up; if pixel y is down, the arrow is flipped like in vcross
+    const float yFactor = (transform.m22() < 0) ? 1 : -1;
+    glyph = windGlyphs.glyph(u, v, arrowSize * std::abs(transform.m11()), withArrowHead, turnBarbs, yFactor,
+        attributes.color, attributes.width, attributes.antialiasing);
+  }
+  if (!glyph) {
+    DiGLPainter::drawWindArrow(u, v, x, y, arrowSize, withArrowHead, turnBarbs);
+    return;
+  }
+  if (glyph->image.isNull())
+    return;
+
+  const QPointF p = transform.map(QPointF(x, y));
+  painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+  setClipPath();
+  painter->drawImage(QPoint(qRound(p.x()) - glyph->offset.x(), qRound(p.y()) - glyph->offset.y()), glyph->image);
+  unsetClipPath();
+}
+
+bool DiPaintGLPainter::canDrawPixelImages() const
+{
+  // images are rendered in pixels, without rotation and with the same scale in x and y
+  const float sx = std::abs(transform.m11()), sy = std::abs(transform.m22());
+  return !isPrinting() && !attributes.lineStipple && colorMask
+      && transform.m12() == 0 && transform.m21() == 0 && std::abs(sx - sy) <= 0.01 * sx;
+}
+
+void DiPaintGLPainter::drawSymbol(quint32 symbol, const QRectF& bounds, const SymbolDrawer& draw)
+{
+  const SymbolSprites::Sprite* sprite = 0;
+  if (canDrawPixelImages()) {
+    DiPaintGLCanvas* c = static_cast<DiPaintGLCanvas*>(canvas());
+    const PaintAttributes& style = attributes;
+    sprite = symbolSprites.sprite(symbol, bounds, std::abs(transform.m11()), transform.m22() < 0,
+        attributes.color, attributes.width, attributes.antialiasing,
+        [c, &style, &draw](QPainter& painter, const QTransform& toPixels) {
+          // replay the primitives with a second painter on the sprite image
+          DiPaintGLPainter sp(c);
+          sp.clear = false;
+          sp.begin(&painter);
+          sp.attributes = style;
+          sp.transform = toPixels;
+          sp.blend = true;
+          sp.blendMode = QPainter::CompositionMode_SourceOver;
+          draw(&sp);
+          sp.end();
+        });
+  }
+  if (!sprite) {
+    DiGLPainter::drawSymbol(symbol, bounds, draw);
+    return;
+  }
+
+  const QPointF p = transform.map(QPointF(0, 0));
+  painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+  setClipPath();
+  painter->drawImage(QPoint(qRound(p.x()) - sprite->offset.x(), qRound(p.y()) - sprite->offset.y()), sprite->image);
+  unsetClipPath();
+}
+
 void DiPaintGLPainter::drawScreenImage(const QPointF& point, const QImage& image)
 {
   PolygonMode(gl_FRONT_AND_BACK, gl_FILL);
@@ -1514,7 +1624,6 @@ bool DiPaintGLPainter::drawText(const QString& str,
   DiPaintGLCanvas* c = (DiPaintGLCanvas*)canvas();
   const QFont& font = c->font();
   this->painter->setFont(font);
-  QFontMetricsF fm = painter->fontMetrics();
 
   // No need to record this transformation.
   this->painter->setTransform(this->transform);
@@ -1525,7 +1634,13 @@ bool DiPaintGLPainter::drawText(const QString& str,
   this->painter->scale(c->fontScaleX(), c->fontScaleY());
   // Flip it vertically to take coordinate system differences into account.
   this->painter->setTransform(QTransform(1, 0, 0, 0, -1, 0, 0, 0, 1), true);
-  this->painter->drawText(0, 0, str);
+  if (!c->isPrinting() && !str.contains(QLatin1Char('\n'))) {
+    // the glyph layout is reused as long as only the text position changes;
+    // static text is positioned by its top left corner, not the baseline
+    this->painter->drawStaticText(QPointF(0, -c->fontAscent()), c->textRun(str).text);
+  } else {
+    this->painter->drawText(0, 0, str);
+  }
   this->painter->restore();
   return true;
 }
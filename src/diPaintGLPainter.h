@@ -2,6 +2,8 @@
 #define PAINTGLPAINTER_H
 
 #include "diGLPainter.h"
+#include "diSymbolSprites.h"
+#include "diWindArrowGlyphs.h"
 
 #include <QColor>
 #include <QHash>
@@ -11,11 +13,13 @@
 #include <QPen>
 #include <QPointF>
 #include <QStack>
+#include <QStaticText>
 #include <QTransform>
 #include <QVector>
 #include <QWidget>
 
 #include <map>
+#include <memory>
 #include <set>
 
 class QPaintDevice;
@@ -98,8 +102,25 @@ public:
   void setPrinting(bool printing=true)
     { mPrinting = printing; }
 
+  //! metrics and glyph layout of a string in the current font
+  struct TextRun {
+    QRectF bounds; //!< tight bounding rectangle, in device pixels
+    QStaticText text;
+  };
+
+  /*! Cached metrics and layout for a string in the current font. The
+   *  reference is valid until the next call.
+   */
+  TextRun& textRun(const QString& str);
+
+  //! ascent of the current font, in device pixels
+  qreal fontAscent();
+
 private:
   bool setFontFace(FontFace face);
+  void fontChanged()
+    { mFontId = -1; }
+  void updateFontId();
 
   void defineFont(const std::string& fontfam, const std::string& fontfilename,
       const std::string& face, bool use_bitmap) override;
@@ -110,6 +131,13 @@ private:
 
   float mFontScaleX, mFontScaleY;
   QHash<QString,QString> fontMap;
+
+  int mFontId; //!< index in mFontIds for mFont, or -1 if not known
+  QHash<QString, int> mFontIds; //!< by QFont::key
+  std::unique_ptr<QFontMetricsF> mFontMetrics; //!< for mFont
+
+  typedef QPair<int, QString> TextKey;
+  QHash<TextKey, TextRun> mTextRuns;
 };
 
 class DiPaintGLPainter : public DiGLPainter
@@ -206,8 +234,12 @@ public:
   void drawPolyline(const QPolygonF& points) override;
   void drawPolygon(const QPolygonF& points) override;
   void drawPolygons(const QList<QPolygonF>& polygons) override;
+  void drawWindArrow(float u, float v, float x, float y,
+      float arrowSize, bool withArrowHead, int turnBarbs=1) override;
   // end DiPainter interface
 
+  void drawSymbol(quint32 symbol, const QRectF& bounds, const SymbolDrawer& draw) override;
+
   void drawScreenImage(const QPointF& point, const QImage& image) override;
 
   void begin(QPainter *painter);
@@ -269,7 +301,13 @@ public:
   QRect viewport;
   QRectF window;
 
+  WindArrowGlyphs windGlyphs;
+  SymbolSprites symbolSprites;
+
 private:
+  //! true if images in pixels can be drawn instead of primitives
+  bool canDrawPixelImages() const;
+
   void plotSubdivided(const QPointF quad[], const QRgb color[], int divisions = 0);
   void setPen();
   void setPolygonColor(const QRgb &color);
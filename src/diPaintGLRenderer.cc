@@ -0,0 +1,121 @@
+#include "diPaintGLRenderer.h"
+
+#include "diPaintable.h"
+#include "diPaintGLPainter.h"
+
+#include <QPainter>
+
+#define MILOGGER_CATEGORY "diana.DiPaintGLRenderer"
+#include <miLogger/miLogging.h>
+
+DiPaintGLRenderer::DiPaintGLRenderer(DiPaintable* paintable, DiPaintGLCanvas* canvas, QObject* parent)
+  : QObject(parent)
+  , paintable_(paintable)
+  , painter_(new DiPaintGLPainter(canvas))
+  , antialiasing_(false)
+  , pending_(false)
+  , stop_(false)
+  , serial_(0)
+  , cancelled_(false)
+  , busy_(false)
+{
+  painter_->ShadeModel(DiGLPainter::gl_FLAT);
+  painter_->HIGH_QUALITY_BUT_SLOW = false;
+  painter_->setCancelFlag(&cancelled_);
+
+  connect(this, SIGNAL(painted(const QImage&, bool, int)),
+      this, SLOT(deliver(const QImage&, bool, int)), Qt::QueuedConnection);
+
+  thread_ = std::thread(&DiPaintGLRenderer::run, this);
+}
+
+DiPaintGLRenderer::~DiPaintGLRenderer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    cancelled_ = true;
+  }
+  wakeup_.notify_one();
+  thread_.join();
+}
+
+void DiPaintGLRenderer::request(const QSize& size, bool antialiasing)
+{
+  METLIBS_LOG_SCOPE(LOGVAL(size.width()) << LOGVAL(size.height()));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_ = size;
+    antialiasing_ = antialiasing;
+    pending_ = true;
+    serial_ += 1;
+    cancelled_ = true;
+  }
+  busy_ = true;
+  wakeup_.notify_one();
+}
+
+void DiPaintGLRenderer::cancel()
+{
+  cancelled_ = true;
+}
+
+void DiPaintGLRenderer::discard()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = false;
+    serial_ += 1;
+    cancelled_ = true;
+  }
+  busy_ = false;
+}
+
+void DiPaintGLRenderer::deliver(const QImage& image, bool complete, int serial)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (serial != serial_)
+      return; // replaced by a newer request, or discarded
+  }
+  busy_ = false;
+  Q_EMIT frameReady(image, complete);
+}
+
+void DiPaintGLRenderer::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wakeup_.wait(lock, [this]() { return stop_ || pending_; });
+    if (stop_)
+      break;
+
+    const QSize size = size_;
+    const bool antialiasing = antialiasing_;
+    const int serial = serial_;
+    pending_ = false;
+    cancelled_ = false;
+    lock.unlock();
+
+    QImage image(size, QImage::Format_ARGB32);
+    paint(image, antialiasing);
+    const bool complete = !cancelled_;
+    METLIBS_LOG_DEBUG(LOGVAL(serial) << LOGVAL(complete));
+    Q_EMIT painted(image, complete, serial);
+
+    lock.lock();
+  }
+}
+
+void DiPaintGLRenderer::paint(QImage& image, bool antialiasing)
+{
+  METLIBS_LOG_TIME();
+  QPainter ipainter(&image);
+  ipainter.setRenderHint(QPainter::Antialiasing, antialiasing);
+  painter_->Viewport(0, 0, image.width(), image.height());
+  painter_->clear = true;
+  painter_->begin(&ipainter);
+  paintable_->paintUnderlay(painter_.get());
+  painter_->end();
+  ipainter.end();
+}
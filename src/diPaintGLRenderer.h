@@ -0,0 +1,86 @@
+#ifndef DIPAINTGLRENDERER_H
+#define DIPAINTGLRENDERER_H 1
+
+#include <QImage>
+#include <QObject>
+#include <QSize>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class DiPaintable;
+class DiPaintGLCanvas;
+class DiPaintGLPainter;
+
+/*! Paints the underlay of a DiPaintable into an off-screen image, in a
+ *  thread of its own.
+ *
+ * A new request cancels the frame being painted, which then stops at the
+ * next check of DiPainter::isCancelled(). Finished frames are sent with
+ * frameReady() to the thread owning the renderer; frames for requests
+ * that have been replaced by newer ones are dropped.
+ *
+ * The paintable must lock its data in paintUnderlay(), and cancel the
+ * renderer before changing them, see Controller::lockPlots().
+ */
+class DiPaintGLRenderer : public QObject
+{
+  Q_OBJECT
+
+public:
+  DiPaintGLRenderer(DiPaintable* paintable, DiPaintGLCanvas* canvas, QObject* parent = 0);
+  ~DiPaintGLRenderer();
+
+  //! paint a new frame, cancelling the current one
+  void request(const QSize& size, bool antialiasing);
+
+  /*! Ask the current frame to stop as soon as possible, without waiting.
+   *  The frame is then sent as incomplete. May be called from any thread.
+   */
+  void cancel();
+
+  //! cancel the current frame and do not send it
+  void discard();
+
+  //! true from request() until the frame is sent, or discard()
+  bool isBusy() const
+    { return busy_; }
+
+Q_SIGNALS:
+  /*! A requested frame has been painted. If complete is false, painting
+   *  was cancelled and the image is not fully painted.
+   */
+  void frameReady(const QImage& image, bool complete);
+
+  //! internal, sent from the render thread
+  void painted(const QImage& image, bool complete, int serial);
+
+private Q_SLOTS:
+  void deliver(const QImage& image, bool complete, int serial);
+
+private:
+  void run();
+  void paint(QImage& image, bool antialiasing);
+
+private:
+  DiPaintable* paintable_;
+  std::unique_ptr<DiPaintGLPainter> painter_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  QSize size_;
+  bool antialiasing_;
+  bool pending_;
+  bool stop_;
+  int serial_; //!< number of the latest request, increased by discard()
+  std::atomic<bool> cancelled_;
+
+  bool busy_; //!< only used in the owning thread
+
+  std::thread thread_;
+};
+
+#endif // DIPAINTGLRENDERER_H
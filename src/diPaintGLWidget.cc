@@ -2,7 +2,9 @@
 #include "diPaintGLWidget.h"
 
 #include "diPaintable.h"
+#include "diPaintGLRenderer.h"
 
+#include <QPointer>
 #include <QtGui>
 
 #define MILOGGER_CATEGORY "diana.DiPaintGLWidget"
@@ -15,6 +17,7 @@ DiPaintGLWidget::DiPaintGLWidget(DiPaintable* p, QWidget *parent, bool aa)
   , paintable(p)
   , background_buffer(0)
   , antialiasing(aa)
+  , frame_arrived(false)
 {
   setFocusPolicy(Qt::StrongFocus);
   glpainter->ShadeModel(DiGLPainter::gl_FLAT);
@@ -24,6 +27,7 @@ DiPaintGLWidget::DiPaintGLWidget(DiPaintable* p, QWidget *parent, bool aa)
 
 DiPaintGLWidget::~DiPaintGLWidget()
 {
+  renderer.reset();
   delete background_buffer;
 }
 
@@ -71,6 +75,9 @@ void DiPaintGLWidget::mousePressEvent(QMouseEvent* me)
 
 void DiPaintGLWidget::mouseMoveEvent(QMouseEvent* me)
 {
+  // hovering would cancel the frame being painted, see paintUnderlayInThread
+  if (renderer && renderer->isBusy() && me->buttons() == Qt::NoButton)
+    return;
   if (paintable && paintable->handleMouseEvents(me))
     update();
 }
@@ -99,6 +106,21 @@ void DiPaintGLWidget::paint(QPainter& wpainter)
       << LOGVAL((!background_buffer))
       << LOGVAL(paintable->update_background_buffer));
 
+  if (paintable->canPaintUnderlayInThread()) {
+    if (!paintUnderlayInThread(wpainter))
+      return;
+  } else {
+    discardFrame();
+    paintUnderlay(wpainter);
+  }
+
+  METLIBS_LOG_DEBUG("overlay");
+  paintable->paintOverlay(glpainter.get());
+  glpainter->end();
+}
+
+void DiPaintGLWidget::paintUnderlay(QPainter& wpainter)
+{
   glpainter->clear = true;
   if (paintable->enable_background_buffer) {
     if (!background_buffer || paintable->update_background_buffer) {
@@ -129,10 +151,67 @@ void DiPaintGLWidget::paint(QPainter& wpainter)
     glpainter->begin(&wpainter);
     paintable->paintUnderlay(glpainter.get());
   }
+}
 
-  METLIBS_LOG_DEBUG("overlay");
-  paintable->paintOverlay(glpainter.get());
-  glpainter->end();
+/*! Show the last frame from the renderer, and request a new one if
+ *  needed. Returns false if the overlay cannot be painted now, because
+ *  the renderer holds the plot lock.
+ */
+bool DiPaintGLWidget::paintUnderlayInThread(QPainter& wpainter)
+{
+  if (!renderer) {
+    renderer.reset(new DiPaintGLRenderer(paintable, glcanvas.get()));
+    connect(renderer.get(), SIGNAL(frameReady(const QImage&, bool)),
+        this, SLOT(frameReady(const QImage&, bool)));
+    const QPointer<DiPaintGLRenderer> r(renderer.get());
+    paintable->setPaintCancel([r]() { if (r) r->cancel(); });
+  }
+
+  // without background buffer, the underlay is painted again for each update
+  const bool request = !background_buffer || paintable->update_background_buffer
+      || (!paintable->enable_background_buffer && !frame_arrived);
+  frame_arrived = false;
+  if (request) {
+    METLIBS_LOG_DEBUG("underlay in thread");
+    paintable->update_background_buffer = false;
+    renderer->request(size(), antialiasing);
+  }
+
+  wpainter.setRenderHint(QPainter::Antialiasing, false);
+  if (background_buffer)
+    wpainter.drawImage(QPoint(0,0), *background_buffer);
+  else
+    wpainter.fillRect(rect(), palette().window());
+  if (renderer->isBusy())
+    return false;
+
+  wpainter.setRenderHint(QPainter::Antialiasing, antialiasing);
+  glpainter->clear = false;
+  glpainter->begin(&wpainter);
+  return true;
+}
+
+void DiPaintGLWidget::frameReady(const QImage& image, bool complete)
+{
+  METLIBS_LOG_SCOPE(LOGVAL(complete));
+  if (complete && image.size() == size()) {
+    if (!background_buffer)
+      background_buffer = new QImage(image);
+    else
+      *background_buffer = image;
+    frame_arrived = true;
+  } else {
+    // cancelled, e.g. by a change of the plots; keep the old frame and try again
+    paintable->update_background_buffer = true;
+  }
+  update();
+}
+
+void DiPaintGLWidget::discardFrame()
+{
+  if (renderer)
+    renderer->discard();
+  frame_arrived = false;
 }
 
 void DiPaintGLWidget::updateGL()
@@ -6,6 +6,7 @@
 #include <memory>
 
 class DiPaintable;
+class DiPaintGLRenderer;
 class QImage;
 
 class DiPaintGLWidget : public QWidget
@@ -20,6 +21,9 @@ public:
 public Q_SLOTS:
   void updateGL();
 
+private Q_SLOTS:
+  void frameReady(const QImage& image, bool complete);
+
 protected:
   void paintEvent(QPaintEvent* event);
   void resizeEvent(QResizeEvent* event);
@@ -33,6 +37,9 @@ protected:
 
 private:
   void paint(QPainter& painter);
+  void paintUnderlay(QPainter& painter);
+  bool paintUnderlayInThread(QPainter& painter);
+  void discardFrame();
   void dropBackgroundBuffer();
 
 protected:
@@ -41,6 +48,9 @@ protected:
   DiPaintable* paintable;
   QImage* background_buffer;
   bool antialiasing;
+
+  std::unique_ptr<DiPaintGLRenderer> renderer; //!< for the underlay, created when first used
+  bool frame_arrived; //!< the next paint shows a frame from the renderer
 };
 
 #endif // DIPAINTGLWIDGET_H
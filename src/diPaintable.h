@@ -2,6 +2,8 @@
 #ifndef DIPAINTABLE_H
 #define DIPAINTABLE_H 1
 
+#include <functional>
+
 class DiCanvas;
 class DiPainter;
 
@@ -27,6 +29,13 @@ public:
   void requestBackgroundBufferUpdate()
     { update_background_buffer = true; }
 
+  /*! True if paintUnderlay() may be called from another thread now. The
+   *  paintable must then lock its data in paintUnderlay(), and call the
+   *  function from setPaintCancel() before changing them.
+   */
+  virtual bool canPaintUnderlayInThread() { return false; }
+  virtual void setPaintCancel(const std::function<void()>&) { }
+
   virtual bool handleKeyEvents(QKeyEvent*) { return false; }
   virtual bool handleMouseEvents(QMouseEvent*) { return false; }
   virtual bool handleWheelEvents(QWheelEvent*) { return false; }
@@ -177,6 +177,7 @@ bool DiCanvas::getCharSize(int c, float& w, float& h)
 
 DiPainter::DiPainter(DiCanvas* canvas)
   : mCanvas(canvas)
+  , mCancelled(0)
 {
 }
 
@@ -8,6 +8,7 @@
 #include <QPointF>
 #include <qglobal.h>
 
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -77,6 +78,16 @@ public:
   bool isPrinting() const
     { return mCanvas->isPrinting(); }
 
+  /*! True if painting should stop early, e.g. because a newer frame has
+   *  been requested. Plots may check this between layers.
+   */
+  bool isCancelled() const
+    { return mCancelled && mCancelled->load(); }
+
+  //! set the flag checked by isCancelled(); it is owned by the caller
+  void setCancelFlag(const std::atomic<bool>* cancelled)
+    { mCancelled = cancelled; }
+
   void setVpGlSize(int vpw, int vph, float glw, float glh);
 
   bool setFont(const std::string& font);
@@ -127,6 +138,7 @@ public:
 
 private:
   DiCanvas* mCanvas;
+  const std::atomic<bool>* mCancelled;
 };
 
 #endif // DIPAINTER_H
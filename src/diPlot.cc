@@ -56,6 +56,7 @@ StaticPlot::StaticPlot()
   , verticalLevel(-1) // current vertical level
   , gcd(0)            // great circle distance (corner to corner)
   , panning(false)    // panning in progress
+  , interactive(false) // full quality
 {
 }
 
@@ -61,6 +61,7 @@ private:
   Colour backContrastColour; // suitable contrast colour
   float gcd;          // great circle distance
   bool panning;       // panning in progress
+  bool interactive;   // reduced quality while panning or zooming
 
 public:
   static GridConverter gc;   // gridconverter class
@@ -222,6 +223,16 @@ public:
   bool isPanning()
     { return panning; }
 
+  /*! Toggle reduced quality, used while the user pans or zooms and full
+   *  quality frames are slow. Plots may then show fewer stations and
+   *  arrows, coarser maps and coarser raster images.
+   */
+  void setInteractive(bool i)
+    { interactive = i; }
+
+  bool isInteractive() const
+    { return interactive; }
+
 private:
   void updatePhysToMapScale();
 };
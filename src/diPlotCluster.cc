@@ -1,5 +1,6 @@
 #include "diPlotCluster.h"
 
+#include "diGLPainter.h"
 #include "diUtilities.h" // delete_all_and_clear
 
 #include <puTools/miStringFunctions.h>
@@ -31,7 +32,7 @@ void PlotCluster::setCanvas(DiCanvas* canvas)
 
 void PlotCluster::plot(DiGLPainter* gl, Plot::PlotOrder zorder)
 {
-  for (size_t i = 0; i < plots_.size(); i++)
+  for (size_t i = 0; i < plots_.size() && !gl->isCancelled(); i++)
     plots_[i]->plot(gl, zorder);
 }
 
@@ -65,6 +65,7 @@
 
 #include <boost/range/adaptor/map.hpp>
 
+#include <chrono>
 #include <memory>
 
 //#define DEBUGPRINT
@@ -77,6 +78,9 @@ using namespace std;
 
 namespace {
 
+//! underlays slower than this (in seconds) are plotted with reduced quality while panning or zooming
+const float INTERACTIVE_FRAME_BUDGET = 0.1;
+
 float GreatCircleDistance(float lat1, float lat2, float lon1, float lon2)
 {
   return LonLat::fromDegrees(lon1, lat1).distanceTo(LonLat::fromDegrees(lon2, lat2));
@@ -92,6 +96,7 @@ PlotModule::PlotModule()
   , mCanvas(0)
   , dorubberband(false)
   , keepcurrentarea(true)
+  , underlayTime(0)
 {
   self = this;
   oldx = newx = oldy = newy = startx = starty = 0;
@@ -672,8 +677,15 @@ void PlotModule::plot(DiGLPainter* gl, bool under, bool over)
   if (staticPlot_->getDirty())
     staticPlot_->updateGcd(gl);
 
-  if (under)
+  if (under) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     plotUnder(gl);
+    // keep dirty so that the next frame recomputes what the cancelled one skipped
+    if (gl->isCancelled())
+      return;
+    if (!staticPlot_->isInteractive())
+      underlayTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+  }
 
   if (over)
     plotOver(gl);
@@ -727,6 +739,9 @@ void PlotModule::plotUnder(DiGLPainter* gl)
       m->plot(gl, Plot::BACKGROUND);
   }
 
+  if (gl->isCancelled())
+    return;
+
   // plot satellite images
   satm->plot(gl, Plot::SHADE_BACKGROUND);
 
@@ -739,6 +754,9 @@ void PlotModule::plotUnder(DiGLPainter* gl)
       m->plot(gl, Plot::SHADE_BACKGROUND);
   }
 
+  if (gl->isCancelled())
+    return;
+
   // plot fields (shaded fields etc. before map)
   fieldplots_->plot(gl, Plot::SHADE);
 
@@ -758,6 +776,9 @@ void PlotModule::plotUnder(DiGLPainter* gl)
       m->plot(gl, Plot::LINES_BACKGROUND);
   }
 
+  if (gl->isCancelled())
+    return;
+
   // plot locationPlots (vcross,...)
   for (size_t i = 0; i < locationPlots.size(); i++)
     locationPlots[i]->plot(gl, Plot::LINES);
@@ -765,6 +786,9 @@ void PlotModule::plotUnder(DiGLPainter* gl)
   // plot fields (isolines, vectors etc. after map)
   fieldplots_->plot(gl, Plot::LINES);
 
+  if (gl->isCancelled())
+    return;
+
   // next line also calls objects.changeProjection
   objm->plotObjects(gl, Plot::LINES);
 
@@ -787,6 +811,9 @@ void PlotModule::plotUnder(DiGLPainter* gl)
 
   obsplots_->plot(gl, Plot::LINES);
 
+  if (gl->isCancelled())
+    return;
+
   //plot trajectories
   for (size_t i = 0; i < vtp.size(); i++)
     vtp[i]->plot(gl, Plot::LINES);
@@ -1588,6 +1615,7 @@ void PlotModule::sendMouseEvent(QMouseEvent* me, EventResult& res)
     } else if (me->button() == Qt::MidButton) {
       areaInsert(true);
       staticPlot_->panPlot(true);
+      setInteractive(true);
       res.newcursor = paint_move_cursor;
       return;
     }
@@ -1669,6 +1697,7 @@ void PlotModule::sendMouseEvent(QMouseEvent* me, EventResult& res)
 
     } else if (me->button() == Qt::MidButton) {
       staticPlot_->panPlot(false);
+      setInteractive(false);
       res.enable_background_buffer = false;
       res.update_background_buffer = false;
       res.repaint = true;
@@ -1732,6 +1761,7 @@ void PlotModule::areaNavigation(PlotModule::AreaNavigationCommand anav, EventRes
     }
     //define new plotarea, first save the old one
     areaInsert(true);
+    setInteractive(true); // stopped by the widget when no more keys are pressed
     setMapAreaFromPhys(r);
   }
 
@@ -1739,6 +1769,22 @@ void PlotModule::areaNavigation(PlotModule::AreaNavigationCommand anav, EventRes
   res.repaint = true;
 }
 
+void PlotModule::setInteractive(bool interactive)
+{
+  // mouse panning stops only when the button is released
+  if (!interactive && staticPlot_->isPanning())
+    return;
+
+  const bool reduced = interactive && underlayTime > INTERACTIVE_FRAME_BUDGET;
+  if (reduced == staticPlot_->isInteractive())
+    return;
+
+  METLIBS_LOG_DEBUG(LOGVAL(reduced) << LOGVAL(underlayTime));
+  staticPlot_->setInteractive(reduced);
+  if (!reduced)
+    staticPlot_->setDirty(true);
+}
+
 bool PlotModule::startTrajectoryComputation()
 {
   METLIBS_LOG_SCOPE();
@@ -124,6 +124,7 @@ private:
   bool areaSaved;
   bool dorubberband;
   bool keepcurrentarea;
+  float underlayTime; // seconds for the last full quality underlay
 
   void plotUnder(DiGLPainter* gl);
   void plotOver(DiGLPainter* gl);
@@ -345,6 +346,16 @@ public:
   };
   void areaNavigation(AreaNavigationCommand anav, EventResult& res);
 
+  /*! Start or stop panning or zooming. While this goes on, plots use
+   *  reduced quality if the last full quality underlay took longer than
+   *  the frame time budget. Stopping marks the plot as dirty, so that the
+   *  next frame has full quality again.
+   */
+  void setInteractive(bool interactive);
+
+  bool isInteractive() const
+    { return staticPlot_->isInteractive(); }
+
   // return settings formatted for log file
   std::vector<std::string> writeLog();
   // read settings from log file data
@@ -176,6 +176,7 @@ const std::string PlotOptions::key_use_stencil="use_stencil";
 const std::string PlotOptions::key_update_stencil="update_stencil";
 const std::string PlotOptions::key_plot_under="plot_under";
 const std::string PlotOptions::key_maxDiagonalInMeters="maxdiagonalinmeters";
+const std::string PlotOptions::key_fullResolution="full_resolution";
 const std::string PlotOptions::key_vector_example_x = "vector.example.x";
 const std::string PlotOptions::key_vector_example_y = "vector.example.y";
 const std::string PlotOptions::key_vector_example_unit_x = "vector.example.unit.x";
@@ -204,7 +205,7 @@ PlotOptions::PlotOptions():
   alignX(0), alignY(0),
   fontname(defaultFontName()), fontface(defaultFontFace()), fontsize(defaultFontSize()), precision(0),
   dimension(1), enabled(true), contourShape(0), tableHeader(true),
-  antialiasing(false), use_stencil(false), update_stencil(false), plot_under(false), maxDiagonalInMeters(-1.0)
+  antialiasing(false), use_stencil(false), update_stencil(false), plot_under(false), maxDiagonalInMeters(-1.0), fullResolution(false)
     , vector_example_x(-1), vector_example_y(-1)
 {
 }
@@ -711,6 +712,8 @@ bool PlotOptions::parsePlotOption(const miutil::KeyValue_v& opts, PlotOptions& p
         po.plot_under=(value == TRUE);
       } else if (key==key_maxDiagonalInMeters){
         po.maxDiagonalInMeters=atof(value.c_str());
+      } else if (key==key_fullResolution){
+        po.fullResolution=(value == TRUE);
       } else if (key==key_vector_example_x){
         po.vector_example_x = miutil::to_float(value);
       } else if (key==key_vector_example_y){
@@ -1004,6 +1007,9 @@ miutil::KeyValue_v PlotOptions::toKeyValueList()
   if (update_stencil)
     miutil::add(ostr, key_update_stencil, update_stencil);
 
+  if (fullResolution)
+    miutil::add(ostr, key_fullResolution, fullResolution);
+
   if (!enabled)
     miutil::add(ostr, key_enabled, enabled);
 
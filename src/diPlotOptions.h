@@ -255,6 +255,8 @@ public:
   static const std::string key_plot_under;
   //only plot if gcd less than maxDiagonalInMeters
   static const std::string key_maxDiagonalInMeters;
+  //never plot downsampled fields
+  static const std::string key_fullResolution;
 
   static const std::string key_vector_example_x;
   static const std::string key_vector_example_y;
@@ -352,6 +354,7 @@ public:
   bool      update_stencil; // whether a stencil is updated with the plot area of the current field
   bool      plot_under;     // plot field together with shade plots
   float     maxDiagonalInMeters;
+  bool      fullResolution; // never plot downsampled fields, even if zoomed out
 
   float vector_example_x; // example vector x-position, for vcross, in relative coordinates
   float vector_example_y; // example vector y-position, for vcross, in relative coordinates
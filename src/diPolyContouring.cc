@@ -33,6 +33,7 @@
 #include "diImageGallery.h"
 #include "diUtilities.h"
 #include "polyStipMasks.h"
+#include "util/format_int.h"
 #include "util/math_util.h"
 #include "util/plotoptions_util.h"
 
@@ -96,6 +97,10 @@ public:
   size_t operator()(size_t ix, size_t iy) const
     { return index(ix, iy); }
 
+  //! grid index coordinates of point (ix, iy)
+  contouring::point_t grid(size_t ix, size_t iy) const
+    { return contouring::point_t(mX0 + ix*mStep, mY0 + iy*mStep); }
+
 private:
   size_t mNX, mNY, mStep, mX0, mY0, mSX, mSY;
 };
@@ -132,6 +137,19 @@ private:
   const float *mXpos, *mYpos;
 };
 
+//! positions in grid index space, for contour geometry independent of the map projection
+class DianaPositionsGrid : public DianaPositions {
+public:
+  DianaPositionsGrid(const DianaArrayIndex& index)
+    : mIndex(index) { }
+
+  contouring::point_t position(size_t ix, size_t iy) const
+    { return mIndex.grid(ix, iy); }
+
+private:
+  const DianaArrayIndex& mIndex;
+};
+
 class DianaPositionsFormula : public DianaPositions {
 public:
   DianaPositionsFormula(const float* coeff)
@@ -280,6 +298,49 @@ DianaPositions::~DianaPositions()
 
 // ########################################################################
 
+DianaGridToMap::DianaGridToMap(int nx, int ny, int step, const float* xz, const float* yz)
+  : mNX(nx), mNY(ny), mStep(std::max(1, step)), mXZ(xz), mYZ(yz)
+{
+}
+
+void DianaGridToMap::lattice(float g, int n, int& i0, int& i1, float& c) const
+{
+  // contour points are on lines between grid points that are multiples of mStep
+  const float u = g / mStep;
+  i0 = int(std::floor(u));
+  c = u - i0;
+  i0 *= mStep;
+  i1 = i0 + mStep;
+  if (i1 >= n || c <= 0) {
+    i1 = i0;
+    c = 0;
+  }
+}
+
+contouring::point_t DianaGridToMap::operator()(const contouring::point_t& g) const
+{
+  int ix0, ix1, iy0, iy1;
+  float cx, cy;
+  lattice(g.x, mNX, ix0, ix1, cx);
+  lattice(g.y, mNY, iy0, iy1, cy);
+
+  const size_t i00 = iy0*mNX + ix0, i01 = iy0*mNX + ix1, i10 = iy1*mNX + ix0, i11 = iy1*mNX + ix1;
+  float x, y;
+  if (cy == 0) {
+    x = (1-cx)*mXZ[i00] + cx*mXZ[i01];
+    y = (1-cx)*mYZ[i00] + cx*mYZ[i01];
+  } else if (cx == 0) {
+    x = (1-cy)*mXZ[i00] + cy*mXZ[i10];
+    y = (1-cy)*mYZ[i00] + cy*mYZ[i10];
+  } else {
+    x = (1-cy)*((1-cx)*mXZ[i00] + cx*mXZ[i01]) + cy*((1-cx)*mXZ[i10] + cx*mXZ[i11]);
+    y = (1-cy)*((1-cx)*mYZ[i00] + cx*mYZ[i01]) + cy*((1-cx)*mYZ[i10] + cx*mYZ[i11]);
+  }
+  return contouring::point_t(x, y);
+}
+
+// ########################################################################
+
 contouring::point_t DianaFieldBase::line_point(contouring::level_t level, size_t x0, size_t y0, size_t x1, size_t y1) const
 {
     const float v0 = value(x0, y0);
@@ -467,6 +528,8 @@ void DianaLines::paint_lines()
 
 void DianaLines::paint_labels()
 {
+  if ((mPaintMode & LINES_LABELS) == 0)
+    return;
   const bool skip_level_0 = skip_level_above0(mPlotOptions);
   for (level_points_m::const_iterator it = m_lines.begin(); it != m_lines.end(); ++it) {
     const contouring::level_t li = it->first;
@@ -515,7 +578,18 @@ class DianaGLLines : public DianaLines
 public:
   DianaGLLines(DiGLPainter* gl, const PlotOptions& poptions,
       const DianaLevels& levels)
-    : DianaLines(poptions, levels), mGL(gl) { }
+    : DianaLines(poptions, levels), mGL(gl), mGridToMap(0), mLabelTileSize(0) { }
+
+  void setPainter(DiGLPainter* gl)
+    { mGL = gl; }
+
+  //! set transformation for contours made in grid index space, or 0 if contours are in map coordinates
+  void setGridToMap(const DianaGridToMap* g2m)
+    { mGridToMap = g2m; }
+
+  //! place labels only inside the tile with grid index origin x0, y0 and the given size, see DianaContourTiles
+  void setLabelTile(int x0, int y0, int size)
+    { mLabelTileX = x0; mLabelTileY = y0; mLabelTileSize = size; }
 
 protected:
   void paint_polygons();
@@ -528,10 +602,25 @@ protected:
   void drawPolygons(const point_vv& polygons);
   void drawLabels(const point_v& points, contouring::level_t li);
 
+private:
+  QPointF toMap(const contouring::point_t& p) const;
+  bool drawLabelAt(const point_v& points, size_t& idx, const QString& lbl, float lbl_w2);
+
 private:
   DiGLPainter* mGL;
+  const DianaGridToMap* mGridToMap;
+  int mLabelTileX, mLabelTileY, mLabelTileSize;
 };
 
+QPointF DianaGLLines::toMap(const contouring::point_t& p) const
+{
+  if (mGridToMap) {
+    const contouring::point_t m = (*mGridToMap)(p);
+    return QPointF(m.x, m.y);
+  }
+  return QPointF(p.x, p.y);
+}
+
 void DianaGLLines::paint_polygons()
 {
   METLIBS_LOG_TIME(LOGVAL(mPlotOptions.undefMasking));
@@ -587,8 +676,9 @@ void DianaGLLines::setLine(const Colour& colour, const Linetype& linetype, int l
 void DianaGLLines::drawLine(const point_v& points)
 {
   QPolygonF line;
+  line.reserve(points.size());
   for (point_v::const_iterator it = points.begin(); it != points.end(); ++it)
-    line << QPointF(it->x, it->y);
+    line << toMap(*it);
   mGL->drawPolyline(line);
 }
 
@@ -597,18 +687,27 @@ void DianaGLLines::drawPolygons(const point_vv& polygons)
   // METLIBS_LOG_TIME();
   for (point_vv::const_iterator itL = polygons.begin(); itL != polygons.end(); ++itL) {
     QPolygonF polygon;
+    polygon.reserve(itL->size());
     for (point_v::const_iterator p = itL->begin(); p != itL->end(); ++p)
-      polygon << QPointF(p->x, p->y);
+      polygon << toMap(*p);
     mGL->drawPolygon(polygon);
   }
 }
 
-void DianaGLLines::drawLabels(const point_v& points, contouring::level_t li)
+void DianaGLLines::drawLabels(const point_v& gpoints, contouring::level_t li)
 {
-  if (points.size() < 10)
+  if (gpoints.size() < 10)
     return;
 
-  const QString lbl = QString::number(mLevels.value_for_level(li));
+  point_v mapped;
+  if (mGridToMap) {
+    mapped.reserve(gpoints.size());
+    for (point_v::const_iterator it = gpoints.begin(); it != gpoints.end(); ++it)
+      mapped.push_back((*mGridToMap)(*it));
+  }
+  const point_v& points = mGridToMap ? mapped : gpoints;
+
+  const QString lbl = QString::fromLatin1(diutil::format_general(mLevels.value_for_level(li)).c_str());
 
   float lbl_w = 0, lbl_h = 0;
   if (not mGL->getTextSize(lbl, lbl_w, lbl_h))
@@ -617,47 +716,71 @@ void DianaGLLines::drawLabels(const point_v& points, contouring::level_t li)
     return;
   const float lbl_w2 = lbl_w * lbl_w;
 
-  size_t idx = int(0.1*(1 + (std::abs(li+100000) % 5))) * points.size();
-  for (; idx + 1 < points.size(); idx += 5) {
-    contouring::point_t p0 = points.at(idx), p1;
-    const int idx0 = idx;
-    for (idx += 1; idx < points.size(); ++idx) {
-      p1 = points.at(idx);
-      const float dy = p1.y - p0.y, dx = p1.x - p0.x;
-      if (diutil::absval2(dx, dy) >= lbl_w2)
-        break;
+  if (mLabelTileSize > 0) {
+    // label where the line crosses the column or row at 1/4, 1/2 or 3/4 of the tile,
+    // depending on the level; these crossings are inside this tile only, so that
+    // a line through several tiles is not labelled at each tile border
+    const float f = 0.25 * (1 + (std::abs(li+100000) % 3));
+    const float xc = mLabelTileX + f * mLabelTileSize, yc = mLabelTileY + f * mLabelTileSize;
+    size_t next = 0;
+    for (size_t i = 0; i + 1 < gpoints.size(); ++i) {
+      if (i < next)
+        continue;
+      const contouring::point_t &g0 = gpoints[i], &g1 = gpoints[i+1];
+      if ((g0.x < xc) == (g1.x < xc) && (g0.y < yc) == (g1.y < yc))
+        continue;
+      size_t idx = i;
+      if (drawLabelAt(points, idx, lbl, lbl_w2))
+        next = idx;
     }
-    if (idx >= points.size())
-      break;
-
-    if (p1.x < p0.x)
-      std::swap(p0, p1);
-    const float angle_deg = atan2f(p1.y - p0.y, p1.x - p0.x) * 180. / M_PI;
+    return;
+  }
 
-    // check that line is somewhat straight under label
-    size_t idx2 = idx0 + 1;
-    for (; idx2 < idx; ++idx2) {
-      const contouring::point_t p2 = points.at(idx2);
-      const float a = atan2f(p2.y - p0.y, p2.x - p0.x) * 180. / M_PI;
-      if (std::abs(a - angle_deg) > 15)
+  size_t idx = int(0.1*(1 + (std::abs(li+100000) % 5))) * points.size();
+  for (; idx + 1 < points.size(); idx += 5) {
+    const size_t idx0 = idx;
+    if (!drawLabelAt(points, idx, lbl, lbl_w2)) {
+      if (idx >= points.size())
         break;
-    }
-    if (idx2 < idx)
       continue;
-
-    // label angle seems ok, find position
-#if 0
-    // centered on line
-    const float f = lbl_h/(2*lbl_w), tx = p0.x + (p1.y-p0.y)*f, ty = p0.y - (p1.x-p0.x)*f;
-#else
-    // sitting on top of line
-    const float tx = p0.x, ty = p0.y;
-#endif
-    mGL->drawText(lbl, tx, ty, angle_deg);
+    }
     idx += 10*(idx - idx0);
   }
 }
 
+bool DianaGLLines::drawLabelAt(const point_v& points, size_t& idx, const QString& lbl, float lbl_w2)
+{
+  contouring::point_t p0 = points.at(idx), p1;
+  const size_t idx0 = idx;
+  for (idx += 1; idx < points.size(); ++idx) {
+    p1 = points.at(idx);
+    const float dy = p1.y - p0.y, dx = p1.x - p0.x;
+    if (diutil::absval2(dx, dy) >= lbl_w2)
+      break;
+  }
+  if (idx >= points.size())
+    return false;
+
+  if (p1.x < p0.x)
+    std::swap(p0, p1);
+  const float angle_deg = atan2f(p1.y - p0.y, p1.x - p0.x) * 180. / M_PI;
+
+  // check that line is somewhat straight under label
+  size_t idx2 = idx0 + 1;
+  for (; idx2 < idx; ++idx2) {
+    const contouring::point_t p2 = points.at(idx2);
+    const float a = atan2f(p2.y - p0.y, p2.x - p0.x) * 180. / M_PI;
+    if (std::abs(a - angle_deg) > 15)
+      break;
+  }
+  if (idx2 < idx)
+    return false;
+
+  // label angle seems ok, sitting on top of line
+  mGL->drawText(lbl, p0.x, p0.y, angle_deg);
+  return true;
+}
+
 // ########################################################################
 
 std::shared_ptr<DianaLevels> dianaLevelsForPlotOptions(const PlotOptions& poptions, float fieldUndef)
@@ -764,3 +887,317 @@ bool poly_contour(int nx, int ny, int ix0, int iy0, int ix1, int iy1,
 
   return true;
 }
+
+// ########################################################################
+
+namespace {
+class DianaLineCollector : public contouring::lines_t {
+public:
+  DianaLineCollector(const DianaLevels& levels, DianaContourLine_v& lines)
+    : mLevels(levels), mLines(lines) { }
+
+  void add_contour_line(contouring::level_t level, const contouring::points_t& points, bool closed) override;
+  void add_contour_polygon(contouring::level_t, const contouring::points_t&) override
+    { }
+
+private:
+  const DianaLevels& mLevels;
+  DianaContourLine_v& mLines;
+};
+
+void DianaLineCollector::add_contour_line(contouring::level_t level, const contouring::points_t& points, bool closed)
+{
+  if (level == DianaLevels::UNDEF_LEVEL || points.empty())
+    return;
+
+  mLines.push_back(DianaContourLine());
+  DianaContourLine& line = mLines.back();
+  line.value = mLevels.value_for_level(level);
+  line.points.assign(points.begin(), points.end());
+  if (closed)
+    line.points.push_back(points.front());
+}
+} // namespace
+
+void poly_contour_lines(int nx, int ny, const float z[], const DianaLevels& levels,
+    int lineSmooth, DianaContourLine_v& lines)
+{
+  const DianaArrayIndex index(nx, ny, 0, 0, nx, ny, lineSmooth);
+  const DianaPositionsGrid positions(index);
+  const DianaField df(index, z, levels, positions);
+  DianaLineCollector collector(levels, lines);
+  try {
+    contouring::run(df, collector);
+  } catch (contouring::too_many_levels& tml) {
+    METLIBS_LOG_WARN(tml.what());
+  }
+}
+
+// ########################################################################
+
+struct DianaContourTiles::Layer {
+  int paintMode;
+  bool use_options_2;
+
+  int nx, ny, lineSmooth;
+  const float *z;
+
+  int block, ntx, nty;
+  DianaLevels_p levels;
+  std::vector< std::shared_ptr<DianaGLLines> > tiles; // 0 if not contoured
+
+  // first and last tile containing any point of index range [i0,i1)
+  void tileRange(int i0, int i1, int ntiles, int& t0, int& t1) const;
+};
+
+void DianaContourTiles::Layer::tileRange(int i0, int i1, int ntiles, int& t0, int& t1) const
+{
+  // tile t covers points t*block .. t*block+block (inclusive)
+  t0 = (i0 > 0) ? (i0 - 1) / block : 0;
+  t1 = std::min(ntiles - 1, std::max(i0, i1 - 1) / block);
+}
+
+DianaContourTiles::DianaContourTiles()
+{
+}
+
+DianaContourTiles::~DianaContourTiles()
+{
+}
+
+void DianaContourTiles::clear()
+{
+  mLayers.clear();
+}
+
+void DianaContourTiles::invalidate(int ix0, int iy0, int ix1, int iy1)
+{
+  if (ix0 >= ix1 || iy0 >= iy1)
+    return;
+  for (size_t l = 0; l < mLayers.size(); ++l) {
+    Layer& layer = *mLayers[l];
+    int tx0, tx1, ty0, ty1;
+    layer.tileRange(ix0, ix1, layer.ntx, tx0, tx1);
+    layer.tileRange(iy0, iy1, layer.nty, ty0, ty1);
+    for (int ty = ty0; ty <= ty1; ++ty)
+      for (int tx = tx0; tx <= tx1; ++tx)
+        layer.tiles[ty*layer.ntx + tx].reset();
+  }
+}
+
+bool DianaContourTiles::paint(int nx, int ny, int ix0, int iy0, int ix1, int iy1,
+    const float z[], const float xz[], const float yz[],
+    DiGLPainter* gl, const PlotOptions& poptions, float fieldUndef,
+    int paintMode, bool use_options_2)
+{
+  if (use_options_2)
+    paintMode &= ~(DianaLines::UNDEFINED|DianaLines::FILL);
+
+  Layer_p layer;
+  for (size_t l = 0; l < mLayers.size() && !layer; ++l) {
+    if (mLayers[l]->paintMode == paintMode && mLayers[l]->use_options_2 == use_options_2)
+      layer = mLayers[l];
+  }
+  if (!layer) {
+    layer = std::make_shared<Layer>();
+    layer->paintMode = paintMode;
+    layer->use_options_2 = use_options_2;
+    layer->nx = layer->ny = 0;
+    mLayers.push_back(layer);
+  }
+  if (layer->nx != nx || layer->ny != ny || layer->lineSmooth != poptions.lineSmooth || layer->z != z) {
+    layer->nx = nx;
+    layer->ny = ny;
+    layer->lineSmooth = poptions.lineSmooth;
+    layer->z = z;
+    layer->block = 32*std::max(1, poptions.lineSmooth);
+    layer->ntx = std::max(1, (nx - 2) / layer->block + 1);
+    layer->nty = std::max(1, (ny - 2) / layer->block + 1);
+    layer->levels = use_options_2
+        ? dianaLevelsForPlotOptions_2(poptions, fieldUndef)
+        : dianaLevelsForPlotOptions  (poptions, fieldUndef);
+    layer->tiles.clear();
+    layer->tiles.resize(layer->ntx * layer->nty);
+  }
+
+  int tx0, tx1, ty0, ty1;
+  layer->tileRange(ix0, ix1, layer->ntx, tx0, tx1);
+  layer->tileRange(iy0, iy1, layer->nty, ty0, ty1);
+
+  const DianaGridToMap g2m(nx, ny, poptions.lineSmooth, xz, yz);
+  std::vector<DianaGLLines*> visible;
+  int ncontoured = 0;
+  for (int ty = ty0; ty <= ty1; ++ty) {
+    for (int tx = tx0; tx <= tx1; ++tx) {
+      std::shared_ptr<DianaGLLines>& tile = layer->tiles[ty*layer->ntx + tx];
+      if (!tile) {
+        const int bx0 = tx*layer->block, by0 = ty*layer->block;
+        const int bx1 = std::min(nx, bx0 + layer->block + 1), by1 = std::min(ny, by0 + layer->block + 1);
+        const DianaArrayIndex index(nx, ny, bx0, by0, bx1, by1, poptions.lineSmooth);
+        const DianaPositionsGrid positions(index);
+        const DianaField df(index, z, *layer->levels, positions);
+        tile = std::make_shared<DianaGLLines>(gl, poptions, *layer->levels);
+        tile->setPaintMode(paintMode);
+        tile->setUseOptions2(use_options_2);
+        tile->setLabelTile(bx0, by0, layer->block);
+        try {
+          contouring::run(df, *tile);
+        } catch (contouring::too_many_levels& tml) {
+          METLIBS_LOG_WARN(tml.what());
+        }
+        ncontoured += 1;
+      }
+      tile->setPainter(gl);
+      tile->setGridToMap(&g2m);
+      visible.push_back(tile.get());
+    }
+  }
+  METLIBS_LOG_DEBUG(LOGVAL(visible.size()) << LOGVAL(ncontoured));
+
+  // paint fill and undefined areas of all tiles below the lines
+  for (size_t i = 0; i < visible.size(); ++i) {
+    visible[i]->setPaintMode(paintMode & ~DianaLines::LINES_LABELS);
+    visible[i]->paint();
+  }
+  if (paintMode & DianaLines::LINES_LABELS) {
+    for (size_t i = 0; i < visible.size(); ++i) {
+      visible[i]->setPaintMode(DianaLines::LINES_LABELS);
+      visible[i]->paint();
+    }
+  }
+
+  return true;
+}
+
+// ########################################################################
+
+namespace {
+//! margin around the painted index range when contouring for DianaContourCache, relative to the range size
+const float CACHE_MARGIN = 0.5;
+
+void withMargin(int i0, int i1, int n, int& c0, int& c1)
+{
+  const int m = int(CACHE_MARGIN * (i1 - i0));
+  c0 = std::max(0, i0 - m);
+  c1 = std::min(n, i1 + m);
+}
+} // namespace
+
+struct DianaContourCache::Layer {
+  int paintMode;
+  bool use_options_2;
+
+  int nx, ny, lineSmooth;
+  const float *z;
+  int cx0, cy0, cx1, cy1; //!< contoured index range
+
+  DianaLevels_p levels;
+  std::vector< std::shared_ptr<DianaGLLines> > blocks; //!< fill, in blocks as in poly_contour
+  std::shared_ptr<DianaGLLines> lines; //!< lines, labels and undefined areas
+
+  bool contains(int ix0, int iy0, int ix1, int iy1) const
+    { return ix0 >= cx0 && iy0 >= cy0 && ix1 <= cx1 && iy1 <= cy1; }
+};
+
+DianaContourCache::DianaContourCache()
+{
+}
+
+DianaContourCache::~DianaContourCache()
+{
+}
+
+void DianaContourCache::clear()
+{
+  mLayers.clear();
+}
+
+bool DianaContourCache::paint(int nx, int ny, int ix0, int iy0, int ix1, int iy1,
+    const float z[], const float xz[], const float yz[],
+    DiGLPainter* gl, const PlotOptions& poptions, float fieldUndef,
+    int paintMode, bool use_options_2)
+{
+  if (use_options_2)
+    paintMode &= ~(DianaLines::UNDEFINED|DianaLines::FILL);
+
+  Layer_p layer;
+  for (size_t l = 0; l < mLayers.size() && !layer; ++l) {
+    if (mLayers[l]->paintMode == paintMode && mLayers[l]->use_options_2 == use_options_2)
+      layer = mLayers[l];
+  }
+  if (!layer) {
+    layer = std::make_shared<Layer>();
+    layer->paintMode = paintMode;
+    layer->use_options_2 = use_options_2;
+    layer->nx = layer->ny = 0;
+    mLayers.push_back(layer);
+  }
+
+  if (layer->nx != nx || layer->ny != ny || layer->lineSmooth != poptions.lineSmooth || layer->z != z
+      || !layer->contains(ix0, iy0, ix1, iy1))
+  {
+    METLIBS_LOG_TIME("contouring for cache");
+    layer->nx = nx;
+    layer->ny = ny;
+    layer->lineSmooth = poptions.lineSmooth;
+    layer->z = z;
+    withMargin(ix0, ix1, nx, layer->cx0, layer->cx1);
+    withMargin(iy0, iy1, ny, layer->cy0, layer->cy1);
+    layer->levels = use_options_2
+        ? dianaLevelsForPlotOptions_2(poptions, fieldUndef)
+        : dianaLevelsForPlotOptions  (poptions, fieldUndef);
+    layer->blocks.clear();
+    layer->lines.reset();
+
+    int linesPaintMode = paintMode;
+    const int blockPaintMode = (paintMode & DianaLines::FILL);
+    if (blockPaintMode) {
+      const int BLOCK = 32*std::max(1, poptions.lineSmooth);
+      for (int ixx0 = layer->cx0; ixx0 < layer->cx1; ixx0 += BLOCK) {
+        const int ixx1 = std::min(layer->cx1, ixx0 + BLOCK+1);
+        for (int iyy0 = layer->cy0; iyy0 < layer->cy1; iyy0 += BLOCK) {
+          const int iyy1 = std::min(layer->cy1, iyy0 + BLOCK+1);
+          const DianaArrayIndex index(nx, ny, ixx0, iyy0, ixx1, iyy1, poptions.lineSmooth);
+          const DianaPositionsGrid positions(index);
+          const DianaField df(index, z, *layer->levels, positions);
+          std::shared_ptr<DianaGLLines> block = std::make_shared<DianaGLLines>(gl, poptions, *layer->levels);
+          block->setPaintMode(blockPaintMode);
+          block->setUseOptions2(use_options_2);
+          try {
+            contouring::run(df, *block);
+          } catch (contouring::too_many_levels& tml) {
+            METLIBS_LOG_WARN(tml.what());
+          }
+          layer->blocks.push_back(block);
+        }
+      }
+      linesPaintMode &= ~DianaLines::FILL;
+    }
+
+    const DianaArrayIndex index(nx, ny, layer->cx0, layer->cy0, layer->cx1, layer->cy1, poptions.lineSmooth);
+    const DianaPositionsGrid positions(index);
+    const DianaField df(index, z, *layer->levels, positions);
+    layer->lines = std::make_shared<DianaGLLines>(gl, poptions, *layer->levels);
+    layer->lines->setPaintMode(linesPaintMode);
+    layer->lines->setUseOptions2(use_options_2);
+    try {
+      contouring::run(df, *layer->lines);
+    } catch (contouring::too_many_levels& tml) {
+      METLIBS_LOG_WARN(tml.what());
+    }
+  }
+
+  METLIBS_LOG_TIME("painting from cache");
+  const DianaGridToMap g2m(nx, ny, poptions.lineSmooth, xz, yz);
+  for (size_t i = 0; i < layer->blocks.size(); ++i) {
+    DianaGLLines& block = *layer->blocks[i];
+    block.setPainter(gl);
+    block.setGridToMap(&g2m);
+    block.paint();
+  }
+  layer->lines->setPainter(gl);
+  layer->lines->setGridToMap(&g2m);
+  layer->lines->paint();
+
+  return true;
+}
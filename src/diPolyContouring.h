@@ -109,6 +109,25 @@ public:
 
 typedef std::shared_ptr<DianaPositions> DianaPositions_p;
 
+/*! Transform points in grid index space to map coordinates.
+ *
+ * Points are interpolated linearly between the map positions of grid points
+ * that are multiples of step, which gives the same result as contouring
+ * with map positions directly.
+ */
+class DianaGridToMap {
+public:
+  DianaGridToMap(int nx, int ny, int step, const float* xz, const float* yz);
+  contouring::point_t operator()(const contouring::point_t& g) const;
+
+private:
+  void lattice(float g, int n, int& i0, int& i1, float& c) const;
+
+private:
+  int mNX, mNY, mStep;
+  const float *mXZ, *mYZ;
+};
+
 // ########################################################################
 
 class DianaFieldBase : public contouring::field_t {
@@ -198,4 +217,94 @@ bool poly_contour(int nx, int ny, int ix0, int iy0, int ix1, int iy1,
     int paintMode = (DianaLines::UNDEFINED | DianaLines::FILL | DianaLines::LINES_LABELS),
     bool use_options_2 = false);
 
+// ########################################################################
+
+//! contour line of a field, see poly_contour_lines
+struct DianaContourLine {
+  float value;
+  std::vector<contouring::point_t> points; //!< grid index coordinates; closed lines end with their first point
+};
+typedef std::vector<DianaContourLine> DianaContourLine_v;
+
+/*! Contour lines for levels without painting anything, e.g. for exporting
+ *  vector data. Lines around undefined areas are not included.
+ *
+ *  Safe to call from several threads at the same time.
+ */
+void poly_contour_lines(int nx, int ny, const float z[], const DianaLevels& levels,
+    int lineSmooth, DianaContourLine_v& lines);
+
+// ########################################################################
+
+/*! Contour geometry of a field, split into tiles of grid index ranges.
+ *
+ *  Tiles are contoured when first painted and kept until invalidated.
+ *  After a change to a small part of the field data, only the tiles
+ *  overlapping the changed index range are contoured again.
+ *
+ *  Geometry is kept in grid index space, so that tiles remain valid when
+ *  the map is panned, zoomed or reprojected.
+ *
+ *  Contour lines are split at tile borders. Each tile labels its lines
+ *  only where they cross a row or column inside the tile, so that lines
+ *  are not labelled again at each tile border.
+ */
+class DianaContourTiles {
+public:
+  DianaContourTiles();
+  ~DianaContourTiles();
+
+  //! forget all tiles
+  void clear();
+
+  //! mark tiles overlapping the grid index range [ix0,ix1) x [iy0,iy1) for recontouring
+  void invalidate(int ix0, int iy0, int ix1, int iy1);
+
+  //! same parameters as poly_contour; contours tiles if needed and paints all tiles in the index range
+  bool paint(int nx, int ny, int ix0, int iy0, int ix1, int iy1,
+      const float z[], const float xz[], const float yz[],
+      DiGLPainter* gl, const PlotOptions& poptions, float fieldUndef,
+      int paintMode, bool use_options_2);
+
+private:
+  struct Layer;
+  typedef std::shared_ptr<Layer> Layer_p;
+
+  std::vector<Layer_p> mLayers;
+};
+
+// ########################################################################
+
+/*! Contour geometry of a field for a grid index range.
+ *
+ *  Like poly_contour, but the geometry is kept in grid index space and
+ *  only transformed to map coordinates when painting. The field is only
+ *  contoured again when the data, the plot options or the paint mode
+ *  change, or when the painted index range is not inside the cached range.
+ *  The cached range is the painted range with a margin, so that small
+ *  pans do not require contouring.
+ *
+ *  The cache does not notice changes to the data array or plot options;
+ *  call clear() after such changes.
+ */
+class DianaContourCache {
+public:
+  DianaContourCache();
+  ~DianaContourCache();
+
+  void clear();
+
+  //! same parameters as poly_contour
+  bool paint(int nx, int ny, int ix0, int iy0, int ix1, int iy1,
+      const float z[], const float xz[], const float yz[],
+      DiGLPainter* gl, const PlotOptions& poptions, float fieldUndef,
+      int paintMode, bool use_options_2);
+
+private:
+  struct Layer;
+  typedef std::shared_ptr<Layer> Layer_p;
+
+  std::vector<Layer_p> mLayers;
+};
+
 #endif // diPolyContouring_hh
@@ -6,6 +6,11 @@
 #define MILOGGER_CATEGORY "diana.RasterPlot"
 #include <miLogger/miLogging.h>
 
+namespace {
+//! size in screen pixels of the raster pixels while panning or zooming
+const int INTERACTIVE_PIXEL_SIZE = 3;
+} // namespace
+
 RasterPlot::RasterPlot()
 {
 }
@@ -19,11 +24,17 @@ QImage RasterPlot::rasterPaint()
   METLIBS_LOG_SCOPE();
 
   StaticPlot* sp = rasterStaticPlot();
-  const diutil::PointI size(sp->getPhysWidth(), sp->getPhysHeight());
+  const diutil::PointI physSize(sp->getPhysWidth(), sp->getPhysHeight());
+
+  // coarse pixels need fewer reprojected points and less data lookup
+  const int ps = sp->isInteractive() ? INTERACTIVE_PIXEL_SIZE : 1;
+  const diutil::PointI size((physSize.x() + ps - 1) / ps, (physSize.y() + ps - 1) / ps);
   cached_ = QImage(size.x(), size.y(), QImage::Format_ARGB32);
   cached_.fill(Qt::transparent);
 
   GridReprojection::instance()->reproject(size, sp->getPlotSize(), sp->getMapArea().P(), rasterArea().P(), *this);
+  if (ps != 1)
+    cached_ = cached_.scaled(physSize.x(), physSize.y());
   return cached_;
 }
 
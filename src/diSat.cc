@@ -34,9 +34,12 @@
 #include "diSat.h"
 
 #include "diKVListPlotCommand.h" // for operator<<
+#include "util/math_util.h"
 
 #include <puTools/miStringFunctions.h>
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 #define MILOGGER_CATEGORY "diana.Sat"
@@ -56,13 +59,14 @@ Sat::Sat() :
   cut(defaultCut), alphacut(defaultAlphacut), alpha(defaultAlpha),
   maxDiff(defaultTimediff), classtable(defaultClasstable),
   palette(false), mosaic(false),
-  commonColourStretch(false), image(0), calibidx(-1),
+  commonColourStretch(false), viewWidth(0), viewHeight(0),
+  image(0), calibidx(-1),
   channelschanged(true), rgboperchanged(true),
   alphaoperchanged(true),mosaicchanged(true)
 {
   METLIBS_LOG_SCOPE();
   for (int i=0; i<maxch; i++)
-    rawimage[i] = 0;
+    rawimage[i] = fullimage[i] = 0;
   for (int i=0; i<3; i++)
     origimage[i] = 0;
 }
@@ -78,14 +82,15 @@ Sat::Sat (const miutil::KeyValue_v& pin) :
   cut(defaultCut), alphacut(defaultAlphacut), alpha(defaultAlpha),
   maxDiff(defaultTimediff), classtable(defaultClasstable),
   palette(false), mosaic(false),
-  commonColourStretch(false), image(0), calibidx(-1),
+  commonColourStretch(false), viewWidth(0), viewHeight(0),
+  image(0), calibidx(-1),
   channelschanged(true), rgboperchanged(true),
   alphaoperchanged(true),mosaicchanged(true)
 {
   METLIBS_LOG_SCOPE(LOGVAL(pin)<<LOGVAL(cut));
 
   for (int i=0; i<maxch; i++)
-    rawimage[i] = 0;
+    rawimage[i] = fullimage[i] = 0;
   for (int i=0; i<3; i++)
     origimage[i] = 0;
 
@@ -174,6 +179,11 @@ void Sat::memberCopy(const Sat& rhs)
   hideColour=rhs.hideColour;
 
   area= rhs.area;
+  window= rhs.window;
+  imagearea= rhs.imagearea;
+  viewArea= rhs.viewArea;
+  viewWidth= rhs.viewWidth;
+  viewHeight= rhs.viewHeight;
 
   time= rhs.time;
   annotation= rhs.annotation;
@@ -194,7 +204,7 @@ void Sat::memberCopy(const Sat& rhs)
   lastMosaicFileTime=rhs.lastMosaicFileTime;
   commonColourStretch=rhs.commonColourStretch;
   // copy images
-  long size= area.gridSize();
+  long size= imagearea.gridSize();
 
   if (size) {
     image = new unsigned char[size];
@@ -241,11 +251,14 @@ void Sat::values(int x, int y, std::vector<SatValues>& satval)
   if (x>=0 && x<area.nx && y>=0 && y<area.ny && approved) { // inside image/legal image
     int index = area.nx*(area.ny-y-1) + x;
 
+    //reduced images are not used for values
+    unsigned char* const* raw = reduced() ? fullimage : rawimage;
+
     //return value from  all channels
 
     std::map<int,table_cal>::iterator p=calibrationTable.begin();
     std::map<int,table_cal>::iterator q=calibrationTable.end();
-    for (; p!=q && rawimage[p->first]!=NULL; p++) {
+    for (; p!=q && raw[p->first]!=NULL; p++) {
       SatValues sv;
       sv.value = -999.99;
       int pvalue;
@@ -256,7 +269,7 @@ void Sat::values(int x, int y, std::vector<SatValues>& satval)
         pvalue = (int)origimage[p->first][index];
       }
       else {
-        pvalue = rawimage[p->first][index];
+        pvalue = raw[p->first][index];
       }
       //return if colour is hidden
       if ( hideColour.count(pvalue) && hideColour[pvalue] == 0) {
@@ -513,6 +526,115 @@ void Sat::setArea()
   area.resolutionY = Ay;
   Rectangle r(0., 0., area.nx*area.resolutionX, area.ny*area.resolutionY);
   area.setR(r);
+  setImageArea();
+}
+
+void Sat::setImageArea()
+{
+  imagearea = area;
+  if (!reduced())
+    return;
+
+  const int s = window.step;
+  imagearea.nx = (window.nx + s - 1) / s;
+  imagearea.ny = (window.ny + s - 1) / s;
+  imagearea.resolutionX = area.resolutionX * s;
+  imagearea.resolutionY = area.resolutionY * s;
+  const float x1 = area.R().x1 + window.x0 * area.resolutionX;
+  const float y2 = area.R().y2 - window.y0 * area.resolutionY;
+  imagearea.setR(Rectangle(x1, y2 - imagearea.ny * imagearea.resolutionY,
+      x1 + imagearea.nx * imagearea.resolutionX, y2));
+}
+
+bool Sat::findWindow(const Area& view, int width, int height, float margin, Window& w) const
+{
+  if (area.nx <= 0 || area.ny <= 0 || width <= 0 || height <= 0)
+    return false;
+
+  // sample the view on a regular grid and convert to image columns and rows
+  const int NS = 16, NP = NS + 1;
+  const Rectangle& vr = view.R();
+  std::vector<float> x(NP*NP), y(NP*NP);
+  for (int j=0; j<NP; j++) {
+    for (int i=0; i<NP; i++) {
+      x[j*NP+i] = vr.x1 + vr.width() * i / NS;
+      y[j*NP+i] = vr.y1 + vr.height() * j / NS;
+    }
+  }
+  if (!area.P().convertPoints(view.P(), x.size(), &x[0], &y[0], true))
+    return false;
+
+  bool outside = false;
+  float gx0 = area.nx, gx1 = 0, gy0 = area.ny, gy1 = 0;
+  for (size_t k=0; k<x.size(); k++) {
+    if (x[k] == HUGE_VAL || y[k] == HUGE_VAL) {
+      outside = true;
+      continue;
+    }
+    x[k] = area.toGridX(x[k]);
+    y[k] = area.ny - area.toGridY(y[k]);
+    gx0 = std::min(gx0, x[k]);
+    gx1 = std::max(gx1, x[k]);
+    gy0 = std::min(gy0, y[k]);
+    gy1 = std::max(gy1, y[k]);
+  }
+
+  // image pixels per screen pixel where the image is most dense
+  const float sx = width / float(NS), sy = height / float(NS);
+  float density = -1;
+  for (int j=0; j<NP; j++) {
+    for (int i=0; i<NP; i++) {
+      const int k = j*NP+i;
+      if (x[k] == HUGE_VAL || y[k] == HUGE_VAL)
+        continue;
+      if (i+1 < NP && x[k+1] != HUGE_VAL && y[k+1] != HUGE_VAL) {
+        const float d = diutil::absval(x[k+1]-x[k], y[k+1]-y[k]) / sx;
+        if (density < 0 || d < density)
+          density = d;
+      }
+      if (j+1 < NP && x[k+NP] != HUGE_VAL && y[k+NP] != HUGE_VAL) {
+        const float d = diutil::absval(x[k+NP]-x[k], y[k+NP]-y[k]) / sy;
+        if (density < 0 || d < density)
+          density = d;
+      }
+    }
+  }
+  const int step = (density >= 2) ? int(density) : 1;
+
+  int x0 = 0, x1 = area.nx, y0 = 0, y1 = area.ny;
+  if (!outside) {
+    const float mx = (gx1 - gx0) * margin + step, my = (gy1 - gy0) * margin + step;
+    x0 = std::max(0, int(std::floor(gx0 - mx)));
+    x1 = std::min(area.nx, int(std::ceil(gx1 + mx)));
+    y0 = std::max(0, int(std::floor(gy0 - my)));
+    y1 = std::min(area.ny, int(std::ceil(gy1 + my)));
+    if (x0 >= x1 || y0 >= y1)
+      return false; // not visible
+  }
+
+  // align to the decimation, so that pixels stay the same when panning
+  x0 -= x0 % step;
+  y0 -= y0 % step;
+
+  w.x0 = x0;
+  w.y0 = y0;
+  w.nx = x1 - x0;
+  w.ny = y1 - y0;
+  w.step = step;
+  return step > 1 || w.nx < area.nx || w.ny < area.ny;
+}
+
+bool Sat::coversView(const Area& view, int width, int height) const
+{
+  if (!reduced())
+    return true;
+
+  Window w;
+  if (!findWindow(view, width, height, 0, w))
+    return false;
+  return window.step <= w.step
+      && window.x0 <= w.x0 && window.x0 + window.nx >= w.x0 + w.nx
+      && window.y0 <= w.y0 && window.y0 + window.ny >= w.y0 + w.ny;
 }
 
 void Sat::cleanup()
@@ -521,6 +643,9 @@ void Sat::cleanup()
 
   area.nx = 0;
   area.ny = 0;
+  window = Window();
+  imagearea.nx = 0;
+  imagearea.ny = 0;
 
   delete[] image;
   image = 0;
@@ -528,6 +653,8 @@ void Sat::cleanup()
   for (int i=0; i<maxch; i++) {
     delete[] rawimage[i];
     rawimage[i]= 0;
+    delete[] fullimage[i];
+    fullimage[i]= 0;
   }
 
   for(int j=0; j<3; j++) {
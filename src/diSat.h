@@ -64,6 +64,20 @@ public:
 
   GridArea area;            ///< Satellite area/projection
 
+  /// part of area read into rawimage, see findWindow
+  struct Window {
+    int x0, y0;  ///< first column and row, rows counted from the top as in the files
+    int nx, ny;  ///< number of columns and rows, 0 for the full image
+    int step;    ///< only every step'th column and row is read
+    Window() : x0(0), y0(0), nx(0), ny(0), step(1) { }
+  };
+  Window window;      ///< part of area in rawimage and image
+  GridArea imagearea; ///< area/projection of rawimage and image
+
+  Area viewArea;  ///< map area for choosing window, not used if viewWidth is 0
+  int viewWidth;  ///< map width in pixels
+  int viewHeight; ///< map height in pixels
+
   miutil::miTime time;          ///< valid time
   std::string annotation;  ///< annotation string
   std::string plotname;    ///< unique plotname
@@ -119,6 +133,7 @@ public:
   int rgbindex[3];      ///< channelindex for rgb-operations
   unsigned char* rawimage[maxch]; ///< raw image
   float* origimage[3]; ///< original image for temperature display images
+  unsigned char* fullimage[maxch]; ///< full resolution raw images for values, if rawimage is reduced
   int rawchannels[maxch];         ///< raw images channel numbers
 
   int calibidx;         ///< channel to use in values routine
@@ -171,6 +186,22 @@ public:
   void setAnnotation();
   void setPlotName();
   void setArea();
+
+  /// true if rawimage and image contain only a part of area, or are decimated
+  bool reduced() const
+    { return window.nx > 0; }
+
+  /*! Find the part of area and the decimation needed to plot view with
+   *  width x height pixels. The window is extended by margin times its
+   *  size on each side. Returns false if the full image is needed.
+   */
+  bool findWindow(const Area& view, int width, int height, float margin, Window& w) const;
+
+  /// true if the current window has all data needed to plot view
+  bool coversView(const Area& view, int width, int height) const;
+
+private:
+  void setImageArea();
 };
 
 #endif
@@ -0,0 +1,174 @@
+#include "diSatHeaderCache.h"
+
+#include "util/binary_io.h"
+#include "util/mapped_file.h"
+
+#include <cstring>
+
+#include <sys/stat.h>
+
+#define MILOGGER_CATEGORY "diana.SatHeaderCache"
+#include <miLogger/miLogging.h>
+
+namespace {
+
+const char MAGIC[8] = { 'D', 'I', 'S', 'A', 'T', 'H', '0', '1' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//! cache files not used for this long are removed
+const time_t MAX_FILE_AGE = 7*24*3600;
+
+typedef diutil::BinaryWriter Writer;
+typedef diutil::BinaryReader Reader;
+
+void putTime(Writer& w, const miutil::miTime& t)
+{
+  if (t.undef()) {
+    w.i64(0);
+  } else {
+    w.i64(((((t.year() * 100LL + t.month()) * 100 + t.day()) * 100 + t.hour()) * 100 + t.min()) * 100 + t.sec());
+  }
+}
+
+bool getTime(Reader& r, miutil::miTime& t)
+{
+  int64_t v;
+  if (!r.i64(v))
+    return false;
+  if (v == 0) {
+    t = miutil::miTime();
+  } else {
+    t = miutil::miTime(v / 10000000000LL, (v / 100000000) % 100, (v / 1000000) % 100,
+        (v / 10000) % 100, (v / 100) % 100, v % 100);
+  }
+  return true;
+}
+
+} // namespace
+
+SatHeaderCache::SatHeaderCache()
+  : files_("satheader-")
+{
+}
+
+// static
+SatHeaderCache& SatHeaderCache::instance()
+{
+  static SatHeaderCache cache;
+  return cache;
+}
+
+void SatHeaderCache::setDirectory(const std::string& directory)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.setDirectory(directory, MAX_FILE_AGE);
+}
+
+// static
+bool SatHeaderCache::stamp(const std::string& filename, Entry& entry)
+{
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0)
+    return false;
+  entry.size = st.st_size;
+  entry.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  return true;
+}
+
+bool SatHeaderCache::load(const std::string& id, Entries& entries)
+{
+  std::string cf;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!files_.enabled())
+      return false;
+    cf = files_.path(id);
+  }
+
+  const diutil::MappedFile mapped(cf);
+  if (!mapped.data())
+    return false;
+  if (!read(mapped.data(), mapped.size(), id, entries)) {
+    METLIBS_LOG_DEBUG("cache file '" << cf << "' is outdated or broken");
+    return false;
+  }
+  METLIBS_LOG_DEBUG("read " << entries.size() << " headers from cache file '" << cf << "'");
+
+  // mark as used, see setDirectory
+  diutil::CacheDirectory::touch(cf);
+  return true;
+}
+
+void SatHeaderCache::store(const std::string& id, const Entries& entries)
+{
+  std::string cf;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!files_.enabled())
+      return;
+    cf = files_.path(id);
+  }
+  diutil::CacheDirectory::write(cf, write(id, entries));
+}
+
+// static
+std::string SatHeaderCache::write(const std::string& id, const Entries& entries)
+{
+  Writer w;
+  w.put(MAGIC, sizeof(MAGIC));
+  w.u32(BYTE_ORDER_MARK);
+  w.str(id);
+  w.u32(entries.size());
+  for (const Entries::value_type& e : entries) {
+    w.str(e.first);
+    w.i64(e.second.size);
+    w.i64(e.second.mtime);
+    const Header& h = e.second.header;
+    putTime(w, h.time);
+    w.u32(h.palette ? 1 : 0);
+    w.u32(h.channel.size());
+    for (const std::string& ch : h.channel)
+      w.str(ch);
+  }
+  return w.buffer;
+}
+
+// static
+bool SatHeaderCache::read(const char* data, size_t size, const std::string& id, Entries& entries)
+{
+  Reader r(data, size);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t byteOrder;
+  std::string fileId;
+  uint32_t n;
+  if (!r.get(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+      || !r.u32(byteOrder) || byteOrder != BYTE_ORDER_MARK
+      || !r.str(fileId) || fileId != id || !r.u32(n))
+    return false;
+
+  Entries ee;
+  for (uint32_t i = 0; i < n; ++i) {
+    std::string name;
+    int64_t fsize, fmtime;
+    uint32_t palette, nch;
+    Header h;
+    if (!r.str(name) || !r.i64(fsize) || !r.i64(fmtime)
+        || !getTime(r, h.time) || !r.u32(palette) || !r.u32(nch))
+      return false;
+    h.palette = (palette != 0);
+    h.channel.resize(nch);
+    for (std::string& ch : h.channel) {
+      if (!r.str(ch))
+        return false;
+    }
+    Entry& e = ee[name];
+    e.size = fsize;
+    e.mtime = fmtime;
+    std::swap(e.header, h);
+  }
+  if (!r.atEnd())
+    return false;
+  std::swap(entries, ee);
+  return true;
+}
@@ -0,0 +1,77 @@
+#ifndef DISATHEADERCACHE_H
+#define DISATHEADERCACHE_H
+
+#include "util/cache_directory.h"
+
+#include <puTools/miTime.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+  \brief Cache of satellite and radar file headers
+
+  Reading the headers of all image files of a product requires opening
+  each file, which is slow for archives with many files, or on network
+  mounts. The header information used for the file lists (time, palette
+  flag and channels) is written to a binary file per product in the cache
+  directory, so that files that did not change are not opened again.
+
+  Entries are identified by file path, file size and modification time.
+  The id of a cache file is made from the file patterns and the reader
+  parameters of the product.
+ */
+class SatHeaderCache {
+public:
+  struct Header {
+    miutil::miTime time;
+    bool palette;
+    std::vector<std::string> channel;
+    Header()
+      : palette(false) { }
+  };
+
+  struct Entry {
+    long long size;
+    long long mtime; //!< nanoseconds
+    Header header;
+    Entry()
+      : size(0), mtime(0) { }
+  };
+
+  //! entries by file path
+  typedef std::unordered_map<std::string, Entry> Entries;
+
+  static SatHeaderCache& instance();
+
+  /*! Set the directory for the cache files, creating it if necessary.
+   *  Files not used for a week are removed. With an empty directory,
+   *  nothing is cached.
+   */
+  void setDirectory(const std::string& directory);
+
+  //! set size and mtime for a file, return false if it cannot be found
+  static bool stamp(const std::string& filename, Entry& entry);
+
+  //! read the entries for a product, return false if not found
+  bool load(const std::string& id, Entries& entries);
+
+  void store(const std::string& id, const Entries& entries);
+
+  //! serialize entries in the binary format of the cache files
+  static std::string write(const std::string& id, const Entries& entries);
+
+  //! read entries in the binary format, return false if the data are broken or for a different id
+  static bool read(const char* data, size_t size, const std::string& id, Entries& entries);
+
+private:
+  SatHeaderCache();
+
+private:
+  std::mutex mutex_;
+  diutil::CacheDirectory files_;
+};
+
+#endif // DISATHEADERCACHE_H
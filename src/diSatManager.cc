@@ -36,9 +36,12 @@
 #include "diSatManager.h"
 
 #include "diSatPlot.h"
+#include "diPlot.h"
 #include "diKVListPlotCommand.h"
+#include "diLocalSetupParser.h"
 #include "diUtilities.h"
 #include "miSetupParser.h"
+#include "util/thread_pool.h"
 #include "util/was_enabled.h"
 
 #include <puTools/miStringFunctions.h>
@@ -52,8 +55,12 @@
 #include <diGEOtiff.h>
 #endif
 
+#include <algorithm>
 #include <fstream>
+#include <mutex>
 #include <set>
+#include <sstream>
+#include <unordered_map>
 
 #define MILOGGER_CATEGORY "diana.SatManager"
 #include <miLogger/miLogging.h>
@@ -62,6 +69,10 @@ using namespace miutil;
 
 static const std::vector<SatFileInfo> emptyfile;
 
+#ifdef HDF5FILE
+static std::mutex hdf5Mutex;
+#endif
+
 SatManager::SatManager()
 {
   //new satellite files read
@@ -247,8 +258,25 @@ void SatManager::getDataAnnotations(std::vector<std::string>& anno)
 
 void SatManager::plot(DiGLPainter* gl, Plot::PlotOrder porder)
 {
-  for (size_t i = 0; i < vsp.size(); i++)
+  for (size_t i = 0; i < vsp.size(); i++) {
+    if (porder == Plot::SHADE_BACKGROUND)
+      updateWindow(vsp[i]);
     vsp[i]->plot(gl, porder);
+  }
+}
+
+void SatManager::updateWindow(SatPlot *satp)
+{
+  // read again if only a part of the image has been read, and the map
+  // has been zoomed or moved outside this part
+  const Sat* satdata = satp->satdata;
+  if (!satp->isEnabled() || !satdata || !satdata->approved || !satdata->reduced())
+    return;
+  const StaticPlot* sp = satp->getStaticPlot();
+  if (satdata->coversView(sp->getMapArea(), sp->getPhysWidth(), sp->getPhysHeight()))
+    return;
+  METLIBS_LOG_DEBUG("map not covered by image window, reading again");
+  setData(satp, true);
 }
 
 void SatManager::clear()
@@ -284,7 +312,7 @@ bool SatManager::getSatArea(Area& a) const
   return true;
 }
 
-bool SatManager::setData(SatPlot *satp)
+bool SatManager::setData(SatPlot *satp, bool reread)
 {
   //  PURPOSE:s   Read data from file, and init. SatPlot
   METLIBS_LOG_SCOPE();
@@ -314,17 +342,16 @@ bool SatManager::setData(SatPlot *satp)
   //Read header if not opened
   subProdInfo& spi = Prod[satdata->satellite][satdata->filetype];
   SatFileInfo& fInfo = spi.file[index];
-  if (!fInfo.opened) {
-    readHeader(fInfo, spi.channel);
-    fInfo.opened = true;
-  }
+  if (!fInfo.opened)
+    readHeaders(spi, std::vector<SatFileInfo*>(1, &fInfo));
 
   //read new file if :
   // 1) satdata contains no images
   // 2) different channels requested
   // 3) requested file different from the actual file
+  // 4) the map is not covered by the part of the image read before
   bool readfresh= (satdata->noimages() || satdata->channelschanged
-      || fInfo.name != satdata->actualfile);
+      || fInfo.name != satdata->actualfile || reread);
 
   // remember filename for later checks
   satdata->actualfile= fInfo.name;
@@ -344,6 +371,18 @@ bool SatManager::setData(SatPlot *satp)
       return false;
     }
     satdata->cleanup();
+
+    //read only the part of the image needed for the map, except for
+    //mosaics and IR+V which combine several files
+    const StaticPlot* sp = satp->getStaticPlot();
+    if (!satdata->mosaic && satdata->plotChannels != "IR+V" && sp->hasPhysSize()) {
+      satdata->viewArea = sp->getMapArea();
+      satdata->viewWidth = sp->getPhysWidth();
+      satdata->viewHeight = sp->getPhysHeight();
+    } else {
+      satdata->viewWidth = satdata->viewHeight = 0;
+    }
+
     if (!readSatFile(satdata, satptime)) {
       METLIBS_LOG_ERROR("Failed readSatFile");
       return false;
@@ -494,8 +533,8 @@ void SatManager::setPalette(Sat* satdata, SatFileInfo &fInfo)
   //  PURPOSE:   uses palette to put data from image into satdata.image
   METLIBS_LOG_SCOPE(miTime::nowTime());
 
-  int nx=satdata->area.nx;
-  int ny=satdata->area.ny;
+  int nx=satdata->imagearea.nx;
+  int ny=satdata->imagearea.ny;
   int size =nx*ny;
 
   // image(RGBA)
@@ -543,8 +582,8 @@ void SatManager::setRGB(Sat* satdata)
   // RGB stretch is performed in order to improve the contrast
 	METLIBS_LOG_SCOPE(satdata->filetype);
 
-	int nx=satdata->area.nx;
-	int ny=satdata->area.ny;
+	int nx=satdata->imagearea.nx;
+	int ny=satdata->imagearea.ny;
 	int size =nx*ny;
 
 	if (size==0)
@@ -870,20 +909,20 @@ void SatManager::getMosaicfiles(Sat* satdata, const miutil::miTime& t)
   }
 }
 
-bool SatManager::readHeader(SatFileInfo &file, std::vector<std::string> &channel)
+// static
+bool SatManager::readHeader(SatFileInfo &file)
 {
   METLIBS_LOG_SCOPE(LOGVAL(file.name) << LOGVAL(file.formattype));
 
   if (file.formattype=="mitiff") {
-    MItiff::readMItiffHeader(file);
+    return MItiff::readMItiffHeader(file);
   }
 
 #ifdef HDF5FILE
   if (file.formattype=="hdf5" || file.formattype=="hdf5-standalone") {
-#ifdef DEBUGPRINT
-    METLIBS_LOG_DEBUG("readHDF5Header");
-#endif
-    HDF5::readHDF5Header(file);
+    // the hdf5 library is not thread-safe
+    std::lock_guard<std::mutex> lock(hdf5Mutex);
+    return HDF5::readHDF5Header(file);
   }
 #endif
 
@@ -892,13 +931,78 @@ bool SatManager::readHeader(SatFileInfo &file, std::vector<std::string> &channel
 #ifdef DEBUGPRINT
     METLIBS_LOG_DEBUG("reading geotiff "<<file.name);
 #endif
-    GEOtiff::readGEOtiffHeader(file);
-#ifdef DEBUGPRINT
-    METLIBS_LOG_DEBUG("finished reading geotiff "<<file.name);
-#endif
+    return GEOtiff::readGEOtiffHeader(file);
   }
 #endif
 
+  return false;
+}
+
+void SatManager::readHeaders(subProdInfo &subp, const std::vector<SatFileInfo*> &files)
+{
+  METLIBS_LOG_SCOPE(LOGVAL(files.size()));
+  if (files.empty())
+    return;
+
+  if (subp.headersId.empty()) {
+    std::ostringstream id;
+    for (const std::string& pattern : subp.pattern)
+      id << pattern << '\n';
+    id << subp.formattype << '\n' << subp.metadata << '\n' << subp.channelinfo
+       << '\n' << subp.paletteinfo << '\n' << subp.hdf5type;
+    subp.headersId = id.str();
+    SatHeaderCache::instance().load(subp.headersId, subp.headers);
+  }
+
+  // look up cached headers and read the others in parallel; headers
+  // is only modified after the parallel loop
+  std::vector<SatHeaderCache::Entry> entries(files.size());
+  std::vector<char> found(files.size(), 0), ok(files.size(), 0);
+  const SatHeaderCache::Entries& headers = subp.headers;
+  diutil::parallel_for(0, files.size(), 1, [&](size_t i0, size_t i1) {
+    for (size_t i = i0; i < i1; ++i) {
+      SatFileInfo& file = *files[i];
+      SatHeaderCache::Entry& e = entries[i];
+      if (!SatHeaderCache::stamp(file.name, e))
+        continue;
+      SatHeaderCache::Entries::const_iterator it = headers.find(file.name);
+      if (it != headers.end() && it->second.size == e.size && it->second.mtime == e.mtime) {
+        e.header = it->second.header;
+        found[i] = ok[i] = 1;
+        continue;
+      }
+      file.channel.clear();
+      if (readHeader(file)) {
+        e.header.time = file.time;
+        e.header.palette = file.palette;
+        e.header.channel = file.channel;
+        ok[i] = 1;
+      }
+    }
+  });
+
+  bool modified = false;
+  for (size_t i = 0; i < files.size(); ++i) {
+    SatFileInfo& file = *files[i];
+    if (found[i]) {
+      const SatHeaderCache::Header& h = entries[i].header;
+      if (!h.time.undef())
+        file.time = h.time;
+      file.palette = h.palette;
+      file.channel = h.channel;
+    } else if (ok[i]) {
+      std::swap(subp.headers[file.name], entries[i]);
+      modified = true;
+    }
+    addSetupChannels(file, subp.channel);
+    file.opened = true;
+  }
+  if (modified)
+    SatHeaderCache::instance().store(subp.headersId, subp.headers);
+}
+
+void SatManager::addSetupChannels(SatFileInfo &file, const std::vector<std::string> &channel)
+{
   //compare channels from setup and channels from file
   for (unsigned int k=0; k<channel.size(); k++) {
     if (channel[k]=="IR+V") {
@@ -939,8 +1043,6 @@ bool SatManager::readHeader(SatFileInfo &file, std::vector<std::string> &channel
     }
 
   }
-
-  return true;
 }
 
 const std::vector<std::string>& SatManager::getChannels(const std::string &satellite,
@@ -949,15 +1051,11 @@ const std::vector<std::string>& SatManager::getChannels(const std::string &satel
   if (index<0 || index>=int (Prod[satellite][file].file.size()))
     return Prod[satellite][file].channel;
 
-  if (Prod[satellite][file].file[index].opened)
-    return Prod[satellite][file].file[index].channel;
-  if (readHeader(Prod[satellite][file].file[index],
-      Prod[satellite][file].channel)) {
-    Prod[satellite][file].file[index].opened=true;
-    return Prod[satellite][file].file[index].channel;
-  }
-
-  return Prod[satellite][file].channel;
+  subProdInfo& subp = Prod[satellite][file];
+  SatFileInfo& fInfo = subp.file[index];
+  if (!fInfo.opened)
+    readHeaders(subp, std::vector<SatFileInfo*>(1, &fInfo));
+  return fInfo.channel;
 }
 
 void SatManager::listFiles(subProdInfo &subp)
@@ -971,99 +1069,136 @@ void SatManager::listFiles(subProdInfo &subp)
   fileListChanged = false;
 
   //if not in archiveMode and archive files are included, clear list
-  if (!useArchive && subp.archiveFiles)
+  if (!useArchive && subp.archiveFiles) {
     subp.file.clear();
+    subp.watches.clear();
+  }
+  subp.watches.resize(subp.pattern.size());
 
   for (unsigned int j=0; j<subp.pattern.size() ;j++) {
     //skip archive files if not in archive mode
     if (subp.archive[j] && !useArchive)
       continue;
 
-    const diutil::string_v matches = diutil::glob(subp.pattern[j]);
-    if (matches.empty()) {
+    // only files added, changed or removed since the last update need to be checked
+    diutil::FileWatch_p& watch = subp.watches[j];
+    const bool relist = (!watch || subp.file.empty());
+    if (!watch)
+      watch = std::make_shared<diutil::FileWatch>(subp.pattern[j]);
+    diutil::FileWatch::Changes changes;
+    watch->update(&changes);
+    if (watch->files().empty()) {
       METLIBS_LOG_ERROR("No files found! " << subp.pattern[j]);
     }
-    for (diutil::string_v::const_reverse_iterator it = matches.rbegin(); it != matches.rend(); ++it) {
-      //remember that archive files are read
-      if (subp.archive[j])
-        subp.archiveFiles=true;
-      SatFileInfo ft;
-      ft.name = *it;
+    if (relist) {
+      changes = diutil::FileWatch::Changes();
+      changes.added = watch->fileNames();
+    }
+    if (changes.empty())
+      continue;
+
+    if (!changes.removed.empty()) {
+      const std::set<std::string> removed(changes.removed.begin(), changes.removed.end());
+      const size_t before = subp.file.size();
+      subp.file.erase(std::remove_if(subp.file.begin(), subp.file.end(),
+              [&removed](const SatFileInfo& fi) { return removed.count(fi.name) > 0; }),
+          subp.file.end());
+      if (subp.file.size() != before)
+        fileListChanged = true;
+      for (const std::string& name : changes.removed)
+        subp.headers.erase(name);
+    }
+
+    std::unordered_map<std::string, size_t> listed;
+    for (size_t i = 0; i < subp.file.size(); ++i)
+      listed.insert(std::make_pair(subp.file[i].name, i));
+
+    //files changed since last update, read headers
+    std::vector<std::string> newfiles;
+    std::vector<size_t> changedIndex;
+    std::vector<SatFileInfo> changedFiles;
+    for (const std::string& name : changes.changed) {
+      std::unordered_map<std::string, size_t>::const_iterator p = listed.find(name);
+      if (p == listed.end()) {
+        newfiles.push_back(name);
+        continue;
+      }
+      changedIndex.push_back(p->second);
+      changedFiles.push_back(SatFileInfo());
+      SatFileInfo& ft = changedFiles.back();
+      ft.name = name;
       ft.formattype= subp.formattype;
       ft.metadata = subp.metadata;
       ft.proj4string = subp.proj4string;
       ft.channelinfo = subp.channelinfo;
       ft.paletteinfo = subp.paletteinfo;
       ft.hdf5type = subp.hdf5type;
+    }
+    if (!changedFiles.empty()) {
+      std::vector<SatFileInfo*> toread;
+      for (SatFileInfo& ft : changedFiles)
+        toread.push_back(&ft);
+      readHeaders(subp, toread);
+    }
+    std::vector<char> erase(subp.file.size(), 0);
+    for (size_t i = 0; i < changedFiles.size(); ++i) {
+      //has time changed in header since last update ?
+      if (changedFiles[i].time != subp.file[changedIndex[i]].time) {
+        //erase file, then put back in list
+        erase[changedIndex[i]] = 1;
+        newfiles.push_back(changedFiles[i].name);
+      }
+    }
+    for (const std::string& name : changes.added) {
+      if (!listed.count(name))
+        newfiles.push_back(name);
+    }
+    if (newfiles.empty())
+      continue;
 
-      bool newfile = true;
-
-      //HK ??? forandret kode for at oppdatering skal virke
-      std::vector<SatFileInfo>::iterator p = subp.file.begin();
-      for (; p!=subp.file.end(); p++) {
-        if (ft.name == p->name) {
-          newfile=false;
-          //find out when this file was last updated
-          unsigned long modtime = _modtime(ft.name);
-          if (modtime >= subp.updateTime) {
-            //special case - file has been changed since last updated
-            //but read header
-            //	     METLIBS_LOG_DEBUG("SPECIAL CASE"<<ft.name);
-            ft.formattype= subp.formattype;
-            ft.metadata = subp.metadata;
-            ft.proj4string = subp.proj4string;
-            ft.channelinfo = subp.channelinfo;
-            ft.paletteinfo = subp.paletteinfo;
-            ft.hdf5type = subp.hdf5type;
-            readHeader(ft, subp.channel);
-            ft.opened = true;
-            //has time changed in header since last update ?
-            if (ft.time != p->time) {
-              //erase file, then put back in list
-              subp.file.erase(p);
-              newfile=true;
-            }
-          }
-          break;
-        }
+    std::vector<SatFileInfo> merged;
+    merged.reserve(subp.file.size() + newfiles.size());
+    std::set<miTime> times;
+    for (size_t i = 0; i < subp.file.size(); ++i) {
+      if (!erase[i]) {
+        merged.push_back(subp.file[i]);
+        times.insert(subp.file[i].time);
       }
+    }
 
-      if (newfile) {
-        fileListChanged = true;
+    //remember that archive files are read
+    if (subp.archive[j])
+      subp.archiveFiles=true;
+    fileListChanged = true;
 
-        //try to find time from filename
-        METLIBS_LOG_DEBUG(ft.name << " " << ft.time);
-        if (subp.filter[j].getTime(ft.name, ft.time) || true) {
-          METLIBS_LOG_DEBUG(ft.name << " Failed");
-
-          ft.opened = false;
-        } else {
-          //Open file if time not found from filename
-          ft.formattype= subp.formattype;
-          ft.metadata = subp.metadata;
-          ft.proj4string = subp.proj4string;
-          ft.channelinfo = subp.channelinfo;
-          ft.paletteinfo = subp.paletteinfo;
-          ft.hdf5type = subp.hdf5type;
-          readHeader(ft, subp.channel);
-          ft.opened=true;
-        }
-        METLIBS_LOG_DEBUG(ft.time << " time");
-
-        //put it in the sorted list
-        //Check if filelist is empty
-        if (subp.file.empty())
-          subp.file.push_back(ft);
-        else {
-          std::vector<SatFileInfo>::iterator p = subp.file.begin();
-          while (p!=subp.file.end() && p->time>ft.time)
-            p++;
-          //skip archive files which are already in list
-          if (!subp.archive[j] || p->time != ft.time)
-            subp.file.insert(p, ft);
-        }
-      }
+    std::vector<SatFileInfo> added;
+    for (std::vector<std::string>::const_reverse_iterator it = newfiles.rbegin(); it != newfiles.rend(); ++it) {
+      SatFileInfo ft;
+      ft.name = *it;
+      ft.formattype= subp.formattype;
+      ft.metadata = subp.metadata;
+      ft.proj4string = subp.proj4string;
+      ft.channelinfo = subp.channelinfo;
+      ft.paletteinfo = subp.paletteinfo;
+      ft.hdf5type = subp.hdf5type;
+
+      //try to find time from filename, files are opened when needed
+      subp.filter[j].getTime(ft.name, ft.time);
+      ft.opened = false;
+      METLIBS_LOG_DEBUG(ft.name << " " << ft.time);
+
+      //skip archive files which are already in list
+      if (subp.archive[j] && !times.insert(ft.time).second)
+        continue;
+      added.push_back(ft);
     }
+
+    //put new files in the list sorted by time, newest first; new files
+    //go before old files with the same time
+    merged.insert(merged.begin(), added.rbegin(), added.rend());
+    std::stable_sort(merged.begin(), merged.end(),
+        [](const SatFileInfo& a, const SatFileInfo& b) { return a.time > b.time; });
+    std::swap(subp.file, merged);
   }
 
   //save time of last update
@@ -1159,12 +1294,35 @@ std::vector<SatValues> SatManager::showValues(float x, float y)
   std::vector<SatValues> satval;
   for (size_t i = 0; i < vsp.size(); i++) {
     if (vsp[i]->isEnabled()) {
+      readFullImage(vsp[i]->satdata);
       vsp[i]->values(x, y, satval);
     }
   }
   return satval;
 }
 
+void SatManager::readFullImage(Sat* satdata)
+{
+  // values are taken from the full resolution image, also if only a part
+  // of the image has been read for plotting
+  if (!satdata || !satdata->approved || !satdata->reduced() || satdata->fullimage[0])
+    return;
+
+  METLIBS_LOG_SCOPE(LOGVAL(satdata->actualfile));
+  Sat sd;
+  for (int j=0; j<Sat::maxch; j++)
+    sd.index[j] = satdata->index[j];
+  sd.no = satdata->no;
+  sd.proj_string = satdata->proj_string;
+  if (!MItiff::readMItiff(satdata->actualfile, sd)
+      || sd.area.nx != satdata->area.nx || sd.area.ny != satdata->area.ny)
+    return;
+  for (int j=0; j<Sat::maxch; j++) {
+    satdata->fullimage[j] = sd.rawimage[j];
+    sd.rawimage[j] = 0;
+  }
+}
+
 std::vector<std::string> SatManager::getSatnames()
 {
   std::vector<std::string> satnames;
@@ -1217,12 +1375,11 @@ std::vector<miTime> SatManager::getSatTimes(bool updateFileList, bool openFiles)
     }
 
     if (openFiles) {
-      int n=subp.file.size();
-      for (int i=0; i<n; i++)
-        if (!subp.file[i].opened) {
-          readHeader(subp.file[i], subp.channel);
-          subp.file[i].opened=true;
-        }
+      std::vector<SatFileInfo*> unopened;
+      for (SatFileInfo& fi : subp.file)
+        if (!fi.opened)
+          unopened.push_back(&fi);
+      readHeaders(subp, unopened);
     }
 
     int nf= subp.file.size();
@@ -1302,6 +1459,10 @@ bool SatManager::parseSetup()
   //remove old setup info
   Prod.clear();
 
+  const std::string& cachedir = LocalSetupParser::basicValue("cachedir");
+  if (!cachedir.empty())
+    SatHeaderCache::instance().setDirectory(cachedir + "/sat");
+
   const std::string sat_name = "IMAGE";
   std::vector<std::string> sect_sat;
 
@@ -33,6 +33,8 @@
 #include "diSat.h"
 #include "diCommonTypes.h"
 #include "diPlotCommand.h"
+#include "diSatHeaderCache.h"
+#include "util/file_watcher.h"
 
 #include <puCtools/stat.h>
 #include <puTools/TimeFilter.h>
@@ -59,6 +61,8 @@ public:
     std::vector<std::string> pattern;
     std::vector<bool> archive;
     std::vector<miutil::TimeFilter> filter;
+    //file lists for each pattern, created by listFiles
+    std::vector<diutil::FileWatch_p> watches;
     std::string formattype; //holds mitiff or hdf5
     std::string metadata;
     std::string proj4string;
@@ -66,6 +70,9 @@ public:
     std::string paletteinfo;
     int hdf5type;
     std::vector<SatFileInfo> file;
+    //headers read from files, and the id for SatHeaderCache (empty if not loaded)
+    SatHeaderCache::Entries headers;
+    std::string headersId;
     std::vector<std::string> channel;
     std::vector<Colour> colours;
     // HK variable to tell whether this list has been updated since
@@ -102,7 +109,10 @@ private:
   void calcRGBstrech(unsigned char *image, const int& size, const float& cut);
   void setPalette(Sat* satdata, SatFileInfo &);
   void listFiles(subProdInfo &subp);
-  bool readHeader(SatFileInfo &, std::vector<std::string> &);
+  static bool readHeader(SatFileInfo &);
+  void addSetupChannels(SatFileInfo &, const std::vector<std::string> &);
+  //read headers of files in subp, using the header cache, in parallel
+  void readHeaders(subProdInfo &subp, const std::vector<SatFileInfo*> &files);
 
   bool _isafile(const std::string name);
   unsigned long _modtime(const std::string fname);
@@ -122,7 +132,9 @@ private:
 
   bool fileListChanged;
 
-  bool setData(SatPlot *satp);
+  bool setData(SatPlot *satp, bool reread=false);
+  void updateWindow(SatPlot *satp);
+  void readFullImage(Sat* satdata);
   int getFileName(Sat* satdata, std::string &);
   int getFileName(Sat* satdata, const miutil::miTime&);
 
@@ -136,10 +136,11 @@ void SatPlot::plot(DiGLPainter* gl, PlotOrder porder)
 
 void SatPlot::rasterPixels(int n, const diutil::PointD &xy0, const diutil::PointD &dxy, QRgb* pixels)
 {
-  const int nx = satdata->area.nx, ny = satdata->area.ny;
+  const GridArea& ia = satdata->imagearea;
+  const int nx = ia.nx, ny = ia.ny;
 
-  const diutil::PointD fxy0(satdata->area.R().x1, satdata->area.R().y1);
-  const diutil::PointD res(satdata->area.resolutionX, satdata->area.resolutionY);
+  const diutil::PointD fxy0(ia.R().x1, ia.R().y1);
+  const diutil::PointD res(ia.resolutionX, ia.resolutionY);
   diutil::PointD ixy = (xy0 - fxy0) / res, step = dxy/res;
   int li = -1, lx = -1, ly = -1;
   for (int i=0; i<n; ++i, ixy += step) {
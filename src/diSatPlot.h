@@ -67,7 +67,7 @@ protected:
   StaticPlot* rasterStaticPlot() override
     { return getStaticPlot(); }
   const GridArea& rasterArea() override
-    { return satdata->area; }
+    { return satdata->imagearea; }
 
   void rasterPixels(int n, const diutil::PointD& xy0, const diutil::PointD& dxy, QRgb* pixels) override;
 
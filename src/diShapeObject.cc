@@ -36,8 +36,10 @@
 #include "diColourShading.h"
 #include "diGLPainter.h"
 #include "diPoint.h"
+#include "util/math_util.h"
 #include "util/polygon_util.h"
 #include "util/subprocess.h"
+#include "util/thread_pool.h"
 
 #include <diField/VcrossUtil.h> // minimize + maximize
 #include <puTools/miStringFunctions.h>
@@ -80,6 +82,13 @@ const float AREA_VISIBLE = 0.005f;
 
 const bool SKIP_SMALL = false;
 
+// simplification levels: the finest tolerance is this fraction of the
+// diagonal of all shapes, each following level has LEVEL_FACTOR times
+// the tolerance of the previous one
+const float LEVEL_FINEST = 1.0f / (1<<20);
+const float LEVEL_FACTOR = 4;
+const int LEVEL_COUNT = 7;
+
 
 bool extractParameterFromWKT(const QString& wkt, const QString& key, double& value)
 {
@@ -185,7 +194,6 @@ bool guessProjectionFromWKT(Projection& p, const QString& wkt)
 } // anonymous namespace
 
 ShapeObject::ShapeObject()
-  : mReductionScale(0, 0) // invalid
 {
   projection = Projection::geographic();
 
@@ -268,11 +276,63 @@ bool ShapeObject::changeProj()
   delete[] tx;
   delete[] ty;
 
-  mReductionScale = XY(0, 0); // invalid
+  makeLevels();
 
   return success;
 }
 
+void ShapeObject::makeLevels()
+{
+  METLIBS_LOG_TIME();
+
+  std::vector<Rectangle> rects;
+  rects.reserve(shapes.size());
+  Rectangle all(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+  for (const ShpData& s : shapes) {
+    rects.push_back(s.rect);
+    if (s.type() != SHPT_POINT && !s.contours.isEmpty()) {
+      vcross::util::minimize(all.x1, s.rect.x1);
+      vcross::util::minimize(all.y1, s.rect.y1);
+      vcross::util::maximize(all.x2, s.rect.x2);
+      vcross::util::maximize(all.y2, s.rect.y2);
+    }
+  }
+  mShapeTree.build(rects);
+
+  mLevelTolerances.assign(1, 0);
+  if (all.x1 < all.x2 || all.y1 < all.y2) {
+    float tolerance = LEVEL_FINEST * diutil::absval(all.width(), all.height());
+    for (int k = 0; k < LEVEL_COUNT; ++k, tolerance *= LEVEL_FACTOR)
+      mLevelTolerances.push_back(tolerance);
+  }
+  const size_t nlevels = mLevelTolerances.size() - 1;
+
+  // shapes are independent, and simplification is the slow part for large shapefiles
+  // FIXME this might turn nice polygons into self-intersecting polygons
+  diutil::parallel_for(0, shapes.size(), 16, [&](size_t i0, size_t i1) {
+    std::vector<float> importance;
+    for (size_t i = i0; i < i1; ++i) {
+      ShpData& s = shapes[i];
+      s.levels.clear();
+      if (s.type() == SHPT_POINT || nlevels == 0)
+        continue; // cannot reduce point data
+
+      s.levels.resize(nlevels);
+      for (int p = 0; p < s.contours.size(); ++p) {
+        const QPolygonF& part = s.contours.at(p);
+        diutil::simplificationImportance(part, importance);
+        for (size_t l = 0; l < nlevels; ++l) {
+          const QList<QPolygonF>& previous = s.contoursForLevel(l);
+          QPolygonF reduced = diutil::simplified(part, importance, mLevelTolerances[l+1]);
+          if (reduced.size() == previous.at(p).size())
+            reduced = previous.at(p); // share data with the previous level
+          s.levels[l] << reduced;
+        }
+      }
+    }
+  });
+}
+
 bool ShapeObject::read(const std::string& filename)
 {
   METLIBS_LOG_TIME(filename);
@@ -321,52 +381,32 @@ bool ShapeObject::read(const std::string& filename)
   return dbf_ok;
 }
 
-// FIXME this might turn nice polygons into self-intersecting polygons
-void ShapeObject::reduceForScale()
+size_t ShapeObject::levelForScale() const
 {
-  if (mReductionScale == getStaticPlot()->getPhysToMapScale())
-    return;
-  mReductionScale = getStaticPlot()->getPhysToMapScale();
-
-  METLIBS_LOG_TIME();
-  for (ShpData_v::iterator s = shapes.begin(); s != shapes.end(); ++s) {
-    if (s->type() == SHPT_POINT) {
-      // cannot reduce point data
-      continue;
-    }
-
-    s->reduced.clear();
-    for (int p=0; p < s->nparts(); p++) {
-      const QPolygonF& pp = s->contours.at(p);
-      QPolygonF ppr;
-      XY pp0 = getStaticPlot()->MapToPhys(fromQ(pp.at(0)));
-      ppr << pp.at(0);
-      for (int k = 1; k < pp.size()-1; k++) {
-        const XY ppk = getStaticPlot()->MapToPhys(fromQ(pp.at(k)));
-        const bool dx = (abs(pp0.x() - ppk.x()) >= MIN_PIXELS);
-        const bool dy = (abs(pp0.y() - ppk.y()) >= MIN_PIXELS);
-        if (dx || dy) {
-          ppr << pp.at(k);
-          pp0 = ppk;
-        }
-      }
-      ppr << pp.at(pp.size()-1);
-      s->reduced << ppr;
-    }
-  }
+  const XY& scale = getStaticPlot()->getPhysToMapScale();
+  const float pixel = MIN_PIXELS * std::min(scale.x(), scale.y());
+  size_t level = 0;
+  while (level+1 < mLevelTolerances.size() && mLevelTolerances[level+1] <= pixel)
+    level += 1;
+  return level;
 }
 
 void ShapeObject::plot(DiGLPainter* gl, PlotOrder porder)
 {
   METLIBS_LOG_TIME(LOGVAL(shapes.size()));
   makeColourmap();
+  const size_t level = levelForScale();
+  std::vector<size_t> visible;
+  mShapeTree.query(getStaticPlot()->getPlotSize(), visible);
+
   gl->PolygonMode(DiGLPainter::gl_FRONT_AND_BACK, DiGLPainter::gl_FILL);
-  for (ShpData& s : shapes) {
+  for (size_t i : visible) {
+    const ShpData& s = shapes[i];
     if (s.type() != SHPT_POLYGON)
       continue;
 
     gl->setLineStyle(s.colour, 2);
-    gl->drawPolygons(s.contours); // TODO optimize like in the other plot(...) function
+    gl->drawPolygons(s.contoursForLevel(level)); // TODO optimize like in the other plot(...) function
   }
 }
 
@@ -385,7 +425,7 @@ bool ShapeObject::plot(DiGLPainter* gl,
 {
   METLIBS_LOG_TIME(LOGVAL(shapes.size()) << LOGVAL(land) << LOGVAL(cont));
 
-  reduceForScale();
+  const size_t level = levelForScale();
 
   //also scale according to windowheight and width (standard is 500)
   const float scalefactor = getStaticPlot()->getPhysDiagonal();
@@ -401,15 +441,16 @@ bool ShapeObject::plot(DiGLPainter* gl,
 
   gl->PolygonMode(DiGLPainter::gl_FRONT_AND_BACK, DiGLPainter::gl_FILL);
 
+  std::vector<size_t> visible;
+  mShapeTree.query(areaX, visible);
+
   size_t item_count = 0;
   const size_t item_limit = 0;
-  for (ShpData_v::const_iterator s = shapes.begin(); s != shapes.end(); ++s) {
+  for (size_t i : visible) {
+    const ShpData_v::const_iterator s = shapes.begin() + i;
     if (s->contours.isEmpty())
       continue;
 
-    if (!areaX.intersects(s->rect))
-      continue;
-
     if (item_limit > 0 && ++item_count >= item_limit) {
       METLIBS_LOG_WARN("stop plotting after " << item_limit << " items");
       break;
@@ -435,16 +476,17 @@ bool ShapeObject::plot(DiGLPainter* gl,
       continue;
     }
 
-    // now it is either a polyline (arc) or a polygon; data are in s->reduced
+    // now it is either a polyline (arc) or a polygon
     if (!land && !cont)
       continue;
 
     if (SKIP_SMALL && fabs(s->rect.width()) < visibleW && fabs(s->rect.height()) < visibleH)
       continue;
 
+    const QList<QPolygonF>& reduced = s->contoursForLevel(level);
     QList<QPolygonF> lines, fills;
     for (int p=0; p < s->nparts(); p++) {
-      const QPolygonF& part =s->reduced.at(p);
+      const QPolygonF& part = reduced.at(p);
       if (part.size() < 2 || (!cont && land && part.size() < 3))
         continue;
 
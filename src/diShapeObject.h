@@ -31,6 +31,7 @@
 
 #include "diObjectPlot.h"
 #include "diGLPainter.h"
+#include "util/rectangle_tree.h"
 
 #include <QPolygonF>
 
@@ -66,7 +67,12 @@ private:
   bool readProjection(const std::string& shpfilename);
 
   Projection projection;
-  XY mReductionScale;
+
+  //! simplification tolerance in map coordinates for each level, level 0 is not simplified
+  std::vector<float> mLevelTolerances;
+
+  //! bounding boxes of all shapes
+  diutil::RectangleTree mShapeTree;
 
   typedef std::shared_ptr<SHPObject> SHPObject_p;
   struct ShpData {
@@ -93,13 +99,20 @@ private:
     Rectangle rect; //<! bounding box in map coordinates
     std::vector<Rectangle> partRects;  //<! bounding boxes of parts in map coordinates
 
-    QList<QPolygonF> reduced; //!< reprojected to map, and reduced for map scale
+    //! contours simplified with mLevelTolerances[1], [2], ...; empty for points
+    std::vector< QList<QPolygonF> > levels;
+
+    const QList<QPolygonF>& contoursForLevel(size_t level) const
+      { return (level == 0 || levels.empty()) ? contours : levels[level-1]; }
   };
   typedef std::vector<ShpData> ShpData_v;
   ShpData_v shapes;
 
-  //! reduce polygons by dropping segments that would be inside one pixel
-  void reduceForScale();
+  //! build simplified contours and the bounding box tree after reprojection
+  void makeLevels();
+
+  //! find the most simplified level with no visible difference at the current map scale
+  size_t levelForScale() const;
 
 public:
   ShapeObject();
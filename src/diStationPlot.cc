@@ -52,6 +52,9 @@ using namespace std;
 
 static std::string ddString[16]; // norwegian directions North, NorthNorthEast, NorthEast, EastNorthEast, etc.
 
+//! margin around the plot area in pixels, to plot images and text for stations just outside
+static const float PLOT_MARGIN = 100;
+
 //! distance in km
 static double distance(const miCoordinates& pos, const Station* s)
 {
@@ -220,10 +223,6 @@ StationPlot::StationPlot(const string& commondesc, const string& common,
 
 void StationPlot::init()
 {
-  // Add a default plot area.
-  StationArea area(-90.0, 90.0, -180.0, 180.0);
-  stationAreas.push_back(area);
-
   //coordinates to be plotted
   show();
   useImage = true;
@@ -248,7 +247,6 @@ StationPlot::~StationPlot()
     delete stations[i];
   }
   stations.clear();
-  stationAreas.clear();
 }
 
 void StationPlot::addStation(float lon, float lat, const std::string& newname,
@@ -281,9 +279,6 @@ void StationPlot::addStation(float lon, float lat, const std::string& newname,
 void StationPlot::addStation(Station* station)
 {
   stations.push_back(station);
-
-  // Add the station to the area tree.
-  stationAreas[0].addStation(station);
 }
 
 void StationPlot::plot(DiGLPainter* gl, PlotOrder zorder)
@@ -304,9 +299,10 @@ void StationPlot::plot(DiGLPainter* gl, PlotOrder zorder)
   map<Station::Status, vector<int> > selected; //index of selected stations for each status
   map<Station::Status, vector<int> > unselected; //index of unselected stations for each status
 
-  //first loop, only unselected stations
-  int n = stations.size();
-  for (int i = 0; i < n; i++) {
+  // only stations inside the plot area, in their original order
+  std::vector<size_t> inside;
+  stationsInRectangle(getStaticPlot()->getPlotSize(), PLOT_MARGIN, inside);
+  for (size_t i : inside) {
     if (!stations[i]->isVisible)
       continue;
     if (stations[i]->isSelected) {
@@ -497,38 +493,43 @@ bool StationPlot::changeProjection()
   METLIBS_LOG_SCOPE("Change projection to: "<< area << " wind might not be rotated");
 #endif
 
-  int npos = xplot.size();
+  stationTree.clear();
+
+  const size_t npos = xplot.size();
   if (npos == 0) {
     return false;
   }
 
-  float *xpos = new float[npos];
-  float *ypos = new float[npos];
-  for (int i = 0; i < npos; i++) {
+  for (size_t i = 0; i < npos; i++) {
     Station* s = stations[i];
-    xpos[i] = s->lon();
-    ypos[i] = s->lat();
+    xplot[i] = s->lon();
+    yplot[i] = s->lat();
   }
 
-  if (!getStaticPlot()->GeoToMap(npos, xpos, ypos)) {
+  if (!getStaticPlot()->GeoToMap(npos, &xplot[0], &yplot[0])) {
     METLIBS_LOG_ERROR("getPoints error");
-    delete[] xpos;
-    delete[] ypos;
     return false;
   }
-  for (int i = 0; i < npos; i++) {
-    xplot[i] = xpos[i];
-    yplot[i] = ypos[i];
-  }
 
-  delete[] xpos;
-  delete[] ypos;
+  // stations that cannot be projected have non-finite positions and are never found
+  std::vector<Rectangle> boxes;
+  boxes.reserve(npos);
+  for (size_t i = 0; i < npos; i++)
+    boxes.push_back(Rectangle(xplot[i], yplot[i], xplot[i], yplot[i]));
+  stationTree.build(boxes);
 
   // TODO rotate wind
 
   return true;
 }
 
+void StationPlot::stationsInRectangle(const Rectangle& r, float phys_radius, std::vector<size_t>& found) const
+{
+  const float dx = phys_radius * getStaticPlot()->getPhysToMapScaleX();
+  const float dy = phys_radius * getStaticPlot()->getPhysToMapScaleY();
+  stationTree.query(diutil::adjustedRectangle(r, dx, dy), found);
+}
+
 vector<Station*> StationPlot::getStations() const
 {
   return stations;
@@ -536,62 +537,61 @@ vector<Station*> StationPlot::getStations() const
 
 Station* StationPlot::stationAt(int phys_x, int phys_y)
 {
-  using diutil::square;
-
-  const float radius = 100;
-  vector<Station*> found = stationsAt(phys_x, phys_y, radius);
-
+  const vector<size_t> found = stationIndicesAt(phys_x, phys_y, 100, false);
   if (found.empty())
     return 0;
 
-  const XY pos = getStaticPlot()->PhysToMap(XY(phys_x, phys_y));
-
-  float min_r = square(radius * getStaticPlot()->getPhysToMapScaleX());
-  int min_i = 0;
-
   // Find the closest station to the point within a given radius.
-  for (unsigned int i = 0; i < found.size(); ++i) {
-    float sx = found[i]->lon(), sy = found[i]->lat();
-    if (getStaticPlot()->GeoToMap(1, &sx, &sy)) {
-      float r = square(pos.x() - sx) + square(pos.y() - sy);
-      if (r < min_r) {
-        min_r = r;
-        min_i = i;
-      }
+  const XY pos = getStaticPlot()->PhysToMap(XY(phys_x, phys_y));
+  size_t min_i = found.front();
+  float min_r = diutil::absval2(pos.x() - xplot[min_i], pos.y() - yplot[min_i]);
+  for (size_t i : found) {
+    const float r = diutil::absval2(pos.x() - xplot[i], pos.y() - yplot[i]);
+    if (r < min_r) {
+      min_r = r;
+      min_i = i;
     }
   }
 
-  return found[min_i];
+  return stations[min_i];
 }
 
 vector<Station*> StationPlot::stationsAt(int phys_x, int phys_y, float radius, bool useAllStations)
 {
-  const XY pos = getStaticPlot()->PhysToMap(XY(phys_x, phys_y));
-
-  float min_r = diutil::square(radius * getStaticPlot()->getPhysToMapScaleX());
-
+  const vector<size_t> found = stationIndicesAt(phys_x, phys_y, radius, useAllStations);
   vector<Station*> within;
+  within.reserve(found.size());
+  for (size_t i : found)
+    within.push_back(stations[i]);
+  return within;
+}
 
-  float geo_x = pos.x(), geo_y = pos.y();
-  if (getStaticPlot()->MapToGeo(1, &geo_x, &geo_y)) {
-    vector<Station*> found;
-    if (useAllStations) {
-      found = stations;
-    } else {
-      found = stationAreas[0].findStations(geo_y, geo_x, radius);
-    }
+vector<size_t> StationPlot::stationIndicesAt(int phys_x, int phys_y, float radius, bool useAllStations) const
+{
+  vector<size_t> within;
 
-    for (unsigned int i = 0; i < found.size(); ++i) {
-      if (found[i]->isVisible) {
-        float sx = found[i]->lon(), sy = found[i]->lat();
-        if (getStaticPlot()->GeoToMap(1, &sx, &sy)) {
-          float r = diutil::absval2(pos.x() - sx, pos.y() - sy);
-          if (r < min_r) {
-            within.push_back(found[i]);
-          }
-        }
-      }
-    }
+  const XY pos = getStaticPlot()->PhysToMap(XY(phys_x, phys_y));
+  const float min_r = diutil::square(radius * getStaticPlot()->getPhysToMapScaleX());
+
+  miCoordinates geo;
+  if (!useAllStations) {
+    float geo_x = pos.x(), geo_y = pos.y();
+    if (!getStaticPlot()->MapToGeo(1, &geo_x, &geo_y))
+      return within;
+    geo = miCoordinates(geo_x, geo_y);
+  }
+
+  vector<size_t> candidates;
+  stationsInRectangle(Rectangle(pos.x(), pos.y(), pos.x(), pos.y()), radius, candidates);
+  for (size_t i : candidates) {
+    const Station* s = stations[i];
+    if (!s->isVisible)
+      continue;
+    if (diutil::absval2(pos.x() - xplot[i], pos.y() - yplot[i]) >= min_r)
+      continue;
+    if (!useAllStations && distance(geo, s) >= radius)
+      continue;
+    within.push_back(i);
   }
 
   return within;
@@ -1277,126 +1277,3 @@ void StationPlot::plotWind(DiGLPainter* gl, int ii, float x, float y, bool class
 
   gl->Disable(DiGLPainter::gl_BLEND);
 }
-
-StationArea::StationArea(float minLat, float maxLat, float minLon, float maxLon) :
-  minLat(minLat), maxLat(maxLat), minLon(minLon), maxLon(maxLon)
-{
-}
-
-double StationArea::distance(const miCoordinates& pos) const
-{
-  if (contains(pos))
-    return 0;
-
-  const float lat = pos.dLat(), lon = pos.dLon();
-  double d = 0;
-  if (lat >= minLat && lat < maxLat) {
-    // on the left or right
-    const miCoordinates left(minLon, lat), right(maxLon, lat);
-    d = std::min(pos.distanceTo(left), pos.distanceTo(right));
-  } else if (lon >= minLon && lat < maxLon) {
-    // on the left or right
-    const miCoordinates below(lon, minLat), above(lon, maxLat);
-    d = std::min(pos.distanceTo(below), pos.distanceTo(above));
-  } else if (lon < minLon && lat < minLat) {
-    const miCoordinates corner(minLon, minLat);
-    d = pos.distanceTo(corner);
-  } else if (lon >= maxLon && lat < minLat) {
-    const miCoordinates corner(maxLon, minLat);
-    d = pos.distanceTo(corner);
-  } else if (lon < minLon && lat >= maxLat) {
-    const miCoordinates corner(minLon, maxLat);
-    d = pos.distanceTo(corner);
-  } else if (lon >= maxLon && lat >= maxLat) {
-    const miCoordinates corner(maxLon, maxLat);
-    d = pos.distanceTo(corner);
-  }
-  return d / 1000; // convert from m to km
-}
-
-vector<Station*> StationArea::findStations(const miCoordinates& pos, float radius) const
-{
-  vector<Station*> all;
-
-  if (!areas.empty()) {
-    for (std::vector<StationArea>::const_iterator it = areas.begin(); it != areas.end(); ++it) {
-      const double d = it->distance(pos);
-      if (d < radius) {
-        const vector<Station*> child = it->findStations(pos, radius);
-        all.insert(all.end(), child.begin(), child.end());
-      }
-    }
-  } else {
-    for (vector<Station*>::const_iterator it = stations.begin(); it != stations.end(); ++it) {
-      Station* s = *it;
-      const double d = ::distance(pos, s);
-      if (d < radius)
-        all.push_back(s);
-    }
-  }
-  return all;
-}
-
-Station* StationArea::findStation(const miCoordinates& pos, float radius) const
-{
-  vector<Station*> found = findStations(pos, radius);
-  if (found.empty())
-    return 0;
-
-  Station* min_station = found.front();
-  if (found.size() > 1) {
-    std::vector<Station*>::const_iterator it = found.begin();
-    float min_dist = ::distance(pos, *it);
-    for (++it; it != found.end(); ++it) {
-      const float dist = ::distance(pos, *it);
-      if (dist < min_dist) {
-        min_dist = dist;
-        min_station = *it;
-      }
-    }
-  }
-  return min_station;
-}
-
-void StationArea::addStation(Station* station)
-{
-  if (areas.empty()) {
-    stations.push_back(station);
-
-    if (stations.size() > 10) {
-      // If there are more than 10 stations in the area, split up the area and
-      // move each of the stations into the appropriate subarea.
-      const float midLat = (minLat + maxLat)/2, midLon = (minLon + maxLon)/2;
-
-      StationArea topLeft(midLat, maxLat, minLon, midLon);
-      areas.push_back(topLeft);
-
-      StationArea topRight(midLat, maxLat, midLon, maxLon);
-      areas.push_back(topRight);
-
-      StationArea bottomLeft(minLat, midLat, minLon, midLon);
-      areas.push_back(bottomLeft);
-
-      StationArea bottomRight(minLat, midLat, midLon, maxLon);
-      areas.push_back(bottomRight);
-
-      // Move all the stations into the subareas. May not call "addStation" to avoid infinite recursion if
-      // there are more than 10 stations with identical lon and lat.
-      for (std::vector<Station*>::const_iterator it = stations.begin(); it != stations.end(); ++it) {
-        const size_t a = ((*it)->lat() >= midLat ? 0 : 2) + ((*it)->lon() >= midLon ? 1 : 0);
-        areas[a].stations.push_back(*it);
-      }
-
-      // Clear the vector of stations in this area.
-      stations.clear();
-    }
-  } else {
-    // Find the appropriate subarea to store the station in.
-    for (std::vector<StationArea>::iterator it = areas.begin(); it != areas.end(); ++it) {
-      if (it->contains(station->lat(), station->lon())) {
-        it->addStation(station);
-        break;
-      }
-    }
-  }
-}
@@ -34,6 +34,7 @@
 #include "diImageGallery.h"
 #include "diPlot.h"
 #include "diPlotOptions.h"
+#include "util/rectangle_tree.h"
 
 #include <puDatatypes/miCoordinates.h>
 #include <diField/diArea.h>
@@ -99,39 +100,6 @@ struct Station {
     { return pos.dLat(); }
 };
 
-class StationArea {
-public:
-  StationArea(float minLat, float maxLat, float minLon, float maxLon);
-
-  std::vector<Station*> findStations(const miCoordinates& pos, float radius) const;
-  std::vector<Station*> findStations(float lat, float lon, float radius) const
-    { return findStations(miCoordinates(lon, lat), radius); }
-
-  Station* findStation(const miCoordinates& pos, float radius) const;
-  Station* findStation(float lat, float lon, float radius) const
-    { return findStation(miCoordinates(lon, lat), radius); }
-
-  void addStation(Station* station);
-
-  bool contains(const miCoordinates& pos) const
-    { return contains(pos.dLat(), pos.dLon()); }
-  bool contains(float lat, float lon) const
-    { return lat >= minLat && lat < maxLat && lon >= minLon && lon < maxLon; }
-
-  /*! Approximate distance from pos to area rectangle in km
-   * The returned value is not correct for large distances.
-   */
-  double distance(const miCoordinates& pos) const;
-
-private:
-  float minLat;
-  float maxLat;
-  float minLon;
-  float maxLon;
-  std::vector<StationArea> areas;  // subareas of this area
-  std::vector<Station*> stations;  // pointers to stations are owned by the StationPlot
-};
-
 /**
    \brief Plot pickable stations/positions on the map
 
@@ -183,8 +151,10 @@ public:
   /// Returns the station at phys position x and y
   Station* stationAt(int phys_x, int phys_y);
 
-  /// Returns all stations at phys position x and y
-  std::vector<Station*> stationsAt(int x, int y, float radius=100.0, bool useAllStation=false);
+  /*! Returns all visible stations within radius pixels of phys position x and y.
+   *  Unless useAllStations is set, stations further away than radius km are skipped.
+   */
+  std::vector<Station*> stationsAt(int x, int y, float radius=100.0, bool useAllStations=false);
 
   /// Returns a std::vector containing the names of the stations at position x and y
   std::vector<std::string> findStation(int x, int y, bool add=false);
@@ -253,7 +223,6 @@ public:
 
 private:
   std::vector<Station*> stations; //stations, name, lon, lat etc...
-  std::vector<StationArea> stationAreas;  // areas containing stations
 
   //  void addStation(const std::string names);
   void addStation(float lon, float lat, const std::string& name="",
@@ -264,9 +233,13 @@ private:
   void plotStation(DiGLPainter* gl, int i);
   void glPlot(DiGLPainter* gl, Station::Status tp, float x, float y, bool selected = false);
   void plotWind(DiGLPainter* gl, int i, float x, float y, bool classic=false, float scale=1);
+  std::vector<size_t> stationIndicesAt(int phys_x, int phys_y, float radius, bool useAllStations) const;
+  //! indices of stations with map positions within phys_radius pixels of map rectangle r
+  void stationsInRectangle(const Rectangle& r, float phys_radius, std::vector<size_t>& found) const;
 
   std::vector <float> xplot; //x-positions to plot in current projection
   std::vector <float> yplot; //y-positions to plot in current projection
+  diutil::RectangleTree stationTree; //xplot,yplot index, rebuilt in changeProjection
 
   bool visible;
   std::string annotation;
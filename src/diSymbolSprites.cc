@@ -0,0 +1,84 @@
+#include "diSymbolSprites.h"
+
+#include <QPainter>
+
+#include <cmath>
+
+#define MILOGGER_CATEGORY "diana.SymbolSprites"
+#include <miLogger/miLogging.h>
+
+namespace {
+
+//! sprite scales are rounded to this fraction of a pixel per symbol unit
+const float SCALE_STEPS = 64;
+
+//! line widths are rounded to this fraction of a pixel
+const float WIDTH_STEPS = 4;
+
+//! the cache is cleared when it grows larger than this
+const int MAX_SPRITES = 4096;
+
+//! sprites larger than this are not cached
+const int MAX_SPRITE_PIXELS = 256 * 256;
+
+//! pack value into bits [shift, shift+bits) of key, return false if it does not fit
+bool pack(quint64& key, int shift, int bits, int value)
+{
+  if (value < 0 || value >= (1 << bits))
+    return false;
+  key |= quint64(value) << shift;
+  return true;
+}
+
+} // namespace
+
+SymbolSprites::SymbolSprites()
+{
+}
+
+void SymbolSprites::clear()
+{
+  sprites_.clear();
+}
+
+const SymbolSprites::Sprite* SymbolSprites::sprite(quint32 symbol, const QRectF& bounds, float scale, bool flipY,
+    QRgb colour, float lineWidth, bool antialiasing, const Renderer& render)
+{
+  if (!(scale > 0) || bounds.isNull() || bounds.width() < 0 || bounds.height() < 0)
+    return 0;
+
+  const int iScale = int(scale * SCALE_STEPS + 0.5), iWidth = int(lineWidth * WIDTH_STEPS + 0.5);
+  quint64 shape = symbol;
+  if (!(iScale > 0 && pack(shape, 32, 16, iScale) && pack(shape, 48, 12, iWidth)
+        && pack(shape, 60, 1, flipY ? 1 : 0) && pack(shape, 61, 1, antialiasing ? 1 : 0)))
+    return 0;
+
+  const Key key(shape, colour);
+  QHash<Key, Sprite>::const_iterator it = sprites_.constFind(key);
+  if (it != sprites_.constEnd())
+    return &it.value();
+
+  // render with the rounded scale so that the sprite does not depend on the first symbol using it
+  const float s = iScale / SCALE_STEPS;
+  const QTransform toPixels(s, 0, 0, flipY ? -s : s, 0, 0);
+  const int margin = int(std::ceil(iWidth / WIDTH_STEPS)) + 2;
+  const QRect pixels = toPixels.mapRect(bounds).toAlignedRect().adjusted(-margin, -margin, margin, margin);
+  if (pixels.width() * pixels.height() > MAX_SPRITE_PIXELS)
+    return 0;
+
+  if (sprites_.size() >= MAX_SPRITES) {
+    METLIBS_LOG_DEBUG("clearing " << sprites_.size() << " sprites");
+    sprites_.clear();
+  }
+
+  Sprite sp;
+  sp.offset = -pixels.topLeft();
+  sp.image = QImage(pixels.size(), QImage::Format_ARGB32_Premultiplied);
+  sp.image.fill(Qt::transparent);
+  {
+    QPainter painter(&sp.image);
+    painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+    render(painter, toPixels * QTransform::fromTranslate(sp.offset.x(), sp.offset.y()));
+  }
+  return &sprites_.insert(key, sp).value();
+}
@@ -0,0 +1,64 @@
+#ifndef DISYMBOLSPRITES_H
+#define DISYMBOLSPRITES_H
+
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QPoint>
+#include <QRectF>
+#include <QTransform>
+
+#include <functional>
+
+class QPainter;
+
+/**
+  \brief Cache of pre-rendered symbol images
+
+  Observation station models are assembled from a few dozen small symbols
+  (cloud cover, present and past weather, cloud types, ...), each drawn
+  with several lines and polygons. The same symbols appear at thousands
+  of stations. Sprites are rendered once per symbol, scale and pen, and
+  can then be drawn as images.
+ */
+class SymbolSprites {
+public:
+  struct Sprite {
+    QImage image;  //!< covers the symbol bounds and the line width
+    QPoint offset; //!< pixel position of the symbol origin in image
+  };
+
+  /*! Draw the symbol with painter; transform maps symbol coordinates to
+   *  image pixels.
+   */
+  typedef std::function<void(QPainter& painter, const QTransform& transform)> Renderer;
+
+  SymbolSprites();
+
+  /*! Find or render the sprite for a symbol.
+   *
+   * \param symbol identifies the symbol shape, the same symbol must always be drawn the same way
+   * \param bounds the area covered by the symbol, in symbol coordinates
+   * \param scale pixels per symbol unit, the same in x and y
+   * \param flipY true if symbol y is up and pixel y is down
+   * \param lineWidth in pixels
+   * \param render called to draw the symbol if it is not cached
+   *
+   * \return the sprite, or 0 if the symbol cannot be cached and must be drawn with primitives
+   */
+  const Sprite* sprite(quint32 symbol, const QRectF& bounds, float scale, bool flipY,
+      QRgb colour, float lineWidth, bool antialiasing, const Renderer& render);
+
+  void clear();
+
+  int size() const
+    { return sprites_.size(); }
+
+private:
+  typedef QPair<quint64, QRgb> Key;
+
+private:
+  QHash<Key, Sprite> sprites_;
+};
+
+#endif // DISYMBOLSPRITES_H
@@ -0,0 +1,125 @@
+#include "diWindArrowGlyphs.h"
+
+#include "diField/VcrossUtil.h"
+#include "util/math_util.h"
+#include "vcross_v2/VcrossQtPaint.h"
+
+#include <QPainter>
+#include <QPen>
+
+#include <cmath>
+
+#define MILOGGER_CATEGORY "diana.WindArrowGlyphs"
+#include <miLogger/miLogging.h>
+
+namespace {
+
+//! number of directions, i.e. glyph directions are rounded to whole degrees
+const int DIRECTIONS = 360;
+
+//! glyph sizes and line widths are rounded to this fraction of a pixel
+const float SIZE_STEPS = 4;
+
+//! the cache is cleared when it grows larger than this
+const int MAX_GLYPHS = 4096;
+
+//! pack value into bits [shift, shift+bits) of key, return false if it does not fit
+bool pack(quint64& key, int shift, int bits, int value)
+{
+  if (value < 0 || value >= (1 << bits))
+    return false;
+  key |= quint64(value) << shift;
+  return true;
+}
+
+} // namespace
+
+WindArrowGlyphs::WindArrowGlyphs()
+{
+}
+
+void WindArrowGlyphs::clear()
+{
+  glyphs_.clear();
+}
+
+const WindArrowGlyphs::Glyph* WindArrowGlyphs::glyph(float u, float v, float size, bool withArrowHead, int turnBarbs, float yFactor,
+    QRgb colour, float lineWidth, bool antialiasing)
+{
+  const float ff = diutil::absval(u, v);
+  if (std::isnan(ff))
+    return 0;
+
+  const vcross::util::WindArrowFeathers waf = vcross::util::countFeathers(ff);
+  int direction = int(std::floor(std::atan2(v, u) * (DIRECTIONS / (2 * M_PI)) + 0.5));
+  if (direction < 0)
+    direction += DIRECTIONS;
+  direction %= DIRECTIONS;
+
+  // calm wind is a single glyph
+  const bool calm = (ff <= 0.00001);
+
+  quint64 shape = 0;
+  if (!(pack(shape, 0, 10, calm ? 0 : waf.n50) && pack(shape, 10, 4, calm ? 0 : waf.n10)
+        && pack(shape, 14, 1, calm ? 0 : waf.n05) && pack(shape, 15, 1, calm ? 1 : 0)
+        && pack(shape, 16, 9, calm ? 0 : direction)
+        && pack(shape, 25, 14, int(size * SIZE_STEPS + 0.5))
+        && pack(shape, 39, 10, int(lineWidth * SIZE_STEPS + 0.5))
+        && pack(shape, 49, 1, withArrowHead ? 1 : 0) && pack(shape, 50, 1, turnBarbs < 0 ? 1 : 0)
+        && pack(shape, 51, 1, yFactor < 0 ? 1 : 0) && pack(shape, 52, 1, antialiasing ? 1 : 0)))
+    return 0;
+
+  const Key key(shape, colour);
+  QHash<Key, Glyph>::const_iterator it = glyphs_.constFind(key);
+  if (it != glyphs_.constEnd())
+    return &it.value();
+
+  if (glyphs_.size() >= MAX_GLYPHS) {
+    METLIBS_LOG_DEBUG("clearing " << glyphs_.size() << " glyphs");
+    glyphs_.clear();
+  }
+
+  Glyph g;
+  if (!calm) {
+    // render with the rounded values so that the glyph does not depend on the first arrow using it
+    g = render(ff, direction, int(size * SIZE_STEPS + 0.5) / SIZE_STEPS, withArrowHead, turnBarbs, yFactor,
+        colour, int(lineWidth * SIZE_STEPS + 0.5) / SIZE_STEPS, antialiasing);
+  }
+  return &glyphs_.insert(key, g).value();
+}
+
+// static
+WindArrowGlyphs::Glyph WindArrowGlyphs::render(float ff, int direction, float size, bool withArrowHead, int turnBarbs, float yFactor,
+    QRgb colour, float lineWidth, bool antialiasing)
+{
+  // the arrow is at most size long, flags extend 0.35*size sideways, and the head a little behind the point
+  const int radius = int(std::ceil(1.4 * size + lineWidth)) + 2;
+
+  Glyph g;
+  g.offset = QPoint(radius, radius);
+  g.image = QImage(2 * radius + 1, 2 * radius + 1, QImage::Format_ARGB32_Premultiplied);
+  g.image.fill(Qt::transparent);
+
+  const float a = direction * (2 * M_PI / DIRECTIONS);
+  QVector<QLineF> lines;
+  std::vector<QPointF> trianglePoints;
+  vcross::PaintWindArrow::makeArrowPrimitives(lines, trianglePoints, size, withArrowHead, yFactor,
+      ff * std::cos(a), ff * std::sin(a), radius + 0.5, radius + 0.5, turnBarbs);
+
+  // pen and brush as in DiPaintGLPainter::setPen and setPolygonColor
+  QPen pen(QColor::fromRgba(colour), lineWidth);
+  pen.setCapStyle(Qt::FlatCap);
+  pen.setCosmetic(true);
+
+  QPainter painter(&g.image);
+  painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+  painter.setPen(pen);
+  painter.drawLines(lines);
+
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(QColor::fromRgba(colour));
+  for (size_t i = 0; i + 2 < trianglePoints.size(); i += 3)
+    painter.drawPolygon(&trianglePoints[i], 3);
+
+  return g;
+}
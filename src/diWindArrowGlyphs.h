@@ -0,0 +1,52 @@
+#ifndef DIWINDARROWGLYPHS_H
+#define DIWINDARROWGLYPHS_H
+
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QPoint>
+
+/**
+  \brief Cache of pre-rendered wind arrow images
+
+  Drawing a wind arrow with barbs and flags takes many line and triangle
+  primitives. Dense wind fields have thousands of arrows. Most of them
+  look the same once the direction is rounded to whole degrees, as the
+  barbs only change with speed in 5 knot steps. Glyphs are rendered once
+  per direction, barbs, size and pen, and can then be drawn as images.
+ */
+class WindArrowGlyphs {
+public:
+  struct Glyph {
+    QImage image;  //!< null if nothing is drawn, e.g. for calm wind
+    QPoint offset; //!< pixel position of the arrow point in image
+  };
+
+  WindArrowGlyphs();
+
+  /*! Find or render the glyph for a wind arrow.
+   *
+   * Parameters are like vcross::PaintWindArrow::makeArrowPrimitives, with
+   * size and lineWidth in pixels.
+   *
+   * \return the glyph, or 0 if the arrow cannot be cached and must be drawn with primitives
+   */
+  const Glyph* glyph(float u, float v, float size, bool withArrowHead, int turnBarbs, float yFactor,
+      QRgb colour, float lineWidth, bool antialiasing);
+
+  void clear();
+
+  int size() const
+    { return glyphs_.size(); }
+
+private:
+  typedef QPair<quint64, QRgb> Key;
+
+  static Glyph render(float ff, int direction, float size, bool withArrowHead, int turnBarbs, float yFactor,
+      QRgb colour, float lineWidth, bool antialiasing);
+
+private:
+  QHash<Key, Glyph> glyphs_;
+};
+
+#endif // DIWINDARROWGLYPHS_H
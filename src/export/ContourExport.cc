@@ -0,0 +1,292 @@
+/*
+ Diana - A Free Meteorological Visualisation Tool
+
+ Copyright (C) 2018 met.no
+
+ Contact information:
+ Norwegian Meteorological Institute
+ Box 43 Blindern
+ 0313 OSLO
+ NORWAY
+ email: diana@met.no
+
+ This file is part of Diana
+
+ Diana is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Diana is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Diana; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ContourExport.h"
+
+#include "util/binary_io.h"
+
+#include <diField/diField.h>
+#include <diField/diFieldDefined.h>
+#include <puTools/miStringFunctions.h>
+
+#include <shapefil.h>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#define MILOGGER_CATEGORY "diana.ContourExport"
+#include <miLogger/miLogging.h>
+
+namespace {
+
+const char MAGIC[8] = { 'D', 'I', 'C', 'O', 'N', 'T', '0', '1' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// same as in writeShapefile in diContouring.cc, diana uses a spherical earth
+const char PROJECTION_WKT[] = "GEOGCS[\"unnamed ellipse\",DATUM[\"D_unknown\",SPHEROID[\"Unknown\",6371000,0]],"
+    "PRIMEM[\"Greenwich\",0],UNIT[\"Degree\",0.017453292519943295]]";
+
+void putJsonString(std::ostream& out, const std::string& s)
+{
+  out << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+    else
+      out << c;
+  }
+  out << '"';
+}
+
+std::string isoTime(const miutil::miTime& t)
+{
+  return t.undef() ? std::string() : t.isoTime("T");
+}
+
+} // namespace
+
+struct ContourExport::Job {
+  miutil::miTime time;
+  std::string model, parameter, level;
+  GridArea area;
+  int lineSmooth;
+  std::vector<float> data;
+  DianaLevels_p levels;
+  DianaContourLine_v lines;
+};
+
+ContourExport::ContourExport(Format format)
+  : format_(format)
+  , tasks_(new diutil::TaskGroup)
+{
+}
+
+ContourExport::~ContourExport()
+{
+  try {
+    tasks_->wait();
+  } catch (std::exception& e) {
+    METLIBS_LOG_ERROR("contouring failed: " << e.what());
+  }
+}
+
+void ContourExport::add(const miutil::miTime& time, const Field* field, const PlotOptions& poptions)
+{
+  if (!field || !field->data || field->area.gridSize() <= 0)
+    return;
+
+  Job_p job = std::make_shared<Job>();
+  job->time = time;
+  job->model = field->modelName;
+  job->parameter = field->paramName;
+  job->level = field->leveltext;
+  job->area = field->area;
+  job->lineSmooth = poptions.lineSmooth;
+  job->data.assign(field->data, field->data + field->area.gridSize());
+  job->levels = dianaLevelsForPlotOptions(poptions, fieldUndef);
+  jobs_.push_back(job);
+
+  tasks_->run([job]() { contour(*job); });
+}
+
+// static
+void ContourExport::contour(Job& job)
+{
+  poly_contour_lines(job.area.nx, job.area.ny, &job.data[0], *job.levels, job.lineSmooth, job.lines);
+  std::vector<float>().swap(job.data);
+}
+
+// static
+void ContourExport::toGeographic(const Job& job, Layer& layer)
+{
+  layer.model = job.model;
+  layer.parameter = job.parameter;
+  layer.level = job.level;
+  layer.time = job.time;
+  layer.lines.reserve(job.lines.size());
+  for (const DianaContourLine& cl : job.lines) {
+    if (cl.points.size() < 2)
+      continue;
+    layer.lines.push_back(Line());
+    Line& line = layer.lines.back();
+    line.value = cl.value;
+    const size_t n = cl.points.size();
+    line.lon.reserve(n);
+    line.lat.reserve(n);
+    for (const contouring::point_t& p : cl.points) {
+      line.lon.push_back(job.area.fromGridX(p.x));
+      line.lat.push_back(job.area.fromGridY(p.y));
+    }
+    if (!job.area.P().convertToGeographic(n, &line.lon[0], &line.lat[0])) {
+      METLIBS_LOG_WARN("could not convert contour line for '" << job.parameter << "' to geographic coordinates");
+      layer.lines.pop_back();
+    }
+  }
+}
+
+bool ContourExport::write(const miutil::miTime& time, const std::string& filename)
+{
+  METLIBS_LOG_SCOPE(LOGVAL(time) << LOGVAL(filename));
+  tasks_->wait();
+
+  Layer_v layers;
+  for (const Job_p& job : jobs_) {
+    if (job->time == time) {
+      layers.push_back(Layer());
+      toGeographic(*job, layers.back());
+    }
+  }
+
+  if (format_ == SHAPEFILE)
+    return writeShapefile(filename, layers);
+
+  const std::string content = (format_ == GEOJSON) ? toGeoJSON(layers) : toBinary(layers);
+  std::ofstream out(filename.c_str(), std::ios::binary);
+  out.write(content.data(), content.size());
+  out.close();
+  if (!out) {
+    METLIBS_LOG_ERROR("could not write contour lines to '" << filename << "'");
+    return false;
+  }
+  return true;
+}
+
+// static
+std::string ContourExport::toGeoJSON(const Layer_v& layers)
+{
+  std::ostringstream out;
+  out << std::setprecision(7);
+  out << "{\"type\":\"FeatureCollection\",\"features\":[";
+  bool first = true;
+  for (const Layer& layer : layers) {
+    for (const Line& line : layer.lines) {
+      if (!first)
+        out << ',';
+      first = false;
+      out << "\n{\"type\":\"Feature\",\"properties\":{\"model\":";
+      putJsonString(out, layer.model);
+      out << ",\"parameter\":";
+      putJsonString(out, layer.parameter);
+      out << ",\"level\":";
+      putJsonString(out, layer.level);
+      out << ",\"time\":";
+      putJsonString(out, isoTime(layer.time));
+      out << ",\"value\":" << line.value
+          << "},\"geometry\":{\"type\":\"LineString\",\"coordinates\":[";
+      for (size_t i = 0; i < line.lon.size(); ++i) {
+        if (i > 0)
+          out << ',';
+        out << '[' << line.lon[i] << ',' << line.lat[i] << ']';
+      }
+      out << "]}}";
+    }
+  }
+  out << "\n]}\n";
+  return out.str();
+}
+
+// static
+std::string ContourExport::toBinary(const Layer_v& layers)
+{
+  diutil::BinaryWriter w;
+  w.put(MAGIC, sizeof(MAGIC));
+  w.u32(BYTE_ORDER_MARK);
+  w.u32(layers.size());
+  for (const Layer& layer : layers) {
+    w.str(layer.model);
+    w.str(layer.parameter);
+    w.str(layer.level);
+    w.str(isoTime(layer.time));
+    w.u32(layer.lines.size());
+    for (const Line& line : layer.lines) {
+      w.put(&line.value, sizeof(line.value));
+      w.u32(line.lon.size());
+      w.column(line.lon);
+      w.column(line.lat);
+    }
+  }
+  return w.buffer;
+}
+
+// static
+bool ContourExport::writeShapefile(const std::string& filename, const Layer_v& layers)
+{
+  std::string basename = filename;
+  if (basename.size() > 4 && miutil::to_lower(basename.substr(basename.size() - 4)) == ".shp")
+    basename.erase(basename.size() - 4);
+
+  std::ofstream prj((basename + ".prj").c_str());
+  prj << PROJECTION_WKT << std::endl;
+  if (!prj) {
+    METLIBS_LOG_ERROR("could not write '" << basename << ".prj'");
+    return false;
+  }
+
+  SHPHandle hSHP = SHPCreate(basename.c_str(), SHPT_ARC);
+  DBFHandle hDBF = DBFCreate(basename.c_str());
+  if (!hSHP || !hDBF) {
+    METLIBS_LOG_ERROR("could not create shapefile '" << basename << "'");
+    if (hSHP)
+      SHPClose(hSHP);
+    if (hDBF)
+      DBFClose(hDBF);
+    return false;
+  }
+
+  const int fModel = DBFAddField(hDBF, "MODEL", FTString, 64, 0);
+  const int fParameter = DBFAddField(hDBF, "PARAMETER", FTString, 64, 0);
+  const int fLevel = DBFAddField(hDBF, "LEVEL", FTString, 32, 0);
+  const int fTime = DBFAddField(hDBF, "TIME", FTString, 19, 0);
+  const int fValue = DBFAddField(hDBF, "VALUE", FTDouble, 16, 6);
+
+  std::vector<double> x, y;
+  for (const Layer& layer : layers) {
+    const std::string time = isoTime(layer.time);
+    for (const Line& line : layer.lines) {
+      x.assign(line.lon.begin(), line.lon.end());
+      y.assign(line.lat.begin(), line.lat.end());
+      SHPObject* shape = SHPCreateSimpleObject(SHPT_ARC, x.size(), &x[0], &y[0], 0);
+      const int iShape = SHPWriteObject(hSHP, -1, shape);
+      SHPDestroyObject(shape);
+
+      DBFWriteStringAttribute(hDBF, iShape, fModel, layer.model.c_str());
+      DBFWriteStringAttribute(hDBF, iShape, fParameter, layer.parameter.c_str());
+      DBFWriteStringAttribute(hDBF, iShape, fLevel, layer.level.c_str());
+      DBFWriteStringAttribute(hDBF, iShape, fTime, time.c_str());
+      DBFWriteDoubleAttribute(hDBF, iShape, fValue, line.value);
+    }
+  }
+
+  SHPClose(hSHP);
+  DBFClose(hDBF);
+  return true;
+}
@@ -0,0 +1,107 @@
+/*
+ Diana - A Free Meteorological Visualisation Tool
+
+ Copyright (C) 2018 met.no
+
+ Contact information:
+ Norwegian Meteorological Institute
+ Box 43 Blindern
+ 0313 OSLO
+ NORWAY
+ email: diana@met.no
+
+ This file is part of Diana
+
+ Diana is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Diana is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Diana; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CONTOUREXPORT_H_
+#define CONTOUREXPORT_H_
+
+#include "diPolyContouring.h"
+#include "util/thread_pool.h"
+
+#include <diField/diArea.h>
+#include <puTools/miTime.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class Field;
+
+/*! Write contour lines of fields as vector data, without painting.
+ *
+ * Fields are contoured in the diutil::ThreadPool while the caller reads
+ * the next fields. The field data are copied, so that the caller may
+ * release the fields after add(). Coordinates are converted to longitude
+ * and latitude in write(), in the calling thread.
+ *
+ * The binary format is, in native byte order:
+ * - 8 bytes "DICONT01", uint32 0x01020304 to check the byte order
+ * - uint32 number of layers, then for each layer
+ *   - strings (uint32 length + bytes) model, parameter, level and time
+ *   - uint32 number of lines, then for each line
+ *     - float32 value, uint32 number of points n
+ *     - n float32 longitudes, n float32 latitudes
+ */
+class ContourExport {
+public:
+  enum Format { GEOJSON, SHAPEFILE, BINARY };
+
+  struct Line {
+    float value;
+    std::vector<float> lon, lat;
+  };
+
+  //! contour lines of one field
+  struct Layer {
+    std::string model, parameter, level;
+    miutil::miTime time;
+    std::vector<Line> lines;
+  };
+  typedef std::vector<Layer> Layer_v;
+
+  explicit ContourExport(Format format);
+  ~ContourExport();
+
+  /*! Contour a field in the background, with levels and lineSmooth
+   *  from the plot options.
+   */
+  void add(const miutil::miTime& time, const Field* field, const PlotOptions& poptions);
+
+  /*! Wait until all fields are contoured, and write the lines of all
+   *  fields added for time.
+   */
+  bool write(const miutil::miTime& time, const std::string& filename);
+
+  static std::string toGeoJSON(const Layer_v& layers);
+  static std::string toBinary(const Layer_v& layers);
+  static bool writeShapefile(const std::string& filename, const Layer_v& layers);
+
+private:
+  struct Job;
+  typedef std::shared_ptr<Job> Job_p;
+
+  static void contour(Job& job);
+  static void toGeographic(const Job& job, Layer& layer);
+
+private:
+  Format format_;
+  std::vector<Job_p> jobs_;
+  std::unique_ptr<diutil::TaskGroup> tasks_;
+};
+
+#endif // CONTOUREXPORT_H_
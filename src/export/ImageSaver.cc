@@ -0,0 +1,83 @@
+/*
+ Diana - A Free Meteorological Visualisation Tool
+
+ Copyright (C) 2018 met.no
+
+ Contact information:
+ Norwegian Meteorological Institute
+ Box 43 Blindern
+ 0313 OSLO
+ NORWAY
+ email: diana@met.no
+
+ This file is part of Diana
+
+ Diana is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Diana is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Diana; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ImageSaver.h"
+
+#include "util/thread_pool.h"
+
+#define MILOGGER_CATEGORY "diana.ImageSaver"
+#include <miLogger/miLogging.h>
+
+ImageSaver::ImageSaver(int maxQueued)
+  : maxQueued_(maxQueued > 0 ? maxQueued : diutil::ThreadPool::instance().threadCount())
+  , tasks_(new diutil::TaskGroup)
+  , failed_(false)
+{
+}
+
+ImageSaver::~ImageSaver()
+{
+  finish();
+}
+
+bool ImageSaver::add(const QImage& image, const QString& filename, const Convert& convert)
+{
+  if (queued_.contains(filename))
+    waitAll();
+  queued_.insert(filename);
+
+  tasks_->throttle(maxQueued_ - 1);
+  tasks_->run([this, image, filename, convert]() {
+      const QImage converted = convert ? convert(image) : image;
+      if (converted.save(filename)) {
+        METLIBS_LOG_DEBUG("saved image '" << filename.toStdString() << "'");
+      } else {
+        METLIBS_LOG_ERROR("could not save image to '" << filename.toStdString() << "'");
+        failed_ = true;
+      }
+    });
+  return !failed_;
+}
+
+bool ImageSaver::finish()
+{
+  waitAll();
+  return !failed_.exchange(false);
+}
+
+void ImageSaver::waitAll()
+{
+  try {
+    tasks_->wait();
+  } catch (std::exception& e) {
+    METLIBS_LOG_ERROR("saving images failed: " << e.what());
+    failed_ = true;
+  }
+  queued_.clear();
+}
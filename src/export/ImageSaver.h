@@ -0,0 +1,84 @@
+/*
+ Diana - A Free Meteorological Visualisation Tool
+
+ Copyright (C) 2018 met.no
+
+ Contact information:
+ Norwegian Meteorological Institute
+ Box 43 Blindern
+ 0313 OSLO
+ NORWAY
+ email: diana@met.no
+
+ This file is part of Diana
+
+ Diana is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Diana is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Diana; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef IMAGESAVER_H_
+#define IMAGESAVER_H_
+
+#include <QImage>
+#include <QSet>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace diutil {
+class TaskGroup;
+}
+
+/*! Writes images in the diutil::ThreadPool, so that the next image can
+ *  be painted while earlier ones are compressed and written.
+ *
+ * At most maxQueued images are kept in memory; add() waits while more
+ * are queued. A file is never written by two tasks at the same time.
+ * Errors are logged, and reported by the next add() or finish().
+ */
+class ImageSaver {
+public:
+  //! conversion applied in the worker thread before writing, e.g. scaling
+  typedef std::function<QImage(const QImage&)> Convert;
+
+  //! maxQueued <= 0 means the number of threads in the pool
+  explicit ImageSaver(int maxQueued = 0);
+
+  //! waits for all queued images
+  ~ImageSaver();
+
+  /*! Queue an image to be written to filename, in a format chosen from
+   *  the file suffix. Returns false if an earlier image could not be
+   *  written.
+   */
+  bool add(const QImage& image, const QString& filename, const Convert& convert = Convert());
+
+  /*! Wait until all queued images are written. Returns false if any of
+   *  them could not be written.
+   */
+  bool finish();
+
+private:
+  void waitAll();
+
+private:
+  int maxQueued_;
+  std::unique_ptr<diutil::TaskGroup> tasks_;
+  std::atomic<bool> failed_;
+  QSet<QString> queued_; //!< files added since the last finish()
+};
+
+#endif // IMAGESAVER_H_
@@ -95,25 +95,25 @@ bool MovieMaker::addImage(const QImage &image)
 
   const QImage::Format FORMAT = QImage::Format_RGB32;
 
-  QImage imageScaled;
-  if (image.size() == mFrameSize)
-    imageScaled = image;
-  else
-    imageScaled = image.scaled(mFrameSize);
-
-  if (imageScaled.format() != FORMAT)
-    imageScaled = imageScaled.convertToFormat(FORMAT);
-
+  const QSize size = mFrameSize;
+  const ImageSaver::Convert convert = [size, FORMAT](const QImage& image) {
+    QImage imageScaled;
+    if (image.size() == size)
+      imageScaled = image;
+    else
+      imageScaled = image.scaled(size);
+
+    if (imageScaled.format() != FORMAT)
+      imageScaled = imageScaled.convertToFormat(FORMAT);
+    return imageScaled;
+  };
+
+  // frame numbers and the file list are assigned here, so the order is kept
   mFrameCount += 1;
   QString imagefilename = framePath(mFrameCount);
-  if (imageScaled.save(imagefilename)) {
-    METLIBS_LOG_DEBUG("saved frame " << mFrameCount << " to '" << imagefilename.toStdString() << "'");
-    mOutputFiles << imagefilename;
-    return true;
-  } else {
-    METLIBS_LOG_ERROR("could not save frame " << mFrameCount << " to '" << imagefilename.toStdString() << "'");
-    return false;
-  }
+  mOutputFiles << imagefilename;
+  METLIBS_LOG_DEBUG("queued frame " << mFrameCount << " for '" << imagefilename.toStdString() << "'");
+  return mFrameSaver.add(image, imagefilename, convert);
 }
 
 bool MovieMaker::finish()
@@ -123,6 +123,8 @@ bool MovieMaker::finish()
     METLIBS_LOG_WARN("no video frames in '" << mOutputFile.toStdString() << "'");
     return false;
   }
+  if (!mFrameSaver.finish())
+    return false;
   if (isImageSeries())
     return true;
   if (!mOutputDir.exists())
@@ -30,6 +30,7 @@
 #ifndef MOVIEMAKER_H_
 #define MOVIEMAKER_H_
 
+#include "ImageSaver.h"
 #include "qtTempDir.h"
 
 #include <QSize>
@@ -56,6 +57,10 @@ public:
   QSize frameSize() const
     { return mFrameSize; }
 
+  /*! Add a frame. The frame is scaled, converted and written in the
+   *  background, so that the next frame can be painted meanwhile; errors
+   *  are reported by later calls to addImage() and by finish().
+   */
   bool addImage(const QImage &image);
   bool finish();
 
@@ -83,6 +88,8 @@ private:
   TempDir mOutputDir;
   int mFrameCount;
   QStringList mOutputFiles;
+
+  ImageSaver mFrameSaver; // after mOutputDir, so that it is destroyed first
 };
 
 #endif /*MOVIEMAKER_H_*/
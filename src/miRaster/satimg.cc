@@ -155,6 +155,85 @@ int satimg::MITIFF_read_diana(const std::string& infile, unsigned char *image[],
 }
 
 
+/*
+ * Read columns x0..x0+nx-1 and rows y0..y0+ny-1 (counted from the top) of
+ * each channel, keeping only every step'th column and row. The image
+ * buffers have (nx+step-1)/step * (ny+step-1)/step values.
+ *
+ * The file is opened with strip chopping, so that only the strips with
+ * the rows that are needed are read from uncompressed files. Rows in
+ * compressed strips are decoded up to the last row needed.
+ *
+ * Returns 0 if ok, and -1 if the window could not be read, e.g. for tiled
+ * images or images with more than one byte per pixel.
+ */
+int satimg::MITIFF_read_window(const std::string& infile, unsigned char *image[],
+    int nchan, int chan[], int x0, int y0, int nx, int ny, int step)
+{
+  if (nx <= 0 || ny <= 0 || step <= 0 || x0 < 0 || y0 < 0)
+    return(-1);
+
+  TIFF *in=TIFFOpen(infile.c_str(), "r");
+  if (!in) {
+    printf(" This is no TIFF file! (2)\n");
+    return(-1);
+  }
+
+  const int wx = (nx + step - 1) / step, wy = (ny + step - 1) / step;
+  for (int i=0; i<nchan; i++)
+    image[i] = 0;
+
+  int status = 0;
+  tdata_t line = 0;
+  for (int i=0; i<nchan && status == 0; i++) {
+    if(i!=0 || chan[0]!=0){ /*TIFFsetDirectory chrashes if chan[0]=0,why??*/
+      if (TIFFSetDirectory(in, chan[i]) == 0) {
+        status = -1;
+        break;
+      }
+    }
+
+    uint32 xsize = 0, ysize = 0;
+    uint16 bps = 8, spp = 1;
+    TIFFGetField(in, TIFFTAG_IMAGEWIDTH, &xsize);
+    TIFFGetField(in, TIFFTAG_IMAGELENGTH, &ysize);
+    TIFFGetFieldDefaulted(in, TIFFTAG_BITSPERSAMPLE, &bps);
+    TIFFGetFieldDefaulted(in, TIFFTAG_SAMPLESPERPIXEL, &spp);
+    if (TIFFIsTiled(in) || bps != 8 || spp != 1
+        || uint32(x0 + nx) > xsize || uint32(y0 + ny) > ysize) {
+      status = -1;
+      break;
+    }
+
+    if (!line)
+      line = _TIFFmalloc(TIFFScanlineSize(in));
+    image[i] = new unsigned char [wx*wy+1];
+
+    const unsigned char* l = (const unsigned char*)line;
+    unsigned char* out = image[i];
+    for (int y=y0; y<y0+ny; y+=step) {
+      if (TIFFReadScanline(in, line, y, 0) == -1) {
+        status = -1;
+        break;
+      }
+      for (int x=x0; x<x0+nx; x+=step)
+        *out++ = l[x];
+    }
+  }
+
+  if (line)
+    _TIFFfree(line);
+  TIFFClose(in);
+
+  if (status != 0) {
+    for (int i=0; i<nchan; i++) {
+      delete[] image[i];
+      image[i] = 0;
+    }
+  }
+  return status;
+}
+
 int satimg::MITIFF_head_diana(const std::string& infile, dihead &ginfo) {
 
   int j,status;
@@ -134,6 +134,8 @@ namespace satimg {
   int day_night(const std::string& infile);
   int MITIFF_read_diana(const std::string& infile, unsigned char *image[], int nchan,
 			int chan[], dihead& ginfo);
+  int MITIFF_read_window(const std::string& infile, unsigned char *image[], int nchan,
+			int chan[], int x0, int y0, int nx, int ny, int step);
   int MITIFF_head_diana(const std::string& infile, dihead &ginfo);
   int fillhead_diana(const std::string& str, const std::string& tag, dihead &ginfo);
 
@@ -4,18 +4,44 @@
 
 #include "miSetupParser.h"
 
+#include "util/binary_io.h"
 #include "util/charsets.h"
+#include "util/mapped_file.h"
 
 #include <puTools/miStringFunctions.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <list>
 #include <sstream>
 
+#include <sys/stat.h>
+
 #define MILOGGER_CATEGORY "diana.SetupParser"
 #include <miLogger/miLogging.h>
 
+namespace {
+
+const char MAGIC[8] = { 'D', 'I', 'S', 'E', 'T', 'U', 'P', '1' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//! snapshot files not used for this long are removed
+const time_t MAX_FILE_AGE = 7*24*3600;
+
+//! get size and mtime for a file, return false if it cannot be found
+bool stamp(const std::string& filename, long long& size, long long& mtime)
+{
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0)
+    return false;
+  size = st.st_size;
+  mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  return true;
+}
+
+} // namespace
+
 namespace miutil {
 
 void SetupSection::clear()
@@ -45,7 +71,14 @@ void SetupParser::destroy()
 }
 
 SetupParser::SetupParser()
+  : snapshots("setup-")
+{
+}
+
+// static function
+void SetupParser::setCacheDirectory(const std::string& directory)
 {
+  instance()->snapshots.setDirectory(directory, MAX_FILE_AGE);
 }
 
 // static function
@@ -94,8 +127,10 @@ bool SetupParser::substitute(std::string& t, bool environment) const
     string_string_m::const_iterator it = substitutions.find(s);
     if (it != substitutions.end())
       n = it->second;
-    else if (environment)
+    else if (environment) {
       n = miutil::from_c_str(getenv(s.c_str()));
+      used_environment[s] = n;
+    }
 
     t.replace(start, stop+1 - start, n);
     stop = start + n.size(); // this does not allow recursive replacement
@@ -266,6 +301,12 @@ bool SetupParser::parseFile(const std::string& filename, // name of file
   sfilename.push_back(filename);
   int activefile = sfilename.size() - 1;
 
+  // stamp before reading, a file changed while reading will not match the snapshot
+  long long fsize = -1, fmtime = -1;
+  stamp(filename, fsize, fmtime);
+  sfilesize.push_back(fsize);
+  sfilemtime.push_back(fmtime);
+
   // ====== just output
   level++;
   std::string dummy = " ";
@@ -446,8 +487,11 @@ bool SetupParser::parse(const std::string& mainfilename)
 bool SetupParser::parseFile(const std::string& mainfilename)
 {
   sfilename.clear();
+  sfilesize.clear();
+  sfilemtime.clear();
   sectionm.clear();
   substitutions.clear();
+  used_environment.clear();
 
   // add user variables
   if (!user_variables.empty()) {
@@ -459,9 +503,163 @@ bool SetupParser::parseFile(const std::string& mainfilename)
      }
    }
 
+  const std::string id = snapshotId(mainfilename);
+  if (loadSnapshot(id))
+    return true;
+
   if (!parseFile(mainfilename, "", -1))
     return false;
 
+  storeSnapshot(id);
+  return true;
+}
+
+std::string SetupParser::snapshotId(const std::string& mainfilename) const
+{
+  std::ostringstream id;
+  id << mainfilename;
+  for (string_string_m::const_iterator it = user_variables.begin(); it != user_variables.end(); ++it)
+    id << '\n' << it->first << '=' << it->second;
+  return id.str();
+}
+
+bool SetupParser::loadSnapshot(const std::string& id)
+{
+  if (!snapshots.enabled())
+    return false;
+
+  const std::string sf = snapshots.path(id);
+  const diutil::MappedFile mapped(sf);
+  if (!mapped.data())
+    return false;
+  if (!readSnapshot(mapped.data(), mapped.size(), id)) {
+    METLIBS_LOG_DEBUG("setup snapshot '" << sf << "' is outdated or broken");
+    return false;
+  }
+  METLIBS_LOG_INFO("read " << sfilename.size() << " setup files from snapshot '" << sf << "'");
+
+  // mark as used, see setCacheDirectory
+  diutil::CacheDirectory::touch(sf);
+  return true;
+}
+
+void SetupParser::storeSnapshot(const std::string& id) const
+{
+  if (snapshots.enabled())
+    diutil::CacheDirectory::write(snapshots.path(id), writeSnapshot(id));
+}
+
+std::string SetupParser::writeSnapshot(const std::string& id) const
+{
+  diutil::BinaryWriter w;
+  w.put(MAGIC, sizeof(MAGIC));
+  w.u32(BYTE_ORDER_MARK);
+  w.str(id);
+
+  w.u32(sfilename.size());
+  for (size_t i = 0; i < sfilename.size(); ++i) {
+    w.str(sfilename[i]);
+    w.i64(sfilesize[i]);
+    w.i64(sfilemtime[i]);
+  }
+
+  w.u32(used_environment.size());
+  for (string_string_m::const_iterator it = used_environment.begin(); it != used_environment.end(); ++it) {
+    w.str(it->first);
+    w.str(it->second);
+  }
+
+  w.u32(substitutions.size());
+  for (string_string_m::const_iterator it = substitutions.begin(); it != substitutions.end(); ++it) {
+    w.str(it->first);
+    w.str(it->second);
+  }
+
+  w.u32(sectionm.size());
+  for (std::map<std::string, SetupSection>::const_iterator it = sectionm.begin(); it != sectionm.end(); ++it) {
+    const SetupSection& sect = it->second;
+    w.str(it->first);
+    w.u32(sect.strlist.size());
+    for (const std::string& line : sect.strlist)
+      w.str(line);
+    w.column(sect.linenum);
+    w.column(sect.filenum);
+  }
+  return w.buffer;
+}
+
+bool SetupParser::readSnapshot(const char* data, size_t size, const std::string& id)
+{
+  diutil::BinaryReader r(data, size);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t byteOrder;
+  std::string fileId;
+  uint32_t n;
+  if (!r.get(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+      || !r.u32(byteOrder) || byteOrder != BYTE_ORDER_MARK
+      || !r.str(fileId) || fileId != id || !r.u32(n))
+    return false;
+
+  // check the setup files and environment before reading the sections
+  string_v filenames(n);
+  std::vector<long long> filesizes(n), filemtimes(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    int64_t fsize, fmtime;
+    long long size, mtime;
+    if (!r.str(filenames[i]) || !r.i64(fsize) || !r.i64(fmtime)
+        || !stamp(filenames[i], size, mtime) || size != fsize || mtime != fmtime)
+      return false;
+    filesizes[i] = fsize;
+    filemtimes[i] = fmtime;
+  }
+
+  string_string_m environment;
+  if (!r.u32(n))
+    return false;
+  for (uint32_t i = 0; i < n; ++i) {
+    std::string key, value;
+    if (!r.str(key) || !r.str(value) || miutil::from_c_str(getenv(key.c_str())) != value)
+      return false;
+    environment[key] = value;
+  }
+
+  string_string_m subst;
+  if (!r.u32(n))
+    return false;
+  for (uint32_t i = 0; i < n; ++i) {
+    std::string key, value;
+    if (!r.str(key) || !r.str(value))
+      return false;
+    subst[key] = value;
+  }
+
+  std::map<std::string, SetupSection> sections;
+  if (!r.u32(n))
+    return false;
+  for (uint32_t i = 0; i < n; ++i) {
+    std::string name;
+    uint32_t nlines;
+    if (!r.str(name) || !r.u32(nlines))
+      return false;
+    SetupSection& sect = sections[name];
+    sect.strlist.resize(nlines);
+    for (std::string& line : sect.strlist) {
+      if (!r.str(line))
+        return false;
+    }
+    if (!r.column(sect.linenum, nlines) || !r.column(sect.filenum, nlines))
+      return false;
+  }
+  if (!r.atEnd())
+    return false;
+
+  std::swap(sfilename, filenames);
+  std::swap(sfilesize, filesizes);
+  std::swap(sfilemtime, filemtimes);
+  std::swap(used_environment, environment);
+  std::swap(substitutions, subst);
+  std::swap(sectionm, sections);
   return true;
 }
 
@@ -26,6 +26,7 @@
 #ifndef MISETUPPARSER_H
 #define MISETUPPARSER_H
 
+#include "util/cache_directory.h"
 #include "util/diKeyValue.h"
 #include <map>
 #include <string>
@@ -47,11 +48,18 @@ private:
 
   /// list of setup-filenames
   string_v sfilename;
+  /// size and modification time (nanoseconds) for each setup-file, checked for snapshots
+  std::vector<long long> sfilesize, sfilemtime;
   /// Setuptext hashed by Section name
   std::map<std::string,SetupSection> sectionm;
 
   string_string_m substitutions;
   string_string_m user_variables;
+  /// environment variables used while parsing, with their values, checked for snapshots
+  mutable string_string_m used_environment;
+
+  /// snapshots of the parsed setup, see setCacheDirectory
+  diutil::CacheDirectory snapshots;
 
   /// report an error with filename and linenumber
   static void internalErrorMsg(const std::string& filename,
@@ -70,6 +78,10 @@ private:
   bool parseFile(const std::string& filename,
       const std::string& section, int level);
 
+  std::string snapshotId(const std::string& mainfilename) const;
+  bool loadSnapshot(const std::string& id);
+  void storeSnapshot(const std::string& id) const;
+
   SetupParser();
   SetupParser& operator=(const SetupParser&);
 
@@ -89,9 +101,26 @@ public:
   /// cleans a string
   static void cleanstr(std::string&);
 
+  /*! Set the directory for snapshots of the parsed setup, creating it if
+   *  necessary. A snapshot is used by parse() instead of reading the setup
+   *  files if none of the files, user variables or environment variables
+   *  used in the files have changed. With an empty directory, no snapshots
+   *  are used.
+   */
+  static void setCacheDirectory(const std::string& directory);
+
   /// recursively parse setupfiles
   static bool parse(const std::string& mainfilename);
 
+  /// serialize the parsed setup in the binary format of the snapshot files
+  std::string writeSnapshot(const std::string& id) const;
+
+  /*! Read the parsed setup in the binary format of the snapshot files.
+   *  Return false if the data are broken, for a different id, or if any
+   *  of the setup files or environment variables have changed.
+   */
+  bool readSnapshot(const char* data, size_t size, const std::string& id);
+
   /// get stringlist for a named section
   static bool getSection(const std::string&,std::vector<std::string>&);
 
@@ -1,6 +1,8 @@
 
 #include "poly_contouring.hh"
 
+#include <boost/pool/object_pool.hpp>
+
 #include <cassert>
 #include <list>
 #include <vector>
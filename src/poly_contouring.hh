@@ -3,7 +3,7 @@
 #define POLY_CONTOURING_HH 1
 
 #include "reversible_list.hh"
-#include <boost/pool/pool_alloc.hpp>
+#include <memory>
 #include <stdexcept>
 
 namespace contouring {
@@ -17,7 +17,8 @@ struct point_t {
         : x(xx), y(yy) { }
 };
 
-typedef boost::fast_pool_allocator<point_t,boost::default_user_allocator_new_delete,boost::details::pool::null_mutex> points_allocator;
+// not a pool allocator without locking, so that fields may be contoured in several threads
+typedef std::allocator<point_t> points_allocator;
 typedef reversible_list<point_t, points_allocator> points_t;
 
 class field_t {
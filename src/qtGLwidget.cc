@@ -38,16 +38,26 @@
 
 #include <QMouseEvent>
 #include <QKeyEvent>
+#include <QTimer>
 
 #define MILOGGER_CATEGORY "diana.GLwidget"
 #include <miLogger/miLogging.h>
 
+namespace {
+//! milliseconds without zoom or pan events before plotting with full quality
+const int REFINE_DELAY = 300;
+} // namespace
+
 GLwidget::GLwidget(Controller* c)
   : contr(c)
   , plotw(1)
   , ploth(1)
   , scrollwheelZoom(false)
+  , refineTimer(new QTimer(this))
 {
+  refineTimer->setSingleShot(true);
+  refineTimer->setInterval(REFINE_DELAY);
+  connect(refineTimer, SIGNAL(timeout()), SLOT(refine()));
 }
 
 GLwidget::~GLwidget()
@@ -73,6 +83,17 @@ void GLwidget::paintUnderlay(DiPainter* painter)
   contr->plot(gl, true, false); // draw underlay
 }
 
+bool GLwidget::canPaintUnderlayInThread()
+{
+  return contr && contr->canPlotInThread();
+}
+
+void GLwidget::setPaintCancel(const std::function<void()>& cancel)
+{
+  if (contr)
+    contr->setPlotCancel(cancel);
+}
+
 void GLwidget::paintOverlay(DiPainter* painter)
 {
   if (!contr)
@@ -160,6 +181,7 @@ bool GLwidget::handleKeyEvents(QKeyEvent* ke)
   EventResult res;
   contr->sendKeyboardEvent(ke, res);
   setFlagsFromEventResult(res);
+  startRefineTimer();
 
   // check if any specific GUI-action requested
   if (res.action != no_action) {
@@ -197,12 +219,31 @@ bool GLwidget::handleWheelEvents(QWheelEvent *we)
       int hd = static_cast<int> ((y2 - y1) / 3.);
 
       Rectangle r(xmap - wd, ymap - hd, xmap + wd, ymap + hd);
+      contr->setInteractive(true);
       contr->zoomTo(r);
     } else {
+      contr->setInteractive(true);
       contr->zoomOut();
     }
+    startRefineTimer();
     update_background_buffer = true;
     return true;
   }
   return false;
 }
+
+void GLwidget::startRefineTimer()
+{
+  // restarted for each event, so that refining waits until zooming or panning stops
+  if (contr->isInteractive())
+    refineTimer->start();
+}
+
+void GLwidget::refine()
+{
+  contr->setInteractive(false);
+  if (!contr->isInteractive()) {
+    update_background_buffer = true;
+    Q_EMIT repaintNeeded();
+  }
+}
@@ -44,6 +44,7 @@
 #include <map>
 
 class Controller;
+class QTimer;
 
 /**
    \brief the map OpenGL widget
@@ -92,6 +93,9 @@ Q_SIGNALS:
   void changeCursor(cursortype);
   void resized(int width, int height);
 
+  /// the map should be repainted, e.g. with full quality after zooming
+  void repaintNeeded();
+
 public:
   void setCanvas(DiCanvas* canvas) override;
   void paint(DiPainter* gl);
@@ -101,8 +105,15 @@ public:
   bool handleMouseEvents(QMouseEvent*) override;
   bool handleWheelEvents(QWheelEvent *we) override;
 
+  bool canPaintUnderlayInThread() override;
+  void setPaintCancel(const std::function<void()>& cancel) override;
+
+private Q_SLOTS:
+  void refine();
+
 private:
   void setFlagsFromEventResult(const EventResult& res);
+  void startRefineTimer();
 
 private:
   Controller* contr;       // gate to main system
@@ -110,6 +121,7 @@ private:
 
   std::map<int,KeyType> keymap; // keymap's for keyboardevents
   bool scrollwheelZoom;
+  QTimer* refineTimer; // full quality plot when zooming or panning stops
 };
 
 #endif
@@ -2498,8 +2498,10 @@ void DianaMainWindow::parseSetup()
       QMessageBox::warning(this, tr("Error"), tr("An error occured while re-reading the setup file '%1'.")
                            .arg(QString::fromStdString(filename)));
     }
-    if (DiCanvas* c = w->Glw()->canvas())
+    if (DiCanvas* c = w->Glw()->canvas()) {
+      const Controller::PlotLock lock = contr->lockPlots();
       c->parseFontSetup();
+    }
     contr->parseSetup();
     if (vcInterface.get())
       vcInterface->parseSetup();
@@ -2594,7 +2596,11 @@ void DianaMainWindow::catchMouseGridPos(QMouseEvent* mev)
     sendLetter(letter);
   }
 
-  QString popupText = contr->getStationManager()->getStationsText(x, y);
+  QString popupText;
+  {
+    const Controller::PlotLock lock = contr->lockPlots();
+    popupText = contr->getStationManager()->getStationsText(x, y);
+  }
   if (popupText.isEmpty()) {
     popupText = QString::fromStdString(contr->getObsPopupText(x, y));
   }
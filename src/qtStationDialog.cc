@@ -214,6 +214,7 @@ void StationDialog::selectSet(const QItemSelection& current)
 void StationDialog::reloadSets()
 {
   QItemSelectionModel* selectionModel = selectedStationPlotList->selectionModel();
+  const Controller::PlotLock lock = m_ctrl->lockPlots();
   foreach (QModelIndex index, selectionModel->selectedRows(1)) {
     std::string url = index.data().toString().toStdString();
     QModelIndex nameIndex = chosenModel->index(index.row(), 0);
@@ -243,7 +244,11 @@ PlotCommand_cpv StationDialog::getOKString()
       if (cis.url == ssi.url) {
 
         // Load the list of stations from the URL.
-        StationPlot* plot = m_ctrl->getStationManager()->importStations(ssi.name, ssi.url);
+        StationPlot* plot;
+        {
+          const Controller::PlotLock lock = m_ctrl->lockPlots();
+          plot = m_ctrl->getStationManager()->importStations(ssi.name, ssi.url);
+        }
         if (plot) {
           m_ctrl->putStations(plot);
           dialogInfo.chosen[ssi.url] = true;
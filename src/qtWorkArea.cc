@@ -60,6 +60,7 @@ WorkArea::WorkArea(Controller *co,  QWidget* parent)
 
   connect(glw, SIGNAL(changeCursor(cursortype)),
       this, SLOT(changeCursor(cursortype)));
+  connect(glw, SIGNAL(repaintNeeded()), qw, SLOT(updateGL()));
 
   QVBoxLayout* vlayout = new QVBoxLayout(this);
   vlayout->addWidget(qw, 1);
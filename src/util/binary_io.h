@@ -0,0 +1,103 @@
+#ifndef DIANA_UTIL_BINARY_IO_H
+#define DIANA_UTIL_BINARY_IO_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace diutil {
+
+//! FNV-1a, stable between processes and builds
+inline uint64_t hash_fnv1a(const std::string& s)
+{
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < s.size(); ++i) {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+/*! Append values in native byte order to a buffer.
+ *
+ * Used for cache files, which are only read on the same machine.
+ */
+class BinaryWriter {
+public:
+  void put(const void* p, size_t n)
+    { buffer.append(static_cast<const char*>(p), n); }
+
+  void u32(uint32_t v)
+    { put(&v, sizeof(v)); }
+
+  void i64(int64_t v)
+    { put(&v, sizeof(v)); }
+
+  void f64(double v)
+    { put(&v, sizeof(v)); }
+
+  void str(const std::string& s)
+    { u32(s.size()); put(s.data(), s.size()); }
+
+  template<class T>
+  void column(const std::vector<T>& v)
+    { if (!v.empty()) put(&v[0], v.size() * sizeof(T)); }
+
+  std::string buffer;
+};
+
+//! Read values written by BinaryWriter, with bounds checks.
+class BinaryReader {
+public:
+  BinaryReader(const char* data, size_t size)
+    : pos_(data), end_(data + size) { }
+
+  bool get(void* p, size_t n)
+    {
+      if (size_t(end_ - pos_) < n)
+        return false;
+      memcpy(p, pos_, n);
+      pos_ += n;
+      return true;
+    }
+
+  bool u32(uint32_t& v)
+    { return get(&v, sizeof(v)); }
+
+  bool i64(int64_t& v)
+    { return get(&v, sizeof(v)); }
+
+  bool f64(double& v)
+    { return get(&v, sizeof(v)); }
+
+  bool str(std::string& s)
+    {
+      uint32_t n;
+      if (!u32(n) || size_t(end_ - pos_) < n)
+        return false;
+      s.assign(pos_, n);
+      pos_ += n;
+      return true;
+    }
+
+  template<class T>
+  bool column(std::vector<T>& v, size_t n)
+    {
+      if (size_t(end_ - pos_) / sizeof(T) < n)
+        return false;
+      v.resize(n);
+      return n == 0 || get(&v[0], n * sizeof(T));
+    }
+
+  bool atEnd() const
+    { return pos_ == end_; }
+
+private:
+  const char* pos_;
+  const char* end_;
+};
+
+} // namespace diutil
+
+#endif // DIANA_UTIL_BINARY_IO_H
@@ -0,0 +1,91 @@
+#include "cache_directory.h"
+
+#include "binary_io.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#define MILOGGER_CATEGORY "diana.util.CacheDirectory"
+#include <miLogger/miLogging.h>
+
+namespace diutil {
+
+CacheDirectory::CacheDirectory(const std::string& prefix, const std::string& suffix)
+  : prefix_(prefix)
+  , suffix_(suffix)
+{
+}
+
+bool CacheDirectory::setDirectory(const std::string& directory, time_t maxAge)
+{
+  directory_ = directory;
+  if (directory_.empty())
+    return false;
+
+  mkdir(directory_.c_str(), 0777);
+  DIR* dir = opendir(directory_.c_str());
+  if (!dir) {
+    METLIBS_LOG_WARN("cannot open cache directory '" << directory_ << "', not using it");
+    directory_.clear();
+    return false;
+  }
+  const time_t old = time(0) - maxAge;
+  const size_t lp = prefix_.size(), ls = suffix_.size();
+  while (struct dirent* de = readdir(dir)) {
+    const std::string name = de->d_name;
+    if (name.size() <= lp + ls || name.compare(0, lp, prefix_) != 0
+        || name.compare(name.size() - ls, ls, suffix_) != 0)
+      continue;
+    const std::string p = directory_ + "/" + name;
+    struct stat st;
+    if (stat(p.c_str(), &st) == 0 && st.st_mtime < old)
+      unlink(p.c_str());
+  }
+  closedir(dir);
+  return true;
+}
+
+std::string CacheDirectory::path(const std::string& id) const
+{
+  std::ostringstream name;
+  name << directory_ << '/' << prefix_ << std::hex << hash_fnv1a(id) << suffix_;
+  return name.str();
+}
+
+// static
+bool CacheDirectory::write(const std::string& path, const std::string& data)
+{
+  // write to a temporary file and rename, other processes might be reading
+  std::ostringstream tmp;
+  tmp << path << '.' << getpid() << ".tmp";
+  {
+    std::ofstream out(tmp.str().c_str(), std::ios::binary);
+    out.write(data.data(), data.size());
+    if (!out) {
+      METLIBS_LOG_WARN("cannot write cache file '" << tmp.str() << "'");
+      out.close();
+      unlink(tmp.str().c_str());
+      return false;
+    }
+  }
+  if (rename(tmp.str().c_str(), path.c_str()) != 0) {
+    METLIBS_LOG_WARN("cannot rename cache file '" << tmp.str() << "'");
+    unlink(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+// static
+void CacheDirectory::touch(const std::string& path)
+{
+  utime(path.c_str(), 0);
+}
+
+} // namespace diutil
@@ -0,0 +1,48 @@
+#ifndef DIANA_UTIL_CACHE_DIRECTORY_H
+#define DIANA_UTIL_CACHE_DIRECTORY_H
+
+#include <ctime>
+#include <string>
+
+namespace diutil {
+
+/*! Directory with cache files that may be shared by several processes.
+ *
+ * Files are named <prefix><hash of id><suffix>. Files are written to a
+ * temporary file and renamed, so that readers never see partial files.
+ * This class is not thread-safe; users must lock.
+ */
+class CacheDirectory {
+public:
+  CacheDirectory(const std::string& prefix, const std::string& suffix = ".cache");
+
+  /*! Use directory, creating it if necessary. Cache files not used for
+   *  maxAge seconds are removed. With an empty or unusable directory, the
+   *  cache is disabled. Returns true if the directory can be used.
+   */
+  bool setDirectory(const std::string& directory, time_t maxAge);
+
+  const std::string& directory() const
+    { return directory_; }
+
+  bool enabled() const
+    { return !directory_.empty(); }
+
+  //! path of the cache file for id
+  std::string path(const std::string& id) const;
+
+  //! replace the file at path with data, return false on error
+  static bool write(const std::string& path, const std::string& data);
+
+  //! mark a cache file as used, see setDirectory
+  static void touch(const std::string& path);
+
+private:
+  std::string prefix_;
+  std::string suffix_;
+  std::string directory_;
+};
+
+} // namespace diutil
+
+#endif // DIANA_UTIL_CACHE_DIRECTORY_H
@@ -0,0 +1,341 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+
+#include <fnmatch.h>
+#include <glob.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#define DIUTIL_HAVE_INOTIFY 1
+#endif
+
+#define MILOGGER_CATEGORY "diana.util.FileWatch"
+#include <miLogger/miLogging.h>
+
+namespace diutil {
+
+struct WatchedPattern {
+  WatchedPattern(const std::string& p, int f);
+
+  std::string pattern;
+  int flags;
+  std::string dir;    //!< directory to watch, empty if polling is necessary
+  std::string prefix; //!< prefix for file names in dir to compare with pattern
+  int wd;             //!< inotify watch descriptor, -1 if polling
+  bool rescan;        //!< true if glob is necessary
+  FileStamps files;
+  unsigned long generation;
+};
+
+WatchedPattern::WatchedPattern(const std::string& p, int f)
+  : pattern(p)
+  , flags(f)
+  , wd(-1)
+  , rescan(true)
+  , generation(0)
+{
+  const size_t slash = pattern.rfind('/');
+  if (slash == std::string::npos) {
+    dir = ".";
+  } else {
+    prefix = pattern.substr(0, slash + 1);
+    dir = (slash == 0) ? "/" : pattern.substr(0, slash);
+  }
+  // fnmatch cannot check braces, and only one directory is watched
+  if (dir.find_first_of("*?[") != std::string::npos
+      || ((flags & GLOB_BRACE) && pattern.find('{') != std::string::npos))
+    dir.clear();
+}
+
+namespace {
+
+bool stampFile(const std::string& path, FileStamp& stamp)
+{
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return false;
+  stamp = FileStamp(st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, st.st_size);
+  return true;
+}
+
+class FileWatcher {
+public:
+  static FileWatcher& instance();
+
+  std::shared_ptr<WatchedPattern> watch(const std::string& pattern, int flags);
+
+  //! bring the file list up to date; mutex must be locked
+  void refresh(WatchedPattern& wp);
+
+  std::mutex mutex;
+
+private:
+  FileWatcher();
+
+  void release(WatchedPattern* wp);
+  void addWatch(WatchedPattern& wp);
+  void readEvents();
+  void fileEvent(int wd, const std::string& name);
+  void scan(WatchedPattern& wp);
+
+private:
+  int fd_;
+  std::map<std::string, std::weak_ptr<WatchedPattern> > patterns_;
+  std::map<int, std::vector<WatchedPattern*> > byWatch_;
+};
+
+FileWatcher::FileWatcher()
+  : fd_(-1)
+{
+#ifdef DIUTIL_HAVE_INOTIFY
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ < 0)
+    METLIBS_LOG_WARN("inotify not available, polling for file changes");
+#endif
+}
+
+// static
+FileWatcher& FileWatcher::instance()
+{
+  // never deleted, FileWatch instances might be destroyed at exit
+  static FileWatcher* watcher = new FileWatcher;
+  return *watcher;
+}
+
+std::shared_ptr<WatchedPattern> FileWatcher::watch(const std::string& pattern, int flags)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::ostringstream key;
+  key << flags << ':' << pattern;
+  std::weak_ptr<WatchedPattern>& w = patterns_[key.str()];
+  std::shared_ptr<WatchedPattern> wp = w.lock();
+  if (!wp) {
+    wp = std::shared_ptr<WatchedPattern>(new WatchedPattern(pattern, flags),
+        [this](WatchedPattern* p) { release(p); delete p; });
+    w = wp;
+  }
+  return wp;
+}
+
+void FileWatcher::release(WatchedPattern* wp)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (wp->wd >= 0) {
+    std::vector<WatchedPattern*>& wps = byWatch_[wp->wd];
+    wps.erase(std::remove(wps.begin(), wps.end(), wp), wps.end());
+    if (wps.empty()) {
+#ifdef DIUTIL_HAVE_INOTIFY
+      inotify_rm_watch(fd_, wp->wd);
+#endif
+      byWatch_.erase(wp->wd);
+    }
+  }
+  for (std::map<std::string, std::weak_ptr<WatchedPattern> >::iterator it = patterns_.begin(); it != patterns_.end(); ) {
+    if (it->second.expired())
+      patterns_.erase(it++);
+    else
+      ++it;
+  }
+}
+
+void FileWatcher::refresh(WatchedPattern& wp)
+{
+  readEvents();
+  if (wp.wd < 0 && !wp.dir.empty())
+    addWatch(wp);
+  if (wp.wd < 0 || wp.rescan)
+    scan(wp);
+}
+
+void FileWatcher::addWatch(WatchedPattern& wp)
+{
+#ifdef DIUTIL_HAVE_INOTIFY
+  if (fd_ < 0)
+    return;
+  const uint32_t mask = IN_CREATE | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO
+      | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF;
+  const int wd = inotify_add_watch(fd_, wp.dir.c_str(), mask);
+  if (wd < 0) {
+    METLIBS_LOG_DEBUG("cannot watch '" << wp.dir << "', polling");
+    return;
+  }
+  wp.wd = wd;
+  wp.rescan = true;
+  byWatch_[wd].push_back(&wp);
+#endif
+}
+
+void FileWatcher::readEvents()
+{
+#ifdef DIUTIL_HAVE_INOTIFY
+  if (fd_ < 0)
+    return;
+
+  char buffer[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+  while (true) {
+    const ssize_t n = read(fd_, buffer, sizeof(buffer));
+    if (n <= 0) {
+      if (n < 0 && errno != EAGAIN && errno != EINTR)
+        METLIBS_LOG_WARN("error reading inotify events");
+      break;
+    }
+    for (const char* p = buffer; p < buffer + n; ) {
+      const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+      p += sizeof(struct inotify_event) + ev->len;
+
+      if (ev->mask & IN_Q_OVERFLOW) {
+        for (std::map<int, std::vector<WatchedPattern*> >::iterator it = byWatch_.begin(); it != byWatch_.end(); ++it) {
+          for (size_t i = 0; i < it->second.size(); ++i)
+            it->second[i]->rescan = true;
+        }
+      } else if (ev->mask & IN_IGNORED) {
+        // directory removed, poll until it is back
+        std::map<int, std::vector<WatchedPattern*> >::iterator it = byWatch_.find(ev->wd);
+        if (it != byWatch_.end()) {
+          for (size_t i = 0; i < it->second.size(); ++i) {
+            it->second[i]->wd = -1;
+            it->second[i]->rescan = true;
+          }
+          byWatch_.erase(it);
+        }
+      } else if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        inotify_rm_watch(fd_, ev->wd); // IN_IGNORED follows
+      } else if (ev->len > 0) {
+        fileEvent(ev->wd, ev->name);
+      }
+    }
+  }
+#endif
+}
+
+void FileWatcher::fileEvent(int wd, const std::string& name)
+{
+  std::map<int, std::vector<WatchedPattern*> >::iterator it = byWatch_.find(wd);
+  if (it == byWatch_.end())
+    return;
+  for (size_t i = 0; i < it->second.size(); ++i) {
+    WatchedPattern& wp = *it->second[i];
+    if (wp.rescan)
+      continue; // will be scanned anyway
+    const std::string path = wp.prefix + name;
+    if (fnmatch(wp.pattern.c_str(), path.c_str(), FNM_PATHNAME | FNM_PERIOD) != 0)
+      continue;
+
+    FileStamp stamp;
+    FileStamps::iterator itF = wp.files.find(path);
+    if (stampFile(path, stamp)) {
+      if (itF == wp.files.end()) {
+        wp.files.insert(std::make_pair(path, stamp));
+        wp.generation += 1;
+      } else if (itF->second != stamp) {
+        itF->second = stamp;
+        wp.generation += 1;
+      }
+    } else if (itF != wp.files.end()) {
+      wp.files.erase(itF);
+      wp.generation += 1;
+    }
+  }
+}
+
+void FileWatcher::scan(WatchedPattern& wp)
+{
+  FileStamps files;
+  glob_t globBuf;
+  if (glob(wp.pattern.c_str(), wp.flags, 0, &globBuf) == 0) {
+    for (size_t i = 0; i < globBuf.gl_pathc; ++i) {
+      FileStamp stamp;
+      if (stampFile(globBuf.gl_pathv[i], stamp))
+        files.insert(std::make_pair(std::string(globBuf.gl_pathv[i]), stamp));
+    }
+  }
+  globfree(&globBuf);
+
+  wp.rescan = false;
+  if (files != wp.files) {
+    wp.files.swap(files);
+    wp.generation += 1;
+  }
+}
+
+} // namespace
+
+// ========================================================================
+
+FileWatch::FileWatch(const std::string& pattern, int glob_flags)
+  : watched_(FileWatcher::instance().watch(pattern, glob_flags))
+  , seenGeneration_(-1)
+{
+}
+
+FileWatch::~FileWatch()
+{
+}
+
+const std::string& FileWatch::pattern() const
+{
+  return watched_->pattern;
+}
+
+bool FileWatch::changed()
+{
+  FileWatcher& fw = FileWatcher::instance();
+  std::lock_guard<std::mutex> lock(fw.mutex);
+  fw.refresh(*watched_);
+  return watched_->generation != seenGeneration_;
+}
+
+bool FileWatch::update(Changes* changes)
+{
+  FileWatcher& fw = FileWatcher::instance();
+  std::lock_guard<std::mutex> lock(fw.mutex);
+  fw.refresh(*watched_);
+  if (watched_->generation == seenGeneration_)
+    return false;
+
+  const FileStamps& files = watched_->files;
+  bool changed = false;
+  FileStamps::const_iterator itO = seen_.begin(), itN = files.begin();
+  while (itO != seen_.end() || itN != files.end()) {
+    if (itN == files.end() || (itO != seen_.end() && itO->first < itN->first)) {
+      if (changes)
+        changes->removed.push_back(itO->first);
+      changed = true;
+      ++itO;
+    } else if (itO == seen_.end() || itN->first < itO->first) {
+      if (changes)
+        changes->added.push_back(itN->first);
+      changed = true;
+      ++itN;
+    } else {
+      if (itO->second != itN->second) {
+        if (changes)
+          changes->changed.push_back(itN->first);
+        changed = true;
+      }
+      ++itO;
+      ++itN;
+    }
+  }
+
+  seen_ = files;
+  seenGeneration_ = watched_->generation;
+  return changed;
+}
+
+std::vector<std::string> FileWatch::fileNames() const
+{
+  std::vector<std::string> names;
+  names.reserve(seen_.size());
+  for (FileStamps::const_iterator it = seen_.begin(); it != seen_.end(); ++it)
+    names.push_back(it->first);
+  return names;
+}
+
+} // namespace diutil
@@ -0,0 +1,83 @@
+#ifndef DIANA_UTIL_FILE_WATCHER_H
+#define DIANA_UTIL_FILE_WATCHER_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace diutil {
+
+struct FileStamp {
+  long long mtime; //!< nanoseconds
+  long long size;
+
+  FileStamp()
+    : mtime(0), size(0) { }
+  FileStamp(long long m, long long s)
+    : mtime(m), size(s) { }
+
+  bool operator==(const FileStamp& o) const
+    { return mtime == o.mtime && size == o.size; }
+  bool operator!=(const FileStamp& o) const
+    { return !(*this == o); }
+};
+
+typedef std::map<std::string, FileStamp> FileStamps;
+
+struct WatchedPattern;
+
+/*! Incremental list of files matching a glob pattern.
+ *
+ * On Linux, the directory containing the files is watched with inotify,
+ * so that checking for changes does not need glob and stat for all
+ * files. Patterns with wildcards in the directory part, brace patterns,
+ * and directories that cannot be watched are polled with glob and stat.
+ *
+ * Each FileWatch reports the changes since its own last update, also
+ * if several FileWatch instances use the same pattern.
+ */
+class FileWatch {
+public:
+  struct Changes {
+    std::vector<std::string> added, changed, removed;
+
+    bool empty() const
+      { return added.empty() && changed.empty() && removed.empty(); }
+  };
+
+  explicit FileWatch(const std::string& pattern, int glob_flags = 0);
+  ~FileWatch();
+
+  const std::string& pattern() const;
+
+  //! true if files were added, changed or removed since the last update
+  bool changed();
+
+  /*! Update the file list. Changes since the last update are appended
+   *  to changes, if given. Returns true if there were changes.
+   */
+  bool update(Changes* changes = 0);
+
+  //! files matching the pattern at the last update
+  const FileStamps& files() const
+    { return seen_; }
+
+  //! names of the files matching the pattern at the last update, sorted
+  std::vector<std::string> fileNames() const;
+
+private:
+  FileWatch(const FileWatch&) = delete;
+  FileWatch& operator=(const FileWatch&) = delete;
+
+private:
+  std::shared_ptr<WatchedPattern> watched_;
+  FileStamps seen_;
+  unsigned long seenGeneration_;
+};
+
+typedef std::shared_ptr<FileWatch> FileWatch_p;
+
+} // namespace diutil
+
+#endif // DIANA_UTIL_FILE_WATCHER_H
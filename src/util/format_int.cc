@@ -1,8 +1,22 @@
 
 #include "format_int.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
 namespace diutil {
 
+namespace {
+
+const int MAX_FAST_DECIMALS = 6;
+const double POW10[MAX_FAST_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+//! values above this are formatted with snprintf
+const double MAX_FAST_VALUE = 1e12;
+
+} // namespace
+
 void format_int(int value, std::string& out, int start, int width, char fill)
 {
   if (value < 0 || width <= 0 || start < 0)
@@ -21,4 +35,44 @@ void format_int(int value, std::string& out, int start, int width, char fill)
   }
 }
 
+std::string format_fixed(float value, int decimals, bool showpos)
+{
+  const double v = value;
+  if (decimals < 0 || decimals > MAX_FAST_DECIMALS || !(std::fabs(v) < MAX_FAST_VALUE)) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), showpos ? "%+.*f" : "%.*f", std::max(decimals, 0), v);
+    return buf;
+  }
+
+  // exact for floats, as 10^6 needs less than 53-24 bits; nearbyint rounds
+  // exact ties to even, like printf
+  unsigned long long n = (unsigned long long) std::nearbyint(std::fabs(v) * POW10[decimals]);
+
+  char buf[32];
+  char* end = buf + sizeof(buf);
+  char* p = end;
+  for (int d = 0; d < decimals; ++d) {
+    *--p = '0' + (n % 10);
+    n /= 10;
+  }
+  if (decimals > 0)
+    *--p = '.';
+  do {
+    *--p = '0' + (n % 10);
+    n /= 10;
+  } while (n > 0);
+  if (std::signbit(value))
+    *--p = '-';
+  else if (showpos)
+    *--p = '+';
+  return std::string(p, end);
+}
+
+std::string format_general(float value)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%g", double(value));
+  return buf;
+}
+
 } // namespace diutil
@@ -14,6 +14,18 @@ namespace diutil {
  */
 void format_int(int value, std::string& out, int start, int width, char fill = '0');
 
+/*!
+ * Format a number with a fixed number of decimals, giving the same result
+ * as printf("%.*f") or std::ostream with std::ios::fixed, but much faster,
+ * e.g. for plotting many observation values.
+ * \param decimals  number of decimals
+ * \param showpos   prefix non-negative values with '+'
+ */
+std::string format_fixed(float value, int decimals, bool showpos = false);
+
+//! Format a number like printf("%g"), std::ostream with default flags, or QString::number.
+std::string format_general(float value);
+
 } // namespace diutil
 
 #endif // DIANA_UTIL_FORMAT_INT_H
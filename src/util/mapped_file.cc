@@ -0,0 +1,43 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MILOGGER_CATEGORY "diana.util.MappedFile"
+#include <miLogger/miLogging.h>
+
+namespace diutil {
+
+MappedFile::MappedFile(const std::string& filename)
+  : data_(0)
+  , size_(0)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    METLIBS_LOG_DEBUG("cannot open '" << filename << "'");
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      data_ = static_cast<const char*>(m);
+      size_ = st.st_size;
+    } else {
+      METLIBS_LOG_DEBUG("cannot map '" << filename << "'");
+    }
+  }
+  // the mapping stays valid after closing the file
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (data_)
+    munmap(const_cast<char*>(data_), size_);
+}
+
+} // namespace diutil
@@ -0,0 +1,35 @@
+#ifndef DIANA_UTIL_MAPPED_FILE_H
+#define DIANA_UTIL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace diutil {
+
+/*! Read-only memory mapping of a complete file.
+ *
+ * data() is null if the file cannot be opened or mapped, or if it is empty.
+ */
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  const char* data() const
+    { return data_; }
+
+  size_t size() const
+    { return size_; }
+
+private:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+  const char* data_;
+  size_t size_;
+};
+
+} // namespace diutil
+
+#endif // DIANA_UTIL_MAPPED_FILE_H
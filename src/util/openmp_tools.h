@@ -13,10 +13,10 @@
 #define DIUTIL_OPENMP(options)                  \
   _Pragma(DIUTIL_STRING_HELPER1(omp options))
 
+// the thread count is a clause, not omp_set_num_threads, so that the
+// process-wide setting is not changed by every loop
 #define DIUTIL_OPENMP_PARALLEL(loopsize,options)                        \
-  omp_set_dynamic(0);                                                   \
-  omp_set_num_threads(diutil::compute_num_threads(loopsize));           \
-  _Pragma(DIUTIL_STRING_HELPER1(omp parallel options))
+  _Pragma(DIUTIL_STRING_HELPER1(omp parallel options num_threads(diutil::compute_num_threads(loopsize))))
 
 #else // !HAVE_OPENMP
 
@@ -28,7 +28,11 @@
 namespace diutil {
 
 /*! A little utility function that dynamically computes the best number of openmp threads
-  based on the number of iterations (nx*ny) for example. */
+  based on the number of iterations (nx*ny) for example.
+
+  The result never exceeds the thread count of diutil::ThreadPool, and is 1 when
+  called from one of the pool's worker threads, as the pool keeps the other cores
+  busy already. */
 int compute_num_threads(long loop_size);
 
 } // namespace diutil
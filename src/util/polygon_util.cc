@@ -3,6 +3,10 @@
 
 #include "diField/diRectangle.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace diutil {
 
 namespace detail {
@@ -27,6 +31,19 @@ int where(const Rectangle& rect, const QPointF& point)
   return w;
 }
 
+//! distance of p from the segment a-b, or from a if a == b
+double distance(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+  const double dx = b.x() - a.x(), dy = b.y() - a.y();
+  const double px = p.x() - a.x(), py = p.y() - a.y();
+  const double len2 = dx*dx + dy*dy;
+  if (len2 <= 0)
+    return std::sqrt(px*px + py*py);
+  const double t = std::max(0.0, std::min(1.0, (px*dx + py*dy) / len2));
+  const double ex = px - t*dx, ey = py - t*dy;
+  return std::sqrt(ex*ex + ey*ey);
+}
+
 } // namespace detail
 
 QPolygonF trimToRectangle(const Rectangle& rect, const QPolygonF& polygon)
@@ -53,4 +70,52 @@ QPolygonF trimToRectangle(const Rectangle& rect, const QPolygonF& polygon)
   return trimmed;
 }
 
+void simplificationImportance(const QPolygonF& line, std::vector<float>& importance)
+{
+  const int n = line.size();
+  importance.assign(n, std::numeric_limits<float>::infinity());
+  if (n < 3)
+    return;
+
+  struct Span {
+    int a, b;
+    float limit; //!< importance of the point that split the parent span
+  };
+  std::vector<Span> todo;
+  todo.push_back(Span{0, n-1, std::numeric_limits<float>::infinity()});
+  while (!todo.empty()) {
+    const Span s = todo.back();
+    todo.pop_back();
+    if (s.b - s.a < 2)
+      continue;
+
+    const QPointF& pa = line.at(s.a);
+    const QPointF& pb = line.at(s.b);
+    int m = s.a + 1;
+    double dm = -1;
+    for (int i = s.a + 1; i < s.b; ++i) {
+      const double d = detail::distance(line.at(i), pa, pb);
+      if (d > dm) {
+        dm = d;
+        m = i;
+      }
+    }
+    // a point cannot be more important than the point that made it visible
+    const float imp = std::min(float(dm), s.limit);
+    importance[m] = imp;
+    todo.push_back(Span{s.a, m, imp});
+    todo.push_back(Span{m, s.b, imp});
+  }
+}
+
+QPolygonF simplified(const QPolygonF& line, const std::vector<float>& importance, float tolerance)
+{
+  QPolygonF s;
+  for (int i = 0; i < line.size(); ++i) {
+    if (importance[i] > tolerance)
+      s << line.at(i);
+  }
+  return s;
+}
+
 } // namespace diutil
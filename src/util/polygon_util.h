@@ -4,6 +4,8 @@
 
 #include <QPolygonF>
 
+#include <vector>
+
 class Rectangle;
 
 namespace diutil {
@@ -16,6 +18,19 @@ namespace diutil {
  */
 QPolygonF trimToRectangle(const Rectangle& rect, const QPolygonF& polygon);
 
+/*!
+ * Compute Douglas-Peucker importance of the points of a line.
+ *
+ * The line simplified with tolerance t consists of the points with
+ * importance > t. The first and last points have infinite importance.
+ * For closed lines (first == last point), distances are measured from
+ * the first point.
+ */
+void simplificationImportance(const QPolygonF& line, std::vector<float>& importance);
+
+//! select the points of line with importance > tolerance
+QPolygonF simplified(const QPolygonF& line, const std::vector<float>& importance, float tolerance);
+
 } // namespace diutil
 
 #endif // DIANA_UTIL_POLYGON_UTIL_H
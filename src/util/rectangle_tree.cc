@@ -0,0 +1,219 @@
+#include "rectangle_tree.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace diutil {
+
+namespace {
+
+//! maximum number of children per node
+const size_t NODE_SIZE = 16;
+
+//! minimum number of changes before a RectangleIndex is rebuilt
+const size_t MIN_CHANGES = 64;
+
+template<class T>
+float centerX(const T& t)
+{
+  return t.box.x1 + t.box.x2;
+}
+
+template<class T>
+float centerY(const T& t)
+{
+  return t.box.y1 + t.box.y2;
+}
+
+/*! Sort items into tiles: slices along x, each slice sorted along y.
+ *  Consecutive groups of NODE_SIZE items are then close to each other.
+ */
+template<class T>
+void sortTiles(std::vector<T>& items)
+{
+  const size_t n = items.size();
+  const size_t groups = (n + NODE_SIZE - 1) / NODE_SIZE;
+  const size_t slices = std::max<size_t>(1, (size_t)std::ceil(std::sqrt(double(groups))));
+  const size_t perSlice = slices * NODE_SIZE;
+
+  std::sort(items.begin(), items.end(),
+      [](const T& a, const T& b) { return centerX(a) < centerX(b); });
+  for (size_t s = 0; s < n; s += perSlice) {
+    std::sort(items.begin() + s, items.begin() + std::min(n, s + perSlice),
+        [](const T& a, const T& b) { return centerY(a) < centerY(b); });
+  }
+}
+
+} // namespace
+
+void RectangleTree::Box::extend(const Box& o)
+{
+  x1 = std::min(x1, o.x1);
+  y1 = std::min(y1, o.y1);
+  x2 = std::max(x2, o.x2);
+  y2 = std::max(y2, o.y2);
+}
+
+RectangleTree::RectangleTree()
+{
+}
+
+void RectangleTree::clear()
+{
+  entries_.clear();
+  nodes_.clear();
+}
+
+void RectangleTree::build(const std::vector<Rectangle>& boxes)
+{
+  clear();
+  if (boxes.empty())
+    return;
+
+  entries_.reserve(boxes.size());
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    Entry e;
+    e.box = Box(boxes[i]);
+    e.index = i;
+    entries_.push_back(e);
+  }
+  sortTiles(entries_);
+
+  // leaves
+  std::vector<Node> level;
+  for (size_t b = 0; b < entries_.size(); b += NODE_SIZE) {
+    Node n;
+    n.begin = b;
+    n.end = std::min(entries_.size(), b + NODE_SIZE);
+    n.leaf = true;
+    n.box = entries_[b].box;
+    for (size_t i = b + 1; i < n.end; ++i)
+      n.box.extend(entries_[i].box);
+    level.push_back(n);
+  }
+
+  // upper levels, each stored after its children
+  while (true) {
+    sortTiles(level);
+    const size_t first = nodes_.size();
+    nodes_.insert(nodes_.end(), level.begin(), level.end());
+    if (level.size() == 1)
+      break;
+
+    std::vector<Node> upper;
+    for (size_t b = 0; b < level.size(); b += NODE_SIZE) {
+      Node n;
+      n.begin = first + b;
+      n.end = first + std::min(level.size(), b + NODE_SIZE);
+      n.leaf = false;
+      n.box = nodes_[n.begin].box;
+      for (size_t i = n.begin + 1; i < n.end; ++i)
+        n.box.extend(nodes_[i].box);
+      upper.push_back(n);
+    }
+    std::swap(level, upper);
+  }
+}
+
+void RectangleTree::query(const Rectangle& r, std::vector<size_t>& found) const
+{
+  if (nodes_.empty())
+    return;
+
+  const size_t before = found.size();
+  query(nodes_.back(), Box(r), found);
+  std::sort(found.begin() + before, found.end());
+}
+
+void RectangleTree::query(const Node& node, const Box& b, std::vector<size_t>& found) const
+{
+  if (!node.box.intersects(b))
+    return;
+  if (node.leaf) {
+    for (size_t i = node.begin; i < node.end; ++i) {
+      if (entries_[i].box.intersects(b))
+        found.push_back(entries_[i].index);
+    }
+  } else {
+    for (size_t i = node.begin; i < node.end; ++i)
+      query(nodes_[i], b, found);
+  }
+}
+
+RectangleIndex::RectangleIndex()
+{
+}
+
+void RectangleIndex::clear()
+{
+  boxes_.clear();
+  state_.clear();
+  changed_.clear();
+  treeIds_.clear();
+  tree_.clear();
+}
+
+void RectangleIndex::set(size_t id, const Rectangle& box)
+{
+  if (id >= boxes_.size()) {
+    boxes_.resize(id + 1);
+    state_.resize(id + 1, ABSENT);
+  }
+  boxes_[id] = box;
+  state_[id] = CHANGED;
+  changed(id);
+}
+
+void RectangleIndex::remove(size_t id)
+{
+  if (contains(id)) {
+    state_[id] = ABSENT;
+    changed(id);
+  }
+}
+
+void RectangleIndex::changed(size_t id)
+{
+  changed_.push_back(id);
+  if (changed_.size() > std::max(MIN_CHANGES, treeIds_.size() / 4))
+    rebuild();
+}
+
+void RectangleIndex::rebuild()
+{
+  std::vector<Rectangle> boxes;
+  treeIds_.clear();
+  for (size_t id = 0; id < state_.size(); ++id) {
+    if (state_[id] == ABSENT)
+      continue;
+    state_[id] = IN_TREE;
+    treeIds_.push_back(id);
+    boxes.push_back(boxes_[id]);
+  }
+  changed_.clear();
+  tree_.build(boxes);
+}
+
+void RectangleIndex::query(const Rectangle& r, std::vector<size_t>& found) const
+{
+  const size_t before = found.size();
+
+  std::vector<size_t> inTree;
+  tree_.query(r, inTree);
+  for (size_t i : inTree) {
+    const size_t id = treeIds_[i];
+    if (state_[id] == IN_TREE)
+      found.push_back(id);
+  }
+
+  const size_t fromTree = found.size();
+  for (size_t id : changed_) {
+    if (state_[id] == CHANGED && r.intersects(boxes_[id]))
+      found.push_back(id);
+  }
+  std::sort(found.begin() + fromTree, found.end());
+  found.erase(std::unique(found.begin() + fromTree, found.end()), found.end());
+  std::inplace_merge(found.begin() + before, found.begin() + fromTree, found.end());
+}
+
+} // namespace diutil
@@ -0,0 +1,104 @@
+#ifndef DIANA_UTIL_RECTANGLE_TREE_H
+#define DIANA_UTIL_RECTANGLE_TREE_H
+
+#include "diField/diRectangle.h"
+
+#include <vector>
+
+namespace diutil {
+
+/*! Static R-tree of bounding boxes, for finding the items in a map area
+ *  without checking all of them.
+ *
+ * The tree is bulk-loaded with the sort-tile-recursive method. It must be
+ * rebuilt when items are added, moved or removed.
+ */
+class RectangleTree {
+public:
+  RectangleTree();
+
+  //! build the tree for boxes; query results are indices into boxes
+  void build(const std::vector<Rectangle>& boxes);
+
+  void clear();
+
+  bool empty() const
+    { return entries_.empty(); }
+
+  size_t size() const
+    { return entries_.size(); }
+
+  /*! Find all boxes intersecting r. Indices are appended to found and
+   *  sorted, so that items can be drawn in their original order.
+   */
+  void query(const Rectangle& r, std::vector<size_t>& found) const;
+
+private:
+  struct Box {
+    float x1, y1, x2, y2;
+    Box() { }
+    Box(const Rectangle& r)
+      : x1(r.x1), y1(r.y1), x2(r.x2), y2(r.y2) { }
+    bool intersects(const Box& o) const
+      { return x1 <= o.x2 && o.x1 <= x2 && y1 <= o.y2 && o.y1 <= y2; }
+    void extend(const Box& o);
+  };
+
+  struct Entry {
+    Box box;
+    size_t index;
+  };
+
+  struct Node {
+    Box box;
+    size_t begin, end; //!< children in nodes_ or, for leaves, in entries_
+    bool leaf;
+  };
+
+  void query(const Node& node, const Box& b, std::vector<size_t>& found) const;
+
+private:
+  std::vector<Entry> entries_;
+  std::vector<Node> nodes_; //!< root is the last node
+};
+
+/*! Boxes identified by number that may be added, moved and removed.
+ *
+ * Changes are kept in a list that is searched linearly, next to a
+ * RectangleTree with the boxes from the last rebuild. The tree is rebuilt
+ * when the list of changes becomes long.
+ */
+class RectangleIndex {
+public:
+  RectangleIndex();
+
+  void clear();
+
+  //! add a box with the given id, or move it if it exists
+  void set(size_t id, const Rectangle& box);
+
+  void remove(size_t id);
+
+  bool contains(size_t id) const
+    { return id < state_.size() && state_[id] != ABSENT; }
+
+  //! find the ids of all boxes intersecting r, appended to found and sorted
+  void query(const Rectangle& r, std::vector<size_t>& found) const;
+
+private:
+  void changed(size_t id);
+  void rebuild();
+
+private:
+  enum State { ABSENT, IN_TREE, CHANGED };
+
+  std::vector<Rectangle> boxes_;  //!< by id
+  std::vector<unsigned char> state_; //!< by id
+  std::vector<size_t> changed_;  //!< ids changed since the last rebuild, may contain duplicates
+  std::vector<size_t> treeIds_;  //!< ids for the boxes in tree_
+  RectangleTree tree_;
+};
+
+} // namespace diutil
+
+#endif // DIANA_UTIL_RECTANGLE_TREE_H
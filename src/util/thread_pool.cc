@@ -0,0 +1,279 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+
+#define MILOGGER_CATEGORY "diana.util.ThreadPool"
+#include <miLogger/miLogging.h>
+
+namespace diutil {
+
+namespace {
+
+int configuredThreadCount = 0;
+
+//! index of the worker queue for the current thread, -1 if not a worker
+thread_local int currentWorker = -1;
+
+int threadCountFromEnvironment()
+{
+  static const char* variables[] = { "DIANA_THREADS", "OMP_THREAD_LIMIT", "OMP_NUM_THREADS", 0 };
+  for (const char** v = variables; *v; ++v) {
+    if (const char* value = getenv(*v)) {
+      const int count = atoi(value);
+      if (count > 0)
+        return count;
+    }
+  }
+  const int cores = std::thread::hardware_concurrency();
+  return (cores > 0) ? cores : 1;
+}
+
+} // namespace
+
+struct ThreadPool::Queue {
+  struct Entry {
+    Task task;
+    const TaskGroup* group;
+  };
+
+  std::mutex mutex;
+  std::deque<Entry> tasks;
+};
+
+ThreadPool::ThreadPool(int count)
+  : threadCount_(std::max(1, count))
+  , queued_(0)
+  , stop_(false)
+{
+  METLIBS_LOG_DEBUG("starting thread pool with " << threadCount_ << " threads");
+  // the calling thread works while waiting, so only count-1 workers
+  for (int i = 0; i < threadCount_; ++i)
+    queues_.push_back(std::unique_ptr<Queue>(new Queue));
+  for (int i = 0; i < threadCount_ - 1; ++i)
+    workers_.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeup_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+}
+
+// static
+void ThreadPool::setThreadCount(int count)
+{
+  configuredThreadCount = count;
+}
+
+// static
+ThreadPool& ThreadPool::instance()
+{
+  static ThreadPool pool(configuredThreadCount > 0 ? configuredThreadCount : threadCountFromEnvironment());
+  return pool;
+}
+
+// static
+bool ThreadPool::inWorker()
+{
+  return currentWorker >= 0;
+}
+
+void ThreadPool::submit(const Task& task, const TaskGroup* group)
+{
+  // the last queue is shared by all threads that are not workers
+  const int q = (currentWorker >= 0) ? currentWorker : (threadCount_ - 1);
+  {
+    std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+    queues_[q]->tasks.push_back(Queue::Entry{task, group});
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_ += 1;
+  }
+  wakeup_.notify_one();
+}
+
+bool ThreadPool::popTask(int worker, const TaskGroup* group, Task& task)
+{
+  if (group) {
+    // oldest task of the group from any queue
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      Queue& q = *queues_[i];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      const auto it = std::find_if(q.tasks.begin(), q.tasks.end(),
+          [group](const Queue::Entry& e) { return e.group == group; });
+      if (it != q.tasks.end()) {
+        task.swap(it->task);
+        q.tasks.erase(it);
+        queued_ -= 1;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // newest task from own queue first, it probably uses data in the cache
+  if (worker >= 0) {
+    Queue& own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task.swap(own.tasks.back().task);
+      own.tasks.pop_back();
+      queued_ -= 1;
+      return true;
+    }
+  }
+
+  // steal oldest task from other queues
+  const int n = queues_.size();
+  for (int k = 1; k <= n; ++k) {
+    const int i = (worker + k + n) % n;
+    if (i == worker)
+      continue;
+    Queue& other = *queues_[i];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task.swap(other.tasks.front().task);
+      other.tasks.pop_front();
+      queued_ -= 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::runPendingTask(const TaskGroup* group)
+{
+  Task task;
+  if (!popTask(currentWorker, group, task))
+    return false;
+  task();
+  return true;
+}
+
+void ThreadPool::work(int worker)
+{
+  currentWorker = worker;
+  while (true) {
+    Task task;
+    if (popTask(worker, 0, task)) {
+      try {
+        task();
+      } catch (std::exception& ex) {
+        METLIBS_LOG_ERROR("exception in task: " << ex.what());
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    wakeup_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    if (stop_)
+      return;
+  }
+}
+
+// ========================================================================
+
+TaskGroup::TaskGroup()
+  : pending_(0)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  try {
+    wait();
+  } catch (std::exception& ex) {
+    METLIBS_LOG_ERROR("exception in task: " << ex.what());
+  }
+}
+
+void TaskGroup::run(const Task& task)
+{
+  pending_ += 1;
+  ThreadPool::instance().submit([this, task]() {
+      std::exception_ptr error;
+      try {
+        task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      finished(error);
+    }, this);
+}
+
+void TaskGroup::finished(std::exception_ptr error)
+{
+  // notify while locked, wait() may destroy this group as soon as the lock is released
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error && !error_)
+    error_ = error;
+  pending_ -= 1;
+  done_.notify_all();
+}
+
+void TaskGroup::throttle(int maxPending)
+{
+  ThreadPool& pool = ThreadPool::instance();
+  // other threads, e.g. the gui or render thread holding the plot lock, must not
+  // run unrelated tasks that may take long or lock other mutexes
+  const TaskGroup* only = ThreadPool::inWorker() ? 0 : this;
+  while (pending_ > maxPending) {
+    // help with queued tasks instead of blocking a core
+    if (!pool.runPendingTask(only)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait_for(lock, std::chrono::milliseconds(1), [this, maxPending] { return pending_ <= maxPending; });
+    }
+  }
+}
+
+void TaskGroup::wait()
+{
+  throttle(0);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = std::exception_ptr();
+    std::rethrow_exception(error);
+  }
+}
+
+// ========================================================================
+
+void parallel_for(size_t begin, size_t end, size_t grain,
+    const std::function<void(size_t, size_t)>& body)
+{
+  if (end <= begin)
+    return;
+
+  const size_t n = end - begin;
+  grain = std::max(grain, size_t(1));
+  const size_t threads = ThreadPool::instance().threadCount();
+  if (threads <= 1 || n < 2*grain) {
+    body(begin, end);
+    return;
+  }
+
+  // a few chunks per thread so that stealing can balance the load
+  const size_t nchunks = std::min(n / grain, 4 * threads);
+  const size_t chunk = (n + nchunks - 1) / nchunks;
+
+  TaskGroup group;
+  for (size_t i0 = begin + chunk; i0 < end; i0 += chunk) {
+    const size_t i1 = std::min(end, i0 + chunk);
+    group.run([&body, i0, i1]() { body(i0, i1); });
+  }
+  body(begin, std::min(end, begin + chunk));
+  group.wait();
+}
+
+} // namespace diutil
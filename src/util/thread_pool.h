@@ -0,0 +1,138 @@
+#ifndef UTIL_THREAD_POOL_H
+#define UTIL_THREAD_POOL_H 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace diutil {
+
+typedef std::function<void()> Task;
+
+class TaskGroup;
+
+/*! Process-wide pool of worker threads.
+ *
+ * Each worker has its own task queue; idle workers steal tasks from the
+ * others. Threads waiting for tasks (see TaskGroup::wait) run queued
+ * tasks themselves, so nested parallel loops neither deadlock nor start
+ * more threads than the configured number. Waiting threads that are not
+ * workers, like the gui thread, only run tasks of the group they wait
+ * for.
+ */
+class ThreadPool {
+public:
+  ~ThreadPool();
+
+  static ThreadPool& instance();
+
+  /*! Set the number of threads working in parallel, including the
+   *  calling thread. Must be called before the pool is used for the
+   *  first time. Without this, the number is taken from the environment
+   *  variables DIANA_THREADS, OMP_THREAD_LIMIT or OMP_NUM_THREADS, or
+   *  the number of cores.
+   */
+  static void setThreadCount(int count);
+
+  int threadCount() const
+    { return threadCount_; }
+
+  //! true if the calling thread is one of the pool's workers
+  static bool inWorker();
+
+  //! queue a task; prefer TaskGroup, which also waits for completion
+  void submit(const Task& task, const TaskGroup* group = 0);
+
+  /*! Run one queued task in the calling thread, return false if none was
+   *  queued. If group is not 0, only a task submitted for this group is run.
+   */
+  bool runPendingTask(const TaskGroup* group = 0);
+
+private:
+  explicit ThreadPool(int count);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  struct Queue;
+  bool popTask(int worker, const TaskGroup* group, Task& task);
+  void work(int worker);
+
+private:
+  int threadCount_;
+  std::vector<std::unique_ptr<Queue> > queues_; //! one per worker + one for other threads
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::atomic<int> queued_;
+  bool stop_;
+};
+
+/*! A set of tasks running in the ThreadPool.
+ *
+ * wait() returns when all tasks are finished and rethrows the first
+ * exception thrown by any of the tasks.
+ */
+class TaskGroup {
+public:
+  TaskGroup();
+  ~TaskGroup();
+
+  void run(const Task& task);
+  void wait();
+
+  /*! Wait until at most maxPending tasks of this group are pending, to
+   *  bound the memory used when tasks are added faster than they run.
+   *  Exceptions are only rethrown by wait().
+   */
+  void throttle(int maxPending);
+
+private:
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void finished(std::exception_ptr error);
+
+private:
+  std::atomic<int> pending_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+  std::exception_ptr error_;
+};
+
+/*! Run body(i0, i1) for subranges [i0,i1) of [begin,end) in parallel.
+ *
+ * Ranges with less than 2*grain elements, and all ranges if the pool
+ * has only one thread, are processed in the calling thread.
+ */
+void parallel_for(size_t begin, size_t end, size_t grain,
+    const std::function<void(size_t, size_t)>& body);
+
+/*! Like parallel_for, but body returns a value for its subrange; the
+ *  sum of all these values is returned.
+ */
+template<typename T, typename F>
+T parallel_sum(size_t begin, size_t end, size_t grain, F body)
+{
+  std::mutex mutex;
+  T sum = T();
+  parallel_for(begin, end, grain, [&](size_t i0, size_t i1) {
+      const T s = body(i0, i1);
+      std::lock_guard<std::mutex> lock(mutex);
+      sum += s;
+    });
+  return sum;
+}
+
+//! default grain size for loops over gridpoints or coordinates
+const size_t GRAIN_POINTS = 4096;
+
+} // namespace diutil
+
+#endif // UTIL_THREAD_POOL_H
@@ -35,6 +35,7 @@
 #include "wmsclient/WebMapPlot.h"
 #include "wmsclient/WebMapUtilities.h"
 #include "wmsclient/WebMapSlippyOSM.h"
+#include "wmsclient/WebMapTileCache.h"
 #include "wmsclient/WebMapWMS.h"
 #include "wmsclient/WebMapWMTS.h"
 
@@ -93,6 +94,7 @@ bool WebMapManager::parseSetup()
       QNetworkDiskCache* cache = new QNetworkDiskCache(network);
       cache->setCacheDirectory(QString::fromStdString(cachedir));
       network->setCache(cache);
+      WebMapTileCache::instance().setDirectory(cachedir + "/webmap");
     }
   }
 
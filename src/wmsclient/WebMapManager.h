@@ -79,6 +79,9 @@ public:
 
   std::vector<std::string> getAnnotations() const Q_DECL_OVERRIDE;
 
+  bool hasPlots() const Q_DECL_OVERRIDE
+    { return isEnabled() && !webmaps.empty(); }
+
   int getServiceCount() const
     { return webmapservices.size(); }
   WebMapService* getService(int i) const
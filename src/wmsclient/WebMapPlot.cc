@@ -31,6 +31,7 @@
 
 #include "WebMapPainting.h"
 #include "WebMapService.h"
+#include "WebMapTileCache.h"
 #include "WebMapUtilities.h"
 #include "diGLPainter.h"
 #include "diPaintGLPainter.h"
@@ -50,6 +51,12 @@ static const std::string EMPTY_STRING;
 static const std::vector<std::string> EMPTY_STRING_V;
 static const bool DEBUG_TILE_BORDERS = true;
 
+//! number of following time steps to prefetch
+static const int PREFETCH_TIMES = 2;
+
+//! width of the ring around the view to prefetch, relative to view size
+static const float PREFETCH_RING = 0.25f;
+
 WebMapPlot::WebMapPlot(WebMapService* service, const std::string& layer)
   : mService(service)
   , mLayerId(layer)
@@ -74,6 +81,7 @@ WebMapPlot::WebMapPlot(WebMapService* service, const std::string& layer)
 WebMapPlot::~WebMapPlot()
 {
   dropRequest();
+  dropPrefetch();
 }
 
 std::string WebMapPlot::title() const
@@ -179,25 +187,13 @@ void WebMapPlot::plot(DiGLPainter* gl, PlotOrder porder)
 
   if (!mRequest) {
     METLIBS_LOG_DEBUG("about to request tiles...");
-    const int phys_w = getStaticPlot()->getPhysWidth();
-    const int phys_h = getStaticPlot()->getPhysHeight();
-    const double mapw = getStaticPlot()->getPlotSize().width(),
-        m_per_unit = diutil::metersPerUnit(getStaticPlot()->getMapArea().P());
-    const double viewScale = mapw * m_per_unit / phys_w
-        / diutil::WMTS_M_PER_PIXEL;
-    METLIBS_LOG_DEBUG("map.w=" << mapw << " m/unit=" << m_per_unit
-        << " phys.w=" << phys_w << " scale=" << viewScale);
     mRequestCompleted = false;
-    mRequest = mService->createRequest(mLayer->identifier(),
-        getStaticPlot()->getPlotSize(), getStaticPlot()->getMapArea().P(), viewScale, phys_w, phys_h);
+    mRequest = createRequest(getStaticPlot()->getPlotSize(), viewScale(),
+        getStaticPlot()->getPhysWidth(), getStaticPlot()->getPhysHeight(), -1);
     if (!mRequest) {
       METLIBS_LOG_DEBUG("no request object");
       return;
     }
-    for (auto& dv : mDimensionValues)
-      mRequest->setDimensionValue(dv.first, dv.second);
-    if (mTimeIndex >= 0 && !mFixedTime.empty())
-      mRequest->setDimensionValue(mLayer->dimension(mTimeIndex).identifier(), mFixedTime);
     connect(mRequest, SIGNAL(completed()), this, SLOT(requestCompleted()));
     mRequest->submit();
   } else if (mRequestCompleted) {
@@ -226,6 +222,80 @@ void WebMapPlot::plot(DiGLPainter* gl, PlotOrder porder)
   }
 }
 
+double WebMapPlot::viewScale() const
+{
+  const int phys_w = getStaticPlot()->getPhysWidth();
+  const double mapw = getStaticPlot()->getPlotSize().width(),
+      m_per_unit = diutil::metersPerUnit(getStaticPlot()->getMapArea().P());
+  const double viewScale = mapw * m_per_unit / phys_w
+      / diutil::WMTS_M_PER_PIXEL;
+  METLIBS_LOG_DEBUG("map.w=" << mapw << " m/unit=" << m_per_unit
+      << " phys.w=" << phys_w << " scale=" << viewScale);
+  return viewScale;
+}
+
+WebMapRequest* WebMapPlot::createRequest(const Rectangle& viewRect, double viewScale, int w, int h, int timeIndex)
+{
+  WebMapRequest* request = mService->createRequest(mLayer->identifier(),
+      viewRect, getStaticPlot()->getMapArea().P(), viewScale, w, h);
+  if (!request)
+    return 0;
+  for (auto& dv : mDimensionValues)
+    request->setDimensionValue(dv.first, dv.second);
+  if (mTimeIndex >= 0) {
+    const WebMapDimension& timeDim = mLayer->dimension(mTimeIndex);
+    if (!mFixedTime.empty())
+      request->setDimensionValue(timeDim.identifier(), mFixedTime);
+    else if (timeIndex >= 0)
+      request->setDimensionValue(timeDim.identifier(), timeDim.value(timeIndex));
+  }
+  return request;
+}
+
+void WebMapPlot::prefetch()
+{
+  METLIBS_LOG_SCOPE();
+  dropPrefetch();
+  if (!mLayer || !WebMapTileCache::instance().enabled())
+    return;
+
+  StaticPlot* sp = getStaticPlot();
+  const Rectangle& view = sp->getPlotSize();
+  const int w = sp->getPhysWidth(), h = sp->getPhysHeight();
+  const double scale = viewScale();
+
+  if (mTimeIndex >= 0 && mTimeSelected >= 0 && mFixedTime.empty()) {
+    const int count = mLayer->dimension(mTimeIndex).count();
+    for (int t = mTimeSelected + 1; t <= mTimeSelected + PREFETCH_TIMES && t < count; ++t)
+      addPrefetch(createRequest(view, scale, w, h, t));
+  }
+
+  const Rectangle ring = diutil::adjustedRectangle(view,
+      PREFETCH_RING*view.width(), PREFETCH_RING*view.height());
+  const float ringScale = 1 + 2*PREFETCH_RING;
+  addPrefetch(createRequest(ring, scale, int(w*ringScale), int(h*ringScale), -1));
+
+  addPrefetch(createRequest(view, 2*scale, w/2, h/2, -1));
+}
+
+void WebMapPlot::addPrefetch(WebMapRequest* request)
+{
+  if (!request)
+    return;
+  request->setPrefetch(true);
+  mPrefetch.push_back(request);
+  request->submit();
+}
+
+void WebMapPlot::dropPrefetch()
+{
+  for (WebMapRequest* request : mPrefetch) {
+    request->abort();
+    request->deleteLater();
+  }
+  mPrefetch.clear();
+}
+
 void WebMapPlot::setStyleAlpha(float offset, float scale)
 {
   mAlphaOffset = offset;
@@ -247,6 +317,7 @@ void WebMapPlot::requestCompleted()
   METLIBS_LOG_SCOPE();
   mRequestCompleted = true;
   Q_EMIT update();
+  prefetch();
 }
 
 void WebMapPlot::changeProjection()
@@ -342,6 +413,7 @@ void WebMapPlot::serviceRefreshStarting()
 {
   METLIBS_LOG_SCOPE();
   dropRequest();
+  dropPrefetch();
   mLayer = 0;
 }
 
@@ -110,6 +110,19 @@ private Q_SLOTS:
 private:
   void dropRequest();
 
+  //! map scale in WMTS scale denominator units
+  double viewScale() const;
+
+  /*! create a request with the current dimension values and time index
+   *  timeIndex (if >= 0) */
+  WebMapRequest* createRequest(const Rectangle& viewRect, double viewScale, int w, int h, int timeIndex);
+
+  /*! fetch tiles for the next times, around the view, and for the
+   *  next coarser zoom level into the tile cache */
+  void prefetch();
+  void addPrefetch(WebMapRequest* request);
+  void dropPrefetch();
+
 private:
   WebMapService* mService;
   std::string mLayerId;
@@ -131,6 +144,8 @@ private:
   WebMapRequest* mRequest;
   bool mRequestCompleted;
 
+  std::vector<WebMapRequest*> mPrefetch;
+
   Area mOldArea;
 };
 
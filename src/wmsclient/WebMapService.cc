@@ -30,6 +30,7 @@
 #include "WebMapService.h"
 
 #include "diUtilities.h"
+#include "WebMapTile.h"
 #include "WebMapUtilities.h"
 
 #include <puTools/miStringFunctions.h>
@@ -41,6 +42,8 @@
 #include <QUrlQuery>
 #endif
 
+#include <sstream>
+
 #ifdef HAVE_CONFIG_H
 #include "config.h" // for PVERSION
 #endif
@@ -108,6 +111,7 @@ static const size_t INVALID_IDX = size_t(-1);
 
 WebMapRequest::WebMapRequest()
   : lastTileIndex(INVALID_IDX)
+  , mPrefetch(false)
 {
 }
 
@@ -153,6 +157,11 @@ void WebMapService::destroyLayers()
 }
 
 QNetworkReply* WebMapService::submitUrl(QUrl url)
+{
+  return submitUrl(url, 0);
+}
+
+QNetworkReply* WebMapService::submitUrl(QUrl url, const WebMapImage* image)
 {
   if (!mExtraQueryItems.empty()) {
     QUrlQuery urlq(url.query());
@@ -171,9 +180,48 @@ QNetworkReply* WebMapService::submitUrl(QUrl url)
     nr.setRawHeader("Authorization", headerData.toLocal8Bit());
   }
 
+  if (image && !image->cacheKey().empty()) {
+    // the tile cache does its own revalidation, bypass the QNetworkDiskCache
+    nr.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    nr.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+    if (const WebMapTileCache::Entry* stale = image->staleCopy()) {
+      if (!stale->etag.empty())
+        nr.setRawHeader("If-None-Match", QByteArray(stale->etag.data(), stale->etag.size()));
+      if (!stale->lastModified.empty())
+        nr.setRawHeader("If-Modified-Since", QByteArray(stale->lastModified.data(), stale->lastModified.size()));
+    }
+  }
+  if (image && image->isPrefetch())
+    nr.setPriority(QNetworkRequest::LowPriority);
+
   return mNetworkAccess->get(nr);
 }
 
+void WebMapService::submitImage(WebMapImage* image, const QUrl& url)
+{
+  if (image->lookupCache())
+    image->submit(0);
+  else
+    image->submit(submitUrl(url, image));
+}
+
+std::string WebMapService::tileCacheKey(const WebMapLayer* layer,
+    const std::map<std::string, std::string>& dimensionValues,
+    const std::string& matrix, int tileX, int tileY) const
+{
+  std::ostringstream key;
+  key << mIdentifier << '\n' << layer->identifier();
+  for (size_t d = 0; d<layer->countDimensions(); ++d) {
+    const WebMapDimension& dim = layer->dimension(d);
+    std::map<std::string, std::string>::const_iterator it
+        = dimensionValues.find(dim.identifier());
+    key << '\n' << dim.identifier() << '='
+        << ((it != dimensionValues.end()) ? it->second : dim.defaultValue());
+  }
+  key << '\n' << matrix << '\n' << tileX << ' ' << tileY;
+  return key.str();
+}
+
 int WebMapService::refreshInterval() const
 {
   return -1;
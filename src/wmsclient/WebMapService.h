@@ -36,6 +36,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -45,6 +46,7 @@ class Projection;
 class QImage;
 class QNetworkAccessManager;
 class QNetworkReply;
+class WebMapImage;
 
 class WebMapDimension {
 public:
@@ -198,12 +200,21 @@ public:
   /*! legend image; might have isNull() == true */
   virtual QImage legendImage() const;
 
+  /*! mark as request fetching tiles ahead of time, to be used by later
+   *  requests via the tile cache; must be called before submit */
+  void setPrefetch(bool prefetch)
+    { mPrefetch = prefetch; }
+
+  bool isPrefetch() const
+    { return mPrefetch; }
+
 public:
   Rectangle tilebbx;
   float x0, dx, y0, dy;
 
 private:
   size_t lastTileIndex; //! cache for "tileIndex"
+  bool mPrefetch;
 
 Q_SIGNALS:
   /*! the request is complete, ready for rendering, or aborted */
@@ -256,6 +267,16 @@ public:
 
   QNetworkReply* submitUrl(QUrl url);
 
+  /*! fetch image from url, or from the tile cache if the image has a
+   *  cache key and a fresh copy is cached */
+  void submitImage(WebMapImage* image, const QUrl& url);
+
+  /*! key for the tile cache, independent of the tile URL; matrix
+   *  identifies the tile matrix or zoom level */
+  std::string tileCacheKey(const WebMapLayer* layer,
+      const std::map<std::string, std::string>& dimensionValues,
+      const std::string& matrix, int tileX, int tileY) const;
+
 public Q_SLOTS:
   /* trigger reload of capabilities */
   virtual void refresh();
@@ -277,6 +298,9 @@ protected:
   std::vector< std::pair< std::string,std::string > > mExtraQueryItems;
   std::vector<WebMapLayer_cx> mLayers;
 
+private:
+  QNetworkReply* submitUrl(QUrl url, const WebMapImage* image);
+
 private:
   QNetworkAccessManager* mNetworkAccess;
 };
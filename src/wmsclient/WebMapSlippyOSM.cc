@@ -112,9 +112,8 @@ void WebMapSlippyOSMRequest::submit()
     WebMapTile* tile = mTiles[i];
     connect(tile, SIGNAL(finished(WebMapTile*)),
         this, SLOT(tileFinished(WebMapTile*)));
-    QNetworkReply* reply = mService->submitRequest(mLayer, mZoom,
-        tile->column(), tile->row());
-    tile->submit(reply);
+    tile->setPrefetch(isPrefetch());
+    mService->submitRequest(mLayer, mZoom, tile);
   }
 }
 
@@ -216,17 +215,19 @@ WebMapRequest_x WebMapSlippyOSM::createRequest(const std::string& layerIdentifie
   return request.release();
 }
 
-QNetworkReply* WebMapSlippyOSM::submitRequest(WebMapSlippyOSMLayer_cx layer,
-    int zoom, int tileX, int tileY)
+void WebMapSlippyOSM::submitRequest(WebMapSlippyOSMLayer_cx layer,
+    int zoom, WebMapTile* tile)
 {
   METLIBS_LOG_SCOPE();
   std::string url = layer->urlTemplate();
   miutil::replace(url, "{zoom}", miutil::from_number(zoom));
-  miutil::replace(url, "{x}", miutil::from_number(tileX));
-  miutil::replace(url, "{y}", miutil::from_number(tileY));
+  miutil::replace(url, "{x}", miutil::from_number(tile->column()));
+  miutil::replace(url, "{y}", miutil::from_number(tile->row()));
   METLIBS_LOG_DEBUG(LOGVAL(url));
 
-  return submitUrl(QUrl(QString::fromStdString(url)));
+  tile->setCacheKey(tileCacheKey(layer, std::map<std::string, std::string>(),
+          miutil::from_number(zoom), tile->column(), tile->row()));
+  submitImage(tile, QUrl(QString::fromStdString(url)));
 }
 
 void WebMapSlippyOSM::refresh()
@@ -155,8 +155,7 @@ public:
   WebMapRequest_x createRequest(const std::string& layer,
       const Rectangle& viewRect, const Projection& viewProj, double viewScale, int w, int h) override;
 
-  QNetworkReply* submitRequest(WebMapSlippyOSMLayer_cx layer,
-      int zoom, int tileX, int tileY);
+  void submitRequest(WebMapSlippyOSMLayer_cx layer, int zoom, WebMapTile* tile);
 
   void refresh() override;
 
@@ -40,8 +40,33 @@
 #define MILOGGER_CATEGORY "diana.WebMapTile"
 #include <miLogger/miLogging.h>
 
+namespace {
+
+std::string rawHeader(const QNetworkReply* reply, const char* name)
+{
+  const QByteArray value = reply->rawHeader(name);
+  return std::string(value.constData(), value.size());
+}
+
+WebMapTileCache::Headers cacheHeaders(const QNetworkReply* reply)
+{
+  WebMapTileCache::Headers h;
+  h.cacheControl = rawHeader(reply, "Cache-Control");
+  h.expires = rawHeader(reply, "Expires");
+  h.date = rawHeader(reply, "Date");
+  h.age = rawHeader(reply, "Age");
+  h.lastModified = rawHeader(reply, "Last-Modified");
+  h.etag = rawHeader(reply, "ETag");
+  return h;
+}
+
+} // namespace
+
 WebMapImage::WebMapImage()
   : mReply(0)
+  , mHaveCached(false)
+  , mCachedFresh(false)
+  , mPrefetch(false)
 {
 }
 
@@ -83,34 +108,76 @@ void WebMapImage::dropRequest()
   mReply = 0;
 }
 
+bool WebMapImage::lookupCache()
+{
+  mHaveCached = !mCacheKey.empty()
+      && WebMapTileCache::instance().load(mCacheKey, mCached);
+  mCachedFresh = mHaveCached
+      && WebMapTileCache::fresh(mCached, WebMapTileCache::now());
+  return mCachedFresh;
+}
+
+bool WebMapImage::replyData(std::string& contentType, std::string& data)
+{
+  if (mCachedFresh) {
+    METLIBS_LOG_DEBUG("using cached tile '" << mCacheKey << "'");
+    contentType = mCached.contentType;
+    data = mCached.data;
+    return true;
+  }
+  if (!mReply)
+    return false;
+
+  METLIBS_LOG_DEBUG(LOGVAL(mReply->isFinished()) << LOGVAL(mReply->error()));
+  const int status = mReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  const int64_t now = WebMapTileCache::now();
+  if (status == 304 && mHaveCached) {
+    METLIBS_LOG_DEBUG("cached tile '" << mCacheKey << "' is still valid");
+    WebMapTileCache::setFromHeaders(mCached, cacheHeaders(mReply), now);
+    WebMapTileCache::instance().store(mCacheKey, mCached);
+    contentType = mCached.contentType;
+    data = mCached.data;
+    return true;
+  }
+
+  contentType = mReply->header(QNetworkRequest::ContentTypeHeader).toString().toStdString();
+  METLIBS_LOG_DEBUG("url='" << mReply->url().toString().toStdString() << "' Content-Type='" << contentType << "'");
+  const QByteArray bytes = mReply->readAll();
+  data.assign(bytes.constData(), bytes.size());
+
+  if (!mCacheKey.empty() && mReply->error() == QNetworkReply::NoError
+      && status == 200 && contentType.compare(0, 6, "image/") == 0)
+  {
+    WebMapTileCache::Entry entry;
+    entry.contentType = contentType;
+    entry.data = data;
+    if (WebMapTileCache::setFromHeaders(entry, cacheHeaders(mReply), now))
+      WebMapTileCache::instance().store(mCacheKey, entry);
+  }
+  return true;
+}
+
 bool WebMapImage::loadImage(const char* format)
 {
   METLIBS_LOG_SCOPE();
-  if (mReply) {
-    METLIBS_LOG_DEBUG(LOGVAL(mReply->isFinished()) << LOGVAL(mReply->error()));
-
-    const QString ct = mReply->header(QNetworkRequest::ContentTypeHeader).toString();
-    METLIBS_LOG_DEBUG("url='" << mReply->url().toString().toStdString() << "' Content-Type='" << ct.toStdString() << "'");
-    bool ok = false;
-    const char* fmt = 0;
-    if (ct == "image/png")
-      fmt = "PNG";
-    else if (ct == "image/jpeg")
-      fmt = "JPEG";
-    else if (ct.startsWith("text")) {
-      QString text = QString::fromUtf8(mReply->readAll().constData());
-      METLIBS_LOG_ERROR(LOGVAL(diutil::qs(text)));
-    }
-    if (fmt != 0) {
-#if 0
-      ok = mImage.load(mReply, fmt);
-#else
-      const QByteArray data = mReply->readAll();
-      ok = mImage.loadFromData(data, fmt);
-#endif
-    }
-    METLIBS_LOG_DEBUG(LOGVAL(mImage.width()) << LOGVAL(mImage.height()) << LOGVAL(ok));
+  std::string ct, data;
+  if (!replyData(ct, data))
+    return !mImage.isNull();
+  if (mPrefetch)
+    return true; // only fetched for the tile cache
+
+  bool ok = false;
+  const char* fmt = 0;
+  if (ct == "image/png")
+    fmt = "PNG";
+  else if (ct == "image/jpeg")
+    fmt = "JPEG";
+  else if (ct.compare(0, 4, "text") == 0) {
+    METLIBS_LOG_ERROR(LOGVAL(data));
   }
+  if (fmt != 0)
+    ok = mImage.loadFromData(reinterpret_cast<const uchar*>(data.data()), data.size(), fmt);
+  METLIBS_LOG_DEBUG(LOGVAL(mImage.width()) << LOGVAL(mImage.height()) << LOGVAL(ok));
   return !mImage.isNull();
 }
 
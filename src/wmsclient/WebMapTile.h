@@ -30,6 +30,8 @@
 #ifndef WebMapTile_h
 #define WebMapTile_h 1
 
+#include "WebMapTileCache.h"
+
 #include <diField/diRectangle.h>
 
 #include <QImage>
@@ -53,6 +55,31 @@ public:
 
   void abort();
 
+  /*! Use the tile cache for this image; key identifies the image
+   *  content, see WebMapService::tileCacheKey. */
+  void setCacheKey(const std::string& key)
+    { mCacheKey = key; }
+
+  const std::string& cacheKey() const
+    { return mCacheKey; }
+
+  /*! Look up the image in the tile cache; returns true if a fresh
+   *  copy was found, which will be used by loadImage without
+   *  network access. */
+  bool lookupCache();
+
+  //! cached copy to be revalidated, or null
+  const WebMapTileCache::Entry* staleCopy() const
+    { return (mHaveCached && !mCachedFresh) ? &mCached : 0; }
+
+  /*! Images fetched ahead of time are only put into the tile cache,
+   *  loadImage does not decode them. */
+  void setPrefetch(bool prefetch)
+    { mPrefetch = prefetch; }
+
+  bool isPrefetch() const
+    { return mPrefetch; }
+
   bool loadImage(const char* format);
   bool loadImage(const std::string& format)
     { return loadImage(format.c_str()); }
@@ -68,10 +95,18 @@ Q_SIGNALS:
 
 private:
   void dropRequest();
+  bool replyData(std::string& contentType, std::string& data);
 
 protected:
   QImage mImage;
   QNetworkReply* mReply;
+
+private:
+  std::string mCacheKey;
+  WebMapTileCache::Entry mCached;
+  bool mHaveCached;
+  bool mCachedFresh;
+  bool mPrefetch;
 };
 
 // ========================================================================
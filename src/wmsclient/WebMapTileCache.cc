@@ -0,0 +1,242 @@
+/*
+  Diana - A Free Meteorological Visualisation Tool
+
+  Copyright (C) 2016 MET Norway
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Box 43 Blindern
+  0313 OSLO
+  NORWAY
+  email: diana@met.no
+
+  This file is part of Diana
+
+  Diana is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  Diana is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Diana; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "WebMapTileCache.h"
+
+#include "util/binary_io.h"
+#include "util/mapped_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <sys/time.h>
+
+#define MILOGGER_CATEGORY "diana.WebMapTileCache"
+#include <miLogger/miLogging.h>
+
+namespace {
+
+const char MAGIC[8] = { 'D', 'I', 'W', 'M', 'T', 'C', '0', '1' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//! tile files not used for this long are removed
+const time_t MAX_FILE_AGE = 14*24*3600;
+
+//! limit for the freshness guessed from Last-Modified, see RFC 7234 section 4.2.2
+const int64_t MAX_HEURISTIC_LIFETIME = 24*3600*1000LL;
+
+typedef diutil::BinaryWriter Writer;
+typedef diutil::BinaryReader Reader;
+
+std::string trimmedLower(const std::string& s, size_t b, size_t e)
+{
+  while (b < e && isspace(s[b]))
+    b += 1;
+  while (e > b && isspace(s[e-1]))
+    e -= 1;
+  std::string t = s.substr(b, e - b);
+  std::transform(t.begin(), t.end(), t.begin(), ::tolower);
+  return t;
+}
+
+//! parse a delta-seconds value like in "max-age=60", return -1 if invalid
+int64_t parseSeconds(const std::string& s)
+{
+  std::string v = s;
+  if (v.size() >= 2 && v[0] == '"' && v[v.size()-1] == '"')
+    v = v.substr(1, v.size() - 2);
+  if (v.empty() || v.find_first_not_of("0123456789") != std::string::npos)
+    return -1;
+  return strtoll(v.c_str(), 0, 10);
+}
+
+} // namespace
+
+WebMapTileCache::WebMapTileCache()
+  : files_("tile-")
+{
+}
+
+// static
+WebMapTileCache& WebMapTileCache::instance()
+{
+  static WebMapTileCache cache;
+  return cache;
+}
+
+void WebMapTileCache::setDirectory(const std::string& directory)
+{
+  files_.setDirectory(directory, MAX_FILE_AGE);
+}
+
+bool WebMapTileCache::load(const std::string& key, Entry& entry)
+{
+  if (!files_.enabled())
+    return false;
+
+  const std::string cf = files_.path(key);
+  const diutil::MappedFile mapped(cf);
+  if (!mapped.data())
+    return false;
+  if (!read(mapped.data(), mapped.size(), key, entry)) {
+    METLIBS_LOG_DEBUG("tile file '" << cf << "' is outdated or broken");
+    return false;
+  }
+
+  // mark as used, see setDirectory
+  diutil::CacheDirectory::touch(cf);
+  return true;
+}
+
+void WebMapTileCache::store(const std::string& key, const Entry& entry)
+{
+  if (files_.enabled())
+    diutil::CacheDirectory::write(files_.path(key), write(key, entry));
+}
+
+// static
+int64_t WebMapTileCache::now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec * 1000LL + tv.tv_usec / 1000;
+}
+
+// static
+bool WebMapTileCache::setFromHeaders(Entry& entry, const Headers& headers, int64_t now)
+{
+  int64_t maxAge = -1;
+  bool noCache = false;
+  const std::string& cc = headers.cacheControl;
+  for (size_t b = 0; b < cc.size(); ) {
+    size_t e = cc.find(',', b);
+    if (e == std::string::npos)
+      e = cc.size();
+    const std::string directive = trimmedLower(cc, b, e);
+    if (directive == "no-store")
+      return false;
+    else if (directive == "no-cache" || directive == "must-revalidate")
+      noCache = true;
+    else if (directive.compare(0, 8, "max-age=") == 0)
+      maxAge = parseSeconds(directive.substr(8));
+    b = e + 1;
+  }
+
+  // use the server clock for differences between server times
+  int64_t date = parseHttpDate(headers.date);
+  if (date < 0)
+    date = now;
+
+  int64_t lifetime = 0;
+  if (maxAge >= 0) {
+    lifetime = maxAge * 1000;
+  } else if (!headers.expires.empty()) {
+    const int64_t expires = parseHttpDate(headers.expires);
+    if (expires > date)
+      lifetime = expires - date;
+  } else {
+    const int64_t lastModified = parseHttpDate(headers.lastModified);
+    if (lastModified >= 0 && lastModified < date)
+      lifetime = std::min((date - lastModified) / 10, MAX_HEURISTIC_LIFETIME);
+  }
+  const int64_t age = std::max<int64_t>(0, parseSeconds(headers.age)) * 1000;
+  if (noCache || lifetime <= age)
+    entry.expires = 0;
+  else
+    entry.expires = now + lifetime - age;
+
+  // a revalidation reply might not repeat the validators
+  if (!headers.etag.empty())
+    entry.etag = headers.etag;
+  if (!headers.lastModified.empty())
+    entry.lastModified = headers.lastModified;
+
+  return entry.expires > 0 || !entry.etag.empty() || !entry.lastModified.empty();
+}
+
+// static
+int64_t WebMapTileCache::parseHttpDate(const std::string& date)
+{
+  static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+  char month[4];
+  struct tm t;
+  memset(&t, 0, sizeof(t));
+  if (sscanf(date.c_str(), "%*3s, %d %3s %d %d:%d:%d GMT",
+          &t.tm_mday, month, &t.tm_year, &t.tm_hour, &t.tm_min, &t.tm_sec) != 6)
+    return -1;
+  const char* m = strstr(MONTHS, month);
+  if (!m || strlen(month) != 3 || (m - MONTHS) % 3 != 0)
+    return -1;
+  t.tm_mon = (m - MONTHS) / 3;
+  t.tm_year -= 1900;
+  return timegm(&t) * 1000LL;
+}
+
+// static
+std::string WebMapTileCache::write(const std::string& key, const Entry& entry)
+{
+  Writer w;
+  w.put(MAGIC, sizeof(MAGIC));
+  w.u32(BYTE_ORDER_MARK);
+  w.str(key);
+  w.i64(entry.expires);
+  w.str(entry.etag);
+  w.str(entry.lastModified);
+  w.str(entry.contentType);
+  w.str(entry.data);
+  return w.buffer;
+}
+
+// static
+bool WebMapTileCache::read(const char* data, size_t size, const std::string& key, Entry& entry)
+{
+  Reader r(data, size);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t byteOrder;
+  std::string fileKey;
+  if (!r.get(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+      || !r.u32(byteOrder) || byteOrder != BYTE_ORDER_MARK
+      || !r.str(fileKey) || fileKey != key)
+    return false;
+
+  Entry e;
+  int64_t expires;
+  if (!r.i64(expires) || !r.str(e.etag) || !r.str(e.lastModified)
+      || !r.str(e.contentType) || !r.str(e.data) || !r.atEnd())
+    return false;
+  e.expires = expires;
+  std::swap(entry, e);
+  return true;
+}
@@ -0,0 +1,120 @@
+/*
+  Diana - A Free Meteorological Visualisation Tool
+
+  Copyright (C) 2016 MET Norway
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Box 43 Blindern
+  0313 OSLO
+  NORWAY
+  email: diana@met.no
+
+  This file is part of Diana
+
+  Diana is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  Diana is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Diana; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef WebMapTileCache_h
+#define WebMapTileCache_h 1
+
+#include "util/cache_directory.h"
+
+#include <cstdint>
+#include <string>
+
+/**
+  \brief Disk cache for web map tiles
+
+  Each tile is stored in a file in the cache directory, together with the
+  HTTP cache information of the response. Tiles are identified by a key
+  made from service, layer, dimension values, tile matrix and tile index,
+  see WebMapService::tileCacheKey, so that tiles are found again even if
+  the URL changes, e.g. with rotating server names.
+
+  Fresh tiles are used without asking the server; stale tiles with an
+  ETag or Last-Modified header are revalidated with a conditional
+  request.
+
+  Not thread-safe, meant to be used from the thread running the
+  QNetworkAccessManager.
+ */
+class WebMapTileCache {
+public:
+  struct Entry {
+    int64_t expires; //!< fresh until this time, milliseconds since the epoch; 0 = revalidate
+    std::string etag;
+    std::string lastModified;
+    std::string contentType;
+    std::string data;
+    Entry()
+      : expires(0) { }
+  };
+
+  //! HTTP response headers relevant for caching
+  struct Headers {
+    std::string cacheControl;
+    std::string expires;
+    std::string date;
+    std::string age;
+    std::string lastModified;
+    std::string etag;
+  };
+
+  static WebMapTileCache& instance();
+
+  /*! Set the directory for the tile files, creating it if necessary.
+   *  Tiles not used for two weeks are removed. With an empty directory,
+   *  nothing is cached.
+   */
+  void setDirectory(const std::string& directory);
+
+  bool enabled() const
+    { return files_.enabled(); }
+
+  //! read the cached tile for key, return false if not found
+  bool load(const std::string& key, Entry& entry);
+
+  void store(const std::string& key, const Entry& entry);
+
+  //! current time in milliseconds since the epoch
+  static int64_t now();
+
+  static bool fresh(const Entry& entry, int64_t now)
+    { return entry.expires > now; }
+
+  /*! Set expiry time and validators of entry from response headers
+   *  received at time now. Returns false if the response must not be
+   *  stored, or if it can neither be used nor revalidated later.
+   */
+  static bool setFromHeaders(Entry& entry, const Headers& headers, int64_t now);
+
+  //! parse a HTTP date ("Sun, 06 Nov 1994 08:49:37 GMT"), return milliseconds since the epoch or -1
+  static int64_t parseHttpDate(const std::string& date);
+
+  //! serialize an entry in the binary format of the cache files
+  static std::string write(const std::string& key, const Entry& entry);
+
+  //! read an entry in the binary format, return false if the data are broken or for a different key
+  static bool read(const char* data, size_t size, const std::string& key, Entry& entry);
+
+private:
+  WebMapTileCache();
+
+private:
+  diutil::CacheDirectory files_;
+};
+
+#endif // WebMapTileCache_h
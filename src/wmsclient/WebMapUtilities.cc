@@ -595,7 +595,7 @@ bool checkRedirect(WebMapService* service, WebMapImage* image)
   QUrl redirect = vRedirect.toUrl();
   if (redirect.isRelative())
     redirect = image->reply()->url().resolved(redirect);
-  image->submit(service->submitUrl(redirect));
+  service->submitImage(image, redirect);
   return true;
 }
 
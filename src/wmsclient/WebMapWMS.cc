@@ -172,9 +172,8 @@ void WebMapWMSRequest::submit()
     WebMapTile* tile = mTiles[i];
     connect(tile, SIGNAL(finished(WebMapTile*)),
         this, SLOT(tileFinished(WebMapTile*)));
-    QNetworkReply* reply = mService->submitRequest(mLayer, mDimensionValues,
-        mLayer->CRS(mCrsIndex), tile);
-    tile->submit(reply);
+    tile->setPrefetch(isPrefetch());
+    mService->submitRequest(mLayer, mDimensionValues, mLayer->CRS(mCrsIndex), mZoom, tile);
   }
 }
 
@@ -297,9 +296,9 @@ WebMapRequest_x WebMapWMS::createRequest(const std::string& layerIdentifier,
   return request.release();
 }
 
-QNetworkReply* WebMapWMS::submitRequest(WebMapWMSLayer_cx layer,
+void WebMapWMS::submitRequest(WebMapWMSLayer_cx layer,
     const std::map<std::string, std::string>& dimensionValues,
-    const std::string& crs, WebMapTile* tile)
+    const std::string& crs, int zoom, WebMapTile* tile)
 {
   QUrl qurl = mServiceURL;
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
@@ -350,7 +349,9 @@ QNetworkReply* WebMapWMS::submitRequest(WebMapWMSLayer_cx layer,
 #endif
 
   METLIBS_LOG_DEBUG("url='" << qurl.toEncoded().constData() << "' x=" << tile->column() << " y=" << tile->row());
-  return submitUrl(qurl);
+  tile->setCacheKey(tileCacheKey(layer, dimensionValues,
+          crs + " " + miutil::from_number(zoom), tile->column(), tile->row()));
+  submitImage(tile, qurl);
 }
 
 void WebMapWMS::refresh()
@@ -186,9 +186,9 @@ public:
   WebMapRequest_x createRequest(const std::string& layer,
       const Rectangle& viewRect, const Projection& viewProj, double viewScale, int w, int h) override;
 
-  QNetworkReply* submitRequest(WebMapWMSLayer_cx layer,
+  void submitRequest(WebMapWMSLayer_cx layer,
       const std::map<std::string, std::string>& dimensionValues,
-      const std::string& crs, WebMapTile* tile);
+      const std::string& crs, int zoom, WebMapTile* tile);
 
   void refresh() override;
 
@@ -165,9 +165,8 @@ void WebMapWMTSRequest::submit()
     WebMapTile* tile = mTiles[i];
     connect(tile, SIGNAL(finished(WebMapTile*)),
         this, SLOT(tileFinished(WebMapTile*)));
-    QNetworkReply* reply = mService->submitRequest(mLayer, mDimensionValues,
-        mMatrixSet, mMatrix, tile->column(), tile->row());
-    tile->submit(reply);
+    tile->setPrefetch(isPrefetch());
+    mService->submitRequest(mLayer, mDimensionValues, mMatrixSet, mMatrix, tile);
   }
 }
 
@@ -282,12 +281,13 @@ WebMapRequest_x WebMapWMTS::createRequest(const std::string& layerIdentifier,
   return request.release();
 }
 
-QNetworkReply* WebMapWMTS::submitRequest(WebMapWMTSLayer_cx layer,
+void WebMapWMTS::submitRequest(WebMapWMTSLayer_cx layer,
     const std::map<std::string, std::string>& dimensionValues,
     WebMapWMTSTileMatrixSet_cx matrixSet, WebMapWMTSTileMatrix_cx matrix,
-    int tileX, int tileY)
+    WebMapTile* tile)
 {
   METLIBS_LOG_SCOPE();
+  const int tileX = tile->column(), tileY = tile->row();
   QUrl qurl;
 
   if (!layer->urlTemplate().empty()) {
@@ -349,7 +349,9 @@ QNetworkReply* WebMapWMTS::submitRequest(WebMapWMTSLayer_cx layer,
   }
   METLIBS_LOG_DEBUG("url='" << qurl.toString().toStdString() << "'");
 
-  return submitUrl(qurl);
+  tile->setCacheKey(tileCacheKey(layer, dimensionValues,
+          matrixSet->identifier() + " " + matrix->identifier(), tileX, tileY));
+  submitImage(tile, qurl);
 }
 
 void WebMapWMTS::refresh()
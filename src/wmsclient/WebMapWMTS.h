@@ -255,10 +255,10 @@ public:
   WebMapRequest_x createRequest(const std::string& layer,
       const Rectangle& viewRect, const Projection& viewProj, double viewScale, int w, int h) override;
 
-  QNetworkReply* submitRequest(WebMapWMTSLayer_cx layer,
+  void submitRequest(WebMapWMTSLayer_cx layer,
       const std::map<std::string, std::string>& dimensionValues,
       WebMapWMTSTileMatrixSet_cx matrixSet, WebMapWMTSTileMatrix_cx matrix,
-      int tileX, int tileY);
+      WebMapTile* tile);
 
   void refresh() override;
 
@@ -0,0 +1,49 @@
+
+#include <diField.h>
+
+#include <gtest/gtest.h>
+
+TEST(FieldTest, Downsampled)
+{
+  const float U = difield::UNDEF;
+  const int nx = 5, ny = 3;
+  const float values[nx*ny] = {
+    1, 3, 5, 7, 9,
+    1, 3, U, U, 9,
+    2, 4, U, U, 10
+  };
+
+  Field f;
+  f.area = GridArea(Area(Projection::geographic(), Rectangle(0, 0, 4, 2)), nx, ny, 1, 1);
+  f.fill(0);
+  std::copy(values, values + nx*ny, f.data);
+  f.checkDefined();
+
+  EXPECT_EQ(&f, f.downsampled(0));
+
+  Field* d1 = f.downsampled(1);
+  ASSERT_TRUE(d1);
+  EXPECT_EQ(3, d1->area.nx);
+  EXPECT_EQ(2, d1->area.ny);
+  EXPECT_FLOAT_EQ(2, d1->area.resolutionX);
+  EXPECT_FLOAT_EQ(0.5, d1->area.R().x1);
+  EXPECT_FLOAT_EQ(4.5, d1->area.R().x2);
+
+  const float expected[3*2] = {
+    2, 6, 9,
+    3, U, 10
+  };
+  for (int i=0; i<3*2; ++i)
+    EXPECT_FLOAT_EQ(expected[i], d1->data[i]) << " i=" << i;
+  EXPECT_EQ(difield::SOME_DEFINED, d1->defined());
+
+  // too small for another level
+  EXPECT_FALSE(f.downsampled(2));
+
+  // changing the data discards downsampled levels
+  f.fill(1);
+  d1 = f.downsampled(1);
+  ASSERT_TRUE(d1);
+  EXPECT_FLOAT_EQ(1, d1->data[4]);
+  EXPECT_TRUE(d1->allDefined());
+}
@@ -0,0 +1,129 @@
+#include <GridInventoryCache.h>
+
+#include <gtest/gtest.h>
+
+using namespace gridinventory;
+
+namespace {
+
+GridInventoryCache::Key makeKey()
+{
+  GridInventoryCache::Key key;
+  key.source = "/data/model/arome_2016030112.nc";
+  key.variant = "netcdf";
+  key.size = 1234567;
+  key.mtime = 1400000000123456789LL;
+  return key;
+}
+
+Inventory makeInventory()
+{
+  ReftimeInventory ri("2016-03-01T12:00:00");
+  ri.timestamp = miutil::miTime(2016, 3, 1, 14, 5, 17);
+  ri.globalAttributes["title"] = "test model";
+
+  Grid grid("xy_lambert");
+  grid.nx = 739;
+  grid.ny = 949;
+  grid.x_resolution = grid.y_resolution = 2500;
+  grid.projection = "+proj=lcc +lat_1=63 +lat_2=63";
+  grid.y_direction_up = true;
+  ri.grids.insert(grid);
+
+  Zaxis zaxis("pressure");
+  zaxis.name = "pressure";
+  zaxis.values.push_back(850);
+  zaxis.values.push_back(500);
+  zaxis.stringvalues.push_back("850");
+  zaxis.stringvalues.push_back("500");
+  zaxis.vc_type = Zaxis::vc_pressure;
+  zaxis.positive = false;
+  ri.zaxes.insert(zaxis);
+  ri.zaxes.insert(Zaxis(""));
+
+  Taxis taxis("time");
+  taxis.values.push_back(1456833600);
+  taxis.values.push_back(1456837200);
+  ri.taxes.insert(taxis);
+
+  GridParameter param(GridParameterKey("air_temperature_pl", "pressure", "time", ""));
+  param.grid = grid.id;
+  param.unit = "K";
+  param.standard_name = "air_temperature";
+  param.zaxis_id = "pressure";
+  param.taxis_id = "time";
+  ri.parameters.insert(param);
+
+  return Inventory(ri);
+}
+
+} // namespace
+
+TEST(GridInventoryCacheTest, WriteRead)
+{
+  const Inventory inv = makeInventory();
+  GridInventoryCache::Properties props;
+  props["reftime"] = "2016-03-01T12:00:00";
+
+  const GridInventoryCache::Key key = makeKey();
+  const std::string data = GridInventoryCache::write(key, inv, props);
+
+  Inventory read;
+  GridInventoryCache::Properties readProps;
+  ASSERT_TRUE(GridInventoryCache::read(data.data(), data.size(), key, read, readProps));
+  EXPECT_EQ(props, readProps);
+
+  ASSERT_EQ(1, read.reftimes.size());
+  const ReftimeInventory& ri0 = inv.reftimes.begin()->second;
+  const ReftimeInventory& ri1 = read.reftimes.begin()->second;
+  EXPECT_EQ(ri0.referencetime, ri1.referencetime);
+  EXPECT_EQ(ri0.timestamp, ri1.timestamp);
+  EXPECT_EQ(ri0.globalAttributes, ri1.globalAttributes);
+
+  ASSERT_EQ(1, ri1.grids.size());
+  const Grid& g = *ri1.grids.begin();
+  EXPECT_EQ(739, g.nx);
+  EXPECT_EQ(949, g.ny);
+  EXPECT_EQ(2500, g.x_resolution);
+  EXPECT_EQ(ri0.grids.begin()->projection, g.projection);
+  EXPECT_TRUE(g.y_direction_up);
+
+  ASSERT_EQ(2, ri1.zaxes.size());
+  const Zaxis& z = ri1.getZaxis("pressure");
+  EXPECT_EQ(Zaxis::vc_pressure, z.vc_type);
+  EXPECT_FALSE(z.positive);
+  EXPECT_EQ(ri0.getZaxis("pressure").values, z.values);
+  EXPECT_EQ(ri0.getZaxis("pressure").stringvalues, z.stringvalues);
+
+  EXPECT_EQ(ri0.getTaxis("time").values, ri1.getTaxis("time").values);
+
+  ASSERT_EQ(1, ri1.parameters.size());
+  const GridParameter& p = *ri1.parameters.begin();
+  EXPECT_EQ("air_temperature_pl", p.key.name);
+  EXPECT_EQ("pressure", p.key.zaxis);
+  EXPECT_EQ("air_temperature", p.standard_name);
+  EXPECT_EQ("K", p.unit);
+  EXPECT_EQ("time", p.taxis_id);
+}
+
+TEST(GridInventoryCacheTest, ReadMismatch)
+{
+  const Inventory inv = makeInventory();
+  const GridInventoryCache::Properties props;
+  const GridInventoryCache::Key key = makeKey();
+  const std::string data = GridInventoryCache::write(key, inv, props);
+
+  Inventory read;
+  GridInventoryCache::Properties readProps;
+
+  GridInventoryCache::Key modified = key;
+  modified.mtime += 1;
+  EXPECT_FALSE(GridInventoryCache::read(data.data(), data.size(), modified, read, readProps));
+
+  modified = key;
+  modified.variant = "grbml";
+  EXPECT_FALSE(GridInventoryCache::read(data.data(), data.size(), modified, read, readProps));
+
+  EXPECT_FALSE(GridInventoryCache::read(data.data(), data.size() - 1, key, read, readProps));
+  EXPECT_TRUE(read.reftimes.empty());
+}
@@ -0,0 +1,105 @@
+#include <diGridRegridding.h>
+#include <diFieldDefined.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const int snx = 5, sny = 5;
+
+GridArea sourceGrid()
+{
+  return GridArea(Area(Projection::geographic(), Rectangle(0, 0, snx-1, sny-1)), snx, sny, 1, 1);
+}
+
+GridArea targetGrid(float x0, float y0, int nx, int ny, float res)
+{
+  return GridArea(Area(Projection::geographic(), Rectangle(x0, y0, x0+(nx-1)*res, y0+(ny-1)*res)),
+      nx, ny, res, res);
+}
+
+// linear in x and y, reproduced exactly by bilinear interpolation
+void fillSource(float* values)
+{
+  for (int j=0; j<sny; ++j)
+    for (int i=0; i<snx; ++i)
+      values[j*snx + i] = i + 10*j;
+}
+
+} // namespace
+
+TEST(GridRegriddingTest, Bilinear)
+{
+  float src[snx*sny];
+  fillSource(src);
+
+  const int tnx = 5, tny = 4;
+  const GridRegridding r(sourceGrid(), targetGrid(0.5, 0.5, tnx, tny, 1), GridRegridding::BILINEAR);
+  ASSERT_TRUE(r.valid());
+
+  float dst[tnx*tny];
+  EXPECT_EQ(size_t(tny), r.apply(src, dst, true)); // last column is outside
+  for (int j=0; j<tny; ++j) {
+    for (int i=0; i<tnx-1; ++i)
+      EXPECT_NEAR(i + 0.5 + 10*(j + 0.5), dst[j*tnx + i], 1e-3) << " i=" << i << " j=" << j;
+    EXPECT_EQ(difield::UNDEF, dst[j*tnx + tnx-1]);
+  }
+
+  // all target points next to an undefined source point are undefined
+  src[2*snx + 2] = difield::UNDEF;
+  EXPECT_EQ(size_t(tny + 4), r.apply(src, dst, false));
+  EXPECT_EQ(difield::UNDEF, dst[1*tnx + 1]);
+  EXPECT_EQ(difield::UNDEF, dst[1*tnx + 2]);
+  EXPECT_EQ(difield::UNDEF, dst[2*tnx + 1]);
+  EXPECT_EQ(difield::UNDEF, dst[2*tnx + 2]);
+  EXPECT_NEAR(0.5 + 5, dst[0], 1e-3);
+}
+
+TEST(GridRegriddingTest, Nearest)
+{
+  float src[snx*sny];
+  fillSource(src);
+
+  const int tnx = 4, tny = 4;
+  const GridRegridding r(sourceGrid(), targetGrid(0.4, 0.4, tnx, tny, 1), GridRegridding::NEAREST);
+  ASSERT_TRUE(r.valid());
+
+  float dst[tnx*tny];
+  EXPECT_EQ(size_t(0), r.apply(src, dst, true));
+  for (int j=0; j<tny; ++j)
+    for (int i=0; i<tnx; ++i)
+      EXPECT_FLOAT_EQ(i + 10*j, dst[j*tnx + i]) << " i=" << i << " j=" << j;
+}
+
+TEST(GridRegriddingTest, Average)
+{
+  float src[snx*sny];
+  fillSource(src);
+  src[4*snx + 4] = difield::UNDEF;
+
+  // target gridboxes contain source points {0,1}, {2,3} and {4}
+  const int tnx = 3, tny = 3;
+  const GridRegridding r(sourceGrid(), targetGrid(0.25, 0.25, tnx, tny, 2), GridRegridding::AVERAGE);
+  ASSERT_TRUE(r.valid());
+
+  float dst[tnx*tny];
+  EXPECT_EQ(size_t(1), r.apply(src, dst, false));
+  const float avg[tnx] = { 0.5, 2.5, 4 };
+  for (int j=0; j<tny; ++j) {
+    for (int i=0; i<tnx; ++i) {
+      if (i == 2 && j == 2)
+        EXPECT_EQ(difield::UNDEF, dst[j*tnx + i]);
+      else
+        EXPECT_NEAR(avg[i] + 10*avg[j], dst[j*tnx + i], 1e-3) << " i=" << i << " j=" << j;
+    }
+  }
+}
+
+TEST(GridRegriddingTest, Cache)
+{
+  const GridArea source = sourceGrid(), target = targetGrid(0.5, 0.5, 3, 3, 1);
+  GridRegridding_cp r1 = GridRegridding::get(source, target, GridRegridding::BILINEAR);
+  ASSERT_TRUE(r1.get());
+  EXPECT_EQ(r1, GridRegridding::get(source, target, GridRegridding::BILINEAR));
+  EXPECT_NE(r1, GridRegridding::get(source, target, GridRegridding::NEAREST));
+}
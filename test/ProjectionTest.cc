@@ -30,3 +30,77 @@ TEST(ProjectionTest, Convert1Point)
   EXPECT_NEAR(fxy.x(), dxy.x(), 1e-6);
   EXPECT_NEAR(fxy.y(), dxy.y(), 1e-6);
 }
+
+TEST(ProjectionTest, AnalyticConversion)
+{
+  const char* definitions[] = {
+    "+proj=ob_tran +o_proj=longlat +lon_0=0 +o_lat_p=25 +x_0=0.811578 +y_0=0.637045 +ellps=WGS84 +towgs84=0,0,0 +no_defs",
+    "+proj=ob_tran +o_proj=longlat +lon_0=15 +o_lat_p=30 +o_lon_p=-10 +R=6371000 +no_defs",
+    "+proj=stere +lat_0=90 +lon_0=0 +lat_ts=60 +ellps=WGS84 +towgs84=0,0,0 +no_defs",
+    "+proj=stere +lat_0=-90 +lon_0=30 +lat_ts=-71 +ellps=WGS84 +no_defs",
+    "+proj=stere +lat_0=90 +lon_0=58 +lat_ts=60 +x_0=3475000 +y_0=7475000 +R=6371000 +no_defs",
+    "+proj=lcc +lat_0=63 +lon_0=15 +lat_1=63 +lat_2=63 +R=6371000 +no_defs",
+    "+proj=lcc +lat_1=33 +lat_2=45 +lat_0=40 +lon_0=-97 +x_0=500000 +ellps=WGS84 +no_defs",
+    0
+  };
+
+  const Projection& p_geo = Projection::geographic();
+  ASSERT_TRUE(p_geo.hasAnalyticConversion());
+  projPJ pj_geo = pj_init_plus(p_geo.getProjDefinition().c_str());
+
+  const int nlon = 9, nlat = 7, npos = nlon*nlat;
+  double lon[npos], lat[npos];
+  for (int j=0; j<nlat; ++j) {
+    for (int i=0; i<nlon; ++i) {
+      lon[j*nlon + i] = (-170 + i*40) * DEG_TO_RAD;
+      lat[j*nlon + i] = (-80 + j*25) * DEG_TO_RAD;
+    }
+  }
+
+  for (const char** d = definitions; *d; ++d) {
+    const Projection p(*d);
+    ASSERT_TRUE(p.isDefined()) << *d;
+    EXPECT_TRUE(p.hasAnalyticConversion()) << *d;
+
+    double ax[npos], ay[npos], px[npos], py[npos];
+    std::copy(lon, lon + npos, ax);
+    std::copy(lat, lat + npos, ay);
+    std::copy(lon, lon + npos, px);
+    std::copy(lat, lat + npos, py);
+
+    EXPECT_TRUE(p.convertPoints(p_geo, npos, ax, ay));
+    projPJ pj = pj_init_plus(*d);
+    pj_transform(pj_geo, pj, npos, 1, px, py, 0);
+    pj_free(pj);
+    const double tolerance = p.isGeographic() || p.getProjDefinition().find("ob_tran") != std::string::npos ? 1e-9 : 1e-3;
+    for (int i=0; i<npos; ++i) {
+      if (px[i] == HUGE_VAL) {
+        EXPECT_EQ(HUGE_VAL, ax[i]) << *d << " i=" << i;
+        continue;
+      }
+      EXPECT_NEAR(px[i], ax[i], tolerance) << *d << " i=" << i;
+      EXPECT_NEAR(py[i], ay[i], tolerance) << *d << " i=" << i;
+    }
+
+    // and back
+    EXPECT_TRUE(p_geo.convertPoints(p, npos, ax, ay));
+    for (int i=0; i<npos; ++i) {
+      if (ax[i] == HUGE_VAL)
+        continue;
+      EXPECT_NEAR(lon[i], ax[i], 1e-9) << *d << " i=" << i;
+      EXPECT_NEAR(lat[i], ay[i], 1e-9) << *d << " i=" << i;
+    }
+  }
+  pj_free(pj_geo);
+}
+
+TEST(ProjectionTest, AnalyticConversionUnsupported)
+{
+  // transverse mercator is converted by proj4
+  const Projection p_utm32("+proj=utm +zone=32 +ellps=WGS84 +datum=WGS84 +units=m +no_defs");
+  EXPECT_FALSE(p_utm32.hasAnalyticConversion());
+
+  // oblique stereographic is not implemented
+  const Projection p_stere("+proj=stere +lat_0=60 +lon_0=10 +ellps=WGS84 +no_defs");
+  EXPECT_FALSE(p_stere.hasAnalyticConversion());
+}
@@ -0,0 +1,83 @@
+#include <export/ContourExport.h>
+#include <util/binary_io.h>
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestContourExport, Lines)
+{
+  const float z[9] = { 0, 0, 0,  0, 10, 0,  0, 0, 0 };
+  const DianaLevelList levels(std::vector<float>(1, 5));
+
+  DianaContourLine_v lines;
+  poly_contour_lines(3, 3, z, levels, 1, lines);
+  ASSERT_EQ(1, lines.size());
+
+  const DianaContourLine& line = lines.front();
+  EXPECT_FLOAT_EQ(5, line.value);
+  ASSERT_EQ(5, line.points.size());
+  EXPECT_FLOAT_EQ(line.points.front().x, line.points.back().x);
+  EXPECT_FLOAT_EQ(line.points.front().y, line.points.back().y);
+  for (const contouring::point_t& p : line.points)
+    EXPECT_FLOAT_EQ(0.5, std::abs(p.x - 1) + std::abs(p.y - 1));
+}
+
+namespace {
+ContourExport::Layer_v makeLayers()
+{
+  ContourExport::Line line;
+  line.value = 1013;
+  line.lon.push_back(10.5);
+  line.lon.push_back(11);
+  line.lat.push_back(60);
+  line.lat.push_back(60.25);
+
+  ContourExport::Layer layer;
+  layer.model = "MEPS";
+  layer.parameter = "air_pressure_at_sea_level";
+  layer.level = "";
+  layer.time = miutil::miTime(2018, 3, 1, 12, 0, 0);
+  layer.lines.push_back(line);
+  return ContourExport::Layer_v(1, layer);
+}
+} // namespace
+
+TEST(TestContourExport, GeoJSON)
+{
+  const std::string json = ContourExport::toGeoJSON(makeLayers());
+  EXPECT_NE(std::string::npos, json.find("\"type\":\"FeatureCollection\""));
+  EXPECT_NE(std::string::npos, json.find("\"parameter\":\"air_pressure_at_sea_level\""));
+  EXPECT_NE(std::string::npos, json.find("\"time\":\"2018-03-01T12:00:00\""));
+  EXPECT_NE(std::string::npos, json.find("\"value\":1013"));
+  EXPECT_NE(std::string::npos, json.find("\"coordinates\":[[10.5,60],[11,60.25]]"));
+}
+
+TEST(TestContourExport, Binary)
+{
+  const std::string data = ContourExport::toBinary(makeLayers());
+  diutil::BinaryReader r(data.data(), data.size());
+
+  char magic[8];
+  uint32_t bom, nlayers, nlines, npoints;
+  std::string model, parameter, level, time;
+  float value;
+  std::vector<float> lon, lat;
+  ASSERT_TRUE(r.get(magic, sizeof(magic)));
+  EXPECT_EQ("DICONT01", std::string(magic, sizeof(magic)));
+  ASSERT_TRUE(r.u32(bom) && r.u32(nlayers));
+  EXPECT_EQ(0x01020304, bom);
+  EXPECT_EQ(1, nlayers);
+  ASSERT_TRUE(r.str(model) && r.str(parameter) && r.str(level) && r.str(time) && r.u32(nlines));
+  EXPECT_EQ("MEPS", model);
+  EXPECT_EQ("2018-03-01T12:00:00", time);
+  EXPECT_EQ(1, nlines);
+  ASSERT_TRUE(r.get(&value, sizeof(value)) && r.u32(npoints));
+  EXPECT_FLOAT_EQ(1013, value);
+  ASSERT_EQ(2, npoints);
+  ASSERT_TRUE(r.column(lon, npoints) && r.column(lat, npoints));
+  EXPECT_FLOAT_EQ(11, lon[1]);
+  EXPECT_FLOAT_EQ(60.25, lat[1]);
+  EXPECT_TRUE(r.atEnd());
+}
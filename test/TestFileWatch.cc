@@ -0,0 +1,101 @@
+#include <export/qtTempDir.h>
+#include <util/file_watcher.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+void writeFile(const std::string& filename, const std::string& content)
+{
+  std::ofstream out(filename.c_str());
+  out << content;
+}
+
+} // namespace
+
+TEST(TestFileWatch, Changes)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+  const std::string dir = tmp.dir().absolutePath().toStdString();
+  writeFile(dir + "/a.txt", "a");
+  writeFile(dir + "/b.txt", "b");
+  writeFile(dir + "/c.dat", "c");
+
+  diutil::FileWatch watch(dir + "/*.txt");
+  EXPECT_TRUE(watch.changed());
+
+  diutil::FileWatch::Changes changes;
+  EXPECT_TRUE(watch.update(&changes));
+  ASSERT_EQ(2u, changes.added.size());
+  EXPECT_EQ(dir + "/a.txt", changes.added[0]);
+  EXPECT_EQ(dir + "/b.txt", changes.added[1]);
+  EXPECT_TRUE(changes.changed.empty());
+  EXPECT_TRUE(changes.removed.empty());
+
+  EXPECT_FALSE(watch.changed());
+  EXPECT_FALSE(watch.update());
+
+  writeFile(dir + "/c.dat", "cc"); // not matching
+  EXPECT_FALSE(watch.changed());
+
+  writeFile(dir + "/d.txt", "d");
+  writeFile(dir + "/a.txt", "aa");
+  unlink((dir + "/b.txt").c_str());
+  EXPECT_TRUE(watch.changed());
+
+  changes = diutil::FileWatch::Changes();
+  EXPECT_TRUE(watch.update(&changes));
+  ASSERT_EQ(1u, changes.added.size());
+  EXPECT_EQ(dir + "/d.txt", changes.added[0]);
+  ASSERT_EQ(1u, changes.changed.size());
+  EXPECT_EQ(dir + "/a.txt", changes.changed[0]);
+  ASSERT_EQ(1u, changes.removed.size());
+  EXPECT_EQ(dir + "/b.txt", changes.removed[0]);
+
+  const std::vector<std::string> names = watch.fileNames();
+  ASSERT_EQ(2u, names.size());
+  EXPECT_EQ(dir + "/a.txt", names[0]);
+  EXPECT_EQ(dir + "/d.txt", names[1]);
+}
+
+TEST(TestFileWatch, SharedPattern)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+  const std::string dir = tmp.dir().absolutePath().toStdString();
+  const std::string pattern = dir + "/*.txt";
+
+  diutil::FileWatch w1(pattern);
+  EXPECT_FALSE(w1.update());
+
+  writeFile(dir + "/a.txt", "a");
+  diutil::FileWatch w2(pattern);
+  EXPECT_TRUE(w1.update());
+
+  // each watch has its own state
+  EXPECT_TRUE(w2.changed());
+  EXPECT_TRUE(w2.update());
+  EXPECT_FALSE(w1.changed());
+}
+
+TEST(TestFileWatch, MissingDirectory)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+  const std::string dir = tmp.dir().absolutePath().toStdString();
+  const std::string sub = dir + "/sub";
+
+  diutil::FileWatch watch(sub + "/*.txt");
+  EXPECT_FALSE(watch.update());
+
+  ASSERT_EQ(0, mkdir(sub.c_str(), 0700));
+  writeFile(sub + "/a.txt", "a");
+  EXPECT_TRUE(watch.update());
+  EXPECT_EQ(1u, watch.files().size());
+}
@@ -35,11 +35,16 @@
 #include <diPaintGLWidget.h>
 
 #include <diColour.h>
+#include <diSymbolSprites.h>
+#include <diWindArrowGlyphs.h>
 
 #include <QCoreApplication>
 #include <QImage>
+#include <QPainter>
 #include <QTimer>
 
+#include <cmath>
+
 #include <gtest/gtest.h>
 
 #define MILOGGER_CATEGORY "diana.test.GLPainter"
@@ -167,3 +172,83 @@ TEST(TestPaintGL, Text)
 
   snapshot.save(TEST_BUILDDIR "/paintgl_text.png");
 }
+
+TEST(TestWindArrowGlyphs, Cache)
+{
+  WindArrowGlyphs glyphs;
+  const QRgb black = qRgba(0, 0, 0, 255);
+
+  const WindArrowGlyphs::Glyph* g = glyphs.glyph(20, 15, 30, false, 1, 1, black, 1, false);
+  ASSERT_TRUE(g);
+  ASSERT_FALSE(g->image.isNull());
+  EXPECT_TRUE(QRect(QPoint(0, 0), g->image.size()).contains(g->offset));
+  int drawn = 0;
+  for (int y = 0; y < g->image.height(); ++y) {
+    for (int x = 0; x < g->image.width(); ++x) {
+      if (qAlpha(g->image.pixel(x, y)) != 0)
+        drawn += 1;
+    }
+  }
+  EXPECT_GT(drawn, 30);
+  EXPECT_EQ(1, glyphs.size());
+
+  // same barbs, direction rounded to the same degree
+  EXPECT_EQ(g, glyphs.glyph(20.01, 15, 30, false, 1, 1, black, 1, false));
+  EXPECT_EQ(1, glyphs.size());
+
+  // southern hemisphere, other colour, other size
+  EXPECT_NE(g, glyphs.glyph(20, 15, 30, false, -1, 1, black, 1, false));
+  EXPECT_NE(g, glyphs.glyph(20, 15, 30, false, 1, 1, qRgba(255, 0, 0, 255), 1, false));
+  EXPECT_NE(g, glyphs.glyph(20, 15, 40, false, 1, 1, black, 1, false));
+  EXPECT_EQ(4, glyphs.size());
+
+  const WindArrowGlyphs::Glyph* calm = glyphs.glyph(0, 0, 30, false, 1, 1, black, 1, false);
+  ASSERT_TRUE(calm);
+  EXPECT_TRUE(calm->image.isNull());
+
+  EXPECT_FALSE(glyphs.glyph(NAN, 1, 30, false, 1, 1, black, 1, false));
+
+  glyphs.clear();
+  EXPECT_EQ(0, glyphs.size());
+}
+
+TEST(TestSymbolSprites, Cache)
+{
+  SymbolSprites sprites;
+  const QRgb black = qRgba(0, 0, 0, 255);
+  const QRectF bounds(-5, -5, 10, 10);
+
+  int rendered = 0;
+  const SymbolSprites::Renderer cross = [&rendered](QPainter& painter, const QTransform& t) {
+    rendered += 1;
+    painter.setPen(Qt::black);
+    painter.drawLine(t.map(QPointF(-5, -5)), t.map(QPointF(5, 5)));
+    painter.drawLine(t.map(QPointF(-5, 5)), t.map(QPointF(5, -5)));
+  };
+
+  const SymbolSprites::Sprite* s = sprites.sprite(1, bounds, 2, true, black, 1, false, cross);
+  ASSERT_TRUE(s);
+  EXPECT_EQ(1, rendered);
+  ASSERT_FALSE(s->image.isNull());
+  EXPECT_GE(s->image.width(), 20);
+  EXPECT_TRUE(QRect(QPoint(0, 0), s->image.size()).contains(s->offset));
+  // the symbol origin is the crossing point
+  EXPECT_NE(0, qAlpha(s->image.pixel(s->offset)));
+
+  // scale rounded to the same step
+  EXPECT_EQ(s, sprites.sprite(1, bounds, 2.001, true, black, 1, false, cross));
+  EXPECT_EQ(1, rendered);
+
+  // other symbol, colour, scale
+  EXPECT_NE(s, sprites.sprite(2, bounds, 2, true, black, 1, false, cross));
+  EXPECT_NE(s, sprites.sprite(1, bounds, 2, true, qRgba(255, 0, 0, 255), 1, false, cross));
+  EXPECT_NE(s, sprites.sprite(1, bounds, 3, true, black, 1, false, cross));
+  EXPECT_EQ(4, rendered);
+  EXPECT_EQ(4, sprites.size());
+
+  // too large to cache
+  EXPECT_FALSE(sprites.sprite(1, bounds, 1000, true, black, 1, false, cross));
+
+  sprites.clear();
+  EXPECT_EQ(0, sprites.size());
+}
@@ -0,0 +1,59 @@
+#include <export/ImageSaver.h>
+#include <export/qtTempDir.h>
+
+#include <QColor>
+#include <QImage>
+
+#include <gtest/gtest.h>
+
+TEST(TestImageSaver, Save)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+
+  {
+    ImageSaver saver(2);
+    for (int i = 0; i < 8; ++i) {
+      QImage image(16, 8, QImage::Format_ARGB32);
+      image.fill(QColor(i, 0, 0));
+      EXPECT_TRUE(saver.add(image, tmp.filePath(QString("frame_%1.png").arg(i)),
+              [](const QImage& img) { return img.scaled(8, 4); }));
+    }
+    EXPECT_TRUE(saver.finish());
+  }
+
+  for (int i = 0; i < 8; ++i) {
+    const QImage image(tmp.filePath(QString("frame_%1.png").arg(i)));
+    ASSERT_FALSE(image.isNull()) << " i=" << i;
+    EXPECT_EQ(QSize(8, 4), image.size());
+    EXPECT_EQ(i, qRed(image.pixel(0, 0)));
+  }
+}
+
+TEST(TestImageSaver, SameFile)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+
+  const QString filename = tmp.filePath("frame.png");
+  ImageSaver saver;
+  for (int i = 0; i < 4; ++i) {
+    QImage image(4, 4, QImage::Format_ARGB32);
+    image.fill(QColor(i, 0, 0));
+    saver.add(image, filename);
+  }
+  EXPECT_TRUE(saver.finish());
+  EXPECT_EQ(3, qRed(QImage(filename).pixel(0, 0)));
+}
+
+TEST(TestImageSaver, Error)
+{
+  ImageSaver saver;
+  QImage image(4, 4, QImage::Format_ARGB32);
+  image.fill(Qt::red);
+  saver.add(image, "/nonexistent/directory/frame.png");
+  EXPECT_FALSE(saver.finish());
+
+  // the error is reported only once
+  EXPECT_TRUE(saver.finish());
+}
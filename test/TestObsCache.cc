@@ -0,0 +1,87 @@
+#include <diObsCache.h>
+
+#include <puTools/miStringFunctions.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+ObsCache::Key makeKey()
+{
+  ObsCache::Key key;
+  key.filename = "/data/obs/synop.bufr";
+  key.variant = "bufr level=-2";
+  key.size = 12345;
+  key.mtime = 1400000000123456789LL;
+  return key;
+}
+
+ObsData makeObs(int i)
+{
+  ObsData d;
+  d.id = "0100" + miutil::from_number(i);
+  d.xpos = 10 + i;
+  d.ypos = 60 - i;
+  d.show_time_id = (i % 2) == 0;
+  d.CAVOK = (i == 1);
+  d.obsTime = miutil::miTime(2016, 3, 1, 12, i, 0);
+  d.fdata["TTT"] = 1.5f * i;
+  if (i == 1) {
+    d.fdata["PPPP"] = 1013.5;
+    d.stringdata["Date"] = "03-01";
+    d.ww.push_back("RA");
+    d.cloud.push_back("SCT020");
+    d.cloud.push_back("BKN050");
+  }
+  return d;
+}
+
+} // namespace
+
+TEST(TestObsCache, WriteRead)
+{
+  ObsData_v obs;
+  for (int i = 0; i < 3; ++i)
+    obs.push_back(makeObs(i));
+  obs[2].obsTime = miutil::miTime();
+
+  const ObsCache::Key key = makeKey();
+  const std::string data = ObsCache::write(key, obs);
+
+  ObsData_v read;
+  ASSERT_TRUE(ObsCache::read(data.data(), data.size(), key, read));
+  ASSERT_EQ(obs.size(), read.size());
+  for (size_t i = 0; i < obs.size(); ++i) {
+    EXPECT_EQ(obs[i].id, read[i].id);
+    EXPECT_EQ(obs[i].name, read[i].name);
+    EXPECT_EQ(obs[i].xpos, read[i].xpos);
+    EXPECT_EQ(obs[i].ypos, read[i].ypos);
+    EXPECT_EQ(obs[i].show_time_id, read[i].show_time_id);
+    EXPECT_EQ(obs[i].CAVOK, read[i].CAVOK);
+    EXPECT_EQ(obs[i].obsTime, read[i].obsTime);
+    EXPECT_EQ(obs[i].fdata, read[i].fdata);
+    EXPECT_EQ(obs[i].stringdata, read[i].stringdata);
+    EXPECT_EQ(obs[i].ww, read[i].ww);
+    EXPECT_EQ(obs[i].cloud, read[i].cloud);
+  }
+  EXPECT_TRUE(read[2].obsTime.undef());
+}
+
+TEST(TestObsCache, ReadMismatch)
+{
+  ObsData_v obs(1, makeObs(1));
+  const ObsCache::Key key = makeKey();
+  const std::string data = ObsCache::write(key, obs);
+
+  ObsData_v read;
+  ObsCache::Key modified = key;
+  modified.mtime += 1;
+  EXPECT_FALSE(ObsCache::read(data.data(), data.size(), modified, read));
+
+  modified = key;
+  modified.variant = "bufr level=500";
+  EXPECT_FALSE(ObsCache::read(data.data(), data.size(), modified, read));
+
+  // truncated file
+  EXPECT_FALSE(ObsCache::read(data.data(), data.size() - 1, key, read));
+}
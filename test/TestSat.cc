@@ -0,0 +1,91 @@
+#include <diSat.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+void makeSat(Sat& sat)
+{
+  sat.area.nx = 1000;
+  sat.area.ny = 800;
+  sat.Ax = sat.Ay = 1;
+  sat.proj_string = "+proj=stere +lat_0=90 +lon_0=0 +lat_ts=60 +R=6371000 +units=km +x_0=0 +y_0=0";
+  sat.setArea();
+}
+
+} // namespace
+
+TEST(TestSat, FindWindowZoomedIn)
+{
+  Sat sat;
+  makeSat(sat);
+  EXPECT_FALSE(sat.reduced());
+
+  const Area view(sat.area.P(), Rectangle(250, 200, 500, 400));
+  Sat::Window w;
+  ASSERT_TRUE(sat.findWindow(view, 1000, 800, 0, w));
+  EXPECT_EQ(1, w.step);
+  EXPECT_LE(w.x0, 250);
+  EXPECT_GE(w.x0, 245);
+  EXPECT_GE(w.x0 + w.nx, 500);
+  EXPECT_LE(w.x0 + w.nx, 505);
+  // rows are counted from the top
+  EXPECT_LE(w.y0, 400);
+  EXPECT_GE(w.y0, 395);
+  EXPECT_GE(w.y0 + w.ny, 600);
+  EXPECT_LE(w.y0 + w.ny, 605);
+
+  Sat::Window wm;
+  ASSERT_TRUE(sat.findWindow(view, 1000, 800, 0.25, wm));
+  EXPECT_LT(wm.x0, w.x0);
+  EXPECT_GT(wm.nx, w.nx);
+}
+
+TEST(TestSat, FindWindowDecimated)
+{
+  Sat sat;
+  makeSat(sat);
+
+  Sat::Window w;
+  ASSERT_TRUE(sat.findWindow(sat.area, 100, 80, 0, w));
+  EXPECT_EQ(10, w.step);
+  EXPECT_EQ(0, w.x0);
+  EXPECT_EQ(0, w.y0);
+  EXPECT_EQ(1000, w.nx);
+  EXPECT_EQ(800, w.ny);
+
+  // full image at full resolution
+  EXPECT_FALSE(sat.findWindow(sat.area, 1000, 800, 0, w));
+}
+
+TEST(TestSat, ImageArea)
+{
+  Sat sat;
+  makeSat(sat);
+
+  Sat::Window& w = sat.window;
+  w.x0 = 100;
+  w.y0 = 200;
+  w.nx = 400;
+  w.ny = 311;
+  w.step = 2;
+  sat.setArea();
+  ASSERT_TRUE(sat.reduced());
+
+  const GridArea& ia = sat.imagearea;
+  EXPECT_EQ(200, ia.nx);
+  EXPECT_EQ(156, ia.ny);
+  EXPECT_FLOAT_EQ(2, ia.resolutionX);
+  EXPECT_FLOAT_EQ(100, ia.R().x1);
+  EXPECT_FLOAT_EQ(500, ia.R().x2);
+  EXPECT_FLOAT_EQ(600, ia.R().y2);
+  EXPECT_FLOAT_EQ(600 - 156*2, ia.R().y1);
+
+  // zooming in within the window does not need a new read
+  const Area inside(sat.area.P(), Rectangle(200, 300, 400, 500));
+  EXPECT_TRUE(sat.coversView(inside, 100, 100));
+  const Area outside(sat.area.P(), Rectangle(600, 300, 800, 500));
+  EXPECT_FALSE(sat.coversView(outside, 100, 100));
+  // zooming in further needs more resolution
+  EXPECT_FALSE(sat.coversView(inside, 1000, 1000));
+}
@@ -0,0 +1,60 @@
+#include <diSatHeaderCache.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const std::string ID = "/data/sat/noaa*.mitiff\nmitiff\n\n\n\n0";
+
+SatHeaderCache::Entries makeEntries()
+{
+  SatHeaderCache::Entries entries;
+
+  SatHeaderCache::Entry& e1 = entries["/data/sat/noaa19_201603011205.mitiff"];
+  e1.size = 4567890;
+  e1.mtime = 1456833900123456789LL;
+  e1.header.time = miutil::miTime(2016, 3, 1, 12, 5, 0);
+  e1.header.palette = false;
+  e1.header.channel.push_back("1");
+  e1.header.channel.push_back("2");
+  e1.header.channel.push_back("4");
+
+  SatHeaderCache::Entry& e2 = entries["/data/sat/noaa19_201603011347.mitiff"];
+  e2.size = 123;
+  e2.mtime = 1456840020000000000LL;
+  e2.header.palette = true;
+
+  return entries;
+}
+
+} // namespace
+
+TEST(TestSatHeaderCache, WriteRead)
+{
+  const SatHeaderCache::Entries entries = makeEntries();
+  const std::string data = SatHeaderCache::write(ID, entries);
+
+  SatHeaderCache::Entries read;
+  ASSERT_TRUE(SatHeaderCache::read(data.data(), data.size(), ID, read));
+  ASSERT_EQ(entries.size(), read.size());
+  for (const SatHeaderCache::Entries::value_type& e : entries) {
+    SatHeaderCache::Entries::const_iterator it = read.find(e.first);
+    ASSERT_TRUE(it != read.end()) << e.first;
+    EXPECT_EQ(e.second.size, it->second.size);
+    EXPECT_EQ(e.second.mtime, it->second.mtime);
+    EXPECT_EQ(e.second.header.time, it->second.header.time);
+    EXPECT_EQ(e.second.header.palette, it->second.header.palette);
+    EXPECT_EQ(e.second.header.channel, it->second.header.channel);
+  }
+  EXPECT_TRUE(read["/data/sat/noaa19_201603011347.mitiff"].header.time.undef());
+}
+
+TEST(TestSatHeaderCache, ReadMismatch)
+{
+  const std::string data = SatHeaderCache::write(ID, makeEntries());
+
+  SatHeaderCache::Entries read;
+  EXPECT_FALSE(SatHeaderCache::read(data.data(), data.size(), ID + "x", read));
+  EXPECT_FALSE(SatHeaderCache::read(data.data(), data.size() - 1, ID, read));
+  EXPECT_TRUE(read.empty());
+}
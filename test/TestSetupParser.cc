@@ -7,8 +7,15 @@
 #endif
 
 #include "miSetupParser.h"
+#include <export/qtTempDir.h>
 #include <gtest/gtest.h>
 
+#include <cstdlib>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
 using miutil::SetupParser;
 
 TEST(miSetupParserTest, splitKeyValue1)
@@ -94,3 +101,63 @@ TEST(miSetupParserTest, substitute)
     EXPECT_EQ("/long/is/good", in_out);
   }
 }
+
+namespace {
+void writeFile(const std::string& filename, const std::string& content)
+{
+  std::ofstream out(filename.c_str());
+  out << content;
+}
+
+std::vector<std::string> section(const std::string& name)
+{
+  std::vector<std::string> lines;
+  SetupParser::getSection(name, lines);
+  return lines;
+}
+} // namespace
+
+TEST(miSetupParserTest, Snapshot)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+  const std::string dir = tmp.dir().absolutePath().toStdString();
+  const std::string main = dir + "/main.setup", inc = dir + "/inc.setup";
+  writeFile(main, "ROOT=/data\n%include " + inc + "\n<MAIN>\npath=$(ROOT)/${DIANA_TEST_SNAPSHOT}\n</MAIN>\n");
+  writeFile(inc, "<INC>\nline = one\n</INC>\n");
+  setenv("DIANA_TEST_SNAPSHOT", "a", 1);
+
+  SetupParser::destroy();
+  SetupParser::setCacheDirectory(dir + "/cache");
+  ASSERT_TRUE(SetupParser::parse(main));
+  ASSERT_EQ(std::vector<std::string>(1, "path=/data/a"), section("MAIN"));
+  ASSERT_EQ(std::vector<std::string>(1, "line=one"), section("INC"));
+  const std::string snapshot = SetupParser::instance()->writeSnapshot("x");
+
+  { // same size and mtime, the file is not read again
+    struct stat st;
+    ASSERT_EQ(0, stat(inc.c_str(), &st));
+    writeFile(inc, "<INC>\nline = two\n</INC>\n");
+    const struct timespec times[2] = { st.st_atim, st.st_mtim };
+    ASSERT_EQ(0, utimensat(AT_FDCWD, inc.c_str(), times, 0));
+  }
+  ASSERT_TRUE(SetupParser::parse(main));
+  EXPECT_EQ(std::vector<std::string>(1, "line=one"), section("INC"));
+  EXPECT_TRUE(SetupParser::instance()->readSnapshot(snapshot.data(), snapshot.size(), "x"));
+  EXPECT_FALSE(SetupParser::instance()->readSnapshot(snapshot.data(), snapshot.size(), "y"));
+  EXPECT_FALSE(SetupParser::instance()->readSnapshot(snapshot.data(), snapshot.size() - 1, "x"));
+
+  // changed file
+  writeFile(inc, "<INC>\nline = three\n</INC>\n");
+  ASSERT_TRUE(SetupParser::parse(main));
+  EXPECT_EQ(std::vector<std::string>(1, "line=three"), section("INC"));
+
+  // changed environment
+  setenv("DIANA_TEST_SNAPSHOT", "b", 1);
+  ASSERT_TRUE(SetupParser::parse(main));
+  EXPECT_EQ(std::vector<std::string>(1, "path=/data/b"), section("MAIN"));
+  EXPECT_FALSE(SetupParser::instance()->readSnapshot(snapshot.data(), snapshot.size(), "x"));
+
+  SetupParser::destroy();
+  unsetenv("DIANA_TEST_SNAPSHOT");
+}
@@ -0,0 +1,118 @@
+#include <util/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(TestThreadPool, ParallelFor)
+{
+  const size_t n = 100000;
+  std::vector<int> visited(n, 0);
+  diutil::parallel_for(0, n, 1000, [&](size_t i0, size_t i1) {
+      for (size_t i = i0; i < i1; ++i)
+        visited[i] += 1;
+    });
+  for (size_t i = 0; i < n; ++i)
+    ASSERT_EQ(1, visited[i]) << " i=" << i;
+
+  // empty and small ranges
+  diutil::parallel_for(5, 5, 1, [](size_t, size_t) { FAIL(); });
+  size_t calls = 0;
+  diutil::parallel_for(0, 10, 100, [&](size_t i0, size_t i1) { calls += 1; EXPECT_EQ(0u, i0); EXPECT_EQ(10u, i1); });
+  EXPECT_EQ(1u, calls);
+}
+
+TEST(TestThreadPool, ParallelSum)
+{
+  const size_t sum = diutil::parallel_sum<size_t>(0, 10001, 100, [](size_t i0, size_t i1) {
+      size_t s = 0;
+      for (size_t i = i0; i < i1; ++i)
+        s += i;
+      return s;
+    });
+  EXPECT_EQ(size_t(10000*10001/2), sum);
+}
+
+TEST(TestThreadPool, Nested)
+{
+  std::atomic<int> count(0);
+  diutil::parallel_for(0, 64, 1, [&](size_t i0, size_t i1) {
+      for (size_t i = i0; i < i1; ++i) {
+        diutil::parallel_for(0, 64, 1, [&](size_t j0, size_t j1) {
+            count += (j1 - j0);
+          });
+      }
+    });
+  EXPECT_EQ(64*64, count);
+}
+
+TEST(TestThreadPool, Exception)
+{
+  diutil::TaskGroup group;
+  std::atomic<int> count(0);
+  for (int i = 0; i < 10; ++i) {
+    group.run([&count, i]() {
+        count += 1;
+        if (i == 3)
+          throw std::runtime_error("task failed");
+      });
+  }
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_EQ(10, count);
+
+  // the group can be used again after an exception
+  group.run([&count]() { count += 1; });
+  EXPECT_NO_THROW(group.wait());
+  EXPECT_EQ(11, count);
+}
+
+TEST(TestThreadPool, Throttle)
+{
+  diutil::TaskGroup group;
+  std::atomic<int> running(0), maxRunning(0), count(0);
+  for (int i = 0; i < 20; ++i) {
+    group.throttle(2);
+    group.run([&]() {
+        const int r = ++running;
+        int m = maxRunning;
+        while (r > m && !maxRunning.compare_exchange_weak(m, r))
+          ;
+        count += 1;
+        running -= 1;
+      });
+  }
+  group.wait();
+  EXPECT_EQ(20, count);
+  EXPECT_LE(maxRunning, 3);
+}
+
+TEST(TestThreadPool, WaitRunsOwnTasks)
+{
+  const std::thread::id self = std::this_thread::get_id();
+  std::atomic<bool> waiting(false), ranOther(false);
+
+  diutil::TaskGroup other;
+  for (int i = 0; i < 20; ++i) {
+    other.run([&]() {
+        if (waiting && std::this_thread::get_id() == self)
+          ranOther = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      });
+  }
+
+  diutil::TaskGroup own;
+  std::atomic<int> count(0);
+  for (int i = 0; i < 20; ++i)
+    own.run([&count]() { count += 1; });
+  waiting = true;
+  own.wait();
+  waiting = false;
+  EXPECT_EQ(20, count);
+  EXPECT_FALSE(ranOther);
+
+  other.wait();
+}
@@ -32,11 +32,14 @@
 #include <util/format_int.h>
 #include <util/math_util.h>
 #include <util/polygon_util.h>
+#include <util/rectangle_tree.h>
 #include <util/string_util.h>
 
 #include <diField/diRectangle.h>
 #include <puCtools/puCglob.h> // for GLOB_BRACE
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
 
 static const std::string SRC_TEST = TEST_SRCDIR "/";
@@ -126,6 +129,25 @@ TEST(TestUtilities, format_int)
   ASSERT_EQ("07-24   xx0", out);
 }
 
+TEST(TestUtilities, format_fixed)
+{
+  EXPECT_EQ("12.3", diutil::format_fixed(12.34f, 1));
+  EXPECT_EQ("-0.0", diutil::format_fixed(-0.04f, 1));
+  EXPECT_EQ("+1013.2", diutil::format_fixed(1013.2f, 1, true));
+  EXPECT_EQ("0.2", diutil::format_fixed(0.25f, 1)); // ties to even, like printf
+  EXPECT_EQ("4", diutil::format_fixed(3.5f, 0));
+  EXPECT_EQ("1e+20", diutil::format_general(1e20f));
+
+  const float values[] = { 0, 0.05f, -7.45f, 999.95f, 12345.678f, 2.5e11f, 3e15f };
+  for (float v : values) {
+    for (int d = 0; d <= 3; ++d) {
+      char expected[64];
+      snprintf(expected, sizeof(expected), "%.*f", d, double(v));
+      EXPECT_EQ(expected, diutil::format_fixed(v, d)) << " v=" << v << " d=" << d;
+    }
+  }
+}
+
 TEST(TestUtilities, numberList)
 {
   const char* expected_c[13] = { "0.4", "0.5", "0.6", "0.7", "0.8", "0.9", "1", "2", "2.5", "3", "4", "5", "6" };
@@ -222,6 +244,125 @@ TEST(TestUtilities, trimToRectangle)
   }
 }
 
+TEST(TestUtilities, simplificationImportance)
+{
+  QPolygonF line;
+  line << QPointF(0, 0)
+       << QPointF(1, 0.1)
+       << QPointF(2, 3)
+       << QPointF(3, 0.5)
+       << QPointF(4, 0);
+
+  std::vector<float> importance;
+  diutil::simplificationImportance(line, importance);
+  ASSERT_EQ(5, importance.size());
+  EXPECT_TRUE(std::isinf(importance[0]));
+  EXPECT_TRUE(std::isinf(importance[4]));
+  EXPECT_FLOAT_EQ(3, importance[2]);
+  EXPECT_GT(importance[1], importance[3]);
+
+  QPolygonF expect;
+  expect << QPointF(0, 0) << QPointF(2, 3) << QPointF(4, 0);
+  EXPECT_EQ(expect, diutil::simplified(line, importance, 1));
+  EXPECT_EQ(line, diutil::simplified(line, importance, 0));
+
+  expect.clear();
+  expect << QPointF(0, 0) << QPointF(4, 0);
+  EXPECT_EQ(expect, diutil::simplified(line, importance, 10));
+}
+
+TEST(TestUtilities, simplificationImportanceClosed)
+{
+  QPolygonF ring;
+  ring << QPointF(0, 0) << QPointF(2, 0) << QPointF(2, 1) << QPointF(0, 1) << QPointF(0, 0);
+
+  std::vector<float> importance;
+  diutil::simplificationImportance(ring, importance);
+  ASSERT_EQ(5, importance.size());
+  // distance from the first point
+  EXPECT_FLOAT_EQ(std::sqrt(5.0f), importance[2]);
+  EXPECT_FLOAT_EQ(2/std::sqrt(5.0f), importance[1]);
+  EXPECT_FLOAT_EQ(2/std::sqrt(5.0f), importance[3]);
+}
+
+TEST(TestUtilities, RectangleTree)
+{
+  std::vector<Rectangle> boxes;
+  for (int i=0; i<100; ++i) {
+    for (int j=0; j<50; ++j)
+      boxes.push_back(Rectangle(i, j, i+0.5, j+0.5));
+  }
+
+  diutil::RectangleTree tree;
+  EXPECT_TRUE(tree.empty());
+  tree.build(boxes);
+  EXPECT_EQ(boxes.size(), tree.size());
+
+  const Rectangle query(10.7, 20.2, 12.2, 21.6);
+  std::vector<size_t> found;
+  tree.query(query, found);
+
+  std::vector<size_t> expected;
+  for (size_t i=0; i<boxes.size(); ++i) {
+    if (query.intersects(boxes[i]))
+      expected.push_back(i);
+  }
+  EXPECT_EQ(4, expected.size());
+  EXPECT_EQ(expected, found);
+
+  found.clear();
+  tree.query(Rectangle(-10, -10, -5, -5), found);
+  EXPECT_TRUE(found.empty());
+
+  found.clear();
+  tree.query(Rectangle(-10, -10, 200, 200), found);
+  EXPECT_EQ(boxes.size(), found.size());
+
+  tree.clear();
+  EXPECT_TRUE(tree.empty());
+  found.clear();
+  tree.query(query, found);
+  EXPECT_TRUE(found.empty());
+}
+
+TEST(TestUtilities, RectangleIndex)
+{
+  diutil::RectangleIndex index;
+  for (size_t i=0; i<1000; ++i)
+    index.set(i, Rectangle(i, 0, i+0.5, 1));
+
+  const Rectangle query(10.2, 0.5, 12.7, 0.6);
+  std::vector<size_t> found;
+  index.query(query, found);
+  EXPECT_EQ((std::vector<size_t>{ 10, 11, 12 }), found);
+
+  // move one box into the query, another one out, and remove a third
+  index.set(500, Rectangle(12.6, 0, 13, 1));
+  index.set(11, Rectangle(100, 0, 101, 1));
+  index.remove(12);
+  EXPECT_FALSE(index.contains(12));
+  found.clear();
+  index.query(query, found);
+  EXPECT_EQ((std::vector<size_t>{ 10, 500 }), found);
+
+  // many changes cause a rebuild
+  for (size_t i=0; i<1000; i += 2)
+    index.set(i, Rectangle(i+0.5, 2, i+1, 3));
+  found.clear();
+  index.query(Rectangle(0, 0, 20, 1), found);
+  EXPECT_EQ((std::vector<size_t>{ 1, 3, 5, 7, 9, 13, 15, 17, 19 }), found);
+
+  index.set(12, Rectangle(0, 0, 1, 1));
+  found.clear();
+  index.query(Rectangle(0, 0, 1, 1), found);
+  EXPECT_EQ((std::vector<size_t>{ 1, 12 }), found);
+
+  index.clear();
+  found.clear();
+  index.query(Rectangle(-10, -10, 2000, 20), found);
+  EXPECT_TRUE(found.empty());
+}
+
 TEST(TestUtilities, Latin1ToUtf8)
 {
   ASSERT_TRUE(bool(diutil::findConverter(diutil::ISO_8859_1, diutil::UTF_8)));
@@ -27,8 +27,20 @@
   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include "WebMapTestServer.h"
+
+#include <export/qtTempDir.h>
+#include <wmsclient/WebMapService.h>
+#include <wmsclient/WebMapTile.h>
+#include <wmsclient/WebMapTileCache.h>
 #include <wmsclient/WebMapUtilities.h>
+
+#include <QEventLoop>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
 #include <QStringList>
+#include <QTimer>
+
 #include <gtest/gtest.h>
 
 TEST(WebMapUtilities, ParseDecimals)
@@ -316,3 +328,169 @@ TEST(WebMapUtilities, ExpandWmsValues)
       EXPECT_EQ(expected[i], actual[i].toStdString()) << "i=" << i;
   }
 }
+
+TEST(WebMapTileCache, ParseHttpDate)
+{
+  EXPECT_EQ(784111777000LL, WebMapTileCache::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT"));
+  EXPECT_EQ(-1, WebMapTileCache::parseHttpDate(""));
+  EXPECT_EQ(-1, WebMapTileCache::parseHttpDate("0"));
+  EXPECT_EQ(-1, WebMapTileCache::parseHttpDate("Sun, 06 Xyz 1994 08:49:37 GMT"));
+}
+
+TEST(WebMapTileCache, SetFromHeaders)
+{
+  const int64_t now = 1400000000000LL;
+
+  { WebMapTileCache::Entry e;
+    WebMapTileCache::Headers h;
+    EXPECT_FALSE(WebMapTileCache::setFromHeaders(e, h, now));
+  }
+  { WebMapTileCache::Entry e;
+    WebMapTileCache::Headers h;
+    h.cacheControl = "public, max-age=600";
+    EXPECT_TRUE(WebMapTileCache::setFromHeaders(e, h, now));
+    EXPECT_EQ(now + 600000, e.expires);
+    EXPECT_TRUE(WebMapTileCache::fresh(e, now + 599999));
+    EXPECT_FALSE(WebMapTileCache::fresh(e, now + 600000));
+
+    h.age = "100";
+    EXPECT_TRUE(WebMapTileCache::setFromHeaders(e, h, now));
+    EXPECT_EQ(now + 500000, e.expires);
+  }
+  { WebMapTileCache::Entry e;
+    WebMapTileCache::Headers h;
+    h.cacheControl = "no-store, max-age=600";
+    EXPECT_FALSE(WebMapTileCache::setFromHeaders(e, h, now));
+  }
+  { WebMapTileCache::Entry e;
+    WebMapTileCache::Headers h;
+    h.cacheControl = "No-Cache";
+    EXPECT_FALSE(WebMapTileCache::setFromHeaders(e, h, now));
+    h.etag = "\"abc\"";
+    EXPECT_TRUE(WebMapTileCache::setFromHeaders(e, h, now));
+    EXPECT_EQ(0, e.expires);
+    EXPECT_EQ("\"abc\"", e.etag);
+
+    // a 304 reply might not repeat the ETag
+    h.etag.clear();
+    h.cacheControl = "max-age=60";
+    EXPECT_TRUE(WebMapTileCache::setFromHeaders(e, h, now));
+    EXPECT_EQ(now + 60000, e.expires);
+    EXPECT_EQ("\"abc\"", e.etag);
+  }
+  { WebMapTileCache::Entry e;
+    WebMapTileCache::Headers h;
+    h.date = "Sun, 06 Nov 1994 08:49:37 GMT";
+    h.expires = "Sun, 06 Nov 1994 09:49:37 GMT";
+    EXPECT_TRUE(WebMapTileCache::setFromHeaders(e, h, now));
+    EXPECT_EQ(now + 3600000, e.expires);
+
+    h.expires = "0";
+    EXPECT_FALSE(WebMapTileCache::setFromHeaders(e, h, now));
+  }
+  { WebMapTileCache::Entry e;
+    WebMapTileCache::Headers h;
+    h.date = "Sun, 06 Nov 1994 08:49:37 GMT";
+    h.lastModified = "Sat, 05 Nov 1994 22:49:37 GMT";
+    EXPECT_TRUE(WebMapTileCache::setFromHeaders(e, h, now));
+    EXPECT_EQ(now + 3600000, e.expires); // 10% of the time since last modification
+    EXPECT_EQ(h.lastModified, e.lastModified);
+  }
+}
+
+TEST(WebMapTileCache, WriteRead)
+{
+  WebMapTileCache::Entry e;
+  e.expires = 1400000000000LL;
+  e.etag = "\"v1\"";
+  e.contentType = "image/png";
+  e.data = std::string("\x89PNG\0\1\2", 7);
+
+  const std::string data = WebMapTileCache::write("key", e);
+
+  WebMapTileCache::Entry r;
+  ASSERT_TRUE(WebMapTileCache::read(data.data(), data.size(), "key", r));
+  EXPECT_EQ(e.expires, r.expires);
+  EXPECT_EQ(e.etag, r.etag);
+  EXPECT_EQ(e.lastModified, r.lastModified);
+  EXPECT_EQ(e.contentType, r.contentType);
+  EXPECT_EQ(e.data, r.data);
+
+  EXPECT_FALSE(WebMapTileCache::read(data.data(), data.size(), "other", r));
+  EXPECT_FALSE(WebMapTileCache::read(data.data(), data.size() - 1, "key", r));
+}
+
+namespace {
+
+class TestService : public WebMapService {
+public:
+  TestService(QNetworkAccessManager* network)
+    : WebMapService("test", network) { }
+
+  WebMapRequest_x createRequest(const std::string&, const Rectangle&,
+      const Projection&, double, int, int) override
+    { return 0; }
+};
+
+bool fetch(WebMapService& service, WebMapTile& tile, const QUrl& url)
+{
+  service.submitImage(&tile, url);
+  if (const QNetworkReply* reply = tile.reply()) {
+    if (!reply->isFinished()) {
+      QEventLoop loop;
+      QObject::connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+      QTimer::singleShot(10000, &loop, SLOT(quit()));
+      loop.exec();
+    }
+  }
+  return tile.loadImage("image/png");
+}
+
+} // namespace
+
+TEST(WebMapTileCache, TestServer)
+{
+  TempDir tmp;
+  ASSERT_TRUE(tmp.create());
+  WebMapTileCache::instance().setDirectory(tmp.dir().absolutePath().toStdString());
+
+  WebMapTestServer server;
+  ASSERT_TRUE(server.listen());
+  QNetworkAccessManager network;
+  TestService service(&network);
+
+  // fresh for one hour, second fetch must not reach the server
+  server.setCacheControl("max-age=3600");
+  const QUrl url = server.url("/tiles/3/4/2.png");
+  for (int i=0; i<2; ++i) {
+    WebMapTile tile(4, 2, Rectangle(0, 0, 1, 1));
+    tile.setCacheKey("fresh");
+    EXPECT_TRUE(fetch(service, tile, url)) << "i=" << i;
+    EXPECT_EQ(256, tile.image().width());
+  }
+  EXPECT_EQ(1, server.requests());
+
+  // must revalidate, second fetch gets "304 Not Modified"
+  server.setCacheControl("no-cache");
+  server.setETag("\"v1\"");
+  for (int i=0; i<2; ++i) {
+    WebMapTile tile(4, 3, Rectangle(0, 0, 1, 1));
+    tile.setCacheKey("revalidate");
+    EXPECT_TRUE(fetch(service, tile, url)) << "i=" << i;
+    EXPECT_EQ(256, tile.image().width());
+  }
+  EXPECT_EQ(3, server.requests());
+  EXPECT_EQ(1, server.notModified());
+
+  // not stored
+  server.setCacheControl("no-store");
+  server.setETag("");
+  for (int i=0; i<2; ++i) {
+    WebMapTile tile(4, 4, Rectangle(0, 0, 1, 1));
+    tile.setCacheKey("nostore");
+    EXPECT_TRUE(fetch(service, tile, url)) << "i=" << i;
+  }
+  EXPECT_EQ(5, server.requests());
+
+  WebMapTileCache::instance().setDirectory("");
+}
@@ -0,0 +1,93 @@
+#include "WebMapTestServer.h"
+
+#include <QBuffer>
+#include <QImage>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+WebMapTestServer::WebMapTestServer()
+  : mServer(new QTcpServer(this))
+  , mRequests(0)
+  , mNotModified(0)
+{
+  connect(mServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
+
+  QImage image(256, 256, QImage::Format_ARGB32);
+  image.fill(qRgba(0, 128, 255, 255));
+  QBuffer buffer(&mTile);
+  buffer.open(QIODevice::WriteOnly);
+  image.save(&buffer, "PNG");
+}
+
+WebMapTestServer::~WebMapTestServer()
+{
+}
+
+bool WebMapTestServer::listen()
+{
+  return mServer->listen(QHostAddress::LocalHost, 0);
+}
+
+QUrl WebMapTestServer::url(const QString& path) const
+{
+  return QUrl(QString("http://127.0.0.1:%1%2").arg(mServer->serverPort()).arg(path));
+}
+
+void WebMapTestServer::newConnection()
+{
+  while (QTcpSocket* socket = mServer->nextPendingConnection()) {
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+  }
+}
+
+void WebMapTestServer::readRequest()
+{
+  QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+  if (!socket)
+    return;
+  QByteArray& pending = mPending[socket];
+  pending += socket->readAll();
+  const int end = pending.indexOf("\r\n\r\n");
+  if (end < 0)
+    return; // header incomplete
+  const QByteArray request = pending.left(end);
+  mPending.remove(socket);
+  respond(socket, request);
+}
+
+void WebMapTestServer::respond(QTcpSocket* socket, const QByteArray& request)
+{
+  mRequests += 1;
+
+  QByteArray ifNoneMatch;
+  const QList<QByteArray> lines = request.split('\n');
+  for (int i=1; i<lines.size(); ++i) {
+    const QByteArray line = lines.at(i).trimmed();
+    const int colon = line.indexOf(':');
+    if (colon > 0 && line.left(colon).toLower() == "if-none-match")
+      ifNoneMatch = line.mid(colon + 1).trimmed();
+  }
+
+  QByteArray response;
+  const bool notModified = (!mETag.isEmpty() && ifNoneMatch == mETag);
+  if (notModified) {
+    mNotModified += 1;
+    response += "HTTP/1.1 304 Not Modified\r\n";
+  } else {
+    response += "HTTP/1.1 200 OK\r\n";
+    response += "Content-Type: image/png\r\n";
+  }
+  if (!mCacheControl.isEmpty())
+    response += "Cache-Control: " + mCacheControl + "\r\n";
+  if (!mETag.isEmpty())
+    response += "ETag: " + mETag + "\r\n";
+  response += "Content-Length: " + QByteArray::number(notModified ? 0 : mTile.size()) + "\r\n";
+  response += "Connection: close\r\n\r\n";
+  if (!notModified)
+    response += mTile;
+
+  socket->write(response);
+  socket->disconnectFromHost();
+}
@@ -0,0 +1,67 @@
+#ifndef WEBMAPTESTSERVER_H
+#define WEBMAPTESTSERVER_H 1
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QUrl>
+
+class QTcpServer;
+class QTcpSocket;
+
+/*! Minimal HTTP server on localhost, standing in for a tile server.
+ *
+ * Answers every GET request with the same PNG tile, or with "304 Not
+ * Modified" if the request has a matching If-None-Match header.
+ */
+class WebMapTestServer : public QObject {
+  Q_OBJECT;
+
+public:
+  WebMapTestServer();
+  ~WebMapTestServer();
+
+  //! start listening on a free port
+  bool listen();
+
+  //! url for path on this server, path must start with '/'
+  QUrl url(const QString& path) const;
+
+  //! value of the Cache-Control response header; empty for none
+  void setCacheControl(const QByteArray& cc)
+    { mCacheControl = cc; }
+
+  //! value of the ETag response header; empty for none
+  void setETag(const QByteArray& etag)
+    { mETag = etag; }
+
+  //! number of requests received
+  int requests() const
+    { return mRequests; }
+
+  //! number of requests answered with "304 Not Modified"
+  int notModified() const
+    { return mNotModified; }
+
+  //! the tile sent in responses
+  const QByteArray& tile() const
+    { return mTile; }
+
+private Q_SLOTS:
+  void newConnection();
+  void readRequest();
+
+private:
+  void respond(QTcpSocket* socket, const QByteArray& request);
+
+private:
+  QTcpServer* mServer;
+  QMap<QTcpSocket*, QByteArray> mPending;
+  QByteArray mCacheControl;
+  QByteArray mETag;
+  QByteArray mTile;
+  int mRequests;
+  int mNotModified;
+};
+
+#endif // WEBMAPTESTSERVER_H